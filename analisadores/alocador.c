@@ -0,0 +1,446 @@
+#include <stdlib.h>
+#include <string.h>
+#include "alocador.h"
+
+// --- Teias ---
+
+static int eh_variavel(const FuncaoRI* f, RegRI r) {
+    return r != RI_NENHUM && !RI_EH_TEMPORARIO(f, r);
+}
+
+static uint32_t raiz(uint32_t* pai, uint32_t x) {
+    while (pai[x] != x) {
+        pai[x] = pai[pai[x]];
+        x = pai[x];
+    }
+    return x;
+}
+
+// A raiz é o menor nó: as teias vivas na entrada da função ficam com o seu
+static void unir(uint32_t* pai, uint32_t a, uint32_t b) {
+    a = raiz(pai, a);
+    b = raiz(pai, b);
+    if (a < b) pai[b] = a;
+    else if (b < a) pai[a] = b;
+}
+
+/*
+ * Nó de cada variável viva na entrada de 'b' (em 'atual'), numerados a partir
+ * de base[b] na ordem dos conjuntos; 'ligar' une cada um ao que 'atual' já
+ * tinha para a variável (a saída do predecessor).
+ */
+static void entradas(const FuncaoRI* f, uint32_t b, const uint32_t* base, uint32_t* atual,
+                     uint32_t* pai, int ligar) {
+    uint32_t k = base[b];
+    for (uint32_t w = 0; w < f->palavras; w++) {
+        for (uint64_t vivos = f->vivos_entrada[(size_t) b * f->palavras + w]; vivos != 0; vivos &= vivos - 1) {
+            RegRI r = f->globais_vivacidade[64 * w + (uint32_t) __builtin_ctzll(vivos)];
+            if (!eh_variavel(f, r)) continue;
+            if (ligar) unir(pai, k, atual[r]);
+            else atual[r] = k;
+            k++;
+        }
+    }
+}
+
+// Registrador da teia do nó 'no' da variável 'r', criado na primeira vez
+static RegRI registrador_da_teia(FuncaoRI* f, uint32_t* pai, RegRI* teia, uint8_t* usado, uint32_t no, RegRI r) {
+    uint32_t c = raiz(pai, no);
+    if (teia[c] == RI_NENHUM) {
+        teia[c] = usado[r] ? ri_novo_reg(f) : r;
+        usado[r] = 1;
+    }
+    return teia[c];
+}
+
+/*
+ * Os nós são as variáveis vivas na entrada de cada bloco alcançável e as
+ * instruções (as que definem uma variável). Numa passada, cada bloco liga a
+ * definição de cada variável que alcança a sua saída ao nó da entrada dos
+ * sucessores; na outra, cada leitura e escrita passa para o registrador da
+ * teia do nó que a alcança.
+ */
+static int separar_funcao(FuncaoRI* f) {
+    uint32_t* base = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    uint32_t* atual = malloc(((size_t) f->num_regs + 1) * sizeof(uint32_t));
+    if (!base || !atual) {
+        free(base);
+        free(atual);
+        return -1;
+    }
+    uint32_t num_entradas = 0;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        base[b] = num_entradas;
+        for (uint32_t w = 0; w < f->palavras; w++) {
+            for (uint64_t vivos = f->vivos_entrada[(size_t) b * f->palavras + w]; vivos != 0; vivos &= vivos - 1) {
+                num_entradas += eh_variavel(f, f->globais_vivacidade[64 * w + (uint32_t) __builtin_ctzll(vivos)]);
+            }
+        }
+    }
+    size_t num_nos = (size_t) num_entradas + f->num_instrs;
+    uint32_t* pai = malloc((num_nos + 1) * sizeof(uint32_t));
+    RegRI* teia = malloc((num_nos + 1) * sizeof(RegRI));
+    uint8_t* usado = calloc((size_t) f->num_locais + f->num_params + 1, 1);
+    int resultado = -1;
+    if (!pai || !teia || !usado) goto liberar;
+    for (size_t i = 0; i < num_nos; i++) {
+        pai[i] = (uint32_t) i;
+        teia[i] = RI_NENHUM;
+    }
+
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        const BlocoRI* bloco = &f->blocos[b];
+        entradas(f, b, base, atual, pai, 0);
+        for (uint32_t j = 0; j < bloco->num_instrs; j++) {
+            RegRI d = ri_definicao(RI_INSTR(f, b, j));
+            if (eh_variavel(f, d)) atual[d] = num_entradas + bloco->primeira + j;
+        }
+        for (int s = 0; s < bloco->num_sucessores; s++) entradas(f, bloco->sucessor[s], base, atual, pai, 1);
+    }
+
+    // As variáveis vivas na entrada da função ficam com o próprio registrador
+    entradas(f, 0, base, atual, pai, 0);
+    for (RegRI r = 0; r < f->num_locais + f->num_params; r++) {
+        if (ri_vivo_entrada(f, 0, r)) registrador_da_teia(f, pai, teia, usado, atual[r], r);
+    }
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        entradas(f, b, base, atual, pai, 0);
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            InstrRI* in = RI_INSTR(f, b, j);
+            RegRI usos[2];
+            int nu = ri_usos(in, usos);
+            // ri_usos devolve 'a' e depois 'b'
+            if (nu >= 1 && eh_variavel(f, in->a)) in->a = registrador_da_teia(f, pai, teia, usado, atual[in->a], in->a);
+            if (nu == 2 && eh_variavel(f, in->b)) in->b = registrador_da_teia(f, pai, teia, usado, atual[in->b], in->b);
+            if (in->op == RI_CHAMADA) {
+                RegRI* args = &f->argumentos[in->a];
+                for (uint32_t a = 0; a < in->b; a++) {
+                    if (eh_variavel(f, args[a])) args[a] = registrador_da_teia(f, pai, teia, usado, atual[args[a]], args[a]);
+                }
+            }
+            RegRI d = ri_definicao(in);
+            if (eh_variavel(f, d)) {
+                uint32_t no = num_entradas + f->blocos[b].primeira + j;
+                atual[d] = no;
+                in->d = registrador_da_teia(f, pai, teia, usado, no, d);
+            }
+        }
+    }
+    resultado = ri_calcular_vivacidade(f);
+
+liberar:
+    free(base);
+    free(atual);
+    free(pai);
+    free(teia);
+    free(usado);
+    return resultado;
+}
+
+int separar_teias(ProgramaRI* prog) {
+    if (separar_funcao(&prog->principal) != 0) return -1;
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) {
+        if (separar_funcao(&prog->funcoes[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+// --- Intervalos ---
+
+typedef struct {
+    uint32_t inicio;
+    RegRI reg;
+} InicioIntervalo;
+
+static int comparar_inicio(const void* a, const void* b) {
+    const InicioIntervalo* x = (const InicioIntervalo*) a;
+    const InicioIntervalo* y = (const InicioIntervalo*) b;
+    if (x->inicio != y->inicio) return x->inicio < y->inicio ? -1 : 1;
+    return x->reg < y->reg ? -1 : x->reg > y->reg;
+}
+
+typedef struct {
+    uint32_t* inicio;
+    uint32_t* fim;
+    uint64_t* peso;
+    uint32_t* chamadas;         // Posição de cada chamada, em ordem
+    uint64_t* peso_chamadas;    // Soma dos pesos das chamadas anteriores a cada uma
+    uint32_t num_chamadas;
+} Intervalos;
+
+static void estender(Intervalos* iv, RegRI r, uint32_t posicao) {
+    if (posicao < iv->inicio[r]) iv->inicio[r] = posicao;
+    if (posicao > iv->fim[r]) iv->fim[r] = posicao;
+}
+
+static void acessar(Intervalos* iv, RegRI r, uint32_t posicao, uint64_t peso) {
+    estender(iv, r, posicao);
+    iv->peso[r] += peso;
+}
+
+/*
+ * Intervalo de cada registrador virtual, do primeiro ao último ponto em que
+ * está vivo na ordem dos blocos (sem buracos): as definições e leituras, e a
+ * entrada e a saída dos blocos em que está vivo. O peso soma os acessos.
+ */
+static void calcular_intervalos(const FuncaoRI* f, const uint32_t* ordem, uint32_t num_ordem,
+                                const uint8_t* profundidade, Intervalos* iv) {
+    uint32_t posicao = 0;
+    iv->num_chamadas = 0;
+    iv->peso_chamadas[0] = 0;
+    for (uint32_t k = 0; k < num_ordem; k++) {
+        uint32_t b = ordem[k];
+        const BlocoRI* bloco = &f->blocos[b];
+        uint32_t primeira = 2 * posicao, ultima = 2 * (posicao + bloco->num_instrs) - 1;
+        for (uint32_t w = 0; w < f->palavras; w++) {
+            uint64_t entrada = f->vivos_entrada[(size_t) b * f->palavras + w];
+            uint64_t saida = f->vivos_saida[(size_t) b * f->palavras + w];
+            for (uint64_t vivos = entrada | saida; vivos != 0; vivos &= vivos - 1) {
+                uint32_t g = 64 * w + (uint32_t) __builtin_ctzll(vivos);
+                RegRI r = f->globais_vivacidade[g];
+                if (entrada & (1ull << (g % 64))) estender(iv, r, primeira);
+                if (saida & (1ull << (g % 64))) estender(iv, r, ultima);
+            }
+        }
+        uint64_t peso = 1ull << (3 * profundidade[b]);
+        for (uint32_t j = 0; j < bloco->num_instrs; j++, posicao++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            RegRI usos[2];
+            int nu = ri_usos(in, usos);
+            for (int u = 0; u < nu; u++) acessar(iv, usos[u], 2 * posicao, peso);
+            if (in->op == RI_CHAMADA) {
+                for (uint32_t a = 0; a < in->b; a++) acessar(iv, RI_ARGUMENTOS(f, in)[a], 2 * posicao, peso);
+                iv->chamadas[iv->num_chamadas] = posicao;
+                iv->peso_chamadas[iv->num_chamadas + 1] = iv->peso_chamadas[iv->num_chamadas] + peso;
+                iv->num_chamadas++;
+            }
+            RegRI d = ri_definicao(in);
+            if (d != RI_NENHUM) acessar(iv, d, 2 * posicao + 1, peso);
+        }
+    }
+}
+
+// Primeira chamada com 2p >= 'posicao', por busca binária
+static uint32_t chamada_desde(const Intervalos* iv, uint32_t posicao) {
+    uint32_t esq = 0, dir = iv->num_chamadas;
+    while (esq < dir) {
+        uint32_t meio = esq + (dir - esq) / 2;
+        if (2 * iv->chamadas[meio] >= posicao) dir = meio;
+        else esq = meio + 1;
+    }
+    return esq;
+}
+
+/*
+ * Peso das chamadas que o intervalo de 'r' atravessa (vivo antes e depois
+ * delas). Um intervalo que começa em 2p, a posição de uma chamada, já estava
+ * vivo antes dela: na ordem da RI, nenhum valor nasce numa leitura, então
+ * ele vem da entrada do bloco, e a chamada é a primeira instrução.
+ */
+static uint64_t peso_atravessado(const Intervalos* iv, RegRI r) {
+    if (iv->fim[r] < 2) return 0;
+    uint32_t primeira = chamada_desde(iv, iv->inicio[r]);
+    uint32_t depois = chamada_desde(iv, iv->fim[r] - 1);
+    return primeira < depois ? iv->peso_chamadas[depois] - iv->peso_chamadas[primeira] : 0;
+}
+
+// --- Varredura linear ---
+
+#define NUM_ALOCAVEIS (ALOCADOR_NUM_T + ALOCADOR_NUM_S)
+
+// 'r' vai para a memória: o lugar no quadro, ou um slot se é temporário
+static void derramar(const FuncaoRI* f, AlocacaoRI* aloc, RegRI r) {
+    aloc->registrador[r] = -1;
+    if (RI_EH_TEMPORARIO(f, r)) aloc->slot[r] = aloc->num_slots++;
+}
+
+/*
+ * Registradores do chamador a salvar em cada chamada: os $t ocupados por um
+ * valor vivo antes e depois dela. Os intervalos de cada registrador são
+ * disjuntos e vêm em ordem de início, então um ponteiro por registrador
+ * acompanha as chamadas, também em ordem.
+ */
+static int marcar_salvamentos(const InicioIntervalo* intervalos, uint32_t num_intervalos,
+                              const Intervalos* iv, AlocacaoRI* aloc) {
+    uint32_t contagem[ALOCADOR_NUM_T + 1] = { 0 };
+    for (uint32_t i = 0; i < num_intervalos; i++) {
+        int8_t reg = aloc->registrador[intervalos[i].reg];
+        if (reg >= ALOCADOR_PRIMEIRO_T && reg < ALOCADOR_PRIMEIRO_T + ALOCADOR_NUM_T) {
+            contagem[reg - ALOCADOR_PRIMEIRO_T + 1]++;
+        }
+    }
+    for (int r = 0; r < ALOCADOR_NUM_T; r++) contagem[r + 1] += contagem[r];
+    RegRI* por_registrador = malloc((num_intervalos > 0 ? num_intervalos : 1) * sizeof(RegRI));
+    if (por_registrador == NULL) return -1;
+    uint32_t proximo[ALOCADOR_NUM_T];
+    memcpy(proximo, contagem, sizeof(proximo));
+    for (uint32_t i = 0; i < num_intervalos; i++) {
+        int8_t reg = aloc->registrador[intervalos[i].reg];
+        if (reg >= ALOCADOR_PRIMEIRO_T && reg < ALOCADOR_PRIMEIRO_T + ALOCADOR_NUM_T) {
+            por_registrador[proximo[reg - ALOCADOR_PRIMEIRO_T]++] = intervalos[i].reg;
+        }
+    }
+    memcpy(proximo, contagem, sizeof(proximo));
+
+    for (uint32_t c = 0; c < iv->num_chamadas; c++) {
+        uint32_t posicao = iv->chamadas[c];
+        uint8_t mascara = 0;
+        for (int r = 0; r < ALOCADOR_NUM_T; r++) {
+            while (proximo[r] < contagem[r + 1] && iv->fim[por_registrador[proximo[r]]] <= 2 * posicao + 1) proximo[r]++;
+            if (proximo[r] < contagem[r + 1] && iv->inicio[por_registrador[proximo[r]]] <= 2 * posicao) {
+                mascara |= (uint8_t) (1u << r);
+            }
+        }
+        aloc->salvar[c] = mascara;
+        aloc->salvos |= mascara;
+    }
+    free(por_registrador);
+    return 0;
+}
+
+// Primeiro registrador livre em [de, de + n), ou -1
+static int livre_entre(const RegRI* ocupante, int de, int n) {
+    for (int r = de; r < de + n; r++) {
+        if (ocupante[r] == RI_NENHUM) return r;
+    }
+    return -1;
+}
+
+int alocar_registradores(const FuncaoRI* f, const uint32_t* ordem, uint32_t num_ordem, int preservar,
+                         AlocacaoRI* aloc) {
+    memset(aloc, 0, sizeof(AlocacaoRI));
+    uint32_t n = f->num_regs, num_chamadas = 0;
+    for (uint32_t k = 0; k < num_ordem; k++) {
+        for (uint32_t j = 0; j < f->blocos[ordem[k]].num_instrs; j++) {
+            num_chamadas += RI_INSTR(f, ordem[k], j)->op == RI_CHAMADA;
+        }
+    }
+    Intervalos iv;
+    aloc->registrador = malloc(n > 0 ? n : 1);
+    aloc->slot = malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+    aloc->salvar = malloc(num_chamadas > 0 ? num_chamadas : 1);
+    aloc->num_chamadas = num_chamadas;
+    iv.inicio = malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+    iv.fim = calloc(n > 0 ? n : 1, sizeof(uint32_t));
+    iv.peso = calloc(n > 0 ? n : 1, sizeof(uint64_t));
+    iv.chamadas = malloc((num_chamadas > 0 ? num_chamadas : 1) * sizeof(uint32_t));
+    iv.peso_chamadas = malloc(((size_t) num_chamadas + 1) * sizeof(uint64_t));
+    uint8_t* profundidade = malloc(f->num_blocos > 0 ? f->num_blocos : 1);
+    InicioIntervalo* intervalos = NULL;
+    int resultado = -1;
+    if (!aloc->registrador || !aloc->slot || !aloc->salvar || !iv.inicio || !iv.fim || !iv.peso ||
+        !iv.chamadas || !iv.peso_chamadas || !profundidade || ri_calcular_profundidade(f, profundidade) != 0) {
+        goto liberar;
+    }
+    memset(aloc->registrador, -1, n);
+    for (uint32_t r = 0; r < n; r++) {
+        aloc->slot[r] = RI_NENHUM;
+        iv.inicio[r] = UINT32_MAX;
+    }
+
+    calcular_intervalos(f, ordem, num_ordem, profundidade, &iv);
+    // Um local lido antes de escrito fica no quadro, como no gerador da AST
+    for (RegRI r = 0; r < f->num_locais; r++) {
+        if (ri_vivo_entrada(f, ordem[0], r)) iv.inicio[r] = UINT32_MAX;
+    }
+    uint32_t num_intervalos = 0;
+    for (RegRI r = 0; r < n; r++) num_intervalos += iv.inicio[r] != UINT32_MAX;
+    intervalos = malloc((num_intervalos > 0 ? num_intervalos : 1) * sizeof(InicioIntervalo));
+    if (!intervalos) goto liberar;
+    num_intervalos = 0;
+    for (RegRI r = 0; r < n; r++) {
+        if (iv.inicio[r] == UINT32_MAX) continue;
+        intervalos[num_intervalos].inicio = iv.inicio[r];
+        intervalos[num_intervalos++].reg = r;
+    }
+    qsort(intervalos, num_intervalos, sizeof(InicioIntervalo), comparar_inicio);
+
+    // Índice r em 'ocupante' é o registrador do MIPS ALOCADOR_PRIMEIRO_T + r
+    RegRI ocupante[NUM_ALOCAVEIS];
+    for (int r = 0; r < NUM_ALOCAVEIS; r++) ocupante[r] = RI_NENHUM;
+    uint32_t preservado = 0;    // $s que já custaram o salvamento
+
+    for (uint32_t i = 0; i < num_intervalos; i++) {
+        RegRI atual = intervalos[i].reg;
+        for (int r = 0; r < NUM_ALOCAVEIS; r++) {
+            if (ocupante[r] != RI_NENHUM && iv.fim[ocupante[r]] < iv.inicio[atual]) ocupante[r] = RI_NENHUM;
+        }
+        /*
+         * Custo de cada lugar, em acessos ponderados: na memória, os próprios
+         * acessos; num $t, salvar e recuperar em cada chamada atravessada; num
+         * $s ainda não usado, salvá-lo no prólogo e recuperá-lo no epílogo. Um
+         * parâmetro vivo na entrada ainda é carregado uma vez no registrador.
+         */
+        uint64_t carga = atual >= f->num_locais && atual < f->num_locais + f->num_params &&
+                         ri_vivo_entrada(f, ordem[0], atual);
+        uint64_t custo_t = 2 * peso_atravessado(&iv, atual) + carga;
+        int livre = livre_entre(ocupante, 0, ALOCADOR_NUM_T), livre_s = -1;
+        for (int r = ALOCADOR_NUM_T; r < NUM_ALOCAVEIS; r++) {
+            if (ocupante[r] != RI_NENHUM) continue;
+            // Um $s já preservado sai de graça
+            if (livre_s < 0 || (preservado & (1u << (r - ALOCADOR_NUM_T)))) livre_s = r;
+            if (preservado & (1u << (r - ALOCADOR_NUM_T))) break;
+        }
+        uint64_t custo_s = carga;
+        if (livre_s >= 0 && preservar && !(preservado & (1u << (livre_s - ALOCADOR_NUM_T)))) custo_s += 2;
+        if (livre < 0 || (livre_s >= 0 && custo_s < custo_t)) {
+            livre = livre_s;
+            custo_t = custo_s;
+        }
+        if (livre >= 0 && custo_t > iv.peso[atual]) {
+            derramar(f, aloc, atual);
+            continue;
+        }
+        if (livre < 0) {
+            // Todos ocupados: vai para a memória o mais leve, ou o que termina mais tarde
+            int leve = -1;
+            uint64_t menor = iv.peso[atual];
+            uint32_t fim_menor = iv.fim[atual];
+            for (int r = 0; r < NUM_ALOCAVEIS; r++) {
+                RegRI o = ocupante[r];
+                if (iv.peso[o] < menor || (iv.peso[o] == menor && iv.fim[o] > fim_menor)) {
+                    leve = r;
+                    menor = iv.peso[o];
+                    fim_menor = iv.fim[o];
+                }
+            }
+            if (leve < 0) {
+                derramar(f, aloc, atual);
+                continue;
+            }
+            derramar(f, aloc, ocupante[leve]);
+            livre = leve;
+        }
+        ocupante[livre] = atual;
+        aloc->registrador[atual] = (int8_t) (ALOCADOR_PRIMEIRO_T + livre);
+        if (livre >= ALOCADOR_NUM_T) preservado |= 1u << (livre - ALOCADOR_NUM_T);
+    }
+
+    // Um $s cujos ocupantes foram todos derramados não precisa ser preservado
+    for (uint32_t i = 0; i < num_intervalos; i++) {
+        int8_t reg = aloc->registrador[intervalos[i].reg];
+        if (reg >= ALOCADOR_PRIMEIRO_S) aloc->preservados |= (uint8_t) (1u << (reg - ALOCADOR_PRIMEIRO_S));
+    }
+    resultado = marcar_salvamentos(intervalos, num_intervalos, &iv, aloc);
+
+liberar:
+    free(iv.inicio);
+    free(iv.fim);
+    free(iv.peso);
+    free(iv.chamadas);
+    free(iv.peso_chamadas);
+    free(profundidade);
+    free(intervalos);
+    if (resultado != 0) liberar_alocacao(aloc);
+    return resultado;
+}
+
+void liberar_alocacao(AlocacaoRI* aloc) {
+    free(aloc->registrador);
+    free(aloc->slot);
+    free(aloc->salvar);
+    memset(aloc, 0, sizeof(AlocacaoRI));
+}
@@ -0,0 +1,64 @@
+#ifndef ALOCADOR_H
+#define ALOCADOR_H
+
+#include <stdint.h>
+#include "ri.h"
+
+/*
+ * Alocação de registradores do MIPS para os registradores virtuais de uma
+ * FuncaoRI, por varredura linear (Poletto e Sarkar) sobre intervalos de vida
+ * na ordem em que os blocos serão escritos.
+ *
+ * A instrução de índice i nessa ordem ocupa as posições 2i (leitura dos
+ * operandos) e 2i+1 (escrita do destino): um operando lido pela última vez
+ * libera o registrador para o destino da mesma instrução.
+ *
+ * Temporários, locais e parâmetros disputam $t0..$t7 e $s0..$s7 ($t8 e $t9
+ * ficam livres para o gerador carregar operandos da memória). Quem não
+ * atravessa chamadas prefere um $t; quem atravessa fica no mais barato entre
+ * um $s, que a função salva uma vez no prólogo, e um $t, salvo antes de cada
+ * chamada e recuperado depois. Cada leitura ou escrita pesa 8 elevado à
+ * profundidade de laços do bloco: um valor fica na memória se os seus
+ * acessos pesam menos que salvar o registrador, e quando faltam
+ * registradores vai para a memória o intervalo de menor peso.
+ *
+ * Fora dos registradores, locais e parâmetros ficam no seu lugar do quadro e
+ * os temporários ganham um slot de derramamento. Um local lido antes de
+ * qualquer escrita fica sempre no quadro; um parâmetro vivo na entrada é
+ * carregado no registrador pelo prólogo.
+ */
+
+#define ALOCADOR_PRIMEIRO_T   8   /* $t0 */
+#define ALOCADOR_NUM_T        8   /* $t0..$t7 */
+#define ALOCADOR_PRIMEIRO_S   16  /* $s0, logo depois de $t7 */
+#define ALOCADOR_NUM_S        8   /* $s0..$s7 */
+
+typedef struct {
+    int8_t* registrador;        /* Por registrador virtual: número do registrador do MIPS, ou -1 */
+    uint32_t* slot;             /* Temporários na memória: slot de derramamento (RI_NENHUM se não há) */
+    uint32_t num_slots;
+    uint8_t* salvar;            /* Por chamada, na ordem: máscara dos $t a salvar (bit i = $ti) */
+    uint32_t num_chamadas;
+    uint8_t salvos;             /* União das máscaras: cada $t salvo tem um lugar no quadro */
+    uint8_t preservados;        /* $s usados (bit i = $si): salvos no prólogo, recuperados no epílogo */
+} AlocacaoRI;
+
+/*
+ * Separa cada local e parâmetro em teias: grupos de definições ligados por
+ * leituras que mais de uma delas alcança. Cada teia vira um registrador
+ * virtual próprio (a que está viva na entrada da função, ou a primeira,
+ * fica com o original), então um local reutilizado em trechos independentes
+ * é alocado, ou derramado, trecho a trecho. Refaz a vivacidade.
+ * Retorna 0, ou -1 se faltar memória.
+ */
+int separar_teias(ProgramaRI* prog);
+
+/* Aloca para 'f' com os blocos escritos na ordem 'ordem' (só alcançáveis,
+ * a entrada primeiro), com a vivacidade e os dominadores já calculados.
+ * 'preservar' diz se a função salva os $s que usa (o main não precisa).
+ * Retorna 0, ou -1 se faltar memória. */
+int alocar_registradores(const FuncaoRI* f, const uint32_t* ordem, uint32_t num_ordem, int preservar,
+                         AlocacaoRI* aloc);
+void liberar_alocacao(AlocacaoRI* aloc);
+
+#endif
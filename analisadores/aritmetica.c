@@ -0,0 +1,93 @@
+#include "aritmetica.h"
+
+static int bits_ligados(uint32_t x) {
+    int n = 0;
+    for (; x != 0; x &= x - 1) n++;
+    return n;
+}
+
+static int zeros_a_direita(uint32_t x) {
+    int n = 0;
+    while (n < 32 && !(x & (1u << n))) n++;
+    return n;
+}
+
+int multiplicacao_constante(int32_t k, MultiplicacaoConstante* m) {
+    if (k == 0) return -1;
+    // |k| sem sinal: INT32_MIN vira 2^31, e negar no fim dá o mesmo produto
+    uint32_t u = k < 0 ? 0u - (uint32_t) k : (uint32_t) k;
+    int baixo = zeros_a_direita(u), ligados = bits_ligados(u);
+    m->negativo = k < 0;
+    m->subtrai = 0;
+    m->menor = (uint8_t) baixo;
+    if (ligados == 1) {
+        // 2^n
+        m->termos = 1;
+        m->maior = (uint8_t) baixo;
+    } else if (ligados == 2) {
+        // 2^m + 2^n
+        m->termos = 2;
+        m->maior = (uint8_t) zeros_a_direita(u & ~(1u << baixo));
+    } else if (bits_ligados(u + (1u << baixo)) == 1) {
+        // Uma sequência de bits ligados: 2^m - 2^n (m < 32, pois u <= 2^31)
+        m->termos = 2;
+        m->subtrai = 1;
+        m->maior = (uint8_t) (baixo + ligados);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Número mágico da divisão com sinal (Hacker's Delight, 10-1): o menor p
+ * com 2^p > nc * (|d| - 2^p mod |d|), em que nc é o maior dividendo com
+ * resto |d| - 1; magico = 2^p / |d| + 1, com o sinal de d, e o deslocamento
+ * é p - 32. O mágico pode passar de 2^31: aí ele é lido como negativo e o
+ * produto precisa de x de volta (a 'correcao').
+ */
+int divisao_constante(int32_t d, DivisaoConstante* q) {
+    if (d == 0) return -1;
+    uint32_t ad = d < 0 ? 0u - (uint32_t) d : (uint32_t) d;
+    q->negativo = d < 0;
+    q->correcao = 0;
+    q->magico = 0;
+    if (bits_ligados(ad) == 1) {
+        q->potencia = 1;
+        q->deslocamento = (uint8_t) zeros_a_direita(ad);
+        return 0;
+    }
+
+    const uint32_t dois31 = 0x80000000u;
+    uint32_t t = dois31 + ((uint32_t) d >> 31);
+    uint32_t anc = t - 1 - t % ad;
+    uint32_t q1 = dois31 / anc, r1 = dois31 - q1 * anc;
+    uint32_t q2 = dois31 / ad, r2 = dois31 - q2 * ad;
+    uint32_t delta;
+    int p = 31;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    uint32_t magico = q2 + 1;
+    q->magico = (int32_t) (d < 0 ? 0u - magico : magico);
+    q->deslocamento = (uint8_t) (p - 32);
+    q->potencia = 0;
+    q->negativo = 0;
+    if (d > 0 && q->magico < 0) q->correcao = 1;
+    if (d < 0 && q->magico > 0) q->correcao = -1;
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ARITMETICA_H
+#define ARITMETICA_H
+
+#include <stdint.h>
+
+/*
+ * Multiplicação e divisão de inteiros de 32 bits por constantes sem 'mul'
+ * nem 'div', para o gerador da RI (gerador_ri.c). Cada função só escolhe a
+ * sequência; o gerador a escreve instrução por instrução, como descrito em
+ * cada estrutura. O teste (testes/teste_aritmetica.c) confere as duas coisas
+ * contra o 'mul' e o 'div' do MIPS: a sequência, refeita em C, e o código que
+ * o gerador emite, executado no simulador.
+ */
+
+/*
+ * x * k como (x << maior) + (x << menor), ou (x << maior) - (x << menor) se
+ * 'subtrai', ou só x << maior se 'termos' é 1; negado no fim se 'negativo'.
+ * Todas as operações são módulo 2^32, como o 'mul'.
+ */
+typedef struct {
+    uint8_t termos;
+    uint8_t maior;
+    uint8_t menor;
+    uint8_t subtrai;
+    uint8_t negativo;
+} MultiplicacaoConstante;
+
+/* Preenche 'm' e retorna 0, ou -1 se o 'mul' é mais barato (ou k é 0) */
+int multiplicacao_constante(int32_t k, MultiplicacaoConstante* m);
+
+/*
+ * x / d com arredondamento para zero, como o 'div' (e INT32_MIN / -1 ==
+ * INT32_MIN). Se 'potencia', |d| = 2^deslocamento: soma a x o resto que
+ * falta para um múltiplo de |d| quando x é negativo, (x >> 31) >>> (32 -
+ * deslocamento), e desloca com sinal. Senão, q é a metade alta de
+ * x * magico (mult; mfhi), mais x se 'correcao' é 1, menos x se é -1,
+ * deslocada com sinal, e mais 1 se negativa (q >>> 31). Negado no fim se
+ * 'negativo' (só com 'potencia'; o número mágico já traz o sinal de d).
+ */
+typedef struct {
+    int32_t magico;
+    uint8_t deslocamento;
+    int8_t correcao;
+    uint8_t potencia;
+    uint8_t negativo;
+} DivisaoConstante;
+
+/* Preenche 'q' e retorna 0, ou -1 se d é 0 (o 'div' fica, com a exceção) */
+int divisao_constante(int32_t d, DivisaoConstante* q);
+
+#endif
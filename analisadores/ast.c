@@ -2,59 +2,233 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "percurso.h"
 
-ASTNode* criar_no(TipoNo tipo, ASTNode* f1, ASTNode* f2, ASTNode* f3, int linha) {
-    ASTNode* no = (ASTNode*) malloc(sizeof(ASTNode));
-    if (no != NULL) {
-        no->tipo = tipo;
-        no->linha = linha; 
-        no->valor_lexico = NULL;
-        no->filho[0] = f1;
-        no->filho[1] = f2;
-        no->filho[2] = f3;
-        no->prox = NULL;
+int aridade(TipoNo tipo) {
+    switch (tipo) {
+        case NO_DECL_FUNC:    /* Nome, parâmetros, corpo */
+        case NO_SE:           /* Condição, então, senão */
+            return 3;
+        case NO_PROGRAMA:     /* Declarações globais, bloco principal */
+        case NO_BLOCO:        /* Declarações locais, comandos */
+        case NO_ENQUANTO:
+        case NO_ATRIBUICAO:
+        case NO_CHAMADA_FUNC: /* Nome, argumentos */
+        case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL: case NO_E: case NO_OU:
+            return 2;
+        case NO_DECL_VAR:
+        case NO_RETORNE:
+        case NO_LEIA:
+        case NO_ESCREVA:
+        case NO_NEG:
+        case NO_GUARDA:
+            return 1;
+        default:
+            return 0;
     }
-    return no;
 }
 
-ASTNode* criar_folha_id(char* lexema, int linha) {
-    ASTNode* no = criar_no(NO_ID, NULL, NULL, NULL, linha);
-    if (no != NULL && lexema != NULL) {
-        no->valor_lexico = strdup(lexema);
+// --- Arrays ---
+
+static int reservar_nos(Ast* ast, uint32_t minimo) {
+    if (minimo <= ast->capacidade_nos) return 1;
+    uint32_t nova = ast->capacidade_nos ? ast->capacidade_nos : 1024;
+    while (nova < minimo) nova *= 2;
+
+    uint8_t* tipo = realloc(ast->tipo, nova * sizeof(uint8_t));
+    if (tipo) ast->tipo = tipo;
+    uint8_t* tipo_dado = realloc(ast->tipo_dado, nova * sizeof(uint8_t));
+    if (tipo_dado) ast->tipo_dado = tipo_dado;
+    uint32_t* primeiro_filho = realloc(ast->primeiro_filho, nova * sizeof(uint32_t));
+    if (primeiro_filho) ast->primeiro_filho = primeiro_filho;
+    NoAst* prox = realloc(ast->prox, nova * sizeof(NoAst));
+    if (prox) ast->prox = prox;
+    uint32_t* linha = realloc(ast->linha, nova * sizeof(uint32_t));
+    if (linha) ast->linha = linha;
+    int32_t* dado = realloc(ast->dado, nova * sizeof(int32_t));
+    if (dado) ast->dado = dado;
+    if (!tipo || !tipo_dado || !primeiro_filho || !prox || !linha || !dado) return 0;
+
+    ast->capacidade_nos = nova;
+    return 1;
+}
+
+static int reservar_filhos(Ast* ast, uint32_t minimo) {
+    if (minimo <= ast->capacidade_filhos) return 1;
+    uint32_t nova = ast->capacidade_filhos ? ast->capacidade_filhos : 1024;
+    while (nova < minimo) nova *= 2;
+    NoAst* filhos = realloc(ast->filhos, nova * sizeof(NoAst));
+    if (!filhos) return 0;
+    ast->filhos = filhos;
+    ast->capacidade_filhos = nova;
+    return 1;
+}
+
+static int reservar_folhas(Ast* ast, uint32_t minimo) {
+    if (minimo <= ast->capacidade_folhas) return 1;
+    uint32_t nova = ast->capacidade_folhas ? ast->capacidade_folhas : 256;
+    while (nova < minimo) nova *= 2;
+    FolhaAst* folhas = realloc(ast->folhas, nova * sizeof(FolhaAst));
+    if (!folhas) return 0;
+    ast->folhas = folhas;
+    ast->capacidade_folhas = nova;
+    return 1;
+}
+
+int ast_reservar(Ast* ast, uint32_t nos, uint32_t filhos, uint32_t folhas) {
+    if (!reservar_nos(ast, nos) || !reservar_filhos(ast, filhos) || !reservar_folhas(ast, folhas)) {
+        return -1;
+    }
+    return 0;
+}
+
+int ast_iniciar(Ast* ast) {
+    memset(ast, 0, sizeof(*ast));
+    /* NO_NENHUM: um NO_NULO cujos filhos (três posições zeradas) são NO_NENHUM */
+    if (!reservar_nos(ast, 1) || !reservar_filhos(ast, 3)) {
+        ast_liberar(ast);
+        return -1;
+    }
+    ast->tipo[NO_NENHUM] = NO_NULO;
+    ast->tipo_dado[NO_NENHUM] = TIPO_INT;
+    ast->primeiro_filho[NO_NENHUM] = 0;
+    ast->prox[NO_NENHUM] = NO_NENHUM;
+    ast->linha[NO_NENHUM] = 0;
+    ast->dado[NO_NENHUM] = 0;
+    ast->num_nos = 1;
+    memset(ast->filhos, 0, 3 * sizeof(NoAst));
+    ast->num_filhos = 3;
+    return 0;
+}
+
+void ast_liberar(Ast* ast) {
+    free(ast->tipo);
+    free(ast->tipo_dado);
+    free(ast->primeiro_filho);
+    free(ast->prox);
+    free(ast->linha);
+    free(ast->dado);
+    free(ast->filhos);
+    free(ast->folhas);
+    memset(ast, 0, sizeof(*ast));
+}
+
+static size_t bytes_ast(uint32_t nos, uint32_t filhos, uint32_t folhas) {
+    size_t por_no = 2 * sizeof(uint8_t) + 3 * sizeof(uint32_t) + sizeof(int32_t);
+    return nos * por_no + filhos * sizeof(NoAst) + folhas * sizeof(FolhaAst);
+}
+
+size_t ast_bytes(const Ast* ast) {
+    return bytes_ast(ast->capacidade_nos, ast->capacidade_filhos, ast->capacidade_folhas);
+}
+
+void imprimir_estatisticas_ast(FILE* saida, const Ast* ast) {
+    uint32_t nos = ast->num_nos - 1;
+    size_t em_uso = bytes_ast(ast->num_nos, ast->num_filhos, ast->num_folhas);
+    fprintf(saida, "--- Estatisticas da AST ---\n");
+    fprintf(saida, "  Nos: %u | Posicoes de filhos: %u | Folhas com lexema: %u\n",
+            nos, ast->num_filhos - 3, ast->num_folhas);
+    fprintf(saida, "  Bytes em uso: %zu (%.1f por no) | reservados: %zu\n",
+            em_uso, nos > 0 ? (double) em_uso / nos : 0.0, ast_bytes(ast));
+}
+
+// --- Criação ---
+
+NoAst criar_no(Ast* ast, TipoNo tipo, NoAst f1, NoAst f2, NoAst f3, int linha) {
+    int n = aridade(tipo);
+    if (ast->sem_memoria || ast->num_nos == UINT32_MAX ||
+        !reservar_nos(ast, ast->num_nos + 1) || !reservar_filhos(ast, ast->num_filhos + n)) {
+        ast->sem_memoria = 1;
+        return NO_NENHUM;
+    }
+
+    NoAst no = ast->num_nos++;
+    ast->tipo[no] = (uint8_t) tipo;
+    ast->tipo_dado[no] = TIPO_INT;
+    ast->prox[no] = NO_NENHUM;
+    ast->linha[no] = (uint32_t) linha;
+    ast->dado[no] = 0;
+
+    // Folhas apontam para as posições de NO_NENHUM: seus "filhos" são nulos
+    ast->primeiro_filho[no] = n > 0 ? ast->num_filhos : 0;
+    NoAst filhos[3] = { f1, f2, f3 };
+    for (int i = 0; i < n; i++) {
+        ast->filhos[ast->num_filhos++] = filhos[i];
     }
     return no;
 }
 
-ASTNode* criar_folha_str(char* lexema, int linha) {
-    ASTNode* no = criar_no(NO_CADEIA_CAR, NULL, NULL, NULL, linha);
-    if (no != NULL && lexema != NULL) {
-        no->valor_lexico = strdup(lexema);
+static NoAst criar_folha(Ast* ast, TipoNo tipo, const char* lexema, int tamanho, int linha) {
+    if (!reservar_folhas(ast, ast->num_folhas + 1)) {
+        ast->sem_memoria = 1;
+        return NO_NENHUM;
     }
+    NoAst no = criar_no(ast, tipo, NO_NENHUM, NO_NENHUM, NO_NENHUM, linha);
+    if (no == NO_NENHUM) return NO_NENHUM;
+
+    FolhaAst* folha = &ast->folhas[ast->num_folhas];
+    folha->lexema = lexema;
+    folha->tamanho = tamanho;
+    folha->valor = 0;
+    folha->lig.classe = LIG_NENHUMA;
+    folha->lig.slot = -1;
+    folha->lig.funcao = NULL;
+    ast->dado[no] = (int32_t) ast->num_folhas++;
     return no;
 }
 
-ASTNode* criar_folha_int(int valor, int linha) {
-    ASTNode* no = criar_no(NO_INT_CONST, NULL, NULL, NULL, linha);
-    if (no != NULL) {
-        no->valor_int = valor;
+NoAst criar_folha_id(Ast* ast, Atomo lexema, int linha) {
+    return criar_folha(ast, NO_ID, lexema.texto, (int) tamanho_atomo(lexema), linha);
+}
+
+NoAst criar_folha_str(Ast* ast, const char* lexema, int tamanho, int linha) {
+    return criar_folha(ast, NO_CADEIA_CAR, lexema, tamanho, linha);
+}
+
+NoAst criar_folha_int(Ast* ast, int valor, int linha) {
+    NoAst no = criar_no(ast, NO_INT_CONST, NO_NENHUM, NO_NENHUM, NO_NENHUM, linha);
+    if (no != NO_NENHUM) {
+        ast->dado[no] = valor;
     }
     return no;
 }
 
-ASTNode* criar_folha_car(char* lexema, int linha) {
-    ASTNode* no = criar_no(NO_CAR_CONST, NULL, NULL, NULL, linha);
-    if (no != NULL && lexema != NULL) {
-        no->valor_lexico = strdup(lexema);
+/* Converte o lexema de uma constante de caractere ('a', '\n') em seu código */
+static int valor_caractere(const char* lexema) {
+    if (lexema[1] != '\\') return (unsigned char) lexema[1];
+    switch (lexema[2]) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case '0': return '\0';
+        default:  return (unsigned char) lexema[2];
+    }
+}
+
+NoAst criar_folha_car(Ast* ast, const char* lexema, int tamanho, int linha) {
+    NoAst no = criar_folha(ast, NO_CAR_CONST, lexema, tamanho, linha);
+    if (no != NO_NENHUM) {
+        AST_FOLHA(ast, no).valor = valor_caractere(lexema);
     }
     return no;
 }
 
-void imprimir_ast(ASTNode* no, int nivel) {
-    if (no == NULL) return;
+// --- Impressão ---
+
+typedef struct {
+    const Ast* ast;
+    int nivel;
+} ImpressaoAst;
 
-    for (int i = 0; i < nivel; i++) printf("  ");
-    
-    switch(no->tipo) {
+static unsigned imprimir_no(void* dados, NoAst no, intptr_t* salvo) {
+    ImpressaoAst* imp = (ImpressaoAst*) dados;
+    const Ast* ast = imp->ast;
+
+    for (int i = 0; i < imp->nivel; i++) printf("  ");
+
+    switch(AST_TIPO(ast, no)) {
         case NO_PROGRAMA: printf("PROGRAMA\n"); break;
         case NO_DECL_FUNC: printf("FUNC_DECL\n"); break;
         case NO_DECL_VAR: printf("VAR_DECL\n"); break;
@@ -68,33 +242,46 @@ void imprimir_ast(ASTNode* no, int nivel) {
         case NO_SUB: printf("SUB (-)\n"); break;
         case NO_MULT: printf("MULT (*)\n"); break;
         case NO_DIV: printf("DIV (/)\n"); break;
-        case NO_ID: printf("ID: %s\n", no->valor_lexico); break;
-        case NO_INT_CONST: printf("INT: %d\n", no->valor_int); break;
-        case NO_CAR_CONST: printf("CAR: %s\n", no->valor_lexico); break;
+        case NO_ID: printf("ID: %s\n", AST_LEXEMA(ast, no)); break;
+        case NO_INT_CONST: printf("INT: %d\n", AST_VALOR_INT(ast, no)); break;
+        case NO_CAR_CONST: printf("CAR: %.*s\n", AST_FOLHA(ast, no).tamanho, AST_LEXEMA(ast, no)); break;
         case NO_CHAMADA_FUNC: printf("CHAMADA_FUNC\n"); break;
         case NO_NOVALINHA: printf("NOVA_LINHA\n"); break;
         case NO_RETORNE: printf("RETORNE\n"); break;
         case NO_LISTA: printf("LISTA\n"); break;
         case NO_NULO: printf("NULO\n"); break;
-        case NO_CADEIA_CAR: printf("CADEIA_CAR: %s\n", no->valor_lexico); break;
-        default: printf("NO_TIPO_%d\n", no->tipo);
+        case NO_CADEIA_CAR: printf("CADEIA_CAR: %.*s\n", AST_FOLHA(ast, no).tamanho, AST_LEXEMA(ast, no)); break;
+        case NO_GUARDA: printf("GUARDA: slot %d\n", AST_SLOT(ast, no)); break;
+        case NO_TEMP: printf("TEMP: slot %d\n", AST_SLOT(ast, no)); break;
+        default: printf("NO_TIPO_%d\n", AST_TIPO(ast, no));
     }
 
-    imprimir_ast(no->filho[0], nivel + 1);
-    imprimir_ast(no->filho[1], nivel + 1);
-    imprimir_ast(no->filho[2], nivel + 1);
-    
-    if (no->prox != NULL) {
-        imprimir_ast(no->prox, nivel);
+    imp->nivel++;
+    return PERCURSO_TODOS;
+}
+
+static void sair_no(void* dados, NoAst no, intptr_t salvo) {
+    ((ImpressaoAst*) dados)->nivel--;
+}
+
+void imprimir_ast(const Ast* ast, NoAst no, int nivel) {
+    static const VisitanteAst impressao = { imprimir_no, NULL, sair_no };
+    ImpressaoAst imp = { ast, nivel };
+    // Os irmãos de 'no' ficam no mesmo nível
+    for (; no != NO_NENHUM; no = AST_PROX(ast, no)) {
+        percorrer_ast(ast, no, &impressao, &imp);
     }
 }
 
-void liberar_ast(ASTNode* no) {
-    if (no == NULL) return;
-    liberar_ast(no->filho[0]);
-    liberar_ast(no->filho[1]);
-    liberar_ast(no->filho[2]);
-    liberar_ast(no->prox);
-    if (no->valor_lexico) free(no->valor_lexico);
-    free(no);
+ListaNos lista_nos(NoAst no) {
+    ListaNos lista = { no, no };
+    return lista;
+}
+
+ListaNos lista_anexar(Ast* ast, ListaNos lista, ListaNos cauda) {
+    if (lista.inicio == NO_NENHUM) return cauda;
+    if (cauda.inicio == NO_NENHUM) return lista;
+    AST_PROX(ast, lista.fim) = cauda.inicio;
+    lista.fim = cauda.fim;
+    return lista;
 }
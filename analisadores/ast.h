@@ -1,6 +1,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stdio.h>
+#include <stdint.h>
 #include "tabela_simbolos.h"
 
 typedef enum {
@@ -24,26 +26,129 @@ typedef enum {
     NO_LISTA,      /* Para sequências de comandos ou declarações */
     NO_NOVALINHA,
     NO_NULO,        /* Para nós vazios */
-    NO_CADEIA_CAR
+    NO_CADEIA_CAR,
+    NO_GUARDA,      /* Otimizador: calcula o filho e guarda o valor num slot local */
+    NO_TEMP         /* Otimizador: valor guardado antes por um NO_GUARDA */
 } TipoNo;
 
-typedef struct ASTNode {
-    TipoNo tipo;
-    int linha;              
-    char *valor_lexico;     /* Para IDs e Strings */
-    int valor_int;          /* Para constantes inteiras */
-    Tipo tipo_dado;         /* TIPO_INT, TIPO_CAR (para análise semântica) */
-    
-    struct ASTNode *filho[3]; /* Até 3 filhos (IF expr ENTAO cmd SENAO cmd) */
-    struct ASTNode *prox;     /* Para listas encadeadas */
-} ASTNode;
-
-ASTNode* criar_no(TipoNo tipo, ASTNode* f1, ASTNode* f2, ASTNode* f3, int linha);
-ASTNode* criar_folha_id(char* lexema, int linha);
-ASTNode* criar_folha_str(char* lexema, int linha);
-ASTNode* criar_folha_int(int valor, int linha);
-ASTNode* criar_folha_car(char* lexema, int linha);
-void imprimir_ast(ASTNode* no, int nivel);
-void liberar_ast(ASTNode* no);
-
-#endif
\ No newline at end of file
+/* Classe de armazenamento de um nome, decidida na análise semântica */
+typedef enum {
+    LIG_NENHUMA,    /* Nome não resolvido (erro semântico) */
+    LIG_GLOBAL,     /* Variável global: rótulo _nome na seção .data */
+    LIG_PARAMETRO,  /* Parâmetro: 'slot' é a posição na lista de parâmetros */
+    LIG_LOCAL,      /* Variável local: 'slot' é a posição no quadro da função */
+    LIG_FUNCAO      /* Nome de função: 'funcao' aponta para a assinatura */
+} ClasseLigacao;
+
+/* Ligação persistente entre um nó NO_ID e a declaração que ele referencia.
+ * É preenchida por verificar_semantica e lida pelo gerador de código, que
+ * assim não precisa refazer nenhuma busca na tabela de símbolos. */
+typedef struct {
+    ClasseLigacao classe;
+    int slot;
+    Symbol* funcao;   /* Válido enquanto o escopo global da pilha existir */
+} Ligacao;
+
+/* Índice de um nó na Ast. O índice 0 é reservado: NO_NENHUM indica ausência
+ * (filho opcional, fim de lista) e os filhos de NO_NENHUM são NO_NENHUM. */
+typedef uint32_t NoAst;
+#define NO_NENHUM 0u
+
+/* Dados de uma folha com lexema: NO_ID, NO_CAR_CONST e NO_CADEIA_CAR */
+typedef struct {
+    const char* lexema; /* IDs: átomo. Literais: trecho do fonte (não terminado em '\0') */
+    int tamanho;        /* Comprimento do lexema em bytes */
+    int valor;          /* NO_CAR_CONST: código do caractere */
+    Ligacao lig;        /* NO_ID: declaração referenciada */
+} FolhaAst;
+
+/*
+ * Árvore sintática de uma compilação, em arrays contíguos (struct-of-arrays).
+ *
+ * Os campos que todas as passagens percorrem (tipo do nó, tipo do dado,
+ * filhos e próximo da lista) ficam separados dos que só as mensagens e as
+ * folhas usam (linha e 'dado'). Os filhos de cada nó ocupam aridade(tipo)
+ * posições consecutivas de 'filhos', a partir de 'primeiro_filho'; folhas não
+ * ocupam nenhuma. Lexemas e ligações vivem num array à parte, só para os nós
+ * que os têm.
+ *
+ * 'dado' depende do tipo do nó:
+ *   NO_INT_CONST                        valor da constante;
+ *   NO_ID, NO_CAR_CONST, NO_CADEIA_CAR  índice da FolhaAst;
+ *   NO_DECL_FUNC, NO_PROGRAMA           slots locais do quadro (num_locais);
+ *   NO_GUARDA, NO_TEMP                  slot local do valor guardado.
+ */
+typedef struct {
+    /* Campos quentes */
+    uint8_t*  tipo;           /* TipoNo */
+    uint8_t*  tipo_dado;      /* TIPO_INT, TIPO_CAR (para análise semântica) */
+    uint32_t* primeiro_filho; /* Posição do primeiro filho em 'filhos' */
+    NoAst*    prox;           /* Para listas encadeadas */
+    /* Campos frios */
+    uint32_t* linha;
+    int32_t*  dado;
+    uint32_t num_nos;
+    uint32_t capacidade_nos;
+
+    NoAst* filhos;
+    uint32_t num_filhos;
+    uint32_t capacidade_filhos;
+
+    FolhaAst* folhas;
+    uint32_t num_folhas;
+    uint32_t capacidade_folhas;
+
+    int sem_memoria;          /* Alguma criação falhou (os nós viraram NO_NENHUM) */
+} Ast;
+
+/* Acesso aos campos de um nó. Todos podem ser usados como lvalue. */
+#define AST_TIPO(ast, no)           ((ast)->tipo[no])
+#define AST_TIPO_DADO(ast, no)      ((ast)->tipo_dado[no])
+#define AST_FILHO(ast, no, i)       ((ast)->filhos[(ast)->primeiro_filho[no] + (i)])
+#define AST_PROX(ast, no)           ((ast)->prox[no])
+#define AST_LINHA(ast, no)          ((ast)->linha[no])
+#define AST_VALOR_INT(ast, no)      ((ast)->dado[no])
+#define AST_NUM_LOCAIS(ast, no)     ((ast)->dado[no])
+#define AST_SLOT(ast, no)           ((ast)->dado[no])
+#define AST_FOLHA(ast, no)          ((ast)->folhas[(ast)->dado[no]])
+#define AST_LEXEMA(ast, no)         (AST_FOLHA(ast, no).lexema)
+#define AST_LIGACAO(ast, no)        (AST_FOLHA(ast, no).lig)
+
+/* Nome de um NO_ID como átomo: só as folhas de criar_folha_id guardam átomos */
+#define AST_ATOMO(ast, no)          ((Atomo) { AST_LEXEMA(ast, no) })
+
+/* Número de filhos de um nó do tipo 'tipo' (NO_SE tem 3; o senão pode faltar) */
+int aridade(TipoNo tipo);
+
+/* Prepara uma árvore vazia (só com NO_NENHUM). Retorna 0, ou -1 se faltar memória. */
+int ast_iniciar(Ast* ast);
+void ast_liberar(Ast* ast);
+
+/* Garante capacidade para 'nos' nós, 'filhos' posições de filhos e 'folhas'
+ * folhas no total (ex: antes de copiar arrays prontos). Retorna 0 ou -1. */
+int ast_reservar(Ast* ast, uint32_t nos, uint32_t filhos, uint32_t folhas);
+
+/* Bytes ocupados pelos arrays da árvore (capacidade reservada incluída) */
+size_t ast_bytes(const Ast* ast);
+void imprimir_estatisticas_ast(FILE* saida, const Ast* ast);
+
+/* Criação de nós. Os filhos além da aridade do tipo são ignorados. Se faltar
+ * memória, marcam ast->sem_memoria e devolvem NO_NENHUM. */
+NoAst criar_no(Ast* ast, TipoNo tipo, NoAst f1, NoAst f2, NoAst f3, int linha);
+NoAst criar_folha_id(Ast* ast, Atomo lexema, int linha);
+NoAst criar_folha_str(Ast* ast, const char* lexema, int tamanho, int linha);
+NoAst criar_folha_int(Ast* ast, int valor, int linha);
+NoAst criar_folha_car(Ast* ast, const char* lexema, int tamanho, int linha);
+void imprimir_ast(const Ast* ast, NoAst no, int nivel);
+
+/* Lista encadeada por 'prox' que guarda também o último nó: o parser anexa
+ * cada elemento em O(1), sem percorrer a lista a cada redução. */
+typedef struct {
+    NoAst inicio;
+    NoAst fim;
+} ListaNos;
+
+ListaNos lista_nos(NoAst no); /* Lista com o nó 'no' (vazia se NO_NENHUM) */
+ListaNos lista_anexar(Ast* ast, ListaNos lista, ListaNos cauda);
+
+#endif
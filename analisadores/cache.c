@@ -0,0 +1,724 @@
+#define _DEFAULT_SOURCE /* flock, mkstemp, futimens */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+#define MAGICA_CACHE   "GOICACH1"
+#define FORMATO_CACHE  1u
+#define ORDEM_BYTES    0x01020304u
+#define SUFIXO_ENTRADA ".ent"
+#define IDADE_TEMPORARIO 3600  /* Temporários órfãos (gravação interrompida), em segundos */
+
+// --- Formato da entrada ---
+
+/* Seções, nesta ordem no arquivo, cada uma alinhada a 8 bytes */
+enum {
+    SECAO_TIPO,
+    SECAO_TIPO_DADO,
+    SECAO_PRIMEIRO_FILHO,
+    SECAO_PROX,
+    SECAO_LINHA,
+    SECAO_DADO,
+    SECAO_FILHOS,
+    SECAO_FOLHAS,    /* FolhaCache por folha */
+    SECAO_LEXEMAS,   /* LexemaCache por lexema distinto */
+    SECAO_TEXTO,     /* Bytes dos lexemas, cada um seguido de '\0' */
+    SECAO_ASSEMBLY,
+    NUM_SECOES
+};
+
+typedef struct {
+    uint64_t deslocamento;
+    uint64_t tamanho;
+} SecaoCache;
+
+struct CabecalhoCache {
+    char magica[8];
+    uint32_t formato;
+    uint32_t ordem;             /* ORDEM_BYTES, na ordem de bytes de quem gravou */
+    ChaveCache chave;
+    uint64_t tamanho_arquivo;   /* Detecta arquivos truncados */
+    uint64_t verificacao;       /* Hash dos bytes depois do cabeçalho */
+    uint32_t num_nos;           /* Contando NO_NENHUM */
+    uint32_t num_filhos;
+    uint32_t num_folhas;
+    uint32_t num_lexemas;
+    uint32_t raiz;
+    uint32_t reservado;
+    SecaoCache secoes[NUM_SECOES];
+};
+
+/* FolhaAst sem ponteiros: o lexema é um índice em SECAO_LEXEMAS */
+typedef struct {
+    uint32_t lexema;
+    int32_t valor;
+    int32_t classe;
+    int32_t slot;
+} FolhaCache;
+
+typedef struct {
+    uint32_t deslocamento;      /* Em SECAO_TEXTO */
+    uint32_t tamanho;
+} LexemaCache;
+
+// --- Hash ---
+
+/* Hash de 128 bits em duas vias independentes, 8 bytes por passo. Não é
+ * criptográfico: protege contra colisões acidentais, não contra ataques. */
+typedef struct {
+    uint64_t a, b;
+    unsigned char pendente[8];
+    size_t num_pendente;
+    uint64_t total;
+} EstadoHash;
+
+static uint64_t rotacionar(uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+static uint64_t finalizar_via(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27; x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static void hash_iniciar(EstadoHash* e) {
+    e->a = 0xcbf29ce484222325ull;
+    e->b = 0x9e3779b97f4a7c15ull;
+    e->num_pendente = 0;
+    e->total = 0;
+}
+
+static void hash_palavra(EstadoHash* e, uint64_t w) {
+    e->a = rotacionar((e->a ^ w) * 0x100000001b3ull, 29);
+    e->b = rotacionar(e->b + w * 0xc2b2ae3d27d4eb4full, 31) * 0x9e3779b97f4a7c15ull;
+}
+
+static void hash_misturar(EstadoHash* e, const void* dados, size_t tamanho) {
+    const unsigned char* p = (const unsigned char*) dados;
+    e->total += tamanho;
+    if (e->num_pendente > 0) {
+        while (tamanho > 0 && e->num_pendente < 8) {
+            e->pendente[e->num_pendente++] = *p++;
+            tamanho--;
+        }
+        if (e->num_pendente < 8) return;
+        uint64_t w;
+        memcpy(&w, e->pendente, 8);
+        hash_palavra(e, w);
+        e->num_pendente = 0;
+    }
+    for (; tamanho >= 8; p += 8, tamanho -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        hash_palavra(e, w);
+    }
+    memcpy(e->pendente, p, tamanho);
+    e->num_pendente = tamanho;
+}
+
+/* Mistura um texto precedido do tamanho, para que as partes não se confundam */
+static void hash_texto_delimitado(EstadoHash* e, const char* texto, size_t tamanho) {
+    uint64_t n = tamanho;
+    hash_misturar(e, &n, sizeof(n));
+    hash_misturar(e, texto, tamanho);
+}
+
+static ChaveCache hash_finalizar(EstadoHash* e) {
+    uint64_t w = 0;
+    memcpy(&w, e->pendente, e->num_pendente);
+    hash_palavra(e, w);
+    hash_palavra(e, e->total);
+    ChaveCache chave;
+    chave.h[0] = finalizar_via(e->a ^ rotacionar(e->b, 17));
+    chave.h[1] = finalizar_via(e->b ^ rotacionar(e->a, 41));
+    return chave;
+}
+
+/* Hash do conteúdo do arquivo 'caminho'. Retorna 0 ou -1. */
+static int hash_arquivo(const char* caminho, ChaveCache* chave) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+    void* mapa = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) return -1;
+
+    EstadoHash e;
+    hash_iniciar(&e);
+    hash_misturar(&e, mapa, (size_t) info.st_size);
+    *chave = hash_finalizar(&e);
+    munmap(mapa, (size_t) info.st_size);
+    return 0;
+}
+
+// --- Abertura ---
+
+int cache_abrir(CacheCompilacao* cache, const char* diretorio, uint64_t limite) {
+    memset(cache, 0, sizeof(*cache));
+    if (mkdir(diretorio, 0777) != 0 && errno != EEXIST) return -1;
+
+    /* O executável identifica o compilador: qualquer mudança no código, em
+     * qualquer fase, invalida as entradas gravadas pela versão anterior. */
+    if (hash_arquivo("/proc/self/exe", &cache->identidade) != 0) return -1;
+
+    cache->diretorio = strdup(diretorio);
+    if (cache->diretorio == NULL) return -1;
+    cache->limite = limite != 0 ? limite : CACHE_LIMITE_PADRAO;
+    return 0;
+}
+
+ChaveCache cache_chave(const CacheCompilacao* cache, const char* opcoes,
+                       const char* fonte, size_t tamanho) {
+    EstadoHash e;
+    hash_iniciar(&e);
+    uint32_t formato = FORMATO_CACHE;
+    hash_misturar(&e, &cache->identidade, sizeof(cache->identidade));
+    hash_misturar(&e, &formato, sizeof(formato));
+    hash_texto_delimitado(&e, opcoes, strlen(opcoes));
+    hash_texto_delimitado(&e, fonte, tamanho);
+    return hash_finalizar(&e);
+}
+
+static char* caminho_entrada(const CacheCompilacao* cache, ChaveCache chave) {
+    size_t n = strlen(cache->diretorio) + 1 + 32 + sizeof(SUFIXO_ENTRADA);
+    char* caminho = (char*) malloc(n);
+    if (caminho != NULL) {
+        snprintf(caminho, n, "%s/%016llx%016llx%s", cache->diretorio,
+                 (unsigned long long) chave.h[0], (unsigned long long) chave.h[1], SUFIXO_ENTRADA);
+    }
+    return caminho;
+}
+
+// --- Leitura ---
+
+static int secao_valida(const struct CabecalhoCache* c, int secao, uint64_t tamanho_elemento, uint64_t num) {
+    const SecaoCache* s = &c->secoes[secao];
+    return s->deslocamento % 8 == 0 &&
+           s->deslocamento >= sizeof(struct CabecalhoCache) &&
+           s->deslocamento <= c->tamanho_arquivo &&
+           s->tamanho <= c->tamanho_arquivo - s->deslocamento &&
+           (tamanho_elemento == 0 || s->tamanho == tamanho_elemento * num);
+}
+
+#define SECAO(c, secao, tipo) ((const tipo*) ((const char*) (c) + (c)->secoes[secao].deslocamento))
+
+/* Confere o cabeçalho, a verificação e os índices da entrada: depois disso,
+ * nenhum índice da AST aponta para fora dos arrays. */
+static int entrada_valida(const struct CabecalhoCache* c, size_t tamanho_mapa, ChaveCache chave) {
+    if (tamanho_mapa < sizeof(*c) || memcmp(c->magica, MAGICA_CACHE, 8) != 0 ||
+        c->formato != FORMATO_CACHE || c->ordem != ORDEM_BYTES ||
+        c->tamanho_arquivo != tamanho_mapa ||
+        c->chave.h[0] != chave.h[0] || c->chave.h[1] != chave.h[1]) {
+        return 0;
+    }
+
+    EstadoHash e;
+    hash_iniciar(&e);
+    hash_misturar(&e, (const char*) c + sizeof(*c), tamanho_mapa - sizeof(*c));
+    if (hash_finalizar(&e).h[0] != c->verificacao) return 0;
+
+    if (c->num_nos < 1 || c->num_filhos < 3 || c->raiz >= c->num_nos ||
+        !secao_valida(c, SECAO_TIPO, sizeof(uint8_t), c->num_nos) ||
+        !secao_valida(c, SECAO_TIPO_DADO, sizeof(uint8_t), c->num_nos) ||
+        !secao_valida(c, SECAO_PRIMEIRO_FILHO, sizeof(uint32_t), c->num_nos) ||
+        !secao_valida(c, SECAO_PROX, sizeof(NoAst), c->num_nos) ||
+        !secao_valida(c, SECAO_LINHA, sizeof(uint32_t), c->num_nos) ||
+        !secao_valida(c, SECAO_DADO, sizeof(int32_t), c->num_nos) ||
+        !secao_valida(c, SECAO_FILHOS, sizeof(NoAst), c->num_filhos) ||
+        !secao_valida(c, SECAO_FOLHAS, sizeof(FolhaCache), c->num_folhas) ||
+        !secao_valida(c, SECAO_LEXEMAS, sizeof(LexemaCache), c->num_lexemas) ||
+        !secao_valida(c, SECAO_TEXTO, 0, 0) ||
+        !secao_valida(c, SECAO_ASSEMBLY, 0, 0)) {
+        return 0;
+    }
+
+    const uint8_t* tipo = SECAO(c, SECAO_TIPO, uint8_t);
+    const uint32_t* primeiro_filho = SECAO(c, SECAO_PRIMEIRO_FILHO, uint32_t);
+    const NoAst* prox = SECAO(c, SECAO_PROX, NoAst);
+    const int32_t* dado = SECAO(c, SECAO_DADO, int32_t);
+    const NoAst* filhos = SECAO(c, SECAO_FILHOS, NoAst);
+    if (tipo[NO_NENHUM] != NO_NULO || filhos[0] != NO_NENHUM ||
+        filhos[1] != NO_NENHUM || filhos[2] != NO_NENHUM) {
+        return 0;
+    }
+    for (uint32_t no = 0; no < c->num_nos; no++) {
+        if (tipo[no] > NO_TEMP || prox[no] >= c->num_nos ||
+            (uint64_t) primeiro_filho[no] + (uint64_t) aridade((TipoNo) tipo[no]) > c->num_filhos) {
+            return 0;
+        }
+        if ((tipo[no] == NO_ID || tipo[no] == NO_CAR_CONST || tipo[no] == NO_CADEIA_CAR) &&
+            (uint32_t) dado[no] >= c->num_folhas) {
+            return 0;
+        }
+    }
+    for (uint32_t i = 0; i < c->num_filhos; i++) {
+        if (filhos[i] >= c->num_nos) return 0;
+    }
+
+    const FolhaCache* folhas = SECAO(c, SECAO_FOLHAS, FolhaCache);
+    for (uint32_t i = 0; i < c->num_folhas; i++) {
+        if (folhas[i].lexema >= c->num_lexemas ||
+            folhas[i].classe < LIG_NENHUMA || folhas[i].classe > LIG_FUNCAO) {
+            return 0;
+        }
+    }
+    const LexemaCache* lexemas = SECAO(c, SECAO_LEXEMAS, LexemaCache);
+    const char* texto = SECAO(c, SECAO_TEXTO, char);
+    uint64_t tamanho_texto = c->secoes[SECAO_TEXTO].tamanho;
+    for (uint32_t i = 0; i < c->num_lexemas; i++) {
+        uint64_t fim = (uint64_t) lexemas[i].deslocamento + lexemas[i].tamanho;
+        if (fim >= tamanho_texto || texto[fim] != '\0') return 0;
+    }
+    return 1;
+}
+
+int cache_buscar(CacheCompilacao* cache, ChaveCache chave, EntradaCache* entrada) {
+    memset(entrada, 0, sizeof(*entrada));
+    char* caminho = caminho_entrada(cache, chave);
+    int fd = caminho != NULL ? open(caminho, O_RDONLY) : -1;
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(struct CabecalhoCache)) {
+        if (fd >= 0) close(fd);
+        free(caminho);
+        cache->novos.faltas++;
+        return 0;
+    }
+
+    size_t tamanho = (size_t) info.st_size;
+    void* mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapa == MAP_FAILED || !entrada_valida((const struct CabecalhoCache*) mapa, tamanho, chave)) {
+        /* Entrada corrompida ou de outro formato: será regravada */
+        if (mapa != MAP_FAILED) munmap(mapa, tamanho);
+        close(fd);
+        unlink(caminho);
+        free(caminho);
+        cache->novos.faltas++;
+        return 0;
+    }
+
+    /* A data de modificação marca o último uso (ver cache_podar) */
+    futimens(fd, NULL);
+    close(fd);
+    free(caminho);
+
+    entrada->mapa = mapa;
+    entrada->tamanho_mapa = tamanho;
+    entrada->cabecalho = (const struct CabecalhoCache*) mapa;
+    cache->novos.acertos++;
+    return 1;
+}
+
+const char* cache_assembly(const EntradaCache* entrada, size_t* tamanho) {
+    const struct CabecalhoCache* c = entrada->cabecalho;
+    *tamanho = (size_t) c->secoes[SECAO_ASSEMBLY].tamanho;
+    return SECAO(c, SECAO_ASSEMBLY, char);
+}
+
+int cache_restaurar(const EntradaCache* entrada, CompilerContext* ctx) {
+    const struct CabecalhoCache* c = entrada->cabecalho;
+    Ast* ast = &ctx->ast;
+
+    /* Cada lexema distinto é internado uma vez */
+    const LexemaCache* lexemas = SECAO(c, SECAO_LEXEMAS, LexemaCache);
+    const char* texto = SECAO(c, SECAO_TEXTO, char);
+    Atomo* atomos = (Atomo*) malloc((c->num_lexemas > 0 ? c->num_lexemas : 1) * sizeof(Atomo));
+    if (atomos == NULL) return -1;
+    for (uint32_t i = 0; i < c->num_lexemas; i++) {
+        atomos[i] = internar_em(&ctx->atomos, texto + lexemas[i].deslocamento, lexemas[i].tamanho);
+        if (atomos[i].texto == NULL) {
+            free(atomos);
+            return -1;
+        }
+    }
+
+    size_t tamanho_assembly = (size_t) c->secoes[SECAO_ASSEMBLY].tamanho;
+    char* assembly = (char*) malloc(tamanho_assembly + 1);
+    if (assembly == NULL || ast_reservar(ast, c->num_nos, c->num_filhos, c->num_folhas) != 0) {
+        free(assembly);
+        free(atomos);
+        return -1;
+    }
+
+    /* Os arrays dos nós têm o layout de Ast: uma cópia cada */
+    memcpy(ast->tipo, SECAO(c, SECAO_TIPO, uint8_t), c->num_nos * sizeof(uint8_t));
+    memcpy(ast->tipo_dado, SECAO(c, SECAO_TIPO_DADO, uint8_t), c->num_nos * sizeof(uint8_t));
+    memcpy(ast->primeiro_filho, SECAO(c, SECAO_PRIMEIRO_FILHO, uint32_t), c->num_nos * sizeof(uint32_t));
+    memcpy(ast->prox, SECAO(c, SECAO_PROX, NoAst), c->num_nos * sizeof(NoAst));
+    memcpy(ast->linha, SECAO(c, SECAO_LINHA, uint32_t), c->num_nos * sizeof(uint32_t));
+    memcpy(ast->dado, SECAO(c, SECAO_DADO, int32_t), c->num_nos * sizeof(int32_t));
+    memcpy(ast->filhos, SECAO(c, SECAO_FILHOS, NoAst), c->num_filhos * sizeof(NoAst));
+    ast->num_nos = c->num_nos;
+    ast->num_filhos = c->num_filhos;
+
+    const FolhaCache* folhas = SECAO(c, SECAO_FOLHAS, FolhaCache);
+    for (uint32_t i = 0; i < c->num_folhas; i++) {
+        FolhaAst* folha = &ast->folhas[i];
+        folha->lexema = atomos[folhas[i].lexema].texto;
+        folha->tamanho = (int) lexemas[folhas[i].lexema].tamanho;
+        folha->valor = folhas[i].valor;
+        folha->lig.classe = (ClasseLigacao) folhas[i].classe;
+        folha->lig.slot = folhas[i].slot;
+        folha->lig.funcao = NULL;
+    }
+    ast->num_folhas = c->num_folhas;
+    ctx->raiz = c->raiz;
+    free(atomos);
+
+    memcpy(assembly, SECAO(c, SECAO_ASSEMBLY, char), tamanho_assembly);
+    assembly[tamanho_assembly] = '\0';
+    free(ctx->assembly);
+    ctx->assembly = assembly;
+    ctx->tamanho_assembly = tamanho_assembly;
+    return 0;
+}
+
+void cache_liberar_entrada(EntradaCache* entrada) {
+    if (entrada->mapa != NULL) munmap(entrada->mapa, entrada->tamanho_mapa);
+    memset(entrada, 0, sizeof(*entrada));
+}
+
+// --- Gravação ---
+
+/* Lexemas distintos das folhas, na ordem da primeira ocorrência */
+typedef struct {
+    LexemaCache* lexemas;
+    uint32_t num_lexemas;
+    char* texto;
+    size_t tamanho_texto;
+    size_t capacidade_texto;
+    const char** chaves;      /* Tabela lexema -> índice, pelo ponteiro */
+    uint32_t* indices;
+    uint32_t capacidade;
+} TabelaLexemas;
+
+/* Índice do lexema 'lexema' (IDs são átomos: o mesmo nome, o mesmo ponteiro).
+ * Retorna UINT32_MAX se faltar memória. */
+static uint32_t indice_lexema(TabelaLexemas* t, const char* lexema, int tamanho) {
+    uint32_t pos = (uint32_t) (((uintptr_t) lexema >> 3) * 0x9e3779b1u) & (t->capacidade - 1);
+    while (t->chaves[pos] != NULL) {
+        if (t->chaves[pos] == lexema && t->lexemas[t->indices[pos]].tamanho == (uint32_t) tamanho) {
+            return t->indices[pos];
+        }
+        pos = (pos + 1) & (t->capacidade - 1);
+    }
+
+    size_t necessario = t->tamanho_texto + (size_t) tamanho + 1;
+    if (necessario > UINT32_MAX) return UINT32_MAX;
+    if (necessario > t->capacidade_texto) {
+        size_t nova = t->capacidade_texto ? t->capacidade_texto : 4096;
+        while (nova < necessario) nova *= 2;
+        char* texto = (char*) realloc(t->texto, nova);
+        if (texto == NULL) return UINT32_MAX;
+        t->texto = texto;
+        t->capacidade_texto = nova;
+    }
+    memcpy(t->texto + t->tamanho_texto, lexema, (size_t) tamanho);
+    t->texto[t->tamanho_texto + (size_t) tamanho] = '\0';
+
+    uint32_t indice = t->num_lexemas++;
+    t->lexemas[indice].deslocamento = (uint32_t) t->tamanho_texto;
+    t->lexemas[indice].tamanho = (uint32_t) tamanho;
+    t->tamanho_texto = necessario;
+    t->chaves[pos] = lexema;
+    t->indices[pos] = indice;
+    return indice;
+}
+
+/* Arquivo em gravação: os bytes depois do cabeçalho entram na verificação */
+typedef struct {
+    FILE* arquivo;
+    EstadoHash hash;
+    uint64_t posicao;
+    int erro;
+} Gravacao;
+
+static void gravar_bytes(Gravacao* g, const void* dados, size_t tamanho) {
+    if (tamanho == 0) return;
+    if (fwrite(dados, 1, tamanho, g->arquivo) != tamanho) g->erro = 1;
+    hash_misturar(&g->hash, dados, tamanho);
+    g->posicao += tamanho;
+}
+
+static void gravar_secao(Gravacao* g, struct CabecalhoCache* c, int secao, const void* dados, size_t tamanho) {
+    static const char zeros[8] = { 0 };
+    gravar_bytes(g, zeros, (size_t) ((8 - g->posicao % 8) % 8));
+    c->secoes[secao].deslocamento = g->posicao;
+    c->secoes[secao].tamanho = tamanho;
+    gravar_bytes(g, dados, tamanho);
+}
+
+static int gravar_entrada(FILE* arquivo, ChaveCache chave, const Ast* ast, NoAst raiz,
+                          const char* assembly, size_t tamanho_assembly) {
+    uint32_t capacidade = 16;
+    while (capacidade < 2 * ast->num_folhas) capacidade *= 2;
+    TabelaLexemas t;
+    memset(&t, 0, sizeof(t));
+    t.capacidade = capacidade;
+    t.lexemas = (LexemaCache*) malloc((ast->num_folhas + 1) * sizeof(LexemaCache));
+    t.chaves = (const char**) calloc(capacidade, sizeof(const char*));
+    t.indices = (uint32_t*) malloc(capacidade * sizeof(uint32_t));
+    FolhaCache* folhas = (FolhaCache*) malloc((ast->num_folhas + 1) * sizeof(FolhaCache));
+
+    int ok = t.lexemas != NULL && t.chaves != NULL && t.indices != NULL && folhas != NULL;
+    for (uint32_t i = 0; ok && i < ast->num_folhas; i++) {
+        const FolhaAst* folha = &ast->folhas[i];
+        folhas[i].lexema = indice_lexema(&t, folha->lexema, folha->tamanho);
+        folhas[i].valor = folha->valor;
+        folhas[i].classe = (int32_t) folha->lig.classe;
+        folhas[i].slot = folha->lig.slot;
+        ok = folhas[i].lexema != UINT32_MAX;
+    }
+
+    if (ok) {
+        struct CabecalhoCache c;
+        memset(&c, 0, sizeof(c));
+        memcpy(c.magica, MAGICA_CACHE, 8);
+        c.formato = FORMATO_CACHE;
+        c.ordem = ORDEM_BYTES;
+        c.chave = chave;
+        c.num_nos = ast->num_nos;
+        c.num_filhos = ast->num_filhos;
+        c.num_folhas = ast->num_folhas;
+        c.num_lexemas = t.num_lexemas;
+        c.raiz = raiz;
+
+        Gravacao g = { arquivo, { 0 }, sizeof(c), 0 };
+        hash_iniciar(&g.hash);
+        if (fwrite(&c, sizeof(c), 1, arquivo) != 1) g.erro = 1;
+        gravar_secao(&g, &c, SECAO_TIPO, ast->tipo, ast->num_nos * sizeof(uint8_t));
+        gravar_secao(&g, &c, SECAO_TIPO_DADO, ast->tipo_dado, ast->num_nos * sizeof(uint8_t));
+        gravar_secao(&g, &c, SECAO_PRIMEIRO_FILHO, ast->primeiro_filho, ast->num_nos * sizeof(uint32_t));
+        gravar_secao(&g, &c, SECAO_PROX, ast->prox, ast->num_nos * sizeof(NoAst));
+        gravar_secao(&g, &c, SECAO_LINHA, ast->linha, ast->num_nos * sizeof(uint32_t));
+        gravar_secao(&g, &c, SECAO_DADO, ast->dado, ast->num_nos * sizeof(int32_t));
+        gravar_secao(&g, &c, SECAO_FILHOS, ast->filhos, ast->num_filhos * sizeof(NoAst));
+        gravar_secao(&g, &c, SECAO_FOLHAS, folhas, ast->num_folhas * sizeof(FolhaCache));
+        gravar_secao(&g, &c, SECAO_LEXEMAS, t.lexemas, t.num_lexemas * sizeof(LexemaCache));
+        gravar_secao(&g, &c, SECAO_TEXTO, t.texto, t.tamanho_texto);
+        gravar_secao(&g, &c, SECAO_ASSEMBLY, assembly, tamanho_assembly);
+
+        /* O cabeçalho, completo, por último */
+        c.tamanho_arquivo = g.posicao;
+        c.verificacao = hash_finalizar(&g.hash).h[0];
+        if (fseek(arquivo, 0, SEEK_SET) != 0 || fwrite(&c, sizeof(c), 1, arquivo) != 1) g.erro = 1;
+        ok = !g.erro;
+    }
+
+    free(t.lexemas);
+    free(t.texto);
+    free(t.chaves);
+    free(t.indices);
+    free(folhas);
+    return ok ? 0 : -1;
+}
+
+int cache_gravar(CacheCompilacao* cache, ChaveCache chave, const Ast* ast, NoAst raiz,
+                 const char* assembly, size_t tamanho_assembly) {
+    char* caminho = caminho_entrada(cache, chave);
+    size_t n = strlen(cache->diretorio) + sizeof("/tmp.XXXXXX");
+    char* temporario = (char*) malloc(n);
+    if (caminho == NULL || temporario == NULL) {
+        free(caminho);
+        free(temporario);
+        return -1;
+    }
+    snprintf(temporario, n, "%s/tmp.XXXXXX", cache->diretorio);
+
+    int fd = mkstemp(temporario);
+    FILE* arquivo = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    int resultado = -1;
+    if (arquivo != NULL) {
+        fchmod(fd, 0644);
+        resultado = gravar_entrada(arquivo, chave, ast, raiz, assembly, tamanho_assembly);
+        if (fclose(arquivo) != 0) resultado = -1;
+        /* rename é atômico: quem buscar a chave vê a entrada anterior ou a nova */
+        if (resultado == 0 && rename(temporario, caminho) != 0) resultado = -1;
+        if (resultado != 0) unlink(temporario);
+    } else if (fd >= 0) {
+        close(fd);
+        unlink(temporario);
+    }
+    free(caminho);
+    free(temporario);
+
+    if (resultado == 0) {
+        cache->novos.gravacoes++;
+        cache_podar(cache, cache->limite);
+    }
+    return resultado;
+}
+
+// --- Remoção ---
+
+typedef struct {
+    char* nome;
+    uint64_t tamanho;
+    struct timespec uso;
+} ArquivoCache;
+
+static int comparar_uso(const void* a, const void* b) {
+    const ArquivoCache* x = (const ArquivoCache*) a;
+    const ArquivoCache* y = (const ArquivoCache*) b;
+    if (x->uso.tv_sec != y->uso.tv_sec) return x->uso.tv_sec < y->uso.tv_sec ? -1 : 1;
+    if (x->uso.tv_nsec != y->uso.tv_nsec) return x->uso.tv_nsec < y->uso.tv_nsec ? -1 : 1;
+    return strcmp(x->nome, y->nome);
+}
+
+static int eh_entrada(const char* nome) {
+    size_t n = strlen(nome);
+    size_t s = strlen(SUFIXO_ENTRADA);
+    return n > s && strcmp(nome + n - s, SUFIXO_ENTRADA) == 0;
+}
+
+/* Entradas do diretório (e temporários órfãos, já removidos). Retorna o
+ * número de entradas em '*arquivos' (NULL se só a soma interessar). */
+static size_t listar_entradas(CacheCompilacao* cache, ArquivoCache** arquivos, uint64_t* total) {
+    *total = 0;
+    if (arquivos != NULL) *arquivos = NULL;
+    int dir_fd = open(cache->diretorio, O_RDONLY | O_DIRECTORY);
+    DIR* dir = dir_fd >= 0 ? fdopendir(dir_fd) : NULL;
+    if (dir == NULL) {
+        if (dir_fd >= 0) close(dir_fd);
+        return 0;
+    }
+
+    size_t num = 0, capacidade = 0;
+    time_t agora = time(NULL);
+    struct dirent* d;
+    while ((d = readdir(dir)) != NULL) {
+        struct stat info;
+        if (fstatat(dir_fd, d->d_name, &info, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        if (strncmp(d->d_name, "tmp.", 4) == 0) {
+            if (agora - info.st_mtime > IDADE_TEMPORARIO) unlinkat(dir_fd, d->d_name, 0);
+            continue;
+        }
+        if (!eh_entrada(d->d_name)) continue;
+
+        *total += (uint64_t) info.st_size;
+        if (arquivos != NULL) {
+            if (num == capacidade) {
+                size_t nova = capacidade ? capacidade * 2 : 64;
+                ArquivoCache* maior = (ArquivoCache*) realloc(*arquivos, nova * sizeof(ArquivoCache));
+                if (maior == NULL) break;
+                *arquivos = maior;
+                capacidade = nova;
+            }
+            ArquivoCache* a = &(*arquivos)[num];
+            a->nome = strdup(d->d_name);
+            if (a->nome == NULL) break;
+            a->tamanho = (uint64_t) info.st_size;
+            a->uso = info.st_mtim;
+        }
+        num++;
+    }
+    closedir(dir);
+    return num;
+}
+
+void cache_podar(CacheCompilacao* cache, uint64_t limite) {
+    ArquivoCache* arquivos;
+    uint64_t total;
+    size_t num = listar_entradas(cache, &arquivos, &total);
+
+    if (total > limite) {
+        qsort(arquivos, num, sizeof(ArquivoCache), comparar_uso);
+        int dir_fd = open(cache->diretorio, O_RDONLY | O_DIRECTORY);
+        for (size_t i = 0; i < num && total > limite && dir_fd >= 0; i++) {
+            /* Outro processo pode ter removido a mesma entrada: só conta a nossa */
+            if (unlinkat(dir_fd, arquivos[i].nome, 0) == 0) cache->novos.remocoes++;
+            total -= arquivos[i].tamanho;
+        }
+        if (dir_fd >= 0) close(dir_fd);
+    }
+
+    for (size_t i = 0; i < num; i++) free(arquivos[i].nome);
+    free(arquivos);
+}
+
+// --- Estatísticas ---
+
+/* Abre o arquivo de estatísticas com flock 'operacao' e lê os contadores */
+static FILE* abrir_estatisticas(const CacheCompilacao* cache, int operacao, ContadoresCache* contadores) {
+    memset(contadores, 0, sizeof(*contadores));
+    size_t n = strlen(cache->diretorio) + sizeof("/estatisticas");
+    char* caminho = (char*) malloc(n);
+    if (caminho == NULL) return NULL;
+    snprintf(caminho, n, "%s/estatisticas", cache->diretorio);
+    int fd = open(caminho, O_RDWR | O_CREAT, 0644);
+    free(caminho);
+    if (fd < 0) return NULL;
+
+    FILE* arquivo = fdopen(fd, "r+");
+    if (arquivo == NULL || flock(fd, operacao) != 0) {
+        if (arquivo != NULL) fclose(arquivo); else close(fd);
+        return NULL;
+    }
+    unsigned long long a = 0, f = 0, g = 0, r = 0;
+    if (fscanf(arquivo, "acertos %llu faltas %llu gravacoes %llu remocoes %llu", &a, &f, &g, &r) == 4) {
+        contadores->acertos = a;
+        contadores->faltas = f;
+        contadores->gravacoes = g;
+        contadores->remocoes = r;
+    }
+    return arquivo;
+}
+
+void cache_fechar(CacheCompilacao* cache) {
+    if (cache->diretorio == NULL) return;
+    ContadoresCache c;
+    FILE* arquivo = abrir_estatisticas(cache, LOCK_EX, &c);
+    if (arquivo != NULL) {
+        rewind(arquivo);
+        int n = fprintf(arquivo, "acertos %llu\nfaltas %llu\ngravacoes %llu\nremocoes %llu\n",
+                        (unsigned long long) (c.acertos + cache->novos.acertos),
+                        (unsigned long long) (c.faltas + cache->novos.faltas),
+                        (unsigned long long) (c.gravacoes + cache->novos.gravacoes),
+                        (unsigned long long) (c.remocoes + cache->novos.remocoes));
+        fflush(arquivo);
+        if (n > 0 && ftruncate(fileno(arquivo), n) != 0) {
+            /* Contadores perdidos não afetam as entradas */
+        }
+        fclose(arquivo);  /* Libera o flock */
+    }
+    free(cache->diretorio);
+    memset(cache, 0, sizeof(*cache));
+}
+
+void cache_imprimir_estatisticas(FILE* saida, CacheCompilacao* cache) {
+    ContadoresCache c;
+    FILE* arquivo = abrir_estatisticas(cache, LOCK_SH, &c);
+    if (arquivo != NULL) fclose(arquivo);
+    c.acertos += cache->novos.acertos;
+    c.faltas += cache->novos.faltas;
+    c.gravacoes += cache->novos.gravacoes;
+    c.remocoes += cache->novos.remocoes;
+
+    uint64_t total;
+    size_t num = listar_entradas(cache, NULL, &total);
+    uint64_t buscas = c.acertos + c.faltas;
+
+    fprintf(saida, "--- Estatisticas do cache (%s) ---\n", cache->diretorio);
+    fprintf(saida, "  Acertos: %llu | Faltas: %llu | Taxa de acertos: %.1f%%\n",
+            (unsigned long long) c.acertos, (unsigned long long) c.faltas,
+            buscas > 0 ? 100.0 * (double) c.acertos / (double) buscas : 0.0);
+    fprintf(saida, "  Gravacoes: %llu | Remocoes: %llu\n",
+            (unsigned long long) c.gravacoes, (unsigned long long) c.remocoes);
+    fprintf(saida, "  Entradas: %zu | Bytes: %llu de %llu\n", num,
+            (unsigned long long) total, (unsigned long long) cache->limite);
+}
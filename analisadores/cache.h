@@ -0,0 +1,106 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "compilador.h"
+
+/*
+ * Cache de compilações em disco, endereçado pelo conteúdo.
+ *
+ * A chave de uma entrada é um hash de 128 bits da identidade do compilador
+ * (hash do próprio executável), das opções que mudam a saída e do texto-fonte.
+ * A entrada guarda o assembly gerado e a AST já anotada pela análise
+ * semântica (tipos e ligações), num formato binário que é usado direto do
+ * arquivo mapeado com mmap: os arrays de nós têm o mesmo layout dos arrays de
+ * Ast e as folhas referenciam uma tabela de lexemas sem ponteiros. Um acerto
+ * dispensa as análises léxica, sintática e semântica e a geração de código.
+ *
+ * Cada entrada é um arquivo <chave>.ent no diretório do cache, gravado num
+ * arquivo temporário e renomeado: processos concorrentes nunca veem uma
+ * entrada pela metade. A data de modificação marca o último uso; quando o
+ * diretório passa do limite de bytes, as entradas usadas há mais tempo são
+ * removidas. Os contadores (acertos, faltas, gravações, remoções) ficam no
+ * arquivo 'estatisticas' do diretório, atualizado sob flock.
+ */
+
+#define CACHE_LIMITE_PADRAO (512ull * 1024 * 1024)
+
+typedef struct {
+    uint64_t h[2];
+} ChaveCache;
+
+/* Contadores persistentes do cache */
+typedef struct {
+    uint64_t acertos;
+    uint64_t faltas;
+    uint64_t gravacoes;
+    uint64_t remocoes;
+} ContadoresCache;
+
+typedef struct {
+    char* diretorio;
+    uint64_t limite;          /* Bytes ocupados pelas entradas, no máximo */
+    ChaveCache identidade;    /* Hash do executável do compilador */
+    ContadoresCache novos;    /* Ainda não somados ao arquivo de estatísticas */
+} CacheCompilacao;
+
+/* Entrada encontrada: o arquivo mapeado e os trechos validados */
+typedef struct {
+    void* mapa;
+    size_t tamanho_mapa;
+    const struct CabecalhoCache* cabecalho;
+} EntradaCache;
+
+/*
+ * Abre (criando, se preciso) o cache em 'diretorio'. 'limite' 0 usa
+ * CACHE_LIMITE_PADRAO. Retorna 0, ou -1 se o diretório não puder ser criado
+ * ou a identidade do compilador não puder ser calculada (errno preservado).
+ */
+int cache_abrir(CacheCompilacao* cache, const char* diretorio, uint64_t limite);
+
+/* Soma os contadores pendentes ao arquivo de estatísticas e libera o cache */
+void cache_fechar(CacheCompilacao* cache);
+
+/*
+ * Chave da compilação de 'fonte' com 'opcoes': um texto que descreve todas
+ * as opções que mudam o assembly gerado ("" se nenhuma).
+ */
+ChaveCache cache_chave(const CacheCompilacao* cache, const char* opcoes,
+                       const char* fonte, size_t tamanho);
+
+/*
+ * Procura a entrada de 'chave'. Retorna 1 e preenche 'entrada' num acerto,
+ * ou 0 se não houver entrada válida (arquivos truncados, de outro formato ou
+ * corrompidos contam como falta). Conta o acerto ou a falta.
+ */
+int cache_buscar(CacheCompilacao* cache, ChaveCache chave, EntradaCache* entrada);
+
+/* Assembly da entrada, no próprio mapeamento (não terminado em '\0') */
+const char* cache_assembly(const EntradaCache* entrada, size_t* tamanho);
+
+/*
+ * Reconstrói no contexto (que ainda não analisou nada) a AST anotada e o
+ * assembly da entrada, como se a compilação tivesse acabado de rodar: os
+ * lexemas são internados em ctx->atomos e as ligações de funções ficam nulas
+ * (não há tabela de símbolos). Retorna 0, ou -1 se faltar memória.
+ */
+int cache_restaurar(const EntradaCache* entrada, CompilerContext* ctx);
+
+void cache_liberar_entrada(EntradaCache* entrada);
+
+/*
+ * Grava a compilação de 'chave' (AST anotada e assembly) e, se o diretório
+ * passar do limite, remove as entradas mais antigas. Retorna 0 ou -1.
+ */
+int cache_gravar(CacheCompilacao* cache, ChaveCache chave, const Ast* ast, NoAst raiz,
+                 const char* assembly, size_t tamanho_assembly);
+
+/* Remove entradas, das usadas há mais tempo, até o total caber em 'limite' */
+void cache_podar(CacheCompilacao* cache, uint64_t limite);
+
+/* Contadores persistentes somados aos pendentes, número de entradas e bytes */
+void cache_imprimir_estatisticas(FILE* saida, CacheCompilacao* cache);
+
+#endif
@@ -0,0 +1,272 @@
+#define _POSIX_C_SOURCE 200809L /* open_memstream */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "compilador.h"
+#include "semantico.h"
+#include "gerador_codigo.h"
+#include "gerador_ri.h"
+#include "alocador.h"
+#include "y.tab.h"
+
+CompilerContext* compilador_criar(void) {
+    CompilerContext* ctx = (CompilerContext*) calloc(1, sizeof(CompilerContext));
+    if (ctx == NULL) return NULL;
+
+#ifdef SEM_FLEX
+    ctx->varredor = VARREDOR_MANUAL;
+#else
+    ctx->varredor = VARREDOR_FLEX;
+#endif
+    ctx->linha = 1;
+    RepositorioAtomos atomos = REPOSITORIO_ATOMOS_VAZIO;
+    ctx->atomos = atomos;
+    ctx->tipo_atual = TIPO_INT;
+    ctx->regras_janela = -1;
+    ctx->convencao = -1;
+    if (ast_iniciar(&ctx->ast) != 0) {
+        free(ctx);
+        return NULL;
+    }
+
+    ctx->diagnosticos = open_memstream(&ctx->texto_diagnosticos, &ctx->tamanho_diagnosticos);
+    if (ctx->diagnosticos == NULL) {
+        ast_liberar(&ctx->ast);
+        free(ctx);
+        return NULL;
+    }
+    ctx->diagnosticos_proprios = 1;
+    return ctx;
+}
+
+void compilador_destruir(CompilerContext* ctx) {
+    if (ctx == NULL) return;
+
+#ifndef SEM_FLEX
+    varredor_flex_finalizar(ctx);
+#endif
+    if (ctx->tabela_simbolos != NULL) {
+        eliminar_pilha_tabelas(ctx->tabela_simbolos);
+    }
+    ast_liberar(&ctx->ast);
+    liberar_repositorio(&ctx->atomos);
+    liberar_tokens(&ctx->tokens);
+
+    /* As fatias dos literais apontam para a fonte: ela é liberada por último */
+    desmapear_fonte(&ctx->fonte);
+
+    if (ctx->diagnosticos_proprios) {
+        fclose(ctx->diagnosticos);
+    }
+    free(ctx->texto_diagnosticos);
+    free(ctx->assembly);
+    free(ctx->texto_ri);
+    free(ctx);
+}
+
+void compilador_definir_diagnosticos(CompilerContext* ctx, FILE* destino) {
+    if (ctx->diagnosticos_proprios) {
+        fclose(ctx->diagnosticos);
+        free(ctx->texto_diagnosticos);
+        ctx->texto_diagnosticos = NULL;
+        ctx->tamanho_diagnosticos = 0;
+        ctx->diagnosticos_proprios = 0;
+    }
+    ctx->diagnosticos = destino;
+}
+
+// --- Carga da fonte ---
+
+int compilador_carregar_memoria(CompilerContext* ctx, const char* texto, size_t tamanho) {
+    return copiar_fonte(texto, tamanho, &ctx->fonte);
+}
+
+int compilador_carregar_arquivo(CompilerContext* ctx, const char* caminho, int permitir_mmap) {
+    /* Varre o arquivo inteiro mapeado em memória, sem cópias */
+    if (permitir_mmap && mapear_fonte(caminho, &ctx->fonte) == 0) {
+        return 0;
+    }
+
+    /* Fallback (pipes, arquivos vazios, --sem-mmap): o arquivo é lido inteiro
+     * para um buffer no heap, já que as fases seguintes precisam do texto todo */
+    FILE* entrada = fopen(caminho, "r");
+    if (entrada == NULL) return -1;
+    int resultado = compilador_carregar_fluxo(ctx, entrada);
+    int erro = errno;
+    fclose(entrada);
+    errno = erro;
+    return resultado;
+}
+
+int compilador_carregar_fluxo(CompilerContext* ctx, FILE* entrada) {
+    return ler_fonte(entrada, &ctx->fonte);
+}
+
+int compilador_iniciar_varredor(CompilerContext* ctx) {
+    if (ctx->varredor_iniciado) return 0;
+    if (ctx->fonte.dados == NULL && copiar_fonte("", 0, &ctx->fonte) != 0) return -1;
+#ifdef SEM_FLEX
+    if (ctx->varredor == VARREDOR_FLEX) ctx->varredor = VARREDOR_MANUAL;
+#endif
+
+    switch (ctx->varredor) {
+        case VARREDOR_PRE_TOKENIZADO:
+            /* Tokeniza o arquivo inteiro antes do parser (ver tokens.h) */
+            if (tokenizar_fonte(ctx->fonte.dados, ctx->fonte.tamanho, ctx->num_fatias, &ctx->tokens) != 0) {
+                return -1;
+            }
+            ctx->proximo_token = 0;
+            break;
+#ifndef SEM_FLEX
+        case VARREDOR_FLEX:
+            if (!varredor_flex_iniciar(ctx)) return -1;
+            break;
+#endif
+        default:
+            varredor_iniciar(&ctx->manual, ctx->fonte.dados, ctx->fonte.tamanho);
+            break;
+    }
+    ctx->varredor_iniciado = 1;
+    ctx->linha = 1;
+    return 0;
+}
+
+// --- Fases ---
+
+int compilador_analisar(CompilerContext* ctx) {
+    if (compilador_iniciar_varredor(ctx) != 0) {
+        fprintf(ctx->diagnosticos, "Erro: Nao foi possivel tokenizar a entrada\n");
+        return -1;
+    }
+    int resultado = yyparse(ctx);
+    if (resultado == 0 && ctx->ast.sem_memoria) {
+        fprintf(ctx->diagnosticos, "Erro: memoria insuficiente para a arvore sintatica\n");
+        return -1;
+    }
+    return resultado;
+}
+
+int compilador_verificar(CompilerContext* ctx) {
+    if (ctx->tabela_simbolos == NULL) {
+        ctx->tabela_simbolos = iniciar_pilha_tabela_simbolos();
+    }
+    ctx->erros_semanticos = verificar_semantica(&ctx->ast, ctx->raiz, ctx->tabela_simbolos, ctx->diagnosticos);
+    return ctx->erros_semanticos;
+}
+
+int compilador_gerar(CompilerContext* ctx) {
+    if (ctx->raiz == NO_NENHUM || ctx->tabela_simbolos == NULL || ctx->erros_semanticos > 0) return -1;
+
+    if (ctx->nivel_otimizacao >= 1 &&
+        (dobrar_constantes(&ctx->ast, ctx->raiz, &ctx->otimizacao) != 0 ||
+         eliminar_subexpressoes(&ctx->ast, ctx->raiz, &ctx->otimizacao) != 0)) {
+        return -1;
+    }
+
+    free(ctx->assembly);
+    ctx->assembly = NULL;
+    ctx->tamanho_assembly = 0;
+    free(ctx->texto_ri);
+    ctx->texto_ri = NULL;
+    ctx->tamanho_ri = 0;
+
+    // A RI é o ponto de partida do código no nível 1, e do texto pedido em qualquer nível
+    ProgramaRI prog;
+    int usar_ri = ctx->nivel_otimizacao >= 1 || ctx->emitir_ri;
+    if (usar_ri && ri_traduzir(&ctx->ast, ctx->raiz, &prog) != 0) return -1;
+    // No nível 1 a recursão final vira laço, as funções pequenas são
+    // integradas, o que não muda nos laços sai deles, e cada variável vira
+    // uma teia por trecho independente
+    if (ctx->nivel_otimizacao >= 1 &&
+        (eliminar_recursao_final(&prog, &ctx->otimizacao) != 0 ||
+         integrar_funcoes(&prog, ctx->relatar_integracao ? ctx->diagnosticos : NULL, &ctx->otimizacao) != 0 ||
+         otimizar_lacos(&prog, &ctx->otimizacao) != 0 ||
+         separar_teias(&prog) != 0)) {
+        ri_liberar(&prog);
+        return -1;
+    }
+    if (ctx->emitir_ri) {
+        FILE* texto = open_memstream(&ctx->texto_ri, &ctx->tamanho_ri);
+        if (texto == NULL) {
+            ri_liberar(&prog);
+            return -1;
+        }
+        ri_imprimir(texto, &prog);
+        if (fclose(texto) != 0) {
+            ri_liberar(&prog);
+            return -1;
+        }
+    }
+
+    FILE* saida = open_memstream(&ctx->assembly, &ctx->tamanho_assembly);
+    int resultado = -1;
+    if (saida != NULL) {
+        ConvencaoChamada convencao = compilador_convencao(ctx);
+        resultado = ctx->nivel_otimizacao >= 1 ? gerar_codigo_ri(&prog, saida, convencao)
+                                               : gerar_codigo(&ctx->ast, ctx->raiz, saida, convencao);
+        if (fclose(saida) != 0) resultado = -1;
+    }
+    if (usar_ri) ri_liberar(&prog);
+    if (resultado != 0) {
+        free(ctx->assembly);
+        ctx->assembly = NULL;
+        ctx->tamanho_assembly = 0;
+        return -1;
+    }
+
+    // Por último, a janela sobre o texto final de qualquer um dos geradores
+    unsigned regras = compilador_regras_janela(ctx);
+    if (regras != 0) {
+        char* otimizado;
+        size_t tamanho;
+        if (otimizar_janela(ctx->assembly, ctx->tamanho_assembly, regras, &otimizado, &tamanho,
+                            &ctx->janela) != 0) {
+            return -1;
+        }
+        free(ctx->assembly);
+        ctx->assembly = otimizado;
+        ctx->tamanho_assembly = tamanho;
+    }
+    return 0;
+}
+
+unsigned compilador_regras_janela(const CompilerContext* ctx) {
+    if (ctx->regras_janela >= 0) return (unsigned) ctx->regras_janela;
+    return ctx->nivel_otimizacao >= 1 ? JANELA_TODAS : 0;
+}
+
+ConvencaoChamada compilador_convencao(const CompilerContext* ctx) {
+    if (ctx->convencao >= 0) return (ConvencaoChamada) ctx->convencao;
+    return ctx->nivel_otimizacao >= 1 ? CONVENCAO_REGISTRADORES : CONVENCAO_PILHA;
+}
+
+int compilar_memoria(CompilerContext* ctx, const char* texto, size_t tamanho) {
+    if (compilador_carregar_memoria(ctx, texto, tamanho) != 0) return -1;
+    if (compilador_analisar(ctx) != 0) return -1;
+    if (compilador_verificar(ctx) != 0) return -1;
+    return compilador_gerar(ctx);
+}
+
+// --- Resultados ---
+
+const char* compilador_assembly(const CompilerContext* ctx, size_t* tamanho) {
+    if (tamanho != NULL) *tamanho = ctx->tamanho_assembly;
+    return ctx->assembly;
+}
+
+const char* compilador_ri(const CompilerContext* ctx, size_t* tamanho) {
+    if (tamanho != NULL) *tamanho = ctx->tamanho_ri;
+    return ctx->texto_ri;
+}
+
+const char* compilador_diagnosticos(CompilerContext* ctx, size_t* tamanho) {
+    if (ctx->diagnosticos_proprios) {
+        fflush(ctx->diagnosticos);
+    }
+    if (ctx->texto_diagnosticos == NULL) {
+        if (tamanho != NULL) *tamanho = 0;
+        return "";
+    }
+    if (tamanho != NULL) *tamanho = ctx->tamanho_diagnosticos;
+    return ctx->texto_diagnosticos;
+}
@@ -0,0 +1,151 @@
+#ifndef COMPILADOR_H
+#define COMPILADOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "tabela_simbolos.h"
+#include "atomos.h"
+#include "regiao.h"
+#include "ast.h"
+#include "otimizador.h"
+#include "fonte.h"
+#include "varredor.h"
+#include "tokens.h"
+#include "janela.h"
+#include "gerador_codigo.h"
+
+/*
+ * Contexto de uma compilação.
+ *
+ * Todo o estado do pipeline (texto-fonte, scanner, parser, átomos, AST, tabela
+ * de símbolos e saídas) fica aqui: nenhuma fase usa variáveis globais, então
+ * cada thread pode compilar com seu próprio contexto ao mesmo tempo que as
+ * outras. Um contexto não deve ser usado por duas threads simultaneamente.
+ *
+ * Uso típico como biblioteca:
+ *
+ *   CompilerContext* ctx = compilador_criar();
+ *   if (compilar_memoria(ctx, texto, tamanho) == 0) {
+ *       size_t n;
+ *       const char* asm_mips = compilador_assembly(ctx, &n);
+ *       ...
+ *   }
+ *   compilador_destruir(ctx);   // invalida o assembly e os diagnósticos
+ *
+ * Os campos são visíveis para o parser e os scanners; os demais usuários
+ * devem se limitar às funções abaixo e às opções marcadas.
+ */
+typedef struct CompilerContext {
+    /* Opções: podem ser alteradas até compilador_iniciar_varredor */
+    TipoVarredor varredor;
+    int num_fatias;              /* Modo pré-tokenizado (ver tokenizar_fonte) */
+    int nivel_otimizacao;        /* 0: nenhuma; 1: constantes e subexpressões (otimizador.h),
+                                    e geração a partir da RI (ri.h) */
+    int emitir_ri;               /* compilador_gerar guarda também o texto da RI */
+    int regras_janela;           /* Máscara das regras de janela (janela.h) aplicadas ao
+                                    assembly; -1: todas no nível 1, nenhuma no 0 */
+    int convencao;               /* ConvencaoChamada (gerador_codigo.h); -1: a dos
+                                    registradores no nível 1, a da pilha no 0 */
+    int relatar_integracao;      /* Nível 1: as decisões da integração de funções
+                                    (integrar_funcoes) vão para 'diagnosticos' */
+
+    /* Entrada: texto inteiro em memória, seguido de dois bytes nulos */
+    FonteMapeada fonte;
+    int linha;                   /* Linha do último token lido (o yylineno) */
+
+    /* Estado dos analisadores léxicos */
+    int varredor_iniciado;
+    Varredor manual;
+    BufferTokens tokens;
+    size_t proximo_token;
+    void* scanner_flex;          /* yyscan_t do scanner reentrante do Flex */
+
+    /* Memória da compilação: átomos e nós vivem até compilador_destruir */
+    RepositorioAtomos atomos;
+    Ast ast;
+
+    /* Estado do parser */
+    NoAst raiz;                  /* NO_PROGRAMA, ou NO_NENHUM */
+    Tipo tipo_atual;
+    int erros_sintaticos;
+
+    /* Análise semântica: as ligações dos nós apontam para esta tabela */
+    ScopeStack* tabela_simbolos;
+    int erros_semanticos;
+
+    /* Otimizações feitas na AST por compilador_gerar */
+    EstatisticasOtimizacao otimizacao;
+    EstatisticasJanela janela;   /* E pela otimização por janela no assembly */
+
+    /* Saídas */
+    FILE* diagnosticos;          /* Mensagens de erro (ver compilador_diagnosticos) */
+    int diagnosticos_proprios;   /* 'diagnosticos' é o buffer em memória abaixo */
+    char* texto_diagnosticos;
+    size_t tamanho_diagnosticos;
+    char* assembly;
+    size_t tamanho_assembly;
+    char* texto_ri;
+    size_t tamanho_ri;
+} CompilerContext;
+
+/* Cria um contexto vazio, com os diagnósticos acumulados em memória.
+ * Retorna NULL se faltar memória. */
+CompilerContext* compilador_criar(void);
+
+/* Libera o contexto e tudo o que a compilação alocou */
+void compilador_destruir(CompilerContext* ctx);
+
+/* Escreve os diagnósticos em 'destino' (ex: stderr) em vez de acumulá-los */
+void compilador_definir_diagnosticos(CompilerContext* ctx, FILE* destino);
+
+/*
+ * Carga do texto-fonte. Cada contexto compila uma única fonte.
+ *   compilador_carregar_memoria: copia os 'tamanho' bytes de 'texto';
+ *   compilador_carregar_arquivo: mapeia o arquivo (ou o lê, se permitir_mmap
+ *     for 0 ou o arquivo não puder ser mapeado);
+ *   compilador_carregar_fluxo: lê 'entrada' até o fim.
+ * Retornam 0 em caso de sucesso ou -1 em caso de erro (errno preservado).
+ */
+int compilador_carregar_memoria(CompilerContext* ctx, const char* texto, size_t tamanho);
+int compilador_carregar_arquivo(CompilerContext* ctx, const char* caminho, int permitir_mmap);
+int compilador_carregar_fluxo(CompilerContext* ctx, FILE* entrada);
+
+/*
+ * Prepara o scanner escolhido em ctx->varredor sobre a fonte carregada (no
+ * modo pré-tokenizado, tokeniza o texto inteiro). compilador_analisar a chama
+ * se necessário; chamá-la antes permite usar yylex() ou medir_varredor()
+ * diretamente. Retorna 0, ou -1 se faltar memória.
+ */
+int compilador_iniciar_varredor(CompilerContext* ctx);
+
+/*
+ * Fases da compilação, na ordem. Cada uma depende do sucesso da anterior.
+ *   compilador_analisar: análise sintática; retorna 0 se a AST foi construída;
+ *   compilador_verificar: análise semântica; retorna o número de erros;
+ *   compilador_gerar: otimiza a AST conforme ctx->nivel_otimizacao e gera o
+ *     assembly MIPS em memória (no nível 1, traduzindo antes para a RI), que
+ *     passa depois pelas regras de compilador_regras_janela; retorna 0 ou -1.
+ */
+int compilador_analisar(CompilerContext* ctx);
+int compilador_verificar(CompilerContext* ctx);
+int compilador_gerar(CompilerContext* ctx);
+
+/* Regras de janela e convenção de chamada que compilador_gerar usa com as
+ * opções atuais */
+unsigned compilador_regras_janela(const CompilerContext* ctx);
+ConvencaoChamada compilador_convencao(const CompilerContext* ctx);
+
+/* Carrega 'texto' e executa as três fases. Retorna 0 se o assembly foi gerado. */
+int compilar_memoria(CompilerContext* ctx, const char* texto, size_t tamanho);
+
+/* Assembly gerado (terminado em '\0'), ou NULL se a geração não ocorreu */
+const char* compilador_assembly(const CompilerContext* ctx, size_t* tamanho);
+
+/* Texto da RI (terminado em '\0'), se ctx->emitir_ri estava ligado na
+ * geração; senão NULL */
+const char* compilador_ri(const CompilerContext* ctx, size_t* tamanho);
+
+/* Diagnósticos acumulados (terminados em '\0'); "" se foram redirecionados */
+const char* compilador_diagnosticos(CompilerContext* ctx, size_t* tamanho);
+
+#endif
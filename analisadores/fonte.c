@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fonte.h"
+
+int mapear_fonte(const char* caminho, FonteMapeada* fonte) {
+    fonte->dados = NULL;
+    fonte->tamanho = 0;
+    fonte->tamanho_mapa = 0;
+
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t pagina = (size_t) sysconf(_SC_PAGESIZE);
+    size_t tamanho = (size_t) info.st_size;
+    size_t tamanho_mapa = (tamanho + 2 + pagina - 1) & ~(pagina - 1);
+
+    /* Reserva páginas anônimas (zeradas) suficientes para o arquivo mais os
+     * dois bytes nulos finais e sobrepõe o arquivo no início da reserva. */
+    char* reserva = mmap(NULL, tamanho_mapa, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserva == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    char* dados = mmap(reserva, tamanho, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (dados == MAP_FAILED) {
+        munmap(reserva, tamanho_mapa);
+        return -1;
+    }
+
+    /* Lido sequencialmente pelo analisador léxico */
+    madvise(dados, tamanho, MADV_SEQUENTIAL);
+
+    fonte->dados = dados;
+    fonte->tamanho = tamanho;
+    fonte->tamanho_mapa = tamanho_mapa;
+    return 0;
+}
+
+int ler_fonte(FILE* entrada, FonteMapeada* fonte) {
+    size_t capacidade = 1 << 16;
+    size_t tamanho = 0;
+
+    /* Arquivo regular (--sem-mmap): o buffer já sai do tamanho certo, com uma
+     * folga para o fread que encontra o fim sem precisar crescer */
+    struct stat info;
+    long posicao = ftell(entrada);
+    if (fstat(fileno(entrada), &info) == 0 && S_ISREG(info.st_mode) && posicao >= 0 &&
+        info.st_size > posicao) {
+        capacidade = (size_t) (info.st_size - posicao) + 3;
+    }
+    char* dados = malloc(capacidade);
+    if (dados == NULL) return -1;
+
+    size_t lidos;
+    while ((lidos = fread(dados + tamanho, 1, capacidade - tamanho - 2, entrada)) > 0) {
+        tamanho += lidos;
+        if (capacidade - tamanho - 2 == 0) {
+            char* maior = realloc(dados, capacidade * 2);
+            if (maior == NULL) {
+                free(dados);
+                return -1;
+            }
+            dados = maior;
+            capacidade *= 2;
+        }
+    }
+    dados[tamanho] = '\0';
+    dados[tamanho + 1] = '\0';
+
+    fonte->dados = dados;
+    fonte->tamanho = tamanho;
+    fonte->tamanho_mapa = 0;
+    return 0;
+}
+
+int copiar_fonte(const char* texto, size_t tamanho, FonteMapeada* fonte) {
+    char* dados = malloc(tamanho + 2);
+    if (dados == NULL) return -1;
+    memcpy(dados, texto, tamanho);
+    dados[tamanho] = '\0';
+    dados[tamanho + 1] = '\0';
+
+    fonte->dados = dados;
+    fonte->tamanho = tamanho;
+    fonte->tamanho_mapa = 0;
+    return 0;
+}
+
+void desmapear_fonte(FonteMapeada* fonte) {
+    if (fonte->dados != NULL) {
+        if (fonte->tamanho_mapa == 0) {
+            free(fonte->dados);
+        } else {
+            munmap(fonte->dados, fonte->tamanho_mapa);
+        }
+    }
+    fonte->dados = NULL;
+    fonte->tamanho = 0;
+    fonte->tamanho_mapa = 0;
+}
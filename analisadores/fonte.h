@@ -0,0 +1,44 @@
+#ifndef FONTE_H
+#define FONTE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/* Trecho do texto-fonte (não necessariamente terminado em '\0') */
+typedef struct {
+    const char* inicio;
+    int tamanho;
+} Fatia;
+
+/* Arquivo-fonte mapeado em memória por inteiro */
+typedef struct {
+    char* dados;          /* Conteúdo do arquivo, seguido de dois bytes '\0' */
+    size_t tamanho;       /* Tamanho do arquivo em bytes */
+    size_t tamanho_mapa;  /* Tamanho total da região mapeada (0: lido com ler_fonte) */
+} FonteMapeada;
+
+/*
+ * Mapeia o arquivo com mmap, reservando dois bytes nulos após o conteúdo
+ * (exigência de yy_scan_buffer). O mapeamento é privado: o analisador léxico
+ * pode escrever no buffer sem alterar o arquivo.
+ * Retorna 0 em caso de sucesso, ou -1 se o arquivo não puder ser mapeado
+ * (ex: pipe ou arquivo vazio); nesse caso deve-se ler o arquivo por fluxo.
+ */
+int mapear_fonte(const char* caminho, FonteMapeada* fonte);
+
+/*
+ * Lê todo o fluxo 'entrada' para um buffer no heap, com o mesmo formato de
+ * mapear_fonte (dois bytes nulos ao final). Usado quando o arquivo não pode
+ * ser mapeado: o compilador sempre varre o texto inteiro em memória, pois as
+ * fatias dos literais, o modo pré-tokenizado e o cache apontam para ele.
+ * Retorna 0 em caso de sucesso, ou -1 se faltar memória.
+ */
+int ler_fonte(FILE* entrada, FonteMapeada* fonte);
+
+/* Copia 'tamanho' bytes de 'texto' para o heap, no formato de ler_fonte */
+int copiar_fonte(const char* texto, size_t tamanho, FonteMapeada* fonte);
+
+/* Desfaz o mapeamento (ou libera o buffer de ler_fonte). Fatias apontando para o arquivo tornam-se inválidas. */
+void desmapear_fonte(FonteMapeada* fonte);
+
+#endif
@@ -4,454 +4,657 @@
 #include "gerador_codigo.h"
 #include "ast.h"
 #include "tabela_simbolos.h"
-
-// --- Variáveis globais ---
-static FILE* out;
-static int label_counter = 0;
-static int string_literal_counter = 0;
-static ScopeStack* g_pilha_escopos_gerador = NULL;
-static int g_offset_local = 0;
-static int decl_global_atual = 1;
+#include "percurso.h"
+
+/*
+ * Layout do quadro de ativação (funções e bloco principal):
+ *
+ *   $fp + F + 4*(n-1-i)  parâmetro i (empilhado pelo chamador, da esquerda p/ direita)
+ *   $fp + F - 4          $ra salvo
+ *   $fp + F - 8          $fp do chamador
+ *   $fp + 4*(L+i)        parâmetro i < 4 recebido em $ai (convenção dos registradores)
+ *   $fp + 4*k            variável local de slot k
+ *
+ * onde F = 4 * (L + R) + 8, L é o número de locais, n o de parâmetros e R o
+ * de parâmetros recebidos em registradores (0 na convenção da pilha). Slots e
+ * classes de armazenamento vêm das ligações deixadas nos nós pela análise
+ * semântica.
+ *
+ * Na convenção dos registradores os argumentos ainda são calculados na pilha
+ * de temporários; só antes da chamada os quatro primeiros vão para $a0..$a3.
+ * Com até quatro, a pilha volta antes da chamada; com mais, os demais já
+ * estão onde o chamado os procura.
+ */
+
+// Condição em tradução: desvia para 'verdadeiro' ou 'falso' (ver sair_condicao)
+typedef struct {
+    NoAst no;
+    int verdadeiro;
+    int falso;
+    int meio;               // 'e' e 'ou': onde começa o operando direito
+    int fim;                // 'e' e 'ou' fora de condição: depois do valor 0 ou 1
+    uint8_t segue_verdadeiro; // O código seguinte é o do rótulo 'verdadeiro' (senão, o do 'falso')
+    uint8_t valor;          // 'e' e 'ou' fora de condição: deixa 0 ou 1 em $a0
+} Condicao;
+
+// --- Estado da geração de uma compilação ---
+typedef struct {
+    FILE* out;
+    const char* prefixo; // Prefixo dos rótulos gerados ("" no programa inteiro)
+    int label_counter;
+    int string_literal_counter;
+    const Ast* ast; // Árvore sendo traduzida
+
+    // Função sendo gerada (NO_NENHUM no bloco principal)
+    NoAst funcao_atual;
+    int tamanho_quadro;
+    int num_params;
+    ConvencaoChamada convencao;
+
+    Condicao proxima;       // O próximo nó a traduzir como condição, e seus destinos
+    Condicao* condicoes;    // Condições em tradução, a mais interna no topo
+    uint32_t num_condicoes;
+    uint32_t capacidade_condicoes;
+    int sem_memoria;
+} GeradorCodigo;
 
 // --- Protótipos ---
-void gerar_no(ASTNode* no);
-void gerar_cabecalho(ASTNode* raiz);
-void gerar_declaracoes_globais(ASTNode* no);
-void gerar_rodape();
-void gerar_expressao(ASTNode* no);
-void gerar_atribuicao(ASTNode* no);
-void gerar_if(ASTNode* no);
-void gerar_while(ASTNode* no);
-void gerar_io(ASTNode* no);
-void gerar_funcao(ASTNode* no);
-void gerar_chamada(ASTNode* no);
-void gerar_declaracao_var(ASTNode* no);
-void empilhar_argumentos(ASTNode* arg, int* count); // Protótipo adicionado
+static int gerar_comandos(GeradorCodigo* ger, NoAst no);
+static void gerar_cabecalho(GeradorCodigo* ger, NoAst raiz);
+static void gerar_declaracoes_globais(GeradorCodigo* ger, NoAst no);
+static int gerar_programa(GeradorCodigo* ger, NoAst raiz);
+static void gerar_rodape(GeradorCodigo* ger);
+static int gerar_funcao(GeradorCodigo* ger, NoAst no);
 
 // --- Auxiliares ---
-char* novo_label() {
-    char* buffer = (char*)malloc(20);
-    sprintf(buffer, "L%d", label_counter++);
-    return buffer;
-}
-
-Symbol* obter_simbolo(char* nome) {
-    return pesquisar_simbolo(g_pilha_escopos_gerador, nome);
-}
-
-// Calcula tamanho das variáveis locais (excluindo parâmetros)
-int calcular_espaco_local(ASTNode* no) {
-    if (no == NULL) return 0;
-    int espaco = 0;
-    ASTNode* atual = no;
-
-    // Se for um bloco, primeiro processa as declarações imediatas
-    if (atual->tipo == NO_BLOCO) {
-        ASTNode* decls = atual->filho[0];
-        while (decls != NULL) {
-             if (decls->tipo == NO_DECL_VAR) {
-                 espaco += 4;
-             }
-             decls = decls->prox;
-        }
-        // Depois processa comandos internos
-        atual = no->filho[1];
+
+// Reserva 'quantidade' rótulos consecutivos e devolve o número do primeiro
+static int novos_labels(GeradorCodigo* ger, int quantidade) {
+    int primeiro = ger->label_counter;
+    ger->label_counter += quantidade;
+    return primeiro;
+}
+
+static void emitir_label(GeradorCodigo* ger, intptr_t label) {
+    fprintf(ger->out, "%sL%d:\n", ger->prefixo, (int) label);
+}
+
+// Desvio incondicional por registrador: alcança qualquer endereço
+static void emitir_salto(GeradorCodigo* ger, intptr_t label) {
+    fprintf(ger->out, "  la $t9, %sL%d\n", ger->prefixo, (int) label);
+    fprintf(ger->out, "  jr $t9\n");
+}
+
+static void empilhar_a0(GeradorCodigo* ger) {
+    fprintf(ger->out, "  addiu $sp, $sp, -4\n");
+    fprintf(ger->out, "  sw $a0, 0($sp)\n");
+}
+
+// Parâmetros que chegam em $a0..$a3
+static int params_em_registradores(const GeradorCodigo* ger) {
+    if (ger->convencao != CONVENCAO_REGISTRADORES) return 0;
+    return ger->num_params < 4 ? ger->num_params : 4;
+}
+
+// Espaço, em bytes, das variáveis locais de uma função ou do bloco principal,
+// e dos parâmetros recebidos em registradores ('num_params' já contado)
+static int calcular_espaco_local(GeradorCodigo* ger, NoAst no) {
+    return 4 * (AST_NUM_LOCAIS(ger->ast, no) + params_em_registradores(ger));
+}
+
+// Lugar no quadro do parâmetro i recebido em $ai, logo acima dos locais
+static int deslocamento_recebido(const GeradorCodigo* ger, int i) {
+    return ger->tamanho_quadro - 8 - 4 * (params_em_registradores(ger) - i);
+}
+
+// Deslocamento em relação a $fp de um parâmetro ou variável local
+static int deslocamento(GeradorCodigo* ger, NoAst id_node) {
+    int slot = AST_LIGACAO(ger->ast, id_node).slot;
+    if (AST_LIGACAO(ger->ast, id_node).classe == LIG_PARAMETRO) {
+        if (slot < params_em_registradores(ger)) return deslocamento_recebido(ger, slot);
+        return ger->tamanho_quadro + 4 * (ger->num_params - 1 - slot);
     }
+    return 4 * slot;
+}
 
-    // Percorre a lista de comandos (usando 'prox')
-    while (atual != NULL) {
-        if (atual->tipo == NO_SE) {
-            int espaco_if = calcular_espaco_local(atual->filho[1]);
-            int espaco_else = (atual->filho[2] != NULL) ? calcular_espaco_local(atual->filho[2]) : 0;
-            espaco += (espaco_if > espaco_else) ? espaco_if : espaco_else;
-        } else if (atual->tipo == NO_ENQUANTO) {
-            espaco += calcular_espaco_local(atual->filho[1]);
-        } else if (atual->tipo == NO_BLOCO) {
-            espaco += calcular_espaco_local(atual);
-        }
-        
-        atual = atual->prox;
+// Gera a carga de uma variável para $a0
+static void gerar_carga(GeradorCodigo* ger, NoAst id_node) {
+    switch (AST_LIGACAO(ger->ast, id_node).classe) {
+        case LIG_GLOBAL:
+            fprintf(ger->out, "  lw $a0, _%s\n", AST_LEXEMA(ger->ast, id_node));
+            break;
+        case LIG_PARAMETRO:
+        case LIG_LOCAL:
+            fprintf(ger->out, "  lw $a0, %d($fp)\n", deslocamento(ger, id_node));
+            break;
+        case LIG_FUNCAO:
+            fprintf(ger->out, "  la $a0, %s\n", AST_LEXEMA(ger->ast, id_node));
+            break;
+        default:
+            break;
     }
-    return espaco;
 }
 
-int obter_offset(char* nome) {
-    Symbol* s = obter_simbolo(nome);
-    if (s) {
-        return s->ordem; 
+// Gera o armazenamento do registrador 'reg' na variável
+static void gerar_armazenamento(GeradorCodigo* ger, NoAst id_node, const char* reg) {
+    switch (AST_LIGACAO(ger->ast, id_node).classe) {
+        case LIG_GLOBAL:
+            fprintf(ger->out, "  sw %s, _%s\n", reg, AST_LEXEMA(ger->ast, id_node));
+            break;
+        case LIG_PARAMETRO:
+        case LIG_LOCAL:
+            fprintf(ger->out, "  sw %s, %d($fp)\n", reg, deslocamento(ger, id_node));
+            break;
+        default:
+            break;
     }
-    return 0; 
+}
+
+// Prólogo comum a funções e ao bloco principal
+static void gerar_prologo(GeradorCodigo* ger, int tamanho_frame) {
+    fprintf(ger->out, "  addiu $sp, $sp, -%d\n", tamanho_frame);
+    fprintf(ger->out, "  sw $ra, %d($sp)\n", tamanho_frame - 4);
+    fprintf(ger->out, "  sw $fp, %d($sp)\n", tamanho_frame - 8);
+    fprintf(ger->out, "  move $fp, $sp\n");
+}
+
+// Epílogo comum: a pilha de temporários já está equilibrada, então $sp == $fp
+static void gerar_epilogo(GeradorCodigo* ger, int tamanho_frame) {
+    fprintf(ger->out, "  lw $ra, %d($sp)\n", tamanho_frame - 4);
+    fprintf(ger->out, "  lw $fp, %d($sp)\n", tamanho_frame - 8);
+    fprintf(ger->out, "  addiu $sp, $sp, %d\n", tamanho_frame);
 }
 
 // --- Função Principal ---
-void gerar_codigo(ASTNode* raiz, FILE* saida, ScopeStack* pilha) {
-    out = saida;
-    if (!out) return;
-    g_pilha_escopos_gerador = pilha;
-
-    gerar_cabecalho(raiz);
-    gerar_no(raiz); // Gera o restante (incluindo main se estiver na árvore como nó)
-    gerar_rodape();
-}
-
-void gerar_declaracoes_globais(ASTNode* no) {
-    if (no == NULL) {
-        decl_global_atual = 0;
-        return;
-    };
-    
-    // Lista de Declarações Globais (DeclFuncVar)
-    // No Yacc: DeclFuncVar -> ... | DeclFunc ...
-    
-    if (no->tipo == NO_DECL_VAR) {
-        ASTNode* id_node = no->filho[1]; // No Yacc: filho[0]=Tipo, filho[1]=ID
-        fprintf(out, "_%s: .word 0\n", id_node->valor_lexico);
-        
-        // Usa o ponteiro 'prox' para a próxima declaração global
-        if (no->prox != NULL) gerar_declaracoes_globais(no->prox);
-        
-    } else if (no->tipo == NO_DECL_FUNC) {
-        gerar_funcao(no);
-        // Se houver mais declarações após a função (depende da estrutura DeclFuncVar)
-        if (no->prox != NULL) gerar_declaracoes_globais(no->prox); 
-    } else {
-        // Pode ser DeclProg (Programa) ou fim
-        decl_global_atual = 0;
-        return;
+int gerar_codigo(const Ast* ast, NoAst raiz, FILE* saida, ConvencaoChamada convencao) {
+    if (!saida) return -1;
+
+    GeradorCodigo estado = { saida, "", 0, 0, ast, NO_NENHUM, 0, 0, convencao };
+    GeradorCodigo* ger = &estado;
+    int resultado = 0;
+
+    gerar_cabecalho(ger, raiz);
+    if (gerar_programa(ger, raiz) != 0) resultado = -1;
+    // Funções são geradas depois do main, na seção .text
+    if (raiz != NO_NENHUM) {
+        for (NoAst decl = AST_FILHO(ast, raiz, 0); decl != NO_NENHUM; decl = AST_PROX(ast, decl)) {
+            if (AST_TIPO(ast, decl) == NO_DECL_FUNC && gerar_funcao(ger, decl) != 0) resultado = -1;
+        }
     }
+    gerar_rodape(ger);
+    return resultado;
+}
+
+// --- Geração por partes ---
+
+void gerar_codigo_cabecalho(const Ast* ast, NoAst raiz, FILE* saida) {
+    GeradorCodigo estado = { saida, "", 0, 0, ast, NO_NENHUM, 0, 0 };
+    gerar_cabecalho(&estado, raiz);
 }
 
-void gerar_cabecalho(ASTNode* raiz) {
-    fprintf(out, ".data\n");
-    fprintf(out, "newline: .asciiz \"\\n\"\n");
-    fprintf(out, "space: .asciiz \" \"\n");
+void gerar_codigo_dados(FILE* saida) {
+    fprintf(saida, ".data\n");
+    fprintf(saida, "newline: .asciiz \"\\n\"\n");
+    fprintf(saida, "space: .asciiz \" \"\n");
+}
+
+void gerar_codigo_global(const Ast* ast, NoAst decl, FILE* saida) {
+    fprintf(saida, "_%s: .word 0\n", AST_LEXEMA(ast, AST_FILHO(ast, decl, 0)));
+}
+
+void gerar_codigo_texto(FILE* saida) {
+    fprintf(saida, ".text\n");
+    fprintf(saida, ".globl main\n");
+}
+
+int gerar_codigo_principal(const Ast* ast, NoAst raiz, FILE* saida, const char* prefixo, ConvencaoChamada convencao) {
+    GeradorCodigo estado = { saida, prefixo, 0, 0, ast, NO_NENHUM, 0, 0, convencao };
+    return gerar_programa(&estado, raiz);
+}
+
+int gerar_codigo_funcao(const Ast* ast, NoAst funcao, FILE* saida, const char* prefixo, ConvencaoChamada convencao) {
+    GeradorCodigo estado = { saida, prefixo, 0, 0, ast, NO_NENHUM, 0, 0, convencao };
+    return gerar_funcao(&estado, funcao);
+}
+
+static void gerar_declaracoes_globais(GeradorCodigo* ger, NoAst no) {
+    // Lista de Declarações Globais (DeclFuncVar), encadeada por 'prox'
+    for (NoAst decl = no; decl != NO_NENHUM; decl = AST_PROX(ger->ast, decl)) {
+        if (AST_TIPO(ger->ast, decl) == NO_DECL_VAR) {
+            gerar_codigo_global(ger->ast, decl, ger->out);
+        }
+    }
+}
+
+static void gerar_cabecalho(GeradorCodigo* ger, NoAst raiz) {
+    gerar_codigo_dados(ger->out);
 
-    // Gera variáveis globais e funções antes do main
     // O filho[0] de Programa é "DeclFuncVar"
-    if (raiz && raiz->filho[0]) {
-        gerar_declaracoes_globais(raiz->filho[0]);
+    if (AST_FILHO(ger->ast, raiz, 0) != NO_NENHUM) {
+        gerar_declaracoes_globais(ger, AST_FILHO(ger->ast, raiz, 0));
     }
 
-    fprintf(out, ".text\n");
-    fprintf(out, ".globl main\n\n");
+    gerar_codigo_texto(ger->out);
+}
+
+static int gerar_programa(GeradorCodigo* ger, NoAst raiz) {
+    if (AST_FILHO(ger->ast, raiz, 1) == NO_NENHUM) return 0;
+
+    NoAst blocoMain = AST_FILHO(ger->ast, raiz, 1);
+    ger->funcao_atual = NO_NENHUM;
+    ger->num_params = 0;
+    ger->tamanho_quadro = calcular_espaco_local(ger, raiz) + 8;
+
+    fprintf(ger->out, "\nmain:\n");
+    gerar_prologo(ger, ger->tamanho_quadro);
+    int resultado = gerar_comandos(ger, blocoMain);
+    gerar_epilogo(ger, ger->tamanho_quadro);
+    fprintf(ger->out, "  li $v0, 10\n");
+    fprintf(ger->out, "  syscall\n");
+    return resultado;
 }
 
-void gerar_rodape() {
+static void gerar_rodape(GeradorCodigo* ger) {
     // Código auxiliar final
 }
 
-void gerar_no(ASTNode* no) {
-    if (no == NULL) return;
-
-    switch(no->tipo) {
-        case NO_PROGRAMA:
-            // Globais já foram processadas no cabeçalho.
-            if (no->filho[1] != NULL) {
-                ASTNode* blocoMain = no->filho[1]; 
-                
-                int espaco_vars = calcular_espaco_local(blocoMain);
-                int tamanho_frame = (espaco_vars + 8 + 3) & ~3;
-
-                fprintf(out, "\nmain:\n");
-                fprintf(out, "  addiu $sp, $sp, -%d\n", tamanho_frame);
-                fprintf(out, "  sw $ra, %d($sp)\n", tamanho_frame - 4);
-                fprintf(out, "  sw $fp, %d($sp)\n", tamanho_frame - 8);
-                fprintf(out, "  move $fp, $sp\n");
-                
-                g_offset_local = 0; 
-                
-                // Processa o bloco principal, que já lida com suas sub-partes
-                if (blocoMain->tipo == NO_BLOCO) {
-                    gerar_no(blocoMain); 
-                }
+// --- Comandos e expressões ---
+
+/*
+ * A tradução percorre a árvore com pilha explícita (percurso.h). Cada nó
+ * deixa seu valor em $a0; nos operadores binários o operando esquerdo espera
+ * na pilha enquanto o direito é calculado. O que a recursão guardaria em
+ * variáveis locais fica em 'salvo': o primeiro rótulo de 'se' e 'enquanto'
+ * e o número de argumentos empilhados de uma chamada.
+ *
+ * A condição de um 'se' ou 'enquanto' não deixa valor: desvia para um de
+ * dois rótulos. O pai marca o nó da condição em 'proxima' antes de visitá-lo,
+ * e ao entrar ele passa para a pilha de condições. 'e' e 'ou' marcam cada
+ * operando, o esquerdo com o rótulo do meio (onde começa o direito) no lugar
+ * de um dos destinos, então o direito só é avaliado se o esquerdo não
+ * decide; '!' marca o operando com os destinos trocados. Uma comparação
+ * desvia direto (blt, bge...), e os demais nós calculam o valor e desviam
+ * com beqz ou bnez. Só o destino que não vem logo depois recebe desvio, com
+ * a condição oposta se preciso. Fora de condições, 'e' e 'ou' desviam para
+ * 'li $a0, 1' ou 'li $a0, 0'.
+ */
+
+// Desvios de cada comparação e da comparação oposta, com os operandos em $t1 e $a0
+static const char* const g_desvios[] = {
+    [NO_IGUAL] = "beq", [NO_DIF] = "bne", [NO_MAIOR] = "bgt", [NO_MENOR] = "blt",
+    [NO_MAIOR_IGUAL] = "bge", [NO_MENOR_IGUAL] = "ble",
+};
+static const char* const g_desvios_opostos[] = {
+    [NO_IGUAL] = "bne", [NO_DIF] = "beq", [NO_MAIOR] = "ble", [NO_MENOR] = "bge",
+    [NO_MAIOR_IGUAL] = "blt", [NO_MENOR_IGUAL] = "bgt",
+};
+
+// O nó 'no' será traduzido como condição
+static void marcar_condicao(GeradorCodigo* ger, NoAst no, int verdadeiro, int falso, int segue_verdadeiro) {
+    Condicao c = { no, verdadeiro, falso, 0, 0, (uint8_t) segue_verdadeiro, 0 };
+    ger->proxima = c;
+}
 
-                fprintf(out, "  lw $ra, %d($sp)\n", tamanho_frame - 4);
-                fprintf(out, "  lw $fp, %d($sp)\n", tamanho_frame - 8);
-                fprintf(out, "  addiu $sp, $sp, %d\n", tamanho_frame);
-                fprintf(out, "  li $v0, 10\n"); 
-                fprintf(out, "  syscall\n");
-            }
-            break;
+static Condicao* empilhar_condicao(GeradorCodigo* ger, const Condicao* c) {
+    if (ger->num_condicoes == ger->capacidade_condicoes) {
+        uint32_t nova = ger->capacidade_condicoes ? ger->capacidade_condicoes * 2 : 16;
+        Condicao* condicoes = realloc(ger->condicoes, nova * sizeof(Condicao));
+        if (!condicoes) {
+            ger->sem_memoria = 1;
+            return NULL;
+        }
+        ger->condicoes = condicoes;
+        ger->capacidade_condicoes = nova;
+    }
+    Condicao* topo = &ger->condicoes[ger->num_condicoes++];
+    *topo = *c;
+    return topo;
+}
 
+// Condição do nó 'no', se ele está sendo traduzido como uma
+static Condicao* condicao_de(GeradorCodigo* ger, NoAst no) {
+    if (ger->num_condicoes == 0 || ger->condicoes[ger->num_condicoes - 1].no != no) return NULL;
+    return &ger->condicoes[ger->num_condicoes - 1];
+}
+
+static unsigned entrar_no(void* dados, NoAst no, intptr_t* salvo) {
+    GeradorCodigo* ger = (GeradorCodigo*) dados;
+
+    if (ger->proxima.no == no) {
+        ger->proxima.no = NO_NENHUM;
+        Condicao c = ger->proxima;
+        c.no = no;
+        if (empilhar_condicao(ger, &c) == NULL) return PERCURSO_NENHUM;
+    }
+
+    switch (AST_TIPO(ger->ast, no)) {
         case NO_DECL_VAR:
-            gerar_declaracao_var(no);
-            if (no->prox != NULL) gerar_no(no->prox);
-            break;
-        
         case NO_DECL_FUNC:
-            // Já gerado via declarações globais
-            break;
+        case NO_NULO:
+            // Slots já atribuídos pela análise semântica; funções geradas à parte
+            return PERCURSO_NENHUM;
 
         case NO_BLOCO:
-            {
-                int offset_anterior = g_offset_local;
-                gerar_no(no->filho[0]); // Declarações
-                
-                ASTNode* stmt = no->filho[1]; // Comandos
-                while(stmt) {
-                    gerar_no(stmt);
-                    stmt = stmt->prox;
-                }
-                g_offset_local = offset_anterior;
+            return 1u << 1; // Comandos
+
+        case NO_ATRIBUICAO:
+            return 1u << 1; // Valor em $a0, guardado na saída
+
+        case NO_SE:
+            *salvo = novos_labels(ger, 3); // Senão, fim, então
+            marcar_condicao(ger, AST_FILHO(ger->ast, no, 0), (int) *salvo + 2, (int) *salvo, 1);
+            return PERCURSO_TODOS;
+
+        case NO_ENQUANTO:
+            *salvo = novos_labels(ger, 3); // Início, fim, corpo
+            emitir_label(ger, *salvo);
+            marcar_condicao(ger, AST_FILHO(ger->ast, no, 0), (int) *salvo + 2, (int) *salvo + 1, 1);
+            return PERCURSO_TODOS;
+
+        case NO_E:
+        case NO_OU:
+        {
+            Condicao* c = condicao_de(ger, no);
+            if (c == NULL) {
+                // Valor 0 ou 1: verdadeiro, falso e fim
+                int primeiro = novos_labels(ger, 3);
+                Condicao valor = { no, primeiro, primeiro + 1, 0, primeiro + 2, 1, 1 };
+                c = empilhar_condicao(ger, &valor);
+                if (c == NULL) return PERCURSO_NENHUM;
             }
-            break;
+            c->meio = novos_labels(ger, 1);
+            if (AST_TIPO(ger->ast, no) == NO_E) {
+                marcar_condicao(ger, AST_FILHO(ger->ast, no, 0), c->meio, c->falso, 1);
+            } else {
+                marcar_condicao(ger, AST_FILHO(ger->ast, no, 0), c->verdadeiro, c->meio, 0);
+            }
+            return PERCURSO_TODOS;
+        }
+
+        case NO_NEG:
+        {
+            const Condicao* c = condicao_de(ger, no);
+            if (c != NULL) {
+                marcar_condicao(ger, AST_FILHO(ger->ast, no, 0), c->falso, c->verdadeiro, !c->segue_verdadeiro);
+            }
+            return PERCURSO_TODOS;
+        }
+
+        case NO_LEIA:
+            fprintf(ger->out, "  li $v0, 5\n");
+            fprintf(ger->out, "  syscall\n");
+            gerar_armazenamento(ger, AST_FILHO(ger->ast, no, 0), "$v0");
+            return PERCURSO_NENHUM;
+
+        case NO_ESCREVA:
+        {
+            NoAst valor = AST_FILHO(ger->ast, no, 0);
+            if (AST_TIPO(ger->ast, valor) != NO_CADEIA_CAR) return PERCURSO_TODOS;
+
+            int str_label = ger->string_literal_counter++;
+            fprintf(ger->out, ".data\n");
+            fprintf(ger->out, "%sstr%d: .asciiz %.*s\n", ger->prefixo, str_label,
+                    AST_FOLHA(ger->ast, valor).tamanho, AST_LEXEMA(ger->ast, valor));
+            fprintf(ger->out, ".text\n");
+            fprintf(ger->out, "  li $v0, 4\n");
+            fprintf(ger->out, "  la $a0, %sstr%d\n", ger->prefixo, str_label);
+            return PERCURSO_NENHUM;
+        }
+
+        case NO_CHAMADA_FUNC:
+            return 1u << 1; // Argumentos, empilhados da esquerda para a direita
 
-        case NO_ATRIBUICAO: gerar_atribuicao(no); break;
-        case NO_SE: gerar_if(no); break;
-        case NO_ENQUANTO: gerar_while(no); break;
-        case NO_ESCREVA: case NO_LEIA: gerar_io(no); break;
-        case NO_CHAMADA_FUNC: gerar_chamada(no); break;
-        
-        case NO_RETORNE:
-            gerar_expressao(no->filho[0]); 
-            fprintf(out, "  move $v0, $a0\n"); 
-            break;
-            
         case NO_NOVALINHA:
-            fprintf(out, "  li $v0, 4\n");
-            fprintf(out, "  la $a0, newline\n");
-            fprintf(out, "  syscall\n");
-            break;
+            fprintf(ger->out, "  li $v0, 4\n");
+            fprintf(ger->out, "  la $a0, newline\n");
+            fprintf(ger->out, "  syscall\n");
+            return PERCURSO_NENHUM;
 
-        default:
-            gerar_expressao(no);
-            break;
-    }
-}
+        case NO_INT_CONST:
+            // Numa condição, a constante só decide o desvio (ver sair_condicao)
+            if (condicao_de(ger, no) == NULL) fprintf(ger->out, "  li $a0, %d\n", AST_VALOR_INT(ger->ast, no));
+            return PERCURSO_NENHUM;
+        case NO_CAR_CONST:
+            if (condicao_de(ger, no) == NULL) fprintf(ger->out, "  li $a0, %d\n", AST_FOLHA(ger->ast, no).valor);
+            return PERCURSO_NENHUM;
 
-void gerar_declaracao_var(ASTNode* no) {
-    ASTNode* id_node = no->filho[1]; // filho[0]=tipo, filho[1]=id
-    if (!decl_global_atual) { 
-        Symbol* s = obter_simbolo(id_node->valor_lexico);
-        if (s) {
-            s->ordem = g_offset_local; 
-            g_offset_local += 4; 
-        }
+        case NO_ID:
+            gerar_carga(ger, no);
+            return PERCURSO_NENHUM;
+
+        case NO_TEMP:
+            fprintf(ger->out, "  lw $a0, %d($fp)\n", 4 * AST_SLOT(ger->ast, no));
+            return PERCURSO_NENHUM;
+
+        default:
+            return PERCURSO_TODOS;
     }
 }
 
-void gerar_expressao(ASTNode* no) {
-    if (no == NULL) return;
+static void depois_filho(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo) {
+    GeradorCodigo* ger = (GeradorCodigo*) dados;
 
-    switch (no->tipo) {
-        case NO_INT_CONST:
-            fprintf(out, "  li $a0, %d\n", no->valor_int);
+    switch (AST_TIPO(ger->ast, no)) {
+        case NO_SE:
+            if (filho == 0) {
+                emitir_label(ger, *salvo + 2);
+            } else if (filho == 1) {
+                emitir_salto(ger, *salvo + 1);
+                emitir_label(ger, *salvo);
+            }
             break;
 
-        case NO_ID:
-            if (eh_global(g_pilha_escopos_gerador, no->valor_lexico)) {
-                fprintf(out, "  lw $a0, _%s\n", no->valor_lexico);
+        case NO_ENQUANTO:
+            if (filho == 0) {
+                emitir_label(ger, *salvo + 2);
             } else {
-                int offset = obter_offset(no->valor_lexico);
-                fprintf(out, "  lw $a0, %d($fp)\n", offset);
+                emitir_salto(ger, *salvo);
             }
             break;
 
-        case NO_ATRIBUICAO: gerar_atribuicao(no); break;
-        case NO_CHAMADA_FUNC: gerar_chamada(no); break;
+        case NO_E:
+        case NO_OU:
+        {
+            // O esquerdo não decidiu: o direito começa no rótulo do meio
+            const Condicao* c = condicao_de(ger, no);
+            if (filho == 0 && c != NULL) {
+                emitir_label(ger, c->meio);
+                marcar_condicao(ger, AST_FILHO(ger->ast, no, 1), c->verdadeiro, c->falso, c->segue_verdadeiro);
+            }
+            break;
+        }
+
+        case NO_CHAMADA_FUNC:
+            empilhar_a0(ger);
+            (*salvo)++;
+            break;
 
         case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
         case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
-        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL: case NO_E: case NO_OU:
-            gerar_expressao(no->filho[0]);
-            fprintf(out, "  addiu $sp, $sp, -4\n");
-            fprintf(out, "  sw $a0, 0($sp)\n");
-            
-            gerar_expressao(no->filho[1]);
-            
-            fprintf(out, "  lw $t1, 0($sp)\n");
-            fprintf(out, "  addiu $sp, $sp, 4\n");
-            
-            switch (no->tipo) {
-                case NO_SOMA: fprintf(out, "  add $a0, $t1, $a0\n"); break;
-                case NO_SUB:  fprintf(out, "  sub $a0, $t1, $a0\n"); break;
-                case NO_MULT: fprintf(out, "  mul $a0, $t1, $a0\n"); break;
-                case NO_DIV:  
-                    fprintf(out, "  div $zero, $t1, $a0\n"); 
-                    fprintf(out, "  mflo $a0\n"); 
-                    break;
-                case NO_IGUAL: fprintf(out, "  seq $a0, $t1, $a0\n"); break;
-                case NO_DIF:   fprintf(out, "  sne $a0, $t1, $a0\n"); break;
-                case NO_MAIOR: fprintf(out, "  sgt $a0, $t1, $a0\n"); break;
-                case NO_MENOR: fprintf(out, "  slt $a0, $t1, $a0\n"); break;
-                case NO_MAIOR_IGUAL: fprintf(out, "  sge $a0, $t1, $a0\n"); break;
-                case NO_MENOR_IGUAL: fprintf(out, "  sle $a0, $t1, $a0\n"); break;
-                case NO_E: fprintf(out, "  and $a0, $t1, $a0\n"); break;
-                case NO_OU: fprintf(out, "  or $a0, $t1, $a0\n"); break;
-                default: break;
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL:
+            if (filho == 0) {
+                empilhar_a0(ger);
+            } else {
+                fprintf(ger->out, "  lw $t1, 0($sp)\n");
+                fprintf(ger->out, "  addiu $sp, $sp, 4\n");
             }
             break;
-        default: break;
-    }
-}
 
-void gerar_atribuicao(ASTNode* no) {
-    gerar_expressao(no->filho[1]); // Valor em $a0
-    ASTNode* idNode = no->filho[0];
-    if (eh_global(g_pilha_escopos_gerador, idNode->valor_lexico)) {
-        fprintf(out, "  sw $a0, _%s\n", idNode->valor_lexico);
-    } else {
-        int offset = obter_offset(idNode->valor_lexico);
-        fprintf(out, "  sw $a0, %d($fp)\n", offset);
+        default:
+            break;
     }
 }
 
-void gerar_if(ASTNode* no) {
-    char* labelElse = novo_label();
-    char* labelEnd = novo_label();
-    
-    gerar_expressao(no->filho[0]);
-    fprintf(out, "  beqz $a0, %s\n", labelElse);
-    
-    gerar_no(no->filho[1]);
-    fprintf(out, "  la $t9, %s\n", labelEnd);
-    fprintf(out, "  jr $t9\n");
-    
-    fprintf(out, "%s:\n", labelElse);
-    if (no->filho[2] != NULL) {
-        gerar_no(no->filho[2]);
-    }
-    
-    fprintf(out, "%s:\n", labelEnd);
-    free(labelElse); free(labelEnd);
-}
-
-void gerar_while(ASTNode* no) {
-    char* labelIni = novo_label();
-    char* labelFim = novo_label();
-    
-    fprintf(out, "%s:\n", labelIni);
-    gerar_expressao(no->filho[0]);
-    fprintf(out, "  beqz $a0, %s\n", labelFim);
-    gerar_no(no->filho[1]);
-    fprintf(out, "  la $t9, %s\n", labelIni);
-    fprintf(out, "  jr $t9\n");
-    fprintf(out, "%s:\n", labelFim);
-    
-    free(labelIni); free(labelFim);
-}
-
-void gerar_io(ASTNode* no) {
-    if (no->tipo == NO_LEIA) {
-        fprintf(out, "  li $v0, 5\n");
-        fprintf(out, "  syscall\n");
-        ASTNode* idNode = no->filho[0];
-        if (eh_global(g_pilha_escopos_gerador, idNode->valor_lexico)) {
-            fprintf(out, "  sw $v0, _%s\n", idNode->valor_lexico);
-        } else {
-            int offset = obter_offset(idNode->valor_lexico);
-            fprintf(out, "  sw $v0, %d($fp)\n", offset);
+// Saída de um nó que deixa o valor em $a0
+static void sair_valor(GeradorCodigo* ger, NoAst no, intptr_t salvo) {
+    switch (AST_TIPO(ger->ast, no)) {
+        case NO_ATRIBUICAO:
+            gerar_armazenamento(ger, AST_FILHO(ger->ast, no, 0), "$a0");
+            break;
+
+        case NO_SE:
+            emitir_label(ger, salvo + 1);
+            break;
+
+        case NO_ENQUANTO:
+            emitir_label(ger, salvo + 1);
+            break;
+
+        case NO_ESCREVA:
+        {
+            NoAst valor = AST_FILHO(ger->ast, no, 0);
+            if (AST_TIPO(ger->ast, valor) != NO_CADEIA_CAR) {
+                // Caracteres são impressos com o serviço 11, inteiros com o 1
+                fprintf(ger->out, "  li $v0, %d\n", AST_TIPO_DADO(ger->ast, valor) == TIPO_CAR ? 11 : 1);
+            }
+            fprintf(ger->out, "  syscall\n");
         }
-    } 
-    else if (no->tipo == NO_ESCREVA) {
-        if (no->filho[0]->tipo == NO_CADEIA_CAR) { 
-            char* str_label = (char*)malloc(20);
-            sprintf(str_label, "str%d", string_literal_counter++);
-            fprintf(out, ".data\n");
-            fprintf(out, "%s: .asciiz %s\n", str_label, no->filho[0]->valor_lexico);
-            fprintf(out, ".text\n");
-            fprintf(out, "  li $v0, 4\n");
-            fprintf(out, "  la $a0, %s\n", str_label);
-            free(str_label);
-        } else { 
-            gerar_expressao(no->filho[0]);
-            fprintf(out, "  li $v0, 1\n");
+        break;
+
+        case NO_CHAMADA_FUNC:
+        {
+            int desempilhar = (int) salvo * 4;
+            if (ger->convencao == CONVENCAO_REGISTRADORES) {
+                for (int i = 0; i < salvo && i < 4; i++) {
+                    fprintf(ger->out, "  lw $a%d, %d($sp)\n", i, 4 * ((int) salvo - 1 - i));
+                }
+                if (salvo <= 4 && desempilhar > 0) {
+                    fprintf(ger->out, "  addiu $sp, $sp, %d\n", desempilhar);
+                    desempilhar = 0;
+                }
+            }
+            fprintf(ger->out, "  la $t9, %s\n", AST_LEXEMA(ger->ast, AST_FILHO(ger->ast, no, 0)));
+            fprintf(ger->out, "  jalr $t9\n");
+            if (desempilhar > 0) {
+                fprintf(ger->out, "  addiu $sp, $sp, %d\n", desempilhar);
+            }
+            fprintf(ger->out, "  move $a0, $v0\n");
+            break;
         }
-        fprintf(out, "  syscall\n");
+
+        case NO_RETORNE:
+            fprintf(ger->out, "  move $v0, $a0\n");
+            if (ger->funcao_atual != NO_NENHUM) {
+                fprintf(ger->out, "  la $t9, %s_end\n", AST_LEXEMA(ger->ast, AST_FILHO(ger->ast, ger->funcao_atual, 0)));
+                fprintf(ger->out, "  jr $t9\n");
+            }
+            break;
+
+        case NO_NEG:
+            fprintf(ger->out, "  seq $a0, $a0, $zero\n");
+            break;
+
+        case NO_GUARDA:
+            fprintf(ger->out, "  sw $a0, %d($fp)\n", 4 * AST_SLOT(ger->ast, no));
+            break;
+
+        case NO_SOMA: fprintf(ger->out, "  add $a0, $t1, $a0\n"); break;
+        case NO_SUB:  fprintf(ger->out, "  sub $a0, $t1, $a0\n"); break;
+        case NO_MULT: fprintf(ger->out, "  mul $a0, $t1, $a0\n"); break;
+        case NO_DIV:
+            fprintf(ger->out, "  div $t1, $a0\n");
+            fprintf(ger->out, "  mflo $a0\n");
+            break;
+        case NO_IGUAL: fprintf(ger->out, "  seq $a0, $t1, $a0\n"); break;
+        case NO_DIF:   fprintf(ger->out, "  sne $a0, $t1, $a0\n"); break;
+        case NO_MAIOR: fprintf(ger->out, "  sgt $a0, $t1, $a0\n"); break;
+        case NO_MENOR: fprintf(ger->out, "  slt $a0, $t1, $a0\n"); break;
+        case NO_MAIOR_IGUAL: fprintf(ger->out, "  sge $a0, $t1, $a0\n"); break;
+        case NO_MENOR_IGUAL: fprintf(ger->out, "  sle $a0, $t1, $a0\n"); break;
+
+        default:
+            break;
     }
 }
 
-void gerar_funcao(ASTNode* no) {
-    char* nomeFunc = no->filho[0]->valor_lexico;
-    
-    // filho[2] é o Bloco da função
-    int espaco_vars = calcular_espaco_local(no->filho[2]);
-    int tamanho_frame = (espaco_vars + 8 + 3) & ~3;
-
-    fprintf(out, "\n%s:\n", nomeFunc);
-    
-    // Prólogo
-    fprintf(out, "  addiu $sp, $sp, -%d\n", tamanho_frame);
-    fprintf(out, "  sw $ra, %d($sp)\n", tamanho_frame - 4);
-    fprintf(out, "  sw $fp, %d($sp)\n", tamanho_frame - 8);
-    fprintf(out, "  move $fp, $sp\n");
-    
-    // filho[1] é a ListaParametros
-    ASTNode* params = no->filho[1];
-    int param_idx = 0;
-
-    // Empilhamento ArgN..Arg1.
-    
-    int param_offset_base = tamanho_frame;
-
-    while (params != NULL) {
-        // params é um nó NO_DECL_VAR: filho[0]=Tipo, filho[1]=ID, filho[2]=Prox
-        if (params->tipo == NO_DECL_VAR) {
-             ASTNode* idParam = params->filho[1];
-             if (idParam) {
-                 Symbol* s = obter_simbolo(idParam->valor_lexico);
-                 if (s) {
-                     s->ordem = param_offset_base + (param_idx * 4);
-                     param_idx++;
-                 }
-             }
-             params = params->prox;
-        } else {
-             // Caso a lista esteja vazia ou formato inesperado
-             break;
+// Saída de um nó traduzido como condição: desvia para o destino que não vem logo depois
+static void sair_condicao(GeradorCodigo* ger, NoAst no, intptr_t salvo) {
+    Condicao c = ger->condicoes[--ger->num_condicoes];
+    TipoNo tipo = (TipoNo) AST_TIPO(ger->ast, no);
+    int destino = c.segue_verdadeiro ? c.falso : c.verdadeiro;
+
+    switch (tipo) {
+        case NO_E:
+        case NO_OU:
+            // Os operandos já desviaram; fora de condição, falta o valor
+            if (c.valor) {
+                emitir_label(ger, c.verdadeiro);
+                fprintf(ger->out, "  li $a0, 1\n");
+                emitir_salto(ger, c.fim);
+                emitir_label(ger, c.falso);
+                fprintf(ger->out, "  li $a0, 0\n");
+                emitir_label(ger, c.fim);
+            }
+            break;
+
+        case NO_NEG:
+            break; // O operando já desviou, com os destinos trocados
+
+        case NO_INT_CONST:
+        case NO_CAR_CONST:
+        {
+            int32_t k = tipo == NO_INT_CONST ? AST_VALOR_INT(ger->ast, no) : AST_FOLHA(ger->ast, no).valor;
+            if ((k != 0) != c.segue_verdadeiro) emitir_salto(ger, destino);
+            break;
         }
+
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL:
+            fprintf(ger->out, "  %s $t1, $a0, %sL%d\n", c.segue_verdadeiro ? g_desvios_opostos[tipo] : g_desvios[tipo],
+                    ger->prefixo, destino);
+            break;
+
+        default:
+            // Qualquer valor não nulo é verdadeiro
+            sair_valor(ger, no, salvo);
+            fprintf(ger->out, "  %s $a0, %sL%d\n", c.segue_verdadeiro ? "beqz" : "bnez", ger->prefixo, destino);
+            break;
     }
+}
 
-    g_offset_local = 0; 
-    
-    // Gera corpo da função (Bloco)
-    gerar_no(no->filho[2]);
-    
-    // Epílogo
-    fprintf(out, "%s_end:\n", nomeFunc);
-    fprintf(out, "  lw $ra, %d($sp)\n", tamanho_frame - 4);
-    fprintf(out, "  lw $fp, %d($sp)\n", tamanho_frame - 8);
-    fprintf(out, "  addiu $sp, $sp, %d\n", tamanho_frame);
-    fprintf(out, "  jr $ra\n");
-}
-
-void empilhar_argumentos(ASTNode* arg, int* count) {
-    if (arg == NULL) return;
-    
-    // filho[0] = Esquerda (Resto da lista), filho[1] = Direita (Expr atual)
-    
-    if (arg->tipo == NO_LISTA) {
-        // Primeiro empilha o da Direita
-        gerar_expressao(arg->filho[1]);
-        fprintf(out, "  addiu $sp, $sp, -4\n");
-        fprintf(out, "  sw $a0, 0($sp)\n");
-        (*count)++;
-        
-        // Depois processa a Esquerda recursivamente
-        empilhar_argumentos(arg->filho[0], count);
-        
+static void sair_no(void* dados, NoAst no, intptr_t salvo) {
+    GeradorCodigo* ger = (GeradorCodigo*) dados;
+    if (condicao_de(ger, no) != NULL) {
+        sair_condicao(ger, no, salvo);
     } else {
-        // Base case: apenas uma Expr (primeiro argumento da lista original)
-        gerar_expressao(arg);
-        fprintf(out, "  addiu $sp, $sp, -4\n");
-        fprintf(out, "  sw $a0, 0($sp)\n");
-        (*count)++;
+        sair_valor(ger, no, salvo);
     }
 }
 
-void gerar_chamada(ASTNode* no) {
-    char* funcName = no->filho[0]->valor_lexico;
-    ASTNode* arg = no->filho[1]; // ListExpr
-    int count = 0;
-    
-    empilhar_argumentos(arg, &count);
-    
-    fprintf(out, "  la $t9, %s\n", funcName);
-    fprintf(out, "  jalr $t9\n");
-    
-    if (count > 0) {
-        fprintf(out, "  addiu $sp, $sp, %d\n", count * 4);
+// Traduz um comando (e tudo abaixo dele). Retorna 0, ou -1 se faltar memória.
+static int gerar_comandos(GeradorCodigo* ger, NoAst no) {
+    static const VisitanteAst traducao = { entrar_no, depois_filho, sair_no };
+    int resultado = percorrer_ast(ger->ast, no, &traducao, ger);
+    free(ger->condicoes);
+    ger->condicoes = NULL;
+    ger->num_condicoes = ger->capacidade_condicoes = 0;
+    return resultado != 0 || ger->sem_memoria ? -1 : 0;
+}
+
+static int gerar_funcao(GeradorCodigo* ger, NoAst no) {
+    const char* nomeFunc = AST_LEXEMA(ger->ast, AST_FILHO(ger->ast, no, 0));
+
+    ger->funcao_atual = no;
+    ger->num_params = 0;
+    for (NoAst p = AST_FILHO(ger->ast, no, 1); p != NO_NENHUM; p = AST_PROX(ger->ast, p)) {
+        ger->num_params++;
+    }
+    ger->tamanho_quadro = calcular_espaco_local(ger, no) + 8;
+
+    fprintf(ger->out, "\n%s:\n", nomeFunc);
+    gerar_prologo(ger, ger->tamanho_quadro);
+    for (int i = 0; i < params_em_registradores(ger); i++) {
+        fprintf(ger->out, "  sw $a%d, %d($fp)\n", i, deslocamento_recebido(ger, i));
     }
-    
-    fprintf(out, "  move $a0, $v0\n");
-}
\ No newline at end of file
+
+    // Gera corpo da função (Bloco)
+    int resultado = gerar_comandos(ger, AST_FILHO(ger->ast, no, 2));
+
+    // Epílogo
+    fprintf(ger->out, "%s_end:\n", nomeFunc);
+    gerar_epilogo(ger, ger->tamanho_quadro);
+    fprintf(ger->out, "  jr $ra\n");
+
+    ger->funcao_atual = NO_NENHUM;
+    return resultado;
+}
@@ -4,10 +4,43 @@
 #include <stdio.h>
 #include "ast.h"
 
+/*
+ * Convenção de chamada, a mesma nos dois geradores:
+ *   CONVENCAO_PILHA: o chamador empilha todos os argumentos, da esquerda para
+ *     a direita, e os desempilha depois da chamada;
+ *   CONVENCAO_REGISTRADORES: os quatro primeiros argumentos vão em $a0..$a3 e
+ *     o chamado os guarda no próprio quadro (ou nos registradores que o
+ *     alocador lhes deu); os demais ficam onde a convenção da pilha os poria,
+ *     numa área de saída que o gerador da RI reserva uma vez no quadro do
+ *     chamador. O resultado volta em $v0 nas duas.
+ */
+typedef enum {
+    CONVENCAO_PILHA,
+    CONVENCAO_REGISTRADORES
+} ConvencaoChamada;
+
 /*
  * Função principal para gerar o código assembly MIPS.
- * Recebe a raiz da AST e o arquivo onde o código será escrito.
+ * Recebe a raiz da AST, já verificada e anotada (tipos e ligações dos nomes)
+ * pela análise semântica, e o arquivo onde o código será escrito.
+ * Retorna 0, ou -1 se faltar memória (o código escrito fica incompleto).
+ */
+int gerar_codigo(const Ast* ast, NoAst raiz, FILE* saida, ConvencaoChamada convencao);
+
+/*
+ * Geração por partes, na ordem: início do .data (gerar_codigo_dados), cada
+ * NO_DECL_VAR global, início do .text, bloco principal e cada NO_DECL_FUNC;
+ * gerar_codigo_cabecalho faz as três primeiras para o programa inteiro. Os
+ * rótulos do bloco principal e das funções são numerados a partir de zero e
+ * prefixados por 'prefixo' (ex: "fat_"), então o código de uma função não
+ * depende das outras partes e pode ser reaproveitado enquanto ela e as
+ * declarações globais que usa não mudarem (ver servidor.h).
  */
-void gerar_codigo(ASTNode* raiz, FILE* saida, ScopeStack* pilha);
+void gerar_codigo_cabecalho(const Ast* ast, NoAst raiz, FILE* saida);
+void gerar_codigo_dados(FILE* saida);
+void gerar_codigo_global(const Ast* ast, NoAst decl, FILE* saida);
+void gerar_codigo_texto(FILE* saida);
+int gerar_codigo_principal(const Ast* ast, NoAst raiz, FILE* saida, const char* prefixo, ConvencaoChamada convencao);
+int gerar_codigo_funcao(const Ast* ast, NoAst funcao, FILE* saida, const char* prefixo, ConvencaoChamada convencao);
 
 #endif
\ No newline at end of file
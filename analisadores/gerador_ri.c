@@ -0,0 +1,657 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gerador_ri.h"
+#include "gerador_codigo.h"
+#include "alocador.h"
+#include "aritmetica.h"
+
+/*
+ * Temporários, locais e parâmetros ficam nos registradores que o alocador
+ * (alocador.h) lhes deu; os demais têm um lugar no quadro. Com L locais, S
+ * slots de derramamento, T registradores $t salvos em alguma chamada, R
+ * registradores $s preservados, A parâmetros recebidos em registradores e
+ * uma área de saída de O palavras, F = 4 * (O + L + S + T + R + A) + 8:
+ *
+ *   $fp + F + 4*(n-1-i)  parâmetro i (empilhado pelo chamador)
+ *   $fp + F - 4          $ra salvo
+ *   $fp + F - 8          $fp do chamador
+ *   $fp + 4*(O+L+S+T+R+i) parâmetro i < A, recebido em $ai
+ *   $fp + 4*(O+L+S+T+j)  j-ésimo $s preservado
+ *   $fp + 4*(O+L+S+j)    j-ésimo $t salvo nas chamadas
+ *   $fp + 4*(O+L+s)      slot de derramamento s
+ *   $fp + 4*(O+k)        local k
+ *   $fp + 4*(m-1-i)      argumento i >= 4 de uma chamada com m argumentos
+ *
+ * Na convenção da pilha A = O = 0 e os argumentos são empilhados a cada
+ * chamada. Na dos registradores A = min(n, 4), e O é o maior excesso sobre
+ * quatro argumentos entre as chamadas da função: $sp não se move no corpo,
+ * então a área de saída fica exatamente onde o chamado procura os seus
+ * parâmetros na pilha.
+ *
+ * Operandos na memória são carregados em $t8 (o primeiro) e $t9 (o segundo,
+ * ou uma constante); um destino na memória é calculado em $t8 e guardado.
+ * Produtos e quocientes por constantes (aritmetica.h) usam $t9 para os
+ * valores intermediários.
+ * O main não preserva os $s: ele termina o programa sem voltar.
+ */
+
+typedef struct {
+    FILE* out;
+    const ProgramaRI* prog;
+    const FuncaoRI* f;
+    int tamanho_quadro;
+    uint32_t base_rotulos;      // Rótulo do bloco b: L(base + b)
+    uint32_t* ordem;            // Blocos alcançáveis, na ordem em que são escritos
+    uint32_t num_ordem;
+    uint8_t* rotulado;          // Bloco é destino de algum desvio
+    AlocacaoRI aloc;
+    uint8_t preservados;        // $s salvos no prólogo
+    uint32_t chamada;           // Chamadas já escritas na função
+    ConvencaoChamada convencao;
+    int area_saida;             // Bytes da área de saída, no fundo do quadro
+    uint8_t* cadeia_escrita;    // Os dados da cadeia k já estão no texto
+} GeradorRI;
+
+static const char* const g_registradores[32] = {
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+    "$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+    "$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+    "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+};
+
+static const char* nome_funcao(const GeradorRI* g) {
+    return g->f == &g->prog->principal ? "main" : g->f->nome;
+}
+
+// Registrador do MIPS de 'r', ou NULL se 'r' mora no quadro
+static const char* registrador(const GeradorRI* g, RegRI r) {
+    int8_t reg = g->aloc.registrador[r];
+    return reg >= 0 ? g_registradores[reg] : NULL;
+}
+
+// Parâmetros que chegam em $a0..$a3
+static uint32_t recebidos(const GeradorRI* g) {
+    if (g->convencao != CONVENCAO_REGISTRADORES) return 0;
+    return g->f->num_params < 4 ? g->f->num_params : 4;
+}
+
+static int deslocamento(const GeradorRI* g, RegRI r) {
+    const FuncaoRI* f = g->f;
+    if (RI_EH_TEMPORARIO(f, r)) return g->area_saida + 4 * (int) (f->num_locais + g->aloc.slot[r]);
+    if (r >= f->num_locais) {
+        uint32_t i = r - f->num_locais;
+        if (i < recebidos(g)) return g->tamanho_quadro - 8 - 4 * (int) (recebidos(g) - i);
+        return g->tamanho_quadro + 4 * (int) (f->num_params - 1 - i);
+    }
+    return g->area_saida + 4 * (int) r;
+}
+
+// Lugar de 'reg' na área de salvamento: os salvos da mesma classe abaixo dele vêm antes
+static int deslocamento_salvo(const GeradorRI* g, int reg) {
+    uint32_t base = g->f->num_locais + g->aloc.num_slots, antes;
+    if (reg >= ALOCADOR_PRIMEIRO_S) {
+        base += (uint32_t) __builtin_popcount(g->aloc.salvos);
+        antes = (uint32_t) __builtin_popcount(g->preservados & ((1u << (reg - ALOCADOR_PRIMEIRO_S)) - 1));
+    } else {
+        antes = (uint32_t) __builtin_popcount(g->aloc.salvos & ((1u << (reg - ALOCADOR_PRIMEIRO_T)) - 1));
+    }
+    return g->area_saida + 4 * (int) (base + antes);
+}
+
+// Valor de 'r' num registrador: o dele, ou 'rascunho' carregado do quadro
+static const char* ler(GeradorRI* g, RegRI r, const char* rascunho) {
+    const char* reg = registrador(g, r);
+    if (reg != NULL) return reg;
+    fprintf(g->out, "  lw %s, %d($fp)\n", rascunho, deslocamento(g, r));
+    return rascunho;
+}
+
+// Último operando da instrução ('r' ou a constante) num registrador
+static const char* operando(GeradorRI* g, const InstrRI* in, RegRI r, const char* rascunho) {
+    if (!in->imediato) return ler(g, r, rascunho);
+    if (in->k == 0) return "$zero";
+    fprintf(g->out, "  li %s, %d\n", rascunho, in->k);
+    return rascunho;
+}
+
+// Onde calcular o destino 'd'; 'escrever' o leva ao quadro se preciso
+static const char* destino(const GeradorRI* g, RegRI d) {
+    const char* reg = registrador(g, d);
+    return reg != NULL ? reg : "$t8";
+}
+
+static void escrever(GeradorRI* g, RegRI d, const char* valor) {
+    if (registrador(g, d) != NULL) {
+        if (valor != registrador(g, d)) fprintf(g->out, "  move %s, %s\n", registrador(g, d), valor);
+        return;
+    }
+    fprintf(g->out, "  sw %s, %d($fp)\n", valor, deslocamento(g, d));
+}
+
+// Copia 'r' para o registrador 'alvo', venha de outro registrador ou do quadro
+static void mover(GeradorRI* g, RegRI r, const char* alvo) {
+    if (registrador(g, r) != NULL) {
+        fprintf(g->out, "  move %s, %s\n", alvo, registrador(g, r));
+    } else {
+        ler(g, r, alvo);
+    }
+}
+
+static int cabe_16_bits(int32_t k) {
+    return k >= -32768 && k <= 32767;
+}
+
+static void salto(GeradorRI* g, uint32_t bloco) {
+    fprintf(g->out, "  la $t9, L%u\n", g->base_rotulos + bloco);
+    fprintf(g->out, "  jr $t9\n");
+}
+
+// --- Disposição dos blocos ---
+
+/*
+ * Cadeias gulosas: a partir do primeiro bloco ainda não escrito, na
+ * pós-ordem reversa (a entrada, de início), segue o destino do salto ou o
+ * ramo verdadeiro do desvio, se ainda estiver livre, senão o falso. Um
+ * 'enquanto' fica teste, corpo e saída; um 'se', então logo após a
+ * condição; os testes de uma cadeia de 'e' e 'ou', na ordem em que rodam.
+ */
+static int dispor_blocos(GeradorRI* g) {
+    const FuncaoRI* f = g->f;
+    uint32_t n = f->num_blocos;
+    g->ordem = malloc((n > 0 ? n : 1) * sizeof(uint32_t));
+    g->rotulado = calloc(n > 0 ? n : 1, sizeof(uint8_t));
+    uint8_t* colocado = calloc(n > 0 ? n : 1, sizeof(uint8_t));
+    if (!g->ordem || !g->rotulado || !colocado) {
+        free(colocado);
+        return -1;
+    }
+    g->num_ordem = 0;
+    for (uint32_t inicio = 0; inicio < f->num_rpo; inicio++) {
+        uint32_t b = f->rpo[inicio];
+        while (b != RI_NENHUM && !colocado[b] && f->ordem_rpo[b] != RI_NENHUM) {
+            colocado[b] = 1;
+            g->ordem[g->num_ordem++] = b;
+            const BlocoRI* bloco = &f->blocos[b];
+            b = RI_NENHUM;
+            for (int s = 0; s < bloco->num_sucessores && b == RI_NENHUM; s++) {
+                if (!colocado[bloco->sucessor[s]]) b = bloco->sucessor[s];
+            }
+        }
+    }
+    free(colocado);
+
+    // Rótulos só onde o bloco anterior não cai direto no bloco
+    for (uint32_t i = 0; i < g->num_ordem; i++) {
+        const BlocoRI* bloco = &f->blocos[g->ordem[i]];
+        uint32_t seguinte = i + 1 < g->num_ordem ? g->ordem[i + 1] : RI_NENHUM;
+        for (int s = 0; s < bloco->num_sucessores; s++) {
+            if (bloco->sucessor[s] != seguinte || bloco->num_sucessores == 2) g->rotulado[bloco->sucessor[s]] = 1;
+        }
+    }
+    return 0;
+}
+
+// --- Instruções ---
+
+static const char* const g_comparacoes[] = {
+    [RI_IGUAL] = "seq", [RI_DIF] = "sne", [RI_MAIOR] = "sgt", [RI_MENOR] = "slt",
+    [RI_MAIOR_IGUAL] = "sge", [RI_MENOR_IGUAL] = "sle",
+};
+
+// Desvios condicionais, e a condição oposta de cada um
+static const char* const g_desvios[] = {
+    [RI_IGUAL] = "beq", [RI_DIF] = "bne", [RI_MAIOR] = "bgt", [RI_MENOR] = "blt",
+    [RI_MAIOR_IGUAL] = "bge", [RI_MENOR_IGUAL] = "ble",
+};
+static const uint8_t g_oposta[] = {
+    [RI_IGUAL] = RI_DIF, [RI_DIF] = RI_IGUAL, [RI_MAIOR] = RI_MENOR_IGUAL, [RI_MENOR] = RI_MAIOR_IGUAL,
+    [RI_MAIOR_IGUAL] = RI_MENOR, [RI_MENOR_IGUAL] = RI_MAIOR,
+};
+
+// x * k com deslocamentos; o destino pode ser o registrador de x, lido antes
+static void gerar_multiplicacao_constante(GeradorRI* g, const InstrRI* in, const MultiplicacaoConstante* m) {
+    FILE* out = g->out;
+    const char* a = ler(g, in->a, "$t8");
+    const char* rd = destino(g, in->d);
+    const char* valor = a;
+    if (m->termos == 1) {
+        if (m->maior > 0) {
+            fprintf(out, "  sll %s, %s, %u\n", rd, a, m->maior);
+            valor = rd;
+        }
+    } else {
+        fprintf(out, "  sll $t9, %s, %u\n", a, m->maior);
+        if (m->menor > 0) {
+            fprintf(out, "  sll %s, %s, %u\n", rd, a, m->menor);
+            valor = rd;
+        }
+        fprintf(out, "  %s %s, $t9, %s\n", m->subtrai ? "subu" : "addu", rd, valor);
+        valor = rd;
+    }
+    if (m->negativo) {
+        fprintf(out, "  subu %s, $zero, %s\n", rd, valor);
+        valor = rd;
+    }
+    escrever(g, in->d, valor);
+}
+
+// x / d sem 'div' (ver DivisaoConstante); x é lido pela última vez antes de escrever o destino
+static void gerar_divisao_constante(GeradorRI* g, const InstrRI* in, const DivisaoConstante* q) {
+    FILE* out = g->out;
+    const char* a = ler(g, in->a, "$t8");
+    const char* rd = destino(g, in->d);
+    const char* valor = a;
+    if (q->potencia && q->deslocamento > 0) {
+        if (q->deslocamento > 1) {
+            fprintf(out, "  sra $t9, %s, 31\n", a);
+            fprintf(out, "  srl $t9, $t9, %u\n", 32u - q->deslocamento);
+        } else {
+            fprintf(out, "  srl $t9, %s, 31\n", a);
+        }
+        fprintf(out, "  addu $t9, %s, $t9\n", a);
+        fprintf(out, "  sra %s, $t9, %u\n", rd, q->deslocamento);
+        valor = rd;
+    } else if (!q->potencia) {
+        fprintf(out, "  li $t9, %d\n", q->magico);
+        fprintf(out, "  mult %s, $t9\n", a);
+        fprintf(out, "  mfhi $t9\n");
+        if (q->correcao != 0) fprintf(out, "  %s $t9, $t9, %s\n", q->correcao > 0 ? "addu" : "subu", a);
+        if (q->deslocamento > 0) fprintf(out, "  sra $t9, $t9, %u\n", q->deslocamento);
+        fprintf(out, "  srl %s, $t9, 31\n", rd);
+        fprintf(out, "  addu %s, $t9, %s\n", rd, rd);
+        valor = rd;
+    }
+    if (q->negativo) {
+        fprintf(out, "  subu %s, $zero, %s\n", rd, valor);
+        valor = rd;
+    }
+    escrever(g, in->d, valor);
+}
+
+static void gerar_instr(GeradorRI* g, const InstrRI* in) {
+    FILE* out = g->out;
+    switch ((OpRI) in->op) {
+        case RI_COPIA:
+        {
+            const char* rd = registrador(g, in->d);
+            if (rd != NULL && in->imediato) {
+                fprintf(out, "  li %s, %d\n", rd, in->k);
+            } else if (rd != NULL && registrador(g, in->a) == NULL) {
+                fprintf(out, "  lw %s, %d($fp)\n", rd, deslocamento(g, in->a));
+            } else {
+                escrever(g, in->d, operando(g, in, in->a, "$t8"));
+            }
+            break;
+        }
+
+        case RI_SOMA:
+        case RI_SUB:
+        {
+            const char* a = ler(g, in->a, "$t8");
+            const char* rd = destino(g, in->d);
+            // x - k vira x + (-k), que transborda nos mesmos casos
+            int negavel = in->op == RI_SOMA || in->k != INT32_MIN;
+            int32_t k = !negavel || in->op == RI_SOMA ? in->k : -in->k;
+            // A soma circular usa as formas sem exceção
+            const char* u = in->circular ? "u" : "";
+            if (in->imediato && negavel && cabe_16_bits(k)) {
+                fprintf(out, "  addi%s %s, %s, %d\n", u, rd, a, k);
+            } else {
+                const char* b = operando(g, in, in->b, "$t9");
+                fprintf(out, "  %s%s %s, %s, %s\n", in->op == RI_SOMA ? "add" : "sub", u, rd, a, b);
+            }
+            escrever(g, in->d, rd);
+            break;
+        }
+        case RI_MULT:
+        case RI_IGUAL: case RI_DIF: case RI_MAIOR: case RI_MENOR:
+        case RI_MAIOR_IGUAL: case RI_MENOR_IGUAL:
+        {
+            MultiplicacaoConstante m;
+            if (in->op == RI_MULT && in->imediato && multiplicacao_constante(in->k, &m) == 0) {
+                gerar_multiplicacao_constante(g, in, &m);
+                break;
+            }
+            const char* a = ler(g, in->a, "$t8");
+            const char* b = operando(g, in, in->b, "$t9");
+            const char* rd = destino(g, in->d);
+            const char* mnemonico = in->op == RI_MULT ? "mul" : g_comparacoes[in->op];
+            fprintf(out, "  %s %s, %s, %s\n", mnemonico, rd, a, b);
+            escrever(g, in->d, rd);
+            break;
+        }
+        case RI_DIV:
+        {
+            DivisaoConstante q;
+            if (in->imediato && divisao_constante(in->k, &q) == 0) {
+                gerar_divisao_constante(g, in, &q);
+                break;
+            }
+            const char* a = ler(g, in->a, "$t8");
+            fprintf(out, "  div %s, %s\n", a, operando(g, in, in->b, "$t9"));
+            const char* rd = destino(g, in->d);
+            fprintf(out, "  mflo %s\n", rd);
+            escrever(g, in->d, rd);
+            break;
+        }
+        // Operadores lógicos: qualquer valor não nulo é verdadeiro
+        case RI_E:
+        {
+            const char* a = ler(g, in->a, "$t8");
+            const char* b = operando(g, in, in->b, "$t9");
+            const char* rd = destino(g, in->d);
+            // O destino pode ser o registrador de b: b é normalizado antes
+            fprintf(out, "  sne $t9, %s, $zero\n", b);
+            fprintf(out, "  sne %s, %s, $zero\n", rd, a);
+            fprintf(out, "  and %s, %s, $t9\n", rd, rd);
+            escrever(g, in->d, rd);
+            break;
+        }
+        case RI_OU:
+        {
+            const char* a = ler(g, in->a, "$t8");
+            const char* b = operando(g, in, in->b, "$t9");
+            const char* rd = destino(g, in->d);
+            fprintf(out, "  or %s, %s, %s\n", rd, a, b);
+            fprintf(out, "  sne %s, %s, $zero\n", rd, rd);
+            escrever(g, in->d, rd);
+            break;
+        }
+        case RI_NAO:
+        {
+            const char* a = ler(g, in->a, "$t8");
+            const char* rd = destino(g, in->d);
+            fprintf(out, "  seq %s, %s, $zero\n", rd, a);
+            escrever(g, in->d, rd);
+            break;
+        }
+
+        case RI_CARREGA:
+        {
+            const char* rd = destino(g, in->d);
+            fprintf(out, "  lw %s, _%s\n", rd, g->prog->globais[in->k]);
+            escrever(g, in->d, rd);
+            break;
+        }
+        case RI_GUARDA:
+            fprintf(out, "  sw %s, _%s\n", ler(g, in->a, "$t8"), g->prog->globais[in->k]);
+            break;
+        case RI_ENDERECO:
+        {
+            const char* rd = destino(g, in->d);
+            fprintf(out, "  la %s, %s\n", rd, g->prog->funcoes[in->k].nome);
+            escrever(g, in->d, rd);
+            break;
+        }
+
+        case RI_LEIA:
+            fprintf(out, "  li $v0, 5\n");
+            fprintf(out, "  syscall\n");
+            escrever(g, in->d, "$v0");
+            break;
+        case RI_ESCREVA:
+        case RI_ESCREVA_CAR:
+            if (in->imediato) {
+                fprintf(out, "  li $a0, %d\n", in->k);
+            } else {
+                mover(g, in->a, "$a0");
+            }
+            // Caracteres são impressos com o serviço 11, inteiros com o 1
+            fprintf(out, "  li $v0, %d\n", in->op == RI_ESCREVA_CAR ? 11 : 1);
+            fprintf(out, "  syscall\n");
+            break;
+        case RI_ESCREVA_CADEIA:
+        {
+            // Uma cadeia copiada pela integração de funções tem o rótulo escrito uma vez só
+            if (!g->cadeia_escrita[in->k]) {
+                const CadeiaRI* cadeia = &g->prog->cadeias[in->k];
+                fprintf(out, ".data\n");
+                fprintf(out, "str%d: .asciiz %.*s\n", in->k, cadeia->tamanho, cadeia->texto);
+                fprintf(out, ".text\n");
+                g->cadeia_escrita[in->k] = 1;
+            }
+            fprintf(out, "  li $v0, 4\n");
+            fprintf(out, "  la $a0, str%d\n", in->k);
+            fprintf(out, "  syscall\n");
+            break;
+        }
+        case RI_NOVALINHA:
+            fprintf(out, "  li $v0, 4\n");
+            fprintf(out, "  la $a0, newline\n");
+            fprintf(out, "  syscall\n");
+            break;
+
+        case RI_CHAMADA:
+        {
+            // Os $t vivos dos dois lados da chamada vão para o quadro e voltam
+            uint8_t salvar = g->aloc.salvar[g->chamada++];
+            for (int r = 0; r < ALOCADOR_NUM_T; r++) {
+                if (salvar & (1u << r)) {
+                    fprintf(out, "  sw %s, %d($fp)\n", g_registradores[ALOCADOR_PRIMEIRO_T + r],
+                            deslocamento_salvo(g, ALOCADOR_PRIMEIRO_T + r));
+                }
+            }
+            const RegRI* args = RI_ARGUMENTOS(g->f, in);
+            uint32_t empilhados = 0;
+            if (g->convencao == CONVENCAO_REGISTRADORES) {
+                // Quatro em $a0..$a3; os demais na área de saída, que já está no lugar
+                for (uint32_t i = 0; i < in->b; i++) {
+                    if (i < 4) {
+                        mover(g, args[i], g_registradores[4 + i]);
+                    } else {
+                        fprintf(out, "  sw %s, %u($sp)\n", ler(g, args[i], "$t8"), 4 * (in->b - 1 - i));
+                    }
+                }
+            } else {
+                // Argumentos empilhados da esquerda para a direita, numa descida só
+                empilhados = in->b;
+                if (empilhados > 0) fprintf(out, "  addiu $sp, $sp, -%u\n", 4 * empilhados);
+                for (uint32_t i = 0; i < in->b; i++) {
+                    fprintf(out, "  sw %s, %u($sp)\n", ler(g, args[i], "$t8"), 4 * (in->b - 1 - i));
+                }
+            }
+            fprintf(out, "  la $t9, %s\n", g->prog->funcoes[in->k].nome);
+            fprintf(out, "  jalr $t9\n");
+            if (empilhados > 0) fprintf(out, "  addiu $sp, $sp, %u\n", 4 * empilhados);
+            for (int r = 0; r < ALOCADOR_NUM_T; r++) {
+                if (salvar & (1u << r)) {
+                    fprintf(out, "  lw %s, %d($fp)\n", g_registradores[ALOCADOR_PRIMEIRO_T + r],
+                            deslocamento_salvo(g, ALOCADOR_PRIMEIRO_T + r));
+                }
+            }
+            escrever(g, in->d, "$v0");
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// Terminador do bloco na posição 'i' da ordem
+static void gerar_terminador(GeradorRI* g, uint32_t i) {
+    uint32_t b = g->ordem[i];
+    const BlocoRI* bloco = &g->f->blocos[b];
+    const InstrRI* in = RI_TERMINADOR(g->f, b);
+    uint32_t seguinte = i + 1 < g->num_ordem ? g->ordem[i + 1] : RI_NENHUM;
+
+    switch ((OpRI) in->op) {
+        case RI_SALTO:
+            if (bloco->sucessor[0] != seguinte) salto(g, bloco->sucessor[0]);
+            break;
+
+        case RI_DESVIO:
+        {
+            const char* a = ler(g, in->a, "$t8");
+            const char* b = operando(g, in, in->b, "$t9");
+            uint32_t verdadeiro = bloco->sucessor[0], falso = bloco->sucessor[1];
+            uint8_t cond = in->cond;
+            if (verdadeiro == seguinte) {
+                // Desvia para o falso com a condição oposta
+                cond = g_oposta[cond];
+                verdadeiro = falso;
+                falso = seguinte;
+            }
+            fprintf(g->out, "  %s %s, %s, L%u\n", g_desvios[cond], a, b, g->base_rotulos + verdadeiro);
+            if (falso != seguinte) salto(g, falso);
+            break;
+        }
+
+        case RI_RETORNE:
+            if (in->imediato) {
+                fprintf(g->out, "  li $v0, %d\n", in->k);
+            } else if (in->a != RI_NENHUM && registrador(g, in->a) != NULL) {
+                fprintf(g->out, "  move $v0, %s\n", registrador(g, in->a));
+            } else if (in->a != RI_NENHUM) {
+                ler(g, in->a, "$v0");
+            }
+            if (seguinte != RI_NENHUM) {
+                fprintf(g->out, "  la $t9, %s_end\n", nome_funcao(g));
+                fprintf(g->out, "  jr $t9\n");
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Epílogo: recupera os $s preservados, $ra e $fp, e libera o quadro
+static void desfazer_quadro(GeradorRI* g) {
+    for (int r = 0; r < ALOCADOR_NUM_S; r++) {
+        if (g->preservados & (1u << r)) {
+            fprintf(g->out, "  lw %s, %d($sp)\n", g_registradores[ALOCADOR_PRIMEIRO_S + r],
+                    deslocamento_salvo(g, ALOCADOR_PRIMEIRO_S + r));
+        }
+    }
+    fprintf(g->out, "  lw $ra, %d($sp)\n", g->tamanho_quadro - 4);
+    fprintf(g->out, "  lw $fp, %d($sp)\n", g->tamanho_quadro - 8);
+    fprintf(g->out, "  addiu $sp, $sp, %d\n", g->tamanho_quadro);
+}
+
+/*
+ * O bloco 'b' termina em 'c = CHAMADA h(args); RETORNE c'? Fora do main, e
+ * se nenhum argumento precisa da pilha (todos vão em $a0..$a3), a chamada
+ * pode reaproveitar o lugar do quadro: h recebe o $ra desta função e volta
+ * direto para quem a chamou. A recursão final na própria função já virou
+ * laço na RI (eliminar_recursao_final).
+ */
+static int chamada_final(const GeradorRI* g, uint32_t b) {
+    const BlocoRI* bloco = &g->f->blocos[b];
+    if (g->f == &g->prog->principal || bloco->num_instrs < 2) return 0;
+    const InstrRI* ret = RI_TERMINADOR(g->f, b);
+    const InstrRI* in = RI_INSTR(g->f, b, bloco->num_instrs - 2);
+    if (ret->op != RI_RETORNE || ret->imediato || in->op != RI_CHAMADA || ret->a != in->d) return 0;
+    return in->b == 0 || (g->convencao == CONVENCAO_REGISTRADORES && in->b <= 4);
+}
+
+// Argumentos em $a0..$a3, o quadro desfeito e um salto no lugar de 'jalr'
+static void gerar_chamada_final(GeradorRI* g, const InstrRI* in) {
+    g->chamada++;   // Nada vive depois dela: não há $t a salvar
+    const RegRI* args = RI_ARGUMENTOS(g->f, in);
+    for (uint32_t i = 0; i < in->b; i++) mover(g, args[i], g_registradores[4 + i]);
+    desfazer_quadro(g);
+    fprintf(g->out, "  la $t9, %s\n", g->prog->funcoes[in->k].nome);
+    fprintf(g->out, "  jr $t9\n");
+}
+
+// Palavras da área de saída: o maior excesso sobre quatro argumentos numa chamada
+static uint32_t area_saida(const GeradorRI* g) {
+    if (g->convencao != CONVENCAO_REGISTRADORES) return 0;
+    uint32_t maior = 0;
+    for (uint32_t k = 0; k < g->num_ordem; k++) {
+        const BlocoRI* bloco = &g->f->blocos[g->ordem[k]];
+        for (uint32_t j = 0; j < bloco->num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(g->f, g->ordem[k], j);
+            if (in->op == RI_CHAMADA && in->b > 4 && in->b - 4 > maior) maior = in->b - 4;
+        }
+    }
+    return maior;
+}
+
+static int gerar_funcao(GeradorRI* g, const FuncaoRI* f) {
+    g->f = f;
+    g->chamada = 0;
+    int eh_main = f == &g->prog->principal;
+    if (dispor_blocos(g) != 0 || alocar_registradores(f, g->ordem, g->num_ordem, !eh_main, &g->aloc) != 0) {
+        free(g->ordem);
+        free(g->rotulado);
+        return -1;
+    }
+    g->preservados = eh_main ? 0 : g->aloc.preservados;
+    uint32_t salvos = (uint32_t) (__builtin_popcount(g->aloc.salvos) + __builtin_popcount(g->preservados));
+    g->area_saida = 4 * (int) area_saida(g);
+    g->tamanho_quadro = g->area_saida + 4 * (int) (f->num_locais + g->aloc.num_slots + salvos + recebidos(g)) + 8;
+
+    fprintf(g->out, "\n%s:\n", nome_funcao(g));
+    fprintf(g->out, "  addiu $sp, $sp, -%d\n", g->tamanho_quadro);
+    fprintf(g->out, "  sw $ra, %d($sp)\n", g->tamanho_quadro - 4);
+    fprintf(g->out, "  sw $fp, %d($sp)\n", g->tamanho_quadro - 8);
+    fprintf(g->out, "  move $fp, $sp\n");
+    for (int r = 0; r < ALOCADOR_NUM_S; r++) {
+        if (g->preservados & (1u << r)) {
+            fprintf(g->out, "  sw %s, %d($fp)\n", g_registradores[ALOCADOR_PRIMEIRO_S + r],
+                    deslocamento_salvo(g, ALOCADOR_PRIMEIRO_S + r));
+        }
+    }
+    // Parâmetros vivos na entrada vão para o registrador; os recebidos em
+    // $ai sem registrador, para o seu lugar no quadro
+    for (RegRI r = f->num_locais; r < f->num_locais + f->num_params; r++) {
+        if (!ri_vivo_entrada(f, 0, r)) continue;
+        uint32_t i = r - f->num_locais;
+        if (i < recebidos(g)) {
+            escrever(g, r, g_registradores[4 + i]);
+        } else if (registrador(g, r) != NULL) {
+            fprintf(g->out, "  lw %s, %d($fp)\n", registrador(g, r), deslocamento(g, r));
+        }
+    }
+
+    for (uint32_t i = 0; i < g->num_ordem; i++) {
+        uint32_t b = g->ordem[i];
+        if (g->rotulado[b]) fprintf(g->out, "L%u:\n", g->base_rotulos + b);
+        const BlocoRI* bloco = &f->blocos[b];
+        if (chamada_final(g, b)) {
+            for (uint32_t j = 0; j + 2 < bloco->num_instrs; j++) gerar_instr(g, RI_INSTR(f, b, j));
+            gerar_chamada_final(g, RI_INSTR(f, b, bloco->num_instrs - 2));
+            continue;
+        }
+        for (uint32_t j = 0; j + 1 < bloco->num_instrs; j++) gerar_instr(g, RI_INSTR(f, b, j));
+        gerar_terminador(g, i);
+    }
+
+    fprintf(g->out, "%s_end:\n", nome_funcao(g));
+    desfazer_quadro(g);
+    if (eh_main) {
+        fprintf(g->out, "  li $v0, 10\n");
+        fprintf(g->out, "  syscall\n");
+    } else {
+        fprintf(g->out, "  jr $ra\n");
+    }
+
+    g->base_rotulos += f->num_blocos;
+    free(g->ordem);
+    free(g->rotulado);
+    liberar_alocacao(&g->aloc);
+    g->ordem = NULL;
+    g->rotulado = NULL;
+    return 0;
+}
+
+int gerar_codigo_ri(const ProgramaRI* prog, FILE* saida, ConvencaoChamada convencao) {
+    if (!saida) return -1;
+
+    GeradorRI estado = { 0 };
+    estado.out = saida;
+    estado.prog = prog;
+    estado.convencao = convencao;
+    estado.cadeia_escrita = calloc(prog->num_cadeias + 1, 1);
+    if (estado.cadeia_escrita == NULL) return -1;
+    gerar_codigo_cabecalho(prog->ast, prog->principal.no, saida);
+    // Funções depois do main, como no gerador da AST
+    int resultado = gerar_funcao(&estado, &prog->principal);
+    for (uint32_t i = 0; i < prog->num_funcoes && resultado == 0; i++) {
+        resultado = gerar_funcao(&estado, &prog->funcoes[i]);
+    }
+    free(estado.cadeia_escrita);
+    return resultado;
+}
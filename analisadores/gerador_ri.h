@@ -0,0 +1,17 @@
+#ifndef GERADOR_RI_H
+#define GERADOR_RI_H
+
+#include <stdio.h>
+#include "ri.h"
+#include "gerador_codigo.h"
+
+/*
+ * Gera o assembly MIPS a partir da RI (ri.h), com o mesmo cabeçalho e as
+ * mesmas convenções de chamada do gerador da AST (gerador_codigo.h).
+ * Os blocos são dispostos em cadeias que seguem os desvios, para que o
+ * sucessor preferido fique logo abaixo e dispense o salto.
+ * Retorna 0, ou -1 se faltar memória (o código escrito fica incompleto).
+ */
+int gerar_codigo_ri(const ProgramaRI* prog, FILE* saida, ConvencaoChamada convencao);
+
+#endif
@@ -6,29 +6,44 @@
 #include <string.h>
 #include "tabela_simbolos.h"
 #include "ast.h"
-#include "semantico.h"
-#include "gerador_codigo.h"
-
-extern int yylex();
-extern int yylineno;
-extern char* yytext;
-extern FILE *yyin;
+#include "regiao.h"
+#include "varredor.h"
+#include "tokens.h"
+#include "servidor.h"
+#include "cache.h"
+
+/* A pilha do parser fica no heap e cresce sob demanda: aninhamentos profundos
+ * (cadeias de 'senao se', parênteses) não esbarram no limite padrão de 10000 */
+#define YYMAXDEPTH 10000000
+%}
 
-void yyerror(const char *s);
+%code requires {
+#include "tabela_simbolos.h"
+#include "atomos.h"
+#include "fonte.h"
+#include "compilador.h"
+}
 
-Tipo g_tipo_atual;
-ASTNode* g_raiz_ast = NULL;
+%code {
+void yyerror(CompilerContext* ctx, const char *s);
+}
 
-%}
+/* Parser reentrante: todo o estado da compilação está em 'ctx' */
+%define api.pure full
+%parse-param { CompilerContext* ctx }
+%lex-param { CompilerContext* ctx }
 
 %union {
     int num_val;
-    char *str_val;
+    Atomo str_val; /* Lexema internado pelo analisador léxico */
+    Fatia fatia_val; /* Literal: trecho do fonte mapeado ou cópia internada */
     Tipo tipo_val;
-    struct ASTNode* ast_node;
+    NoAst ast_node;
+    ListaNos lista_val; /* Listas: início e último nó, para anexar em O(1) */
 }
 
-%token <str_val> T_ID T_CADEIA T_CARCONST
+%token <str_val> T_ID
+%token <fatia_val> T_CADEIA T_CARCONST
 %token <num_val> T_INTCONST
 %token T_PROGRAMA T_CAR T_INT T_RETORNE T_LEIA T_ESCREVA T_NOVALINHA
 %token T_SE T_ENTAO T_SENAO T_ENQUANTO T_EXECUTE T_OU T_E
@@ -37,11 +52,11 @@ ASTNode* g_raiz_ast = NULL;
 %token T_LPAREN T_RPAREN T_LCHAVE T_RCHAVE T_PVIRGULA T_VIRGULA
 
 %type <tipo_val> Tipo
-%type <ast_node> Programa DeclFuncVar DeclGlobal DeclVarGlobal ListaDeclVarCont
-%type <ast_node> DeclFunc Bloco ListaParametros ListaParametrosCont
-%type <ast_node> DeclProg ListaDeclVar DeclVarLocal
-%type <ast_node> ListaComando Comando BlocoComoComando
-%type <ast_node> Expr Atribuicao OrExpr AndExpr EqExpr DesigExpr AddExpr MulExpr UnExpr PrimExpr ListExpr
+%type <ast_node> Programa DeclFunc Bloco DeclProg Comando BlocoComoComando
+%type <lista_val> DeclFuncVar DeclGlobal DeclVarGlobal ListaDeclVarCont
+%type <lista_val> ListaParametros ListaParametrosCont ListaDeclVar DeclVarLocal
+%type <lista_val> ListaComando ListExpr
+%type <ast_node> Expr Atribuicao OrExpr AndExpr EqExpr DesigExpr AddExpr MulExpr UnExpr PrimExpr
 %type <ast_node> ComandoSe ComandoEnquanto ComandoLeia ComandoEscreva ComandoRetorne
 
 %left T_OU
@@ -61,64 +76,42 @@ ASTNode* g_raiz_ast = NULL;
 Programa:
     DeclFuncVar DeclProg
     {
-        $$ = criar_no(NO_PROGRAMA, $1, $2, NULL, yylineno);
-        g_raiz_ast = $$; /* Salva na variável global */
+        $$ = criar_no(&ctx->ast, NO_PROGRAMA, $1.inicio, $2, NO_NENHUM, ctx->linha);
+        ctx->raiz = $$; /* Salva no contexto da compilação */
     }
     ;
 
 DeclFuncVar:
-    /* Vazio */ { $$ = NULL; }
-    | DeclFuncVar DeclGlobal
-    {
-        if ($1 == NULL) {
-            $$ = $2;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = $2;
-            $$ = $1;
-        }
-    }
+    /* Vazio */ { $$ = lista_nos(NO_NENHUM); }
+    | DeclFuncVar DeclGlobal { $$ = lista_anexar(&ctx->ast, $1, $2); }
     ;
 
 DeclGlobal:
     DeclVarGlobal { $$ = $1; }
-    | DeclFunc    { $$ = $1; }
+    | DeclFunc    { $$ = lista_nos($1); }
     ;
 
 DeclVarGlobal:
     Tipo T_ID
     ListaDeclVarCont T_PVIRGULA
     {
-        ASTNode *id_node = criar_folha_id($2, yylineno);
-        ASTNode *decl_node = criar_no(NO_DECL_VAR, id_node, NULL, NULL, yylineno);
-        decl_node->tipo_dado = $1;
+        NoAst id_node = criar_folha_id(&ctx->ast, $2, ctx->linha);
+        NoAst decl_node = criar_no(&ctx->ast, NO_DECL_VAR, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
+        AST_TIPO_DADO(&ctx->ast, decl_node) = $1;
         /* Encadeia com o resto das declarações da mesma linha (ex: int a, b, c;) */
-        decl_node->prox = $3; 
-        
-        $$ = decl_node;
-        free($2);
+        $$ = lista_anexar(&ctx->ast, lista_nos(decl_node), $3);
     }
     ;
 
 ListaDeclVarCont:
-    /* Vazio */ { $$ = NULL; }
+    /* Vazio */ { $$ = lista_nos(NO_NENHUM); }
     |
     ListaDeclVarCont T_VIRGULA T_ID
     {
-        ASTNode *id_node = criar_folha_id($3, yylineno);
+        NoAst id_node = criar_folha_id(&ctx->ast, $3, ctx->linha);
            
-        ASTNode *decl_node = criar_no(NO_DECL_VAR, id_node, NULL, NULL, yylineno);
-        
-         if ($1 == NULL) {
-            $$ = decl_node;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = decl_node;
-            $$ = $1;
-        }
-        free($3);
+        NoAst decl_node = criar_no(&ctx->ast, NO_DECL_VAR, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
+        $$ = lista_anexar(&ctx->ast, $1, lista_nos(decl_node));
     }
     ;
 
@@ -127,17 +120,15 @@ DeclFunc:
     T_LPAREN ListaParametros T_RPAREN
     Bloco
     {
-        ASTNode *id_func = criar_folha_id($2, yylineno);
-        
-        $$ = criar_no(NO_DECL_FUNC, id_func, $4, $6, yylineno);
-        $$->tipo_dado = $1; /* Tipo de retorno da função */
+        NoAst id_func = criar_folha_id(&ctx->ast, $2, ctx->linha);
         
-        free($2);
+        $$ = criar_no(&ctx->ast, NO_DECL_FUNC, id_func, $4.inicio, $6, ctx->linha);
+        AST_TIPO_DADO(&ctx->ast, $$) = $1; /* Tipo de retorno da função */
     }
     ;
 
 ListaParametros:
-    /* Vazio */ { $$ = NULL; }
+    /* Vazio */ { $$ = lista_nos(NO_NENHUM); }
     |
     ListaParametrosCont { $$ = $1; }
     ;
@@ -145,29 +136,18 @@ ListaParametros:
 ListaParametrosCont:
     Tipo T_ID
     {
-        ASTNode *id_node = criar_folha_id($2, yylineno);
-        $$ = criar_no(NO_DECL_VAR, id_node, NULL, NULL, yylineno);
-        $$->tipo_dado = $1;
-        
-        free($2);
+        NoAst id_node = criar_folha_id(&ctx->ast, $2, ctx->linha);
+        NoAst param_node = criar_no(&ctx->ast, NO_DECL_VAR, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
+        AST_TIPO_DADO(&ctx->ast, param_node) = $1;
+        $$ = lista_nos(param_node);
     }
     |
     ListaParametrosCont T_VIRGULA Tipo T_ID
     {
-        ASTNode *id_node = criar_folha_id($4, yylineno);
-        ASTNode *param_node = criar_no(NO_DECL_VAR, id_node, NULL, NULL, yylineno);
-        param_node->tipo_dado = $3;
-        
-        if ($1 == NULL) {
-            $$ = param_node;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = param_node;
-            $$ = $1;
-        }
-        
-        free($4);
+        NoAst id_node = criar_folha_id(&ctx->ast, $4, ctx->linha);
+        NoAst param_node = criar_no(&ctx->ast, NO_DECL_VAR, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
+        AST_TIPO_DADO(&ctx->ast, param_node) = $3;
+        $$ = lista_anexar(&ctx->ast, $1, lista_nos(param_node));
     }
     ;
 
@@ -183,39 +163,27 @@ Bloco:
     T_LCHAVE ListaDeclVar ListaComando T_RCHAVE
     {
         /* Bloco contem lista de declarações locais e lista de comandos */
-        $$ = criar_no(NO_BLOCO, $2, $3, NULL, yylineno);
+        $$ = criar_no(&ctx->ast, NO_BLOCO, $2.inicio, $3.inicio, NO_NENHUM, ctx->linha);
     }
     ;
 
 ListaDeclVar:
-    /* Vazio */ { $$ = NULL; }
-    | ListaDeclVar DeclVarLocal
-    {
-        if ($1 == NULL) {
-            $$ = $2;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = $2;
-            $$ = $1;
-        }
-    }
+    /* Vazio */ { $$ = lista_nos(NO_NENHUM); }
+    | ListaDeclVar DeclVarLocal { $$ = lista_anexar(&ctx->ast, $1, $2); }
     ;
 
 DeclVarLocal:
     Tipo T_ID
     {
-        g_tipo_atual = $1;
+        ctx->tipo_atual = $1;
     }
     ListaDeclVarCont T_PVIRGULA
     {
-        ASTNode *id_node = criar_folha_id($2, yylineno);
-        ASTNode *decl_node = criar_no(NO_DECL_VAR, id_node, NULL, NULL, yylineno);
-        decl_node->tipo_dado = $1;
-        decl_node->prox = $4; /* Encadeia outras vars da mesma linha: int a, b; */
-        
-        $$ = decl_node;
-        free($2);
+        NoAst id_node = criar_folha_id(&ctx->ast, $2, ctx->linha);
+        NoAst decl_node = criar_no(&ctx->ast, NO_DECL_VAR, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
+        AST_TIPO_DADO(&ctx->ast, decl_node) = $1;
+        /* Encadeia outras vars da mesma linha: int a, b; */
+        $$ = lista_anexar(&ctx->ast, lista_nos(decl_node), $4);
     }
     ;
 
@@ -225,30 +193,20 @@ Tipo:
     ;
 
 ListaComando:
-    /* Vazio */ { $$ = NULL; }
-    | ListaComando Comando
-    {
-        if ($1 == NULL) {
-            $$ = $2;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = $2;
-            $$ = $1;
-        }
-    }
+    /* Vazio */ { $$ = lista_nos(NO_NENHUM); }
+    | ListaComando Comando { $$ = lista_anexar(&ctx->ast, $1, lista_nos($2)); }
     ;
 
 Comando:
     Expr T_PVIRGULA          { $$ = $1; }
-    | T_PVIRGULA             { $$ = criar_no(NO_NULO, NULL, NULL, NULL, yylineno); }
+    | T_PVIRGULA             { $$ = criar_no(&ctx->ast, NO_NULO, NO_NENHUM, NO_NENHUM, NO_NENHUM, ctx->linha); }
     | BlocoComoComando       { $$ = $1; }
     | ComandoSe              { $$ = $1; }
     | ComandoEnquanto        { $$ = $1; }
     | ComandoLeia            { $$ = $1; }
     | ComandoEscreva         { $$ = $1; }
     | ComandoRetorne         { $$ = $1; }
-    | T_NOVALINHA T_PVIRGULA { $$ = criar_no(NO_NOVALINHA, NULL, NULL, NULL, yylineno); }
+    | T_NOVALINHA T_PVIRGULA { $$ = criar_no(&ctx->ast, NO_NOVALINHA, NO_NENHUM, NO_NENHUM, NO_NENHUM, ctx->linha); }
     ;
 
 BlocoComoComando:
@@ -264,190 +222,389 @@ Expr:
 Atribuicao: 
     T_ID T_ATRIB Expr
     {
-        ASTNode *id_node = criar_folha_id($1, yylineno);
-        $$ = criar_no(NO_ATRIBUICAO, id_node, $3, NULL, yylineno);
-        free($1);
+        NoAst id_node = criar_folha_id(&ctx->ast, $1, ctx->linha);
+        $$ = criar_no(&ctx->ast, NO_ATRIBUICAO, id_node, $3, NO_NENHUM, ctx->linha);
     }
     ;
 
 OrExpr:
     AndExpr { $$ = $1; }
-    | OrExpr T_OU AndExpr { $$ = criar_no(NO_OU, $1, $3, NULL, yylineno); }
+    | OrExpr T_OU AndExpr { $$ = criar_no(&ctx->ast, NO_OU, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 AndExpr:
     EqExpr { $$ = $1; }
-    | AndExpr T_E EqExpr { $$ = criar_no(NO_E, $1, $3, NULL, yylineno); }
+    | AndExpr T_E EqExpr { $$ = criar_no(&ctx->ast, NO_E, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 EqExpr:
     DesigExpr { $$ = $1; }
-    | EqExpr T_EQ DesigExpr { $$ = criar_no(NO_IGUAL, $1, $3, NULL, yylineno); }
-    | EqExpr T_NE DesigExpr { $$ = criar_no(NO_DIF, $1, $3, NULL, yylineno); }
+    | EqExpr T_EQ DesigExpr { $$ = criar_no(&ctx->ast, NO_IGUAL, $1, $3, NO_NENHUM, ctx->linha); }
+    | EqExpr T_NE DesigExpr { $$ = criar_no(&ctx->ast, NO_DIF, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 DesigExpr:
     AddExpr { $$ = $1; }
-    | DesigExpr T_MENOR AddExpr { $$ = criar_no(NO_MENOR, $1, $3, NULL, yylineno); }
-    | DesigExpr T_MAIOR AddExpr { $$ = criar_no(NO_MAIOR, $1, $3, NULL, yylineno); }
-    | DesigExpr T_LE AddExpr    { $$ = criar_no(NO_MENOR_IGUAL, $1, $3, NULL, yylineno); }
-    | DesigExpr T_GE AddExpr    { $$ = criar_no(NO_MAIOR_IGUAL, $1, $3, NULL, yylineno); }
+    | DesigExpr T_MENOR AddExpr { $$ = criar_no(&ctx->ast, NO_MENOR, $1, $3, NO_NENHUM, ctx->linha); }
+    | DesigExpr T_MAIOR AddExpr { $$ = criar_no(&ctx->ast, NO_MAIOR, $1, $3, NO_NENHUM, ctx->linha); }
+    | DesigExpr T_LE AddExpr    { $$ = criar_no(&ctx->ast, NO_MENOR_IGUAL, $1, $3, NO_NENHUM, ctx->linha); }
+    | DesigExpr T_GE AddExpr    { $$ = criar_no(&ctx->ast, NO_MAIOR_IGUAL, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 AddExpr:
     MulExpr { $$ = $1; }
-    | AddExpr T_SOMA MulExpr { $$ = criar_no(NO_SOMA, $1, $3, NULL, yylineno); }
-    | AddExpr T_SUB MulExpr  { $$ = criar_no(NO_SUB, $1, $3, NULL, yylineno); }
+    | AddExpr T_SOMA MulExpr { $$ = criar_no(&ctx->ast, NO_SOMA, $1, $3, NO_NENHUM, ctx->linha); }
+    | AddExpr T_SUB MulExpr  { $$ = criar_no(&ctx->ast, NO_SUB, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 MulExpr:
     UnExpr { $$ = $1; }
-    | MulExpr T_MULT UnExpr { $$ = criar_no(NO_MULT, $1, $3, NULL, yylineno); }
-    | MulExpr T_DIV UnExpr  { $$ = criar_no(NO_DIV, $1, $3, NULL, yylineno); }
+    | MulExpr T_MULT UnExpr { $$ = criar_no(&ctx->ast, NO_MULT, $1, $3, NO_NENHUM, ctx->linha); }
+    | MulExpr T_DIV UnExpr  { $$ = criar_no(&ctx->ast, NO_DIV, $1, $3, NO_NENHUM, ctx->linha); }
     ;
 
 UnExpr:
     PrimExpr { $$ = $1; }
     | T_SUB UnExpr { 
         /* Subtração unária (negativo aritmético) */
-        ASTNode *zero = criar_folha_int(0, yylineno);
-        $$ = criar_no(NO_SUB, zero, $2, NULL, yylineno); 
+        NoAst zero = criar_folha_int(&ctx->ast, 0, ctx->linha);
+        $$ = criar_no(&ctx->ast, NO_SUB, zero, $2, NO_NENHUM, ctx->linha); 
       }
-    | T_NEG UnExpr { $$ = criar_no(NO_NEG, $2, NULL, NULL, yylineno); }
+    | T_NEG UnExpr { $$ = criar_no(&ctx->ast, NO_NEG, $2, NO_NENHUM, NO_NENHUM, ctx->linha); }
     ;
 
 PrimExpr:
     T_ID 
     {
-        $$ = criar_folha_id($1, yylineno);
-        free($1);
+        $$ = criar_folha_id(&ctx->ast, $1, ctx->linha);
     }
     | T_ID T_LPAREN T_RPAREN
     {
-         ASTNode *id_node = criar_folha_id($1, yylineno);
-         $$ = criar_no(NO_CHAMADA_FUNC, id_node, NULL, NULL, yylineno);
-         free($1);
+         NoAst id_node = criar_folha_id(&ctx->ast, $1, ctx->linha);
+         $$ = criar_no(&ctx->ast, NO_CHAMADA_FUNC, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
     }
     | T_ID T_LPAREN ListExpr T_RPAREN
     {
-         ASTNode *id_node = criar_folha_id($1, yylineno);
-         $$ = criar_no(NO_CHAMADA_FUNC, id_node, $3, NULL, yylineno);
-         free($1);
+         NoAst id_node = criar_folha_id(&ctx->ast, $1, ctx->linha);
+         $$ = criar_no(&ctx->ast, NO_CHAMADA_FUNC, id_node, $3.inicio, NO_NENHUM, ctx->linha);
     }
-    | T_INTCONST { $$ = criar_folha_int($1, yylineno); }
-    | T_CARCONST { $$ = criar_folha_car($1, yylineno); free($1); }
+    | T_INTCONST { $$ = criar_folha_int(&ctx->ast, $1, ctx->linha); }
+    | T_CARCONST { $$ = criar_folha_car(&ctx->ast, $1.inicio, $1.tamanho, ctx->linha); }
     | T_LPAREN Expr T_RPAREN { $$ = $2; }
     ;
 
 ListExpr:
-    Expr { $$ = $1; }
-    | ListExpr T_VIRGULA Expr
-    {
-        if ($1 == NULL) {
-            $$ = $3;
-        } else {
-            ASTNode *temp = $1;
-            while (temp->prox != NULL) temp = temp->prox;
-            temp->prox = $3;
-            $$ = $1;
-        }
-    }
+    Expr { $$ = lista_nos($1); }
+    | ListExpr T_VIRGULA Expr { $$ = lista_anexar(&ctx->ast, $1, lista_nos($3)); }
     ;
 
 ComandoSe:
     T_SE T_LPAREN Expr T_RPAREN T_ENTAO Comando %prec T_ENTAO
     {
         /* IF sem ELSE: Filho1=Expr, Filho2=Comando, Filho3=NULL */
-        $$ = criar_no(NO_SE, $3, $6, NULL, yylineno);
+        $$ = criar_no(&ctx->ast, NO_SE, $3, $6, NO_NENHUM, ctx->linha);
     }
     | T_SE T_LPAREN Expr T_RPAREN T_ENTAO Comando T_SENAO Comando
     {
         /* IF com ELSE: Filho1=Expr, Filho2=CmdThen, Filho3=CmdElse */
-        $$ = criar_no(NO_SE, $3, $6, $8, yylineno);
+        $$ = criar_no(&ctx->ast, NO_SE, $3, $6, $8, ctx->linha);
     }
     ;
 
 ComandoEnquanto:
     T_ENQUANTO T_LPAREN Expr T_RPAREN T_EXECUTE Comando
     {
-        $$ = criar_no(NO_ENQUANTO, $3, $6, NULL, yylineno);
+        $$ = criar_no(&ctx->ast, NO_ENQUANTO, $3, $6, NO_NENHUM, ctx->linha);
     }
     ;
 
 ComandoLeia:
     T_LEIA T_ID T_PVIRGULA 
     {
-        ASTNode *id_node = criar_folha_id($2, yylineno);
-        $$ = criar_no(NO_LEIA, id_node, NULL, NULL, yylineno);
-        free($2);
+        NoAst id_node = criar_folha_id(&ctx->ast, $2, ctx->linha);
+        $$ = criar_no(&ctx->ast, NO_LEIA, id_node, NO_NENHUM, NO_NENHUM, ctx->linha);
     }
     ;
 
 ComandoEscreva:
-    T_ESCREVA Expr T_PVIRGULA { $$ = criar_no(NO_ESCREVA, $2, NULL, NULL, yylineno); }
+    T_ESCREVA Expr T_PVIRGULA { $$ = criar_no(&ctx->ast, NO_ESCREVA, $2, NO_NENHUM, NO_NENHUM, ctx->linha); }
     | T_ESCREVA T_CADEIA T_PVIRGULA
     {
         /* Tratamento de string literal no escreva */
-        ASTNode *str_node = criar_folha_str($2, yylineno);
-        $$ = criar_no(NO_ESCREVA, str_node, NULL, NULL, yylineno);
-        free($2);
+        NoAst str_node = criar_folha_str(&ctx->ast, $2.inicio, $2.tamanho, ctx->linha);
+        $$ = criar_no(&ctx->ast, NO_ESCREVA, str_node, NO_NENHUM, NO_NENHUM, ctx->linha);
     }
     ;
 
 ComandoRetorne: 
     T_RETORNE Expr T_PVIRGULA
     {
-        $$ = criar_no(NO_RETORNE, $2, NULL, NULL, yylineno);
+        $$ = criar_no(&ctx->ast, NO_RETORNE, $2, NO_NENHUM, NO_NENHUM, ctx->linha);
     }
     ;
 
 %%
 
+/* A biblioteca (make biblioteca) usa o mesmo parser, sem o programa de linha de comando */
+#ifndef GOIANINHA_BIBLIOTECA
+
+/* Grava 'assembly' em 'caminho'. Retorna 1 em caso de sucesso. */
+static int escrever_texto(const char* assembly, size_t tamanho, const char* caminho) {
+    FILE *saida = fopen(caminho, "w");
+    if (!saida) return 0;
+    size_t escritos = fwrite(assembly, 1, tamanho, saida);
+    return (fclose(saida) == 0) && escritos == tamanho;
+}
+
+/* Grava o assembly gerado em 'caminho'. Retorna 1 em caso de sucesso. */
+static int escrever_assembly(CompilerContext* ctx, const char* caminho) {
+    size_t tamanho;
+    const char* assembly = compilador_assembly(ctx, &tamanho);
+    return escrever_texto(assembly, tamanho, caminho);
+}
+
+/* Grava o texto da RI em 'caminho' ("-": saída padrão). Retorna 1 em caso de sucesso. */
+static int escrever_ri(CompilerContext* ctx, const char* caminho) {
+    size_t tamanho;
+    const char* texto = compilador_ri(ctx, &tamanho);
+    if (texto == NULL) return 0;
+    if (strcmp(caminho, "-") == 0) return fwrite(texto, 1, tamanho, stdout) == tamanho;
+    return escrever_texto(texto, tamanho, caminho);
+}
+
+/* Tamanho em bytes, com sufixo K, M ou G opcional (ex: "64M"); 0 se inválido */
+static uint64_t ler_tamanho(const char* texto) {
+    char* fim;
+    unsigned long long valor = strtoull(texto, &fim, 10);
+    switch (*fim) {
+        case 'K': case 'k': valor <<= 10; fim++; break;
+        case 'M': case 'm': valor <<= 20; fim++; break;
+        case 'G': case 'g': valor <<= 30; fim++; break;
+    }
+    return *fim == '\0' ? (uint64_t) valor : 0;
+}
+
 int main(int argc, char **argv) {
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            fprintf(stderr, "Erro: Nao foi possivel abrir o arquivo '%s'\n", argv[1]);
+    const char* arquivo = NULL;
+    int mostrar_estatisticas = 0;
+    int permitir_mmap = 1;
+    int medir = 0;
+    int mostrar_tokens = 0;
+    int servidor = 0;
+    const char* caminho_socket = NULL;
+    const char* diretorio_cache = NULL;
+    uint64_t limite_cache = 0;
+    int mostrar_cache = 0;
+    const char* arquivo_ri = NULL;
+
+    CompilerContext* ctx = compilador_criar();
+    if (ctx == NULL) {
+        fprintf(stderr, "Erro: memoria insuficiente\n");
+        return 1;
+    }
+    compilador_definir_diagnosticos(ctx, stderr);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--estatisticas") == 0) {
+            mostrar_estatisticas = 1;
+        } else if (strcmp(argv[i], "--sem-mmap") == 0) {
+            permitir_mmap = 0;
+        } else if (strcmp(argv[i], "--varredor=manual") == 0) {
+            ctx->varredor = VARREDOR_MANUAL;
+        } else if (strcmp(argv[i], "--varredor=flex") == 0) {
+            ctx->varredor = VARREDOR_FLEX;
+        } else if (strcmp(argv[i], "--medir-varredor") == 0) {
+            medir = 1;
+        } else if (strcmp(argv[i], "--pre-tokenizar") == 0) {
+            ctx->varredor = VARREDOR_PRE_TOKENIZADO;
+        } else if (strncmp(argv[i], "--fatias=", 9) == 0) {
+            ctx->num_fatias = atoi(argv[i] + 9);
+        } else if (strcmp(argv[i], "--dump-tokens") == 0) {
+            ctx->varredor = VARREDOR_PRE_TOKENIZADO;
+            mostrar_tokens = 1;
+        } else if (strcmp(argv[i], "--servidor") == 0) {
+            servidor = 1;
+        } else if (strncmp(argv[i], "--servidor=", 11) == 0) {
+            servidor = 1;
+            caminho_socket = argv[i] + 11;
+        } else if (strcmp(argv[i], "-O0") == 0 || strcmp(argv[i], "-O1") == 0) {
+            ctx->nivel_otimizacao = argv[i][2] - '0';
+        } else if (strncmp(argv[i], "--peephole=", 11) == 0) {
+            unsigned regras;
+            if (janela_ler_regras(argv[i] + 11, &regras) != 0) {
+                fprintf(stderr, "Erro: regra de janela desconhecida em '%s'\n", argv[i] + 11);
+                compilador_destruir(ctx);
+                return 1;
+            }
+            ctx->regras_janela = (int) regras;
+        } else if (strcmp(argv[i], "--convencao=pilha") == 0) {
+            ctx->convencao = CONVENCAO_PILHA;
+        } else if (strcmp(argv[i], "--convencao=registradores") == 0) {
+            ctx->convencao = CONVENCAO_REGISTRADORES;
+        } else if (strcmp(argv[i], "--relatorio-integracao") == 0) {
+            ctx->relatar_integracao = 1;
+        } else if (strcmp(argv[i], "--emit-ir") == 0) {
+            arquivo_ri = "saida.ir";
+        } else if (strncmp(argv[i], "--emit-ir=", 10) == 0) {
+            arquivo_ri = argv[i] + 10;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            diretorio_cache = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-limite=", 15) == 0) {
+            limite_cache = ler_tamanho(argv[i] + 15);
+        } else if (strcmp(argv[i], "--cache-estatisticas") == 0) {
+            mostrar_cache = 1;
+        } else {
+            arquivo = argv[i];
+        }
+    }
+
+    ctx->emitir_ri = arquivo_ri != NULL;
+
+    if (servidor) {
+        /* Compilações incrementais sob demanda (ver servidor.h), com as opções acima */
+        int status = executar_servidor(caminho_socket, ctx);
+        compilador_destruir(ctx);
+        return status;
+    }
+
+    /* O texto inteiro fica em memória: mapeado, ou lido do arquivo ou de stdin */
+    if (arquivo != NULL) {
+        if (compilador_carregar_arquivo(ctx, arquivo, permitir_mmap) != 0) {
+            fprintf(stderr, "Erro: Nao foi possivel abrir o arquivo '%s'\n", arquivo);
+            compilador_destruir(ctx);
             return 1;
         }
-    } else {
-        yyin = stdin;
+    } else if (compilador_carregar_fluxo(ctx, stdin) != 0) {
+        fprintf(stderr, "Erro: memoria insuficiente para ler a entrada\n");
+        compilador_destruir(ctx);
+        return 1;
     }
 
-    int parse_result = yyparse();
+    /* Cache em disco: um acerto dispensa todas as fases (ver cache.h) */
+    CacheCompilacao cache;
+    int usar_cache = 0;
+    ChaveCache chave;
+    /* O cache guarda só o assembly: --emit-ir e --relatorio-integracao sempre compilam */
+    if (diretorio_cache != NULL && !mostrar_tokens && !medir && arquivo_ri == NULL && !ctx->relatar_integracao) {
+        if (cache_abrir(&cache, diretorio_cache, limite_cache) != 0) {
+            fprintf(stderr, "Aviso: cache '%s' indisponivel; compilando sem cache\n", diretorio_cache);
+        } else {
+            /* Opções que mudam o assembly gerado */
+            char opcoes_saida[32];
+            snprintf(opcoes_saida, sizeof(opcoes_saida), "-O%d %u %d", ctx->nivel_otimizacao,
+                     compilador_regras_janela(ctx), (int) compilador_convencao(ctx));
+            usar_cache = 1;
+            chave = cache_chave(&cache, opcoes_saida, ctx->fonte.dados, ctx->fonte.tamanho);
+
+            EntradaCache entrada;
+            if (cache_buscar(&cache, chave, &entrada)) {
+                /* A AST restaurada só interessa às estatísticas: o assembly
+                 * sai direto do arquivo mapeado */
+                size_t tamanho;
+                const char* assembly = cache_assembly(&entrada, &tamanho);
+                int ok = escrever_texto(assembly, tamanho, "saida.asm") &&
+                         (!mostrar_estatisticas || cache_restaurar(&entrada, ctx) == 0);
+                cache_liberar_entrada(&entrada);
+                if (ok) {
+                    printf("Compilacao encontrada no cache.\n");
+                    printf("Geracao de codigo concluida. Saida em 'saida.asm'.\n");
+                } else {
+                    fprintf(stderr, "Erro: Nao foi possivel criar o arquivo de saida 'saida.asm'\n");
+                }
+                if (mostrar_estatisticas) {
+                    imprimir_estatisticas_repositorio(stderr, &ctx->atomos);
+                    imprimir_estatisticas_ast(stderr, &ctx->ast);
+                }
+                if (mostrar_estatisticas || mostrar_cache) cache_imprimir_estatisticas(stderr, &cache);
+                cache_fechar(&cache);
+                compilador_destruir(ctx);
+                regiao_liberar_cache();
+                return !ok;
+            }
+        }
+    }
+
+    if (compilador_iniciar_varredor(ctx) != 0) {
+        fprintf(stderr, "Erro: Nao foi possivel tokenizar a entrada\n");
+        if (usar_cache) cache_fechar(&cache);
+        compilador_destruir(ctx);
+        return 1;
+    }
+
+    if (mostrar_tokens) {
+        imprimir_tokens(stdout, &ctx->tokens, ctx->fonte.dados);
+        compilador_destruir(ctx);
+        return 0;
+    }
+
+    if (medir) {
+        /* Só o analisador léxico: contagem de tokens e vazão (ver varredor.h) */
+        medir_varredor(ctx, stdout);
+        compilador_destruir(ctx);
+        regiao_liberar_cache();
+        return 0;
+    }
+
+    regiao_definir_fase("sintatico");
+    int parse_result = compilador_analisar(ctx);
     int semantico_result = 1; /* Inicializa com erro, sucesso se a análise semântica passar */
 
     if (parse_result == 0) {
         printf("\nAnalise sintatica bem-sucedida!\n");
-        /* imprimir_ast(g_raiz_ast, 0); */
+        /* imprimir_ast(&ctx->ast, ctx->raiz, 0); */
+
+        regiao_definir_fase("semantico");
+        printf("\n--- Iniciando Analise Semantica ---\n");
+        int erros_semanticos = compilador_verificar(ctx);
+        if (erros_semanticos == 0) {
+            printf("Analise semantica concluida com SUCESSO.\n");
+        } else {
+            printf("Analise semantica concluida com %d ERROS.\n", erros_semanticos);
+        }
+        semantico_result = erros_semanticos != 0;
 
-        ScopeStack* tabela_simbolos = iniciar_pilha_tabela_simbolos();
-        semantico_result = verificar_semantica(g_raiz_ast, tabela_simbolos);
-        
         if(semantico_result == 0) {
-            FILE *saida = fopen("saida.asm", "w");
-            if (!saida) {
+            printf("Iniciando geracao de codigo...\n");
+            regiao_definir_fase("geracao");
+            if (compilador_gerar(ctx) != 0 || !escrever_assembly(ctx, "saida.asm")) {
                 fprintf(stderr, "Erro: Nao foi possivel criar o arquivo de saida 'saida.asm'\n");
             } else {
-                printf("Iniciando geracao de codigo...\n");
-                /*gerar_codigo(g_raiz_ast, saida, tabela_simbolos);*/
-                fclose(saida);
                 printf("Geracao de codigo concluida. Saida em 'saida.asm'.\n");
+                if (arquivo_ri != NULL && !escrever_ri(ctx, arquivo_ri)) {
+                    fprintf(stderr, "Erro: Nao foi possivel escrever a RI em '%s'\n", arquivo_ri);
+                }
+                if (usar_cache) {
+                    size_t tamanho;
+                    const char* assembly = compilador_assembly(ctx, &tamanho);
+                    if (cache_gravar(&cache, chave, &ctx->ast, ctx->raiz, assembly, tamanho) != 0) {
+                        fprintf(stderr, "Aviso: Nao foi possivel gravar no cache '%s'\n", diretorio_cache);
+                    }
+                }
             }
         }
-        
-        eliminar_pilha_tabelas(tabela_simbolos);
     }
 
-    liberar_ast(g_raiz_ast);
-
-    if (yyin != stdin) {
-        fclose(yyin);
+    if (mostrar_estatisticas) {
+        imprimir_estatisticas_repositorio(stderr, &ctx->atomos);
+        imprimir_estatisticas_ast(stderr, &ctx->ast);
+        if (ctx->nivel_otimizacao >= 1) imprimir_estatisticas_otimizacao(stderr, &ctx->otimizacao);
+        if (compilador_regras_janela(ctx) != 0) imprimir_estatisticas_janela(stderr, &ctx->janela);
+        regiao_imprimir_estatisticas(stderr);
+    }
+    if (usar_cache) {
+        if (mostrar_estatisticas || mostrar_cache) cache_imprimir_estatisticas(stderr, &cache);
+        cache_fechar(&cache);
     }
-    
+
+    compilador_destruir(ctx);
+    regiao_liberar_cache();
+
     return parse_result || semantico_result;
 }
 
-void yyerror(const char *s) {
-    fprintf(stderr, "ERRO: %s na linha %d\n", s, yylineno);
-}
\ No newline at end of file
+#endif /* GOIANINHA_BIBLIOTECA */
+
+void yyerror(CompilerContext* ctx, const char *s) {
+    fprintf(ctx->diagnosticos, "ERRO: %s na linha %d\n", s, ctx->linha);
+    ctx->erros_sintaticos++;
+}
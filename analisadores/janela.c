@@ -0,0 +1,976 @@
+#define _POSIX_C_SOURCE 200809L /* open_memstream */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "janela.h"
+
+/*
+ * O texto é dividido em linhas que guardam só onde começam; as instruções
+ * são decodificadas quando uma regra olha para elas. Uma instrução reescrita
+ * vai para 'novas', com operandos que apontam para o texto original ou para
+ * cadeias estáticas, e uma linha removida só muda de tipo: a saída é escrita
+ * no fim, pulando as removidas.
+ */
+
+#define NENHUMA UINT32_MAX
+#define MAXIMO_RODADAS 4        /* Rodadas de todas as regras, até nada mudar */
+#define MAXIMO_ENCADEAMENTO 8   /* Saltos seguidos por 'encadeamento' */
+#define LINHA_LONGA UINT16_MAX
+
+typedef struct {
+    const char* s;
+    uint32_t n;
+} Texto;
+
+static int texto_igual(Texto a, Texto b) {
+    return a.n == b.n && memcmp(a.s, b.s, a.n) == 0;
+}
+
+static Texto texto_de(const char* s) {
+    Texto t = { s, (uint32_t) strlen(s) };
+    return t;
+}
+
+// --- Registradores ---
+
+enum { R_ZERO = 0, R_V0 = 2, R_A0 = 4, R_T9 = 25, R_GP = 28, R_SP = 29, R_FP = 30, R_RA = 31 };
+
+#define BIT(r)              (1u << (r))
+#define TODOS               0xffffffffu
+#define REGS_ARGUMENTOS     (BIT(4) | BIT(5) | BIT(6) | BIT(7))
+#define REGS_S              0x00ff0000u
+/* Destruídos por uma chamada: $at, $v0, $v1, $a0..$a3, $t0..$t9 e $ra */
+#define REGS_CHAMADOR       (0x0000fffeu | BIT(24) | BIT(25) | BIT(R_RA))
+/* Vivos depois de 'jr $ra': o resultado, a pilha e os registradores do chamado */
+#define VIVOS_RETORNO       (BIT(R_V0) | BIT(R_SP) | BIT(R_FP) | BIT(R_RA) | BIT(R_GP) | REGS_S)
+/* Nunca somem, mesmo sem leitura à vista */
+#define REGS_FIXOS          (BIT(R_SP) | BIT(R_FP) | BIT(R_RA) | BIT(R_GP))
+
+// Número do registrador, -1 se o operando não é registrador, -2 se é um desconhecido
+static int registrador(Texto t) {
+    if (t.n < 2 || t.s[0] != '$') return -1;
+    if (t.n == 2 && t.s[1] >= '0' && t.s[1] <= '9') return t.s[1] - '0';
+    if (t.n == 5) return memcmp(t.s, "$zero", 5) == 0 ? R_ZERO : -2;
+    if (t.n != 3) return -2;
+    // Pelo nome: letra e dígito, ou um dos de dois nomes fixos
+    char letra = t.s[1], c = t.s[2];
+    int d = c - '0';
+    if (c >= '0' && c <= '9') {
+        if (letra >= '1' && letra <= '3') {
+            int r = (letra - '0') * 10 + d;
+            return r < 32 ? r : -2;
+        }
+        switch (letra) {
+            case 'v': return d < 2 ? R_V0 + d : -2;
+            case 'a': return d < 4 ? R_A0 + d : -2;
+            case 't': return d < 8 ? 8 + d : 24 + d - 8;
+            case 's': return d < 8 ? 16 + d : -2;
+            case 'k': return d < 2 ? 26 + d : -2;
+        }
+        return -2;
+    }
+    if (letra == 'a' && c == 't') return 1;
+    if (letra == 'g' && c == 'p') return R_GP;
+    if (letra == 's' && c == 'p') return R_SP;
+    if (letra == 'f' && c == 'p') return R_FP;
+    if (letra == 'r' && c == 'a') return R_RA;
+    return -2;
+}
+
+// Base de um operando de memória "desl($base)", ou -1 (endereço por rótulo)
+static int base_memoria(Texto t) {
+    const char* abre = memchr(t.s, '(', t.n);
+    if (abre == NULL || t.s[t.n - 1] != ')') return -1;
+    Texto base = { abre + 1, (uint32_t) (t.s + t.n - 1 - (abre + 1)) };
+    return registrador(base);
+}
+
+// --- Mnemônicos ---
+
+typedef enum {
+    F_DESCONHECIDO, /* Lê tudo: nenhuma regra mexe ao redor */
+    F_CALCULO,      /* Escreve op0, lê os registradores op1 e op2 */
+    F_CARGA,        /* lw: escreve op0, lê a base de op1 */
+    F_GUARDA,       /* sw: lê op0 e a base de op1 */
+    F_HILO,         /* mult, div: com dois operandos lê ambos; com três é F_CALCULO */
+    F_DESVIO_ZERO,  /* beqz R, L */
+    F_DESVIO,       /* beq A, B, L */
+    F_SALTO,        /* j L */
+    F_RETORNO,      /* jr R */
+    F_CHAMADA,      /* jal L */
+    F_CHAMADA_REG,  /* jalr R */
+    F_SYSCALL,
+    F_NOP
+} Formato;
+
+typedef enum {
+    M_DESCONHECIDO,
+    M_LW, M_SW, M_LI, M_LA, M_MOVE, M_ADDIU, M_ADDU, M_SUBU, M_MUL,
+    M_AND, M_ANDI, M_OR, M_ORI, M_XOR, M_XORI, M_NOR, M_SLL, M_SRL, M_SRA,
+    M_SLT, M_SLTI, M_SLTU, M_SLTIU, M_SEQ, M_SNE, M_SGT, M_SGE, M_SLE, M_MFLO, M_MFHI,
+    M_ADD, M_ADDI, M_SUB, M_DIV, M_DIVU, M_REM, M_REMU, M_MULT, M_MULTU,
+    M_BEQZ, M_BNEZ, M_BLTZ, M_BGEZ, M_BGTZ, M_BLEZ,
+    M_BEQ, M_BNE, M_BLT, M_BGE, M_BGT, M_BLE,
+    M_J, M_B, M_JR, M_JAL, M_JALR, M_SYSCALL, M_NOP,
+    NUM_MNEMONICOS
+} Mnemonico;
+
+typedef struct {
+    const char* nome;
+    uint8_t formato;
+    uint8_t pura;       /* Sem efeito além do registrador escrito: some se ele está morto */
+} InfoMnemonico;
+
+static const InfoMnemonico g_mnemonicos[NUM_MNEMONICOS] = {
+    [M_DESCONHECIDO] = { "", F_DESCONHECIDO, 0 },
+    [M_LW] = { "lw", F_CARGA, 1 }, [M_SW] = { "sw", F_GUARDA, 0 },
+    [M_LI] = { "li", F_CALCULO, 1 }, [M_LA] = { "la", F_CALCULO, 1 },
+    [M_MOVE] = { "move", F_CALCULO, 1 }, [M_ADDIU] = { "addiu", F_CALCULO, 1 },
+    [M_ADDU] = { "addu", F_CALCULO, 1 }, [M_SUBU] = { "subu", F_CALCULO, 1 },
+    [M_MUL] = { "mul", F_CALCULO, 1 },
+    [M_AND] = { "and", F_CALCULO, 1 }, [M_ANDI] = { "andi", F_CALCULO, 1 },
+    [M_OR] = { "or", F_CALCULO, 1 }, [M_ORI] = { "ori", F_CALCULO, 1 },
+    [M_XOR] = { "xor", F_CALCULO, 1 }, [M_XORI] = { "xori", F_CALCULO, 1 },
+    [M_NOR] = { "nor", F_CALCULO, 1 }, [M_SLL] = { "sll", F_CALCULO, 1 },
+    [M_SRL] = { "srl", F_CALCULO, 1 }, [M_SRA] = { "sra", F_CALCULO, 1 },
+    [M_SLT] = { "slt", F_CALCULO, 1 }, [M_SLTI] = { "slti", F_CALCULO, 1 },
+    [M_SLTU] = { "sltu", F_CALCULO, 1 }, [M_SLTIU] = { "sltiu", F_CALCULO, 1 },
+    [M_SEQ] = { "seq", F_CALCULO, 1 }, [M_SNE] = { "sne", F_CALCULO, 1 },
+    [M_SGT] = { "sgt", F_CALCULO, 1 }, [M_SGE] = { "sge", F_CALCULO, 1 },
+    [M_SLE] = { "sle", F_CALCULO, 1 },
+    [M_MFLO] = { "mflo", F_CALCULO, 1 }, [M_MFHI] = { "mfhi", F_CALCULO, 1 },
+    // Estouro e divisão por zero geram exceção: ficam mesmo sem leitura
+    [M_ADD] = { "add", F_CALCULO, 0 }, [M_ADDI] = { "addi", F_CALCULO, 0 },
+    [M_SUB] = { "sub", F_CALCULO, 0 },
+    [M_DIV] = { "div", F_HILO, 0 }, [M_DIVU] = { "divu", F_HILO, 0 },
+    [M_REM] = { "rem", F_HILO, 0 }, [M_REMU] = { "remu", F_HILO, 0 },
+    [M_MULT] = { "mult", F_HILO, 0 }, [M_MULTU] = { "multu", F_HILO, 0 },
+    [M_BEQZ] = { "beqz", F_DESVIO_ZERO, 0 }, [M_BNEZ] = { "bnez", F_DESVIO_ZERO, 0 },
+    [M_BLTZ] = { "bltz", F_DESVIO_ZERO, 0 }, [M_BGEZ] = { "bgez", F_DESVIO_ZERO, 0 },
+    [M_BGTZ] = { "bgtz", F_DESVIO_ZERO, 0 }, [M_BLEZ] = { "blez", F_DESVIO_ZERO, 0 },
+    [M_BEQ] = { "beq", F_DESVIO, 0 }, [M_BNE] = { "bne", F_DESVIO, 0 },
+    [M_BLT] = { "blt", F_DESVIO, 0 }, [M_BGE] = { "bge", F_DESVIO, 0 },
+    [M_BGT] = { "bgt", F_DESVIO, 0 }, [M_BLE] = { "ble", F_DESVIO, 0 },
+    [M_J] = { "j", F_SALTO, 0 }, [M_B] = { "b", F_SALTO, 0 },
+    [M_JR] = { "jr", F_RETORNO, 0 }, [M_JAL] = { "jal", F_CHAMADA, 0 },
+    [M_JALR] = { "jalr", F_CHAMADA_REG, 0 },
+    [M_SYSCALL] = { "syscall", F_SYSCALL, 0 }, [M_NOP] = { "nop", F_NOP, 0 },
+};
+
+// Desvio com a condição oposta
+static const uint8_t g_oposto[NUM_MNEMONICOS] = {
+    [M_BEQZ] = M_BNEZ, [M_BNEZ] = M_BEQZ, [M_BLTZ] = M_BGEZ, [M_BGEZ] = M_BLTZ,
+    [M_BGTZ] = M_BLEZ, [M_BLEZ] = M_BGTZ,
+    [M_BEQ] = M_BNE, [M_BNE] = M_BEQ, [M_BLT] = M_BGE, [M_BGE] = M_BLT,
+    [M_BGT] = M_BLE, [M_BLE] = M_BGT,
+};
+
+// Desvio que toma a mesma decisão que a comparação
+static const uint8_t g_desvio_da_comparacao[NUM_MNEMONICOS] = {
+    [M_SLT] = M_BLT, [M_SGT] = M_BGT, [M_SGE] = M_BGE, [M_SLE] = M_BLE,
+    [M_SEQ] = M_BEQ, [M_SNE] = M_BNE,
+};
+
+static Mnemonico procurar_mnemonico(Texto t) {
+    for (int m = 1; m < NUM_MNEMONICOS; m++) {
+        const char* nome = g_mnemonicos[m].nome;
+        if (nome[0] == t.s[0] && t.n == strlen(nome) && memcmp(t.s, nome, t.n) == 0) return (Mnemonico) m;
+    }
+    return M_DESCONHECIDO;
+}
+
+static int eh_desvio(Mnemonico m) {
+    return g_mnemonicos[m].formato == F_DESVIO || g_mnemonicos[m].formato == F_DESVIO_ZERO;
+}
+
+// --- Linhas ---
+
+typedef enum { LINHA_INSTRUCAO, LINHA_ROTULO, LINHA_OUTRA, LINHA_REMOVIDA } TipoLinha;
+
+typedef struct {
+    uint32_t inicio;        // No texto original
+    uint32_t nova;          // Instrução reescrita: índice + 1 em 'novas'; 0 se é a original
+    uint16_t tamanho;       // Sem o '\n'; LINHA_LONGA: procurar o fim
+    uint8_t tipo;
+    uint8_t mnemonico;
+} Linha;
+
+typedef struct {
+    uint8_t mnemonico;
+    uint8_t num_ops;
+    Texto op[3];
+} Instrucao;
+
+typedef struct {
+    const char* texto;
+    size_t tamanho;
+    Linha* linhas;
+    uint32_t num_linhas;
+    Instrucao* novas;
+    uint32_t num_novas;
+    uint32_t capacidade_novas;
+    uint32_t* rotulos;      // Tabela de dispersão: linha de cada rótulo (NENHUMA se vazia)
+    uint32_t mascara_rotulos;
+    uint32_t* entrada;      // Vivos na entrada de cada linha (regras com vivacidade)
+    uint32_t menor_retorno; // Menor destino de salto para trás lido na passada
+    unsigned regras;
+    EstatisticasJanela* est;
+    int sem_memoria;
+    int mudou;
+} Janela;
+
+static Texto linha_texto(const Janela* j, uint32_t i) {
+    const char* inicio = j->texto + j->linhas[i].inicio;
+    if (j->linhas[i].tamanho != LINHA_LONGA) return (Texto) { inicio, j->linhas[i].tamanho };
+    const char* fim = memchr(inicio, '\n', (size_t) (j->texto + j->tamanho - inicio));
+    Texto t = { inicio, (uint32_t) ((fim ? fim : j->texto + j->tamanho) - inicio) };
+    return t;
+}
+
+// Nome do rótulo da linha, sem os dois pontos
+static Texto nome_rotulo(const Janela* j, uint32_t i) {
+    Texto t = linha_texto(j, i);
+    t.n--;
+    return t;
+}
+
+static Texto aparar(Texto t) {
+    while (t.n > 0 && (t.s[0] == ' ' || t.s[0] == '\t')) {
+        t.s++;
+        t.n--;
+    }
+    while (t.n > 0 && (t.s[t.n - 1] == ' ' || t.s[t.n - 1] == '\t' || t.s[t.n - 1] == '\r')) t.n--;
+    return t;
+}
+
+static void decodificar(const Janela* j, uint32_t i, Instrucao* in) {
+    if (j->linhas[i].nova != 0) {
+        *in = j->novas[j->linhas[i].nova - 1];
+        return;
+    }
+    // Uma passada só: pula o mnemônico e corta os operandos nas vírgulas
+    Texto t = linha_texto(j, i);
+    const char* p = t.s;
+    const char* fim = t.s + t.n;
+    while (p < fim && (*p == ' ' || *p == '\t')) p++;
+    while (p < fim && *p != ' ' && *p != '\t') p++;
+    in->mnemonico = j->linhas[i].mnemonico;
+    in->num_ops = 0;
+    for (;;) {
+        while (p < fim && (*p == ' ' || *p == '\t')) p++;
+        if (p == fim) break;
+        if (in->num_ops == 3) {
+            // Operandos demais: ninguém mexe
+            in->mnemonico = M_DESCONHECIDO;
+            break;
+        }
+        const char* inicio = p;
+        while (p < fim && *p != ',') p++;
+        const char* ultimo = p;
+        while (ultimo > inicio && (ultimo[-1] == ' ' || ultimo[-1] == '\t' || ultimo[-1] == '\r')) ultimo--;
+        in->op[in->num_ops++] = (Texto) { inicio, (uint32_t) (ultimo - inicio) };
+        if (p < fim) p++;
+    }
+}
+
+static void reescrever(Janela* j, uint32_t i, const Instrucao* in) {
+    if (j->num_novas == j->capacidade_novas) {
+        uint32_t nova = j->capacidade_novas ? j->capacidade_novas * 2 : 256;
+        Instrucao* novas = realloc(j->novas, nova * sizeof(Instrucao));
+        if (novas == NULL) {
+            j->sem_memoria = 1;
+            return;
+        }
+        j->novas = novas;
+        j->capacidade_novas = nova;
+    }
+    j->novas[j->num_novas++] = *in;
+    j->linhas[i].nova = j->num_novas;
+    j->linhas[i].mnemonico = in->mnemonico;
+}
+
+static void remover(Janela* j, uint32_t i) {
+    j->linhas[i].tipo = LINHA_REMOVIDA;
+}
+
+// Próxima linha que não é removida nem de dados (rótulo ou instrução)
+static uint32_t proxima(const Janela* j, uint32_t i) {
+    for (i++; i < j->num_linhas; i++) {
+        if (j->linhas[i].tipo == LINHA_INSTRUCAO || j->linhas[i].tipo == LINHA_ROTULO) return i;
+    }
+    return NENHUMA;
+}
+
+static uint32_t anterior(const Janela* j, uint32_t i) {
+    while (i-- > 0) {
+        if (j->linhas[i].tipo == LINHA_INSTRUCAO || j->linhas[i].tipo == LINHA_ROTULO) return i;
+    }
+    return NENHUMA;
+}
+
+// Instrução logo depois (ou antes) de 'i', sem rótulo no meio
+static uint32_t vizinha_seguinte(const Janela* j, uint32_t i) {
+    uint32_t n = proxima(j, i);
+    return n != NENHUMA && j->linhas[n].tipo == LINHA_INSTRUCAO ? n : NENHUMA;
+}
+
+static uint32_t vizinha_anterior(const Janela* j, uint32_t i) {
+    uint32_t p = anterior(j, i);
+    return p != NENHUMA && j->linhas[p].tipo == LINHA_INSTRUCAO ? p : NENHUMA;
+}
+
+// --- Rótulos ---
+
+static uint32_t dispersao(Texto t) {
+    uint32_t h = 2166136261u;
+    for (uint32_t k = 0; k < t.n; k++) h = (h ^ (uint8_t) t.s[k]) * 16777619u;
+    return h;
+}
+
+static int indexar_rotulos(Janela* j) {
+    uint32_t num = 0;
+    for (uint32_t i = 0; i < j->num_linhas; i++) num += j->linhas[i].tipo == LINHA_ROTULO;
+    uint32_t capacidade = 16;
+    while (capacidade < 2 * num) capacidade *= 2;
+    j->rotulos = malloc(capacidade * sizeof(uint32_t));
+    if (j->rotulos == NULL) return -1;
+    memset(j->rotulos, 0xff, capacidade * sizeof(uint32_t));
+    j->mascara_rotulos = capacidade - 1;
+    for (uint32_t i = 0; i < j->num_linhas; i++) {
+        if (j->linhas[i].tipo != LINHA_ROTULO) continue;
+        uint32_t h = dispersao(nome_rotulo(j, i)) & j->mascara_rotulos;
+        while (j->rotulos[h] != NENHUMA) h = (h + 1) & j->mascara_rotulos;
+        j->rotulos[h] = i;
+    }
+    return 0;
+}
+
+static uint32_t linha_do_rotulo(const Janela* j, Texto nome) {
+    for (uint32_t h = dispersao(nome) & j->mascara_rotulos; j->rotulos[h] != NENHUMA;
+         h = (h + 1) & j->mascara_rotulos) {
+        if (texto_igual(nome_rotulo(j, j->rotulos[h]), nome)) return j->rotulos[h];
+    }
+    return NENHUMA;
+}
+
+// O rótulo 'nome' está entre os rótulos logo depois da linha 'i'?
+static int rotulo_segue(const Janela* j, uint32_t i, Texto nome) {
+    for (uint32_t n = proxima(j, i); n != NENHUMA && j->linhas[n].tipo == LINHA_ROTULO; n = proxima(j, n)) {
+        if (texto_igual(nome_rotulo(j, n), nome)) return 1;
+    }
+    return 0;
+}
+
+// --- Efeitos das instruções ---
+
+static uint32_t bit_registrador(Texto t) {
+    int r = registrador(t);
+    return r > 0 ? BIT(r) : 0;
+}
+
+// Registradores lidos e escritos pela instrução; uma desconhecida lê todos
+static void efeitos(const Instrucao* in, uint32_t* usos, uint32_t* defs) {
+    *usos = *defs = 0;
+    int formato = g_mnemonicos[in->mnemonico].formato;
+    if (formato == F_HILO && in->num_ops == 3) formato = F_CALCULO;
+    for (int k = 0; k < in->num_ops; k++) {
+        if (registrador(in->op[k]) == -2 || base_memoria(in->op[k]) == -2) formato = F_DESCONHECIDO;
+    }
+    switch (formato) {
+        case F_CALCULO:
+            *defs = bit_registrador(in->op[0]);
+            for (int k = 1; k < in->num_ops; k++) *usos |= bit_registrador(in->op[k]);
+            break;
+        case F_CARGA:
+            *defs = bit_registrador(in->op[0]);
+            if (in->num_ops > 1 && base_memoria(in->op[1]) > 0) *usos = BIT(base_memoria(in->op[1]));
+            break;
+        case F_GUARDA:
+            *usos = bit_registrador(in->op[0]);
+            if (in->num_ops > 1 && base_memoria(in->op[1]) > 0) *usos |= BIT(base_memoria(in->op[1]));
+            break;
+        case F_HILO:
+        case F_DESVIO_ZERO:
+        case F_DESVIO:
+        case F_RETORNO:
+            for (int k = 0; k < in->num_ops; k++) *usos |= bit_registrador(in->op[k]);
+            break;
+        case F_CHAMADA:
+        case F_CHAMADA_REG:
+            *usos = REGS_ARGUMENTOS | BIT(R_SP) | BIT(R_FP) | BIT(R_GP);
+            if (formato == F_CHAMADA_REG && in->num_ops > 0) *usos |= bit_registrador(in->op[in->num_ops - 1]);
+            *defs = REGS_CHAMADOR;
+            break;
+        case F_SYSCALL:
+            *usos = BIT(R_V0) | BIT(R_A0) | BIT(5);
+            break;
+        case F_SALTO:
+        case F_NOP:
+            break;
+        default:
+            *usos = TODOS;
+            break;
+    }
+}
+
+// Registrador escrito por uma instrução de cálculo ou carga (destino em op0), ou -1
+static int destino(const Instrucao* in) {
+    int formato = g_mnemonicos[in->mnemonico].formato;
+    if (formato == F_HILO && in->num_ops == 3) formato = F_CALCULO;
+    if ((formato != F_CALCULO && formato != F_CARGA) || in->num_ops < 2) return -1;
+    return registrador(in->op[0]);
+}
+
+// --- Regras locais ---
+
+static int eh(const Instrucao* in, Mnemonico m, int num_ops) {
+    return in->mnemonico == m && in->num_ops == num_ops;
+}
+
+// Rótulo de destino de um salto ou desvio (o último operando)
+static Texto* alvo_do_desvio(Instrucao* in) {
+    if (in->num_ops == 0) return NULL;
+    if (g_mnemonicos[in->mnemonico].formato == F_SALTO || eh_desvio((Mnemonico) in->mnemonico)) {
+        return &in->op[in->num_ops - 1];
+    }
+    return NULL;
+}
+
+// la $t9, L; jr $t9  ->  j L   (jalr -> jal)
+static int salto_direto(Janela* j, uint32_t i, Instrucao* in) {
+    if (!eh(in, M_LA, 2) || registrador(in->op[0]) != R_T9) return 0;
+    uint32_t n = vizinha_seguinte(j, i);
+    if (n == NENHUMA) return 0;
+    Instrucao prox;
+    decodificar(j, n, &prox);
+    if ((!eh(&prox, M_JR, 1) && !eh(&prox, M_JALR, 1)) || registrador(prox.op[0]) != R_T9) return 0;
+    Instrucao novo = { prox.mnemonico == M_JR ? M_J : M_JAL, 1, { in->op[1] } };
+    reescrever(j, i, &novo);
+    remover(j, n);
+    return 1;
+}
+
+// Desvio para um rótulo cuja primeira instrução é 'j M' vai direto para M
+static int encadeamento(Janela* j, uint32_t i, Instrucao* in) {
+    Texto* alvo = alvo_do_desvio(in);
+    if (alvo == NULL) return 0;
+    Texto vistos[MAXIMO_ENCADEAMENTO + 1];
+    Texto atual = *alvo;
+    int saltos = 0;
+    vistos[0] = atual;
+    while (saltos < MAXIMO_ENCADEAMENTO) {
+        uint32_t l = linha_do_rotulo(j, atual);
+        if (l == NENHUMA) break;
+        uint32_t f = proxima(j, l);
+        while (f != NENHUMA && j->linhas[f].tipo == LINHA_ROTULO) f = proxima(j, f);
+        if (f == NENHUMA) break;
+        Instrucao destino_salto;
+        decodificar(j, f, &destino_salto);
+        if (!eh(&destino_salto, M_J, 1) && !eh(&destino_salto, M_B, 1)) break;
+        // Laço de saltos: fica como está
+        for (int k = 0; k <= saltos; k++) {
+            if (texto_igual(vistos[k], destino_salto.op[0])) return 0;
+        }
+        atual = destino_salto.op[0];
+        vistos[++saltos] = atual;
+    }
+    if (saltos == 0) return 0;
+    *alvo = atual;
+    reescrever(j, i, in);
+    return 1;
+}
+
+// Salto ou desvio para um rótulo logo abaixo
+static int salto_seguinte(Janela* j, uint32_t i, Instrucao* in) {
+    Texto* alvo = alvo_do_desvio(in);
+    if (alvo == NULL || !rotulo_segue(j, i, *alvo)) return 0;
+    remover(j, i);
+    return 1;
+}
+
+// bCC L1; j L2; L1:  ->  b!CC L2; L1:
+static int inversao(Janela* j, uint32_t i, Instrucao* in) {
+    if (!eh_desvio((Mnemonico) in->mnemonico)) return 0;
+    uint32_t n = vizinha_seguinte(j, i);
+    if (n == NENHUMA) return 0;
+    Instrucao salto;
+    decodificar(j, n, &salto);
+    if (!eh(&salto, M_J, 1) && !eh(&salto, M_B, 1)) return 0;
+    Texto* alvo = alvo_do_desvio(in);
+    if (!rotulo_segue(j, n, *alvo)) return 0;
+    in->mnemonico = g_oposto[in->mnemonico];
+    *alvo = salto.op[0];
+    reescrever(j, i, in);
+    remover(j, n);
+    return 1;
+}
+
+static int eh_ajuste_pilha(const Instrucao* in, const char* delta) {
+    return eh(in, M_ADDIU, 3) && registrador(in->op[0]) == R_SP && registrador(in->op[1]) == R_SP &&
+           texto_igual(in->op[2], texto_de(delta));
+}
+
+static int eh_topo_pilha(const Instrucao* in, Mnemonico m) {
+    return eh(in, m, 2) && registrador(in->op[0]) > 0 && texto_igual(in->op[1], texto_de("0($sp)"));
+}
+
+/*
+ * addiu $sp, $sp, -4; sw R, 0($sp); [I;] lw T, 0($sp); addiu $sp, $sp, 4
+ *   ->  move T, R; [I]
+ * com I uma instrução de cálculo ou carga que não toca em $sp nem em T.
+ */
+static int pilha(Janela* j, uint32_t i, Instrucao* in) {
+    if (!eh_ajuste_pilha(in, "-4")) return 0;
+    uint32_t linhas[4];
+    Instrucao ins[4];
+    uint32_t atual = i;
+    for (int k = 0; k < 4; k++) {
+        linhas[k] = atual = vizinha_seguinte(j, atual);
+        if (atual == NENHUMA) {
+            if (k < 3) return 0;
+            break;
+        }
+        decodificar(j, atual, &ins[k]);
+    }
+    if (!eh_topo_pilha(&ins[0], M_SW) || registrador(ins[0].op[0]) == R_SP) return 0;
+    int meio = eh_topo_pilha(&ins[1], M_LW) ? 0 : 1;
+    if (linhas[meio + 2] == NENHUMA) return 0;
+    const Instrucao* desempilha = &ins[1 + meio];
+    if (!eh_topo_pilha(desempilha, M_LW) || !eh_ajuste_pilha(&ins[2 + meio], "4")) return 0;
+    int t = registrador(desempilha->op[0]);
+    if (meio) {
+        uint32_t usos, defs;
+        efeitos(&ins[1], &usos, &defs);
+        if (destino(&ins[1]) < 0 || ((usos | defs) & (BIT(R_SP) | BIT(t)))) return 0;
+    }
+    Instrucao mover = { M_MOVE, 2, { desempilha->op[0], ins[0].op[0] } };
+    reescrever(j, i, &mover);
+    remover(j, linhas[0]);
+    remover(j, linhas[1 + meio]);
+    remover(j, linhas[2 + meio]);
+    return 1;
+}
+
+/*
+ * sw R, X; lw T, X  ->  sw R, X; move T, R
+ * lw R, X; lw T, X  ->  lw R, X; move T, R
+ * lw R, X; sw R, X  ->  lw R, X
+ * sw R, X; sw S, X  ->  sw S, X
+ * (com X do mesmo jeito nas duas, e R fora do endereço)
+ */
+static int memoria(Janela* j, uint32_t i, Instrucao* in) {
+    if ((!eh(in, M_SW, 2) && !eh(in, M_LW, 2)) || registrador(in->op[0]) <= 0) return 0;
+    if (in->mnemonico == M_LW && base_memoria(in->op[1]) == registrador(in->op[0])) return 0;
+    uint32_t n = vizinha_seguinte(j, i);
+    if (n == NENHUMA) return 0;
+    Instrucao prox;
+    decodificar(j, n, &prox);
+    if ((!eh(&prox, M_SW, 2) && !eh(&prox, M_LW, 2)) || !texto_igual(in->op[1], prox.op[1]) ||
+        registrador(prox.op[0]) <= 0) {
+        return 0;
+    }
+    int mesmo = registrador(in->op[0]) == registrador(prox.op[0]);
+    if (prox.mnemonico == M_LW) {
+        if (mesmo) {
+            remover(j, n);
+        } else {
+            Instrucao mover = { M_MOVE, 2, { prox.op[0], in->op[0] } };
+            reescrever(j, n, &mover);
+        }
+        return 1;
+    }
+    if (in->mnemonico == M_LW) {
+        if (!mesmo) return 0;
+        remover(j, n);
+        return 1;
+    }
+    remover(j, i);
+    return 1;
+}
+
+// move R, R  some;  move A, B; move B, A  ->  move A, B
+static int movimento(Janela* j, uint32_t i, Instrucao* in) {
+    if (!eh(in, M_MOVE, 2) || registrador(in->op[0]) < 0) return 0;
+    if (registrador(in->op[0]) == registrador(in->op[1])) {
+        remover(j, i);
+        return 1;
+    }
+    uint32_t n = vizinha_seguinte(j, i);
+    if (n == NENHUMA) return 0;
+    Instrucao prox;
+    decodificar(j, n, &prox);
+    if (!eh(&prox, M_MOVE, 2) || registrador(prox.op[0]) != registrador(in->op[1]) ||
+        registrador(prox.op[1]) != registrador(in->op[0])) {
+        return 0;
+    }
+    remover(j, n);
+    return 1;
+}
+
+// --- Vivacidade ---
+
+// Linha para onde vai um 'jr R' precedido de 'la R, L', ou NENHUMA
+static uint32_t alvo_do_jr(const Janela* j, uint32_t i, const Instrucao* in) {
+    uint32_t p = vizinha_anterior(j, i);
+    if (p == NENHUMA) return NENHUMA;
+    Instrucao carga;
+    decodificar(j, p, &carga);
+    if (!eh(&carga, M_LA, 2) || registrador(carga.op[0]) != registrador(in->op[0])) return NENHUMA;
+    return linha_do_rotulo(j, carga.op[1]);
+}
+
+// 'syscall' logo depois de 'li $v0, 10': o programa acaba ali
+static int termina_programa(const Janela* j, uint32_t i) {
+    uint32_t p = vizinha_anterior(j, i);
+    if (p == NENHUMA) return 0;
+    Instrucao carga;
+    decodificar(j, p, &carga);
+    return eh(&carga, M_LI, 2) && registrador(carga.op[0]) == R_V0 && texto_igual(carga.op[1], texto_de("10"));
+}
+
+static uint32_t vivos_em(const Janela* j, uint32_t linha) {
+    return linha == NENHUMA ? TODOS : j->entrada[linha];
+}
+
+/*
+ * Vivos na saída da linha 'i', dados os vivos na entrada das sucessoras;
+ * 'seguinte' é a próxima linha (rótulo ou instrução), ou NENHUMA no fim.
+ */
+// Vivos no destino de um salto; um salto para trás pode pedir outra passada
+static uint32_t vivos_alvo(Janela* j, uint32_t i, uint32_t alvo) {
+    if (alvo <= i && alvo < j->menor_retorno) j->menor_retorno = alvo;
+    return vivos_em(j, alvo);
+}
+
+static uint32_t vivos_saida(Janela* j, uint32_t i, const Instrucao* in, uint32_t seguinte) {
+    if (j->linhas[i].tipo == LINHA_ROTULO) return vivos_em(j, seguinte);
+    int formato = g_mnemonicos[in->mnemonico].formato;
+    switch (formato) {
+        case F_SALTO:
+            return in->num_ops == 1 ? vivos_alvo(j, i, linha_do_rotulo(j, in->op[0])) : TODOS;
+        case F_DESVIO_ZERO:
+        case F_DESVIO:
+            return vivos_em(j, seguinte) | vivos_alvo(j, i, linha_do_rotulo(j, in->op[in->num_ops - 1]));
+        case F_RETORNO:
+            if (in->num_ops == 1 && registrador(in->op[0]) == R_RA) return VIVOS_RETORNO;
+            return vivos_alvo(j, i, alvo_do_jr(j, i, in));
+        case F_SYSCALL:
+            return termina_programa(j, i) ? 0 : vivos_em(j, seguinte);
+        default:
+            return vivos_em(j, seguinte);
+    }
+}
+
+static uint32_t vivos_entrada(const Instrucao* in, uint32_t saida) {
+    uint32_t usos, defs;
+    efeitos(in, &usos, &defs);
+    return usos | (saida & ~defs);
+}
+
+/*
+ * Ponto fixo, de trás para frente: os conjuntos só crescem a partir de
+ * vazios. Numa passada, só um salto para trás lê um valor antigo; se nenhuma
+ * linha a partir do menor desses destinos mudou depois, a passada já basta.
+ */
+static void calcular_vivacidade(Janela* j) {
+    memset(j->entrada, 0, j->num_linhas * sizeof(uint32_t));
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        j->menor_retorno = NENHUMA;
+        uint32_t seguinte = NENHUMA;
+        for (uint32_t i = j->num_linhas; i-- > 0;) {
+            uint8_t tipo = j->linhas[i].tipo;
+            if (tipo != LINHA_INSTRUCAO && tipo != LINHA_ROTULO) continue;
+            Instrucao in;
+            if (tipo == LINHA_INSTRUCAO) decodificar(j, i, &in);
+            uint32_t saida = vivos_saida(j, i, &in, seguinte);
+            uint32_t entrada = tipo == LINHA_ROTULO ? saida : vivos_entrada(&in, saida);
+            if (entrada != j->entrada[i]) {
+                j->entrada[i] = entrada;
+                if (i >= j->menor_retorno) mudou = 1;
+            }
+            seguinte = i;
+        }
+    }
+}
+
+// --- Regras com vivacidade ---
+
+static int ativa(const Janela* j, RegraJanela regra) {
+    return (j->regras >> regra) & 1u;
+}
+
+static void contar(Janela* j, RegraJanela regra) {
+    j->est->aplicacoes[regra]++;
+    j->mudou = 1;
+}
+
+// op R, ...; move T, R  (R morto depois)  ->  op T, ...
+static int copia(Janela* j, uint32_t i, Instrucao* in, uint32_t saida, uint32_t* linha) {
+    if (!eh(in, M_MOVE, 2)) return 0;
+    int t = registrador(in->op[0]), r = registrador(in->op[1]);
+    if (t <= 0 || r <= 0 || t == r || (saida & BIT(r)) || (BIT(r) & REGS_FIXOS)) return 0;
+    uint32_t p = vizinha_anterior(j, i);
+    if (p == NENHUMA) return 0;
+    Instrucao anterior_in;
+    decodificar(j, p, &anterior_in);
+    if (destino(&anterior_in) != r) return 0;
+    anterior_in.op[0] = in->op[0];
+    reescrever(j, p, &anterior_in);
+    remover(j, i);
+    *linha = p;
+    *in = anterior_in;
+    return 1;
+}
+
+// sCC R, A, B; beqz R, L  (R morto depois)  ->  b!CC A, B, L   (bnez: bCC)
+static int desvio(Janela* j, uint32_t i, Instrucao* in, uint32_t saida, uint32_t* linha) {
+    int negar;
+    if (eh(in, M_BEQZ, 2) || eh(in, M_BNEZ, 2)) {
+        negar = in->mnemonico == M_BEQZ;
+    } else if ((eh(in, M_BEQ, 3) || eh(in, M_BNE, 3)) && registrador(in->op[1]) == R_ZERO) {
+        negar = in->mnemonico == M_BEQ;
+    } else {
+        return 0;
+    }
+    int r = registrador(in->op[0]);
+    if (r <= 0 || (saida & BIT(r))) return 0;
+    uint32_t p = vizinha_anterior(j, i);
+    if (p == NENHUMA) return 0;
+    Instrucao comparacao;
+    decodificar(j, p, &comparacao);
+    uint8_t mnemonico = g_desvio_da_comparacao[comparacao.mnemonico];
+    if (mnemonico == 0 || comparacao.num_ops != 3 || registrador(comparacao.op[0]) != r ||
+        registrador(comparacao.op[1]) < 0 || registrador(comparacao.op[2]) < 0) {
+        return 0;
+    }
+    Instrucao novo = { negar ? g_oposto[mnemonico] : mnemonico, 3,
+                       { comparacao.op[1], comparacao.op[2], in->op[in->num_ops - 1] } };
+    reescrever(j, p, &novo);
+    remover(j, i);
+    *linha = p;
+    *in = novo;
+    return 1;
+}
+
+// Instrução pura cujo destino ninguém lê depois
+static int escrita_morta(Janela* j, uint32_t i, const Instrucao* in, uint32_t saida) {
+    int d = destino(in);
+    if (!g_mnemonicos[in->mnemonico].pura || d <= 0 || (saida & BIT(d)) || (BIT(d) & REGS_FIXOS)) return 0;
+    remover(j, i);
+    return 1;
+}
+
+/*
+ * Uma passada de trás para frente com os vivos do ponto fixo: cada regra
+ * olha os vivos na saída da instrução, e a entrada é refeita na hora, então
+ * o que uma regra remove já libera a de cima.
+ */
+static void aplicar_vivacidade(Janela* j) {
+    calcular_vivacidade(j);
+    uint32_t seguinte = NENHUMA;
+    for (uint32_t i = j->num_linhas; i-- > 0;) {
+        uint8_t tipo = j->linhas[i].tipo;
+        if (tipo != LINHA_INSTRUCAO && tipo != LINHA_ROTULO) continue;
+        Instrucao in;
+        if (tipo == LINHA_INSTRUCAO) decodificar(j, i, &in);
+        uint32_t saida = vivos_saida(j, i, &in, seguinte);
+        if (tipo == LINHA_INSTRUCAO) {
+            uint32_t linha = i;
+            if (ativa(j, JANELA_COPIA) && copia(j, i, &in, saida, &linha)) {
+                contar(j, JANELA_COPIA);
+            } else if (ativa(j, JANELA_DESVIO) && desvio(j, i, &in, saida, &linha)) {
+                contar(j, JANELA_DESVIO);
+            }
+            if (ativa(j, JANELA_ESCRITA_MORTA) && escrita_morta(j, linha, &in, saida)) {
+                contar(j, JANELA_ESCRITA_MORTA);
+                continue;
+            }
+            // A instrução fundida ocupa a linha de cima: a varredura continua dela
+            i = linha;
+        }
+        j->entrada[i] = tipo == LINHA_ROTULO ? saida : vivos_entrada(&in, saida);
+        seguinte = i;
+    }
+}
+
+// --- Tabela de regras ---
+
+typedef int (*RegraLocal)(Janela* j, uint32_t i, Instrucao* in);
+
+static const struct {
+    const char* nome;
+    RegraLocal aplicar;     // NULL: aplicada na passada com vivacidade
+} g_regras[JANELA_NUM_REGRAS] = {
+    [JANELA_SALTO_DIRETO] = { "salto_direto", salto_direto },
+    [JANELA_ENCADEAMENTO] = { "encadeamento", encadeamento },
+    [JANELA_SALTO_SEGUINTE] = { "salto_seguinte", salto_seguinte },
+    [JANELA_INVERSAO] = { "inversao", inversao },
+    [JANELA_PILHA] = { "pilha", pilha },
+    [JANELA_MEMORIA] = { "memoria", memoria },
+    [JANELA_MOVIMENTO] = { "movimento", movimento },
+    [JANELA_COPIA] = { "copia", NULL },
+    [JANELA_ESCRITA_MORTA] = { "escrita_morta", NULL },
+    [JANELA_DESVIO] = { "desvio", NULL },
+};
+
+const char* janela_nome_regra(RegraJanela regra) {
+    return regra < JANELA_NUM_REGRAS ? g_regras[regra].nome : "";
+}
+
+/*
+ * Uma passada para frente com as regras locais ativas: quando uma se aplica,
+ * as regras são tentadas de novo na mesma linha, se ela ainda existe.
+ */
+static void aplicar_locais(Janela* j) {
+    for (uint32_t i = 0; i < j->num_linhas && !j->sem_memoria; i++) {
+        int aplicou = 1;
+        while (aplicou && j->linhas[i].tipo == LINHA_INSTRUCAO) {
+            aplicou = 0;
+            Instrucao in;
+            decodificar(j, i, &in);
+            for (int r = 0; r < JANELA_NUM_REGRAS && !aplicou; r++) {
+                if (g_regras[r].aplicar == NULL || !ativa(j, (RegraJanela) r)) continue;
+                if (g_regras[r].aplicar(j, i, &in)) {
+                    contar(j, (RegraJanela) r);
+                    aplicou = 1;
+                }
+            }
+        }
+    }
+}
+
+// --- Entrada e saída ---
+
+static int dividir_linhas(Janela* j) {
+    uint32_t num = 1;
+    for (const char* p = j->texto; (p = memchr(p, '\n', (size_t) (j->texto + j->tamanho - p))) != NULL; p++) num++;
+    j->linhas = malloc(num * sizeof(Linha));
+    if (j->linhas == NULL) return -1;
+    int dados = 0;
+    size_t inicio = 0;
+    j->num_linhas = 0;
+    while (inicio < j->tamanho) {
+        Linha* l = &j->linhas[j->num_linhas++];
+        memset(l, 0, sizeof(Linha));
+        l->inicio = (uint32_t) inicio;
+        l->tamanho = LINHA_LONGA;
+        Texto linha = linha_texto(j, j->num_linhas - 1);
+        if (linha.n < LINHA_LONGA) l->tamanho = (uint16_t) linha.n;
+        inicio += linha.n + 1;
+        Texto t = aparar(linha);
+        l->tipo = LINHA_OUTRA;
+        if (t.n == 0 || t.s[0] == '#') continue;
+        if (t.s[0] == '.') {
+            // Cadeias e globais vão para .data no meio do código
+            if (t.n >= 5 && memcmp(t.s, ".data", 5) == 0) dados = 1;
+            if (t.n >= 5 && memcmp(t.s, ".text", 5) == 0) dados = 0;
+            continue;
+        }
+        if (dados) continue;
+        if (t.s[t.n - 1] == ':' && memchr(t.s, ' ', t.n) == NULL && t.s == j->texto + l->inicio) {
+            l->tipo = LINHA_ROTULO;
+            continue;
+        }
+        uint32_t k = 0;
+        while (k < t.n && t.s[k] != ' ' && t.s[k] != '\t') k++;
+        l->tipo = LINHA_INSTRUCAO;
+        l->mnemonico = (uint8_t) procurar_mnemonico((Texto) { t.s, k });
+    }
+    return 0;
+}
+
+static void escrever_instrucao(FILE* saida, const Instrucao* in) {
+    fprintf(saida, "  %s", g_mnemonicos[in->mnemonico].nome);
+    for (int k = 0; k < in->num_ops; k++) {
+        fprintf(saida, "%s%.*s", k == 0 ? " " : ", ", (int) in->op[k].n, in->op[k].s);
+    }
+    fputc('\n', saida);
+}
+
+static int escrever(const Janela* j, char** saida, size_t* tamanho_saida) {
+    FILE* f = open_memstream(saida, tamanho_saida);
+    if (f == NULL) return -1;
+    for (uint32_t i = 0; i < j->num_linhas; i++) {
+        if (j->linhas[i].tipo == LINHA_REMOVIDA) continue;
+        if (j->linhas[i].nova != 0) {
+            escrever_instrucao(f, &j->novas[j->linhas[i].nova - 1]);
+            continue;
+        }
+        Texto t = linha_texto(j, i);
+        fwrite(t.s, 1, t.n, f);
+        if (t.s + t.n < j->texto + j->tamanho) fputc('\n', f);
+    }
+    if (fclose(f) != 0) {
+        free(*saida);
+        *saida = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int otimizar_janela(const char* texto, size_t tamanho, unsigned mascara,
+                    char** saida, size_t* tamanho_saida, EstatisticasJanela* est) {
+    *saida = NULL;
+    *tamanho_saida = 0;
+    Janela j;
+    memset(&j, 0, sizeof(Janela));
+    j.texto = texto;
+    j.tamanho = tamanho;
+    j.regras = mascara & JANELA_TODAS;
+    j.est = est;
+    int resultado = -1;
+    if (tamanho >= UINT32_MAX) {
+        // Além do que as linhas endereçam: sai como entrou
+        j.regras = 0;
+    }
+    if (dividir_linhas(&j) != 0 || indexar_rotulos(&j) != 0) goto liberar;
+    j.entrada = malloc((j.num_linhas > 0 ? j.num_linhas : 1) * sizeof(uint32_t));
+    if (j.entrada == NULL) goto liberar;
+
+    unsigned com_vivacidade = (1u << JANELA_COPIA) | (1u << JANELA_ESCRITA_MORTA) | (1u << JANELA_DESVIO);
+    j.mudou = j.regras != 0;
+    for (int rodada = 0; rodada < MAXIMO_RODADAS && j.mudou && !j.sem_memoria; rodada++) {
+        j.mudou = 0;
+        aplicar_locais(&j);
+        if (j.regras & com_vivacidade) aplicar_vivacidade(&j);
+    }
+    if (!j.sem_memoria) resultado = escrever(&j, saida, tamanho_saida);
+
+liberar:
+    free(j.linhas);
+    free(j.novas);
+    free(j.rotulos);
+    free(j.entrada);
+    return resultado;
+}
+
+// --- Configuração e estatísticas ---
+
+int janela_ler_regras(const char* lista, unsigned* mascara) {
+    unsigned resultado = 0;
+    while (*lista != '\0') {
+        size_t n = strcspn(lista, ",");
+        Texto nome = { lista, (uint32_t) n };
+        if (texto_igual(nome, texto_de("todas"))) {
+            resultado = JANELA_TODAS;
+        } else if (!texto_igual(nome, texto_de("nenhuma"))) {
+            int r = 0;
+            while (r < JANELA_NUM_REGRAS && !texto_igual(nome, texto_de(g_regras[r].nome))) r++;
+            if (r == JANELA_NUM_REGRAS) return -1;
+            resultado |= 1u << r;
+        }
+        lista += n;
+        if (*lista == ',') lista++;
+    }
+    *mascara = resultado;
+    return 0;
+}
+
+void imprimir_estatisticas_janela(FILE* saida, const EstatisticasJanela* est) {
+    fprintf(saida, "--- Otimizacao por janela ---\n");
+    for (int r = 0; r < JANELA_NUM_REGRAS; r++) {
+        fprintf(saida, "  %-16s %u\n", g_regras[r].nome, est->aplicacoes[r]);
+    }
+}
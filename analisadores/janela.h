@@ -0,0 +1,70 @@
+#ifndef JANELA_H
+#define JANELA_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/*
+ * Otimização por janela (peephole) sobre o assembly MIPS já gerado, por
+ * qualquer um dos geradores. Uma tabela de regras reconhece sequências
+ * curtas de instruções vizinhas e as troca por outras mais baratas:
+ *
+ *   salto_direto     la $t9, L; jr $t9      ->  j L   (e jalr $t9 -> jal L)
+ *   encadeamento     desvio para um rótulo seguido de 'j M' vai direto para M
+ *   salto_seguinte   desvio ou salto para o rótulo logo abaixo some
+ *   inversao         bCC L1; j L2; L1:      ->  b!CC L2; L1:
+ *   pilha            empilha R; I; desempilha em T  ->  move T, R; I
+ *   memoria          sw R, X; lw T, X  ->  sw R, X; move T, R  (e lw/sw repetidos)
+ *   movimento        move R, R e move A, B; move B, A  (o segundo some)
+ *   copia            op R, ...; move T, R  (R morto)  ->  op T, ...
+ *   escrita_morta    instrução sem efeito colateral cujo resultado ninguém lê
+ *   desvio           slt R, A, B; beqz R, L  (R morto)  ->  bge A, B, L
+ *
+ * As três últimas consultam a vivacidade dos registradores, calculada sobre
+ * o grafo de fluxo do próprio assembly: uma chamada lê $a0..$a3 e destrói os
+ * registradores do chamador, e 'jr $ra' deixa vivos $v0 e os $s. Os rótulos
+ * chegam só por 'j', desvios e 'la $t9, L; jr $t9'; $t9 guarda apenas o
+ * endereço desses saltos e chamadas, nunca um valor lido no destino.
+ *
+ * As regras são aplicadas até nenhuma mudar mais nada.
+ */
+
+typedef enum {
+    JANELA_SALTO_DIRETO,
+    JANELA_ENCADEAMENTO,
+    JANELA_SALTO_SEGUINTE,
+    JANELA_INVERSAO,
+    JANELA_PILHA,
+    JANELA_MEMORIA,
+    JANELA_MOVIMENTO,
+    JANELA_COPIA,
+    JANELA_ESCRITA_MORTA,
+    JANELA_DESVIO,
+    JANELA_NUM_REGRAS
+} RegraJanela;
+
+#define JANELA_TODAS ((1u << JANELA_NUM_REGRAS) - 1)
+
+/* Quantas vezes cada regra foi aplicada */
+typedef struct {
+    unsigned aplicacoes[JANELA_NUM_REGRAS];
+} EstatisticasJanela;
+
+const char* janela_nome_regra(RegraJanela regra);
+
+/* Lê uma lista de nomes de regras separados por vírgula ("todas" e "nenhuma"
+ * também valem) para uma máscara (bit r = regra r). Retorna 0, ou -1 se
+ * algum nome não existe. */
+int janela_ler_regras(const char* lista, unsigned* mascara);
+
+/*
+ * Otimiza o assembly 'texto' com as regras de 'mascara' e devolve o novo em
+ * '*saida' (alocado com malloc, 'tamanho_saida' bytes). Soma as aplicações
+ * em 'est'. Retorna 0, ou -1 se faltar memória (sem nada para liberar).
+ */
+int otimizar_janela(const char* texto, size_t tamanho, unsigned mascara,
+                    char** saida, size_t* tamanho_saida, EstatisticasJanela* est);
+
+void imprimir_estatisticas_janela(FILE* saida, const EstatisticasJanela* est);
+
+#endif
@@ -0,0 +1,616 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "otimizador.h"
+#include "percurso.h"
+
+/*
+ * Estado da propagação: o valor conhecido de cada variável da função atual
+ * (locais no índice do slot, parâmetros depois dos locais). Dentro de um
+ * 'se' ou 'enquanto', cada alteração guarda o valor anterior no rastro, para
+ * que o estado da entrada possa ser restaurado (ramo senão, saída do laço)
+ * sem copiar o estado inteiro a cada nível de aninhamento.
+ */
+typedef struct {
+    uint32_t variavel;
+    uint8_t conhecido;
+    int32_t valor;
+} Alteracao;
+
+typedef struct {
+    Ast* ast;
+    EstatisticasOtimizacao* est;
+    NoAst programa;
+
+    uint8_t* conhecido;
+    int32_t* valor;
+    uint32_t* marca;        // Época em que a variável foi vista (ver ramo_entao)
+    uint32_t num_vars;
+    uint32_t capacidade_vars;
+    uint32_t num_locais;
+    uint32_t epoca;
+
+    Alteracao* rastro;
+    size_t tamanho_rastro;
+    size_t capacidade_rastro;
+    int abertos;            // 'se' e 'enquanto' em visita
+
+    int sem_memoria;
+} Dobrador;
+
+// Estado de um 'se' em visita, guardado em 'salvo' (e de um 'e' ou 'ou', cujo
+// operando direito é um ramo então sem senão)
+typedef struct {
+    size_t marca;           // Tamanho do rastro antes dos ramos
+    Alteracao* entao;       // Valores no fim do ramo então, das variáveis que ele alterou
+    uint32_t num_entao;
+} QuadroSe;
+
+// --- Aritmética ---
+
+// Valor de um nó constante. Retorna 0 se o nó não for constante.
+static int valor_constante(const Ast* ast, NoAst no, int32_t* valor) {
+    if (AST_TIPO(ast, no) == NO_INT_CONST) {
+        *valor = AST_VALOR_INT(ast, no);
+        return 1;
+    }
+    if (AST_TIPO(ast, no) == NO_CAR_CONST) {
+        *valor = AST_FOLHA(ast, no).valor;
+        return 1;
+    }
+    return 0;
+}
+
+/* Resultado de 'a op b' com a semântica do código gerado. Retorna 0 se o
+ * resultado deve ficar para a execução (estouro, divisão por zero). */
+static int calcular(TipoNo op, int32_t a, int32_t b, int32_t* r) {
+    int64_t x = a, y = b;
+    switch (op) {
+        case NO_SOMA:
+            if (x + y < INT32_MIN || x + y > INT32_MAX) return 0;
+            *r = (int32_t) (x + y);
+            return 1;
+        case NO_SUB:
+            if (x - y < INT32_MIN || x - y > INT32_MAX) return 0;
+            *r = (int32_t) (x - y);
+            return 1;
+        case NO_MULT:
+            // 'mul' guarda os 32 bits menos significativos
+            *r = (int32_t) (uint32_t) ((uint64_t) x * (uint64_t) y);
+            return 1;
+        case NO_DIV:
+            if (b == 0 || (a == INT32_MIN && b == -1)) return 0;
+            *r = a / b;
+            return 1;
+        case NO_IGUAL:       *r = a == b; return 1;
+        case NO_DIF:         *r = a != b; return 1;
+        case NO_MAIOR:       *r = a > b;  return 1;
+        case NO_MENOR:       *r = a < b;  return 1;
+        case NO_MAIOR_IGUAL: *r = a >= b; return 1;
+        case NO_MENOR_IGUAL: *r = a <= b; return 1;
+        case NO_E:           *r = (a != 0) && (b != 0); return 1;
+        case NO_OU:          *r = (a != 0) || (b != 0); return 1;
+        default:
+            return 0;
+    }
+}
+
+static int eh_binario(TipoNo tipo) {
+    return tipo >= NO_SOMA && tipo <= NO_OU;
+}
+
+// O operando esquerdo 'a' decide o 'e' ou o 'ou' sem o direito?
+static int decide(TipoNo tipo, int32_t a) {
+    return (tipo == NO_E && a == 0) || (tipo == NO_OU && a != 0);
+}
+
+// --- Transformações ---
+
+// Troca o nó por uma constante, mantendo o tipo do dado (int ou car)
+static void virar_constante(Ast* ast, NoAst no, int32_t valor) {
+    AST_TIPO(ast, no) = NO_INT_CONST;
+    AST_VALOR_INT(ast, no) = valor;
+    ast->primeiro_filho[no] = 0;
+}
+
+/* Põe 'por' (um comando) no lugar de 'no', que continua na mesma posição da
+ * lista; NO_NENHUM deixa um comando vazio */
+static void substituir(Ast* ast, NoAst no, NoAst por) {
+    if (por == NO_NENHUM) {
+        AST_TIPO(ast, no) = NO_NULO;
+        ast->primeiro_filho[no] = 0;
+        AST_VALOR_INT(ast, no) = 0;
+        return;
+    }
+    AST_TIPO(ast, no) = AST_TIPO(ast, por);
+    AST_TIPO_DADO(ast, no) = AST_TIPO_DADO(ast, por);
+    ast->primeiro_filho[no] = ast->primeiro_filho[por];
+    ast->dado[no] = ast->dado[por];
+    AST_LINHA(ast, no) = AST_LINHA(ast, por);
+}
+
+// --- Estado das variáveis ---
+
+// Índice da variável de um NO_ID, ou -1 se ela não é acompanhada (globais)
+static int64_t indice_variavel(const Dobrador* d, NoAst id) {
+    Ligacao lig = AST_LIGACAO(d->ast, id);
+    if (lig.slot < 0) return -1;
+    uint64_t i;
+    if (lig.classe == LIG_LOCAL) {
+        i = (uint64_t) lig.slot;
+    } else if (lig.classe == LIG_PARAMETRO) {
+        i = (uint64_t) d->num_locais + (uint64_t) lig.slot;
+    } else {
+        return -1;
+    }
+    return i < d->num_vars ? (int64_t) i : -1;
+}
+
+static void definir(Dobrador* d, uint32_t i, int conhecido, int32_t valor) {
+    if (d->abertos > 0) {
+        if (d->tamanho_rastro == d->capacidade_rastro) {
+            size_t nova = d->capacidade_rastro ? d->capacidade_rastro * 2 : 256;
+            Alteracao* rastro = realloc(d->rastro, nova * sizeof(Alteracao));
+            if (!rastro) {
+                // Sem como desfazer: daqui em diante nada é propagado
+                d->sem_memoria = 1;
+                d->num_vars = 0;
+                return;
+            }
+            d->rastro = rastro;
+            d->capacidade_rastro = nova;
+        }
+        Alteracao* a = &d->rastro[d->tamanho_rastro++];
+        a->variavel = i;
+        a->conhecido = d->conhecido[i];
+        a->valor = d->valor[i];
+    }
+    d->conhecido[i] = (uint8_t) conhecido;
+    d->valor[i] = valor;
+}
+
+static void esquecer_id(Dobrador* d, NoAst id) {
+    int64_t i = indice_variavel(d, id);
+    if (i >= 0 && d->conhecido[i]) definir(d, (uint32_t) i, 0, 0);
+}
+
+// Desfaz as alterações feitas depois que o rastro tinha 'marca' elementos
+static void desfazer_ate(Dobrador* d, size_t marca) {
+    while (d->tamanho_rastro > marca) {
+        Alteracao* a = &d->rastro[--d->tamanho_rastro];
+        if (a->variavel < d->num_vars) {
+            d->conhecido[a->variavel] = a->conhecido;
+            d->valor[a->variavel] = a->valor;
+        }
+    }
+}
+
+// Fecha um 'se' ou 'enquanto': fora de todos, o rastro não é mais necessário
+static void fechar(Dobrador* d) {
+    if (--d->abertos == 0) d->tamanho_rastro = 0;
+}
+
+// Começa uma função (ou o bloco principal) sem nenhum valor conhecido
+static void iniciar_quadro(Dobrador* d, uint32_t num_locais, uint32_t num_params) {
+    uint32_t n = num_locais + num_params;
+    if (d->sem_memoria) return;
+    if (n > d->capacidade_vars) {
+        uint8_t* conhecido = realloc(d->conhecido, n * sizeof(uint8_t));
+        if (conhecido) d->conhecido = conhecido;
+        int32_t* valor = realloc(d->valor, n * sizeof(int32_t));
+        if (valor) d->valor = valor;
+        uint32_t* marca = realloc(d->marca, n * sizeof(uint32_t));
+        if (marca) d->marca = marca;
+        if (!conhecido || !valor || !marca) {
+            d->sem_memoria = 1;
+            d->num_vars = 0;
+            return;
+        }
+        d->capacidade_vars = n;
+    }
+    if (n > 0) {
+        memset(d->conhecido, 0, n * sizeof(uint8_t));
+        memset(d->marca, 0, n * sizeof(uint32_t));
+    }
+    d->num_vars = n;
+    d->num_locais = num_locais;
+    d->epoca = 0;
+    d->tamanho_rastro = 0;
+}
+
+// --- Laços ---
+
+/* Avaliação de uma condição sem alterar a árvore: uma pilha de valores
+ * (conhecido ou não) e a indicação de que há efeitos colaterais */
+typedef struct {
+    const Dobrador* d;
+    int32_t* valores;
+    uint8_t* conhecidos;
+    size_t tamanho;
+    size_t capacidade;
+    int impura;
+    int sem_memoria;
+} Avaliacao;
+
+static void empilhar_valor(Avaliacao* a, int conhecido, int32_t valor) {
+    if (a->tamanho == a->capacidade) {
+        size_t nova = a->capacidade ? a->capacidade * 2 : 64;
+        int32_t* valores = realloc(a->valores, nova * sizeof(int32_t));
+        if (valores) a->valores = valores;
+        uint8_t* conhecidos = realloc(a->conhecidos, nova * sizeof(uint8_t));
+        if (conhecidos) a->conhecidos = conhecidos;
+        if (!valores || !conhecidos) {
+            a->sem_memoria = 1;
+            return;
+        }
+        a->capacidade = nova;
+    }
+    a->valores[a->tamanho] = valor;
+    a->conhecidos[a->tamanho] = (uint8_t) conhecido;
+    a->tamanho++;
+}
+
+static unsigned avaliar_entrada(void* dados, NoAst no, intptr_t* salvo) {
+    Avaliacao* a = (Avaliacao*) dados;
+    const Ast* ast = a->d->ast;
+    int32_t v;
+    switch (AST_TIPO(ast, no)) {
+        case NO_ID:
+        {
+            int64_t i = indice_variavel(a->d, no);
+            int conhecido = i >= 0 && a->d->conhecido[i];
+            empilhar_valor(a, conhecido, conhecido ? a->d->valor[i] : 0);
+            return PERCURSO_NENHUM;
+        }
+        case NO_CHAMADA_FUNC:
+        case NO_ATRIBUICAO:
+            a->impura = 1;
+            empilhar_valor(a, 0, 0);
+            return PERCURSO_NENHUM;
+        default:
+            if (valor_constante(ast, no, &v)) {
+                empilhar_valor(a, 1, v);
+                return PERCURSO_NENHUM;
+            }
+            return PERCURSO_TODOS;
+    }
+}
+
+static void avaliar_saida(void* dados, NoAst no, intptr_t salvo) {
+    Avaliacao* a = (Avaliacao*) dados;
+    TipoNo tipo = (TipoNo) AST_TIPO(a->d->ast, no);
+    if (a->sem_memoria) return;
+
+    if (tipo == NO_NEG && a->tamanho >= 1) {
+        a->valores[a->tamanho - 1] = a->valores[a->tamanho - 1] == 0;
+    } else if (eh_binario(tipo) && a->tamanho >= 2) {
+        size_t e = a->tamanho - 2;
+        int32_t r = 0;
+        int conhecido = a->conhecidos[e] && a->conhecidos[e + 1] &&
+                        calcular(tipo, a->valores[e], a->valores[e + 1], &r);
+        if (!conhecido && a->conhecidos[e] && decide(tipo, a->valores[e])) {
+            conhecido = 1;
+            r = tipo == NO_OU;
+        }
+        a->valores[e] = r;
+        a->conhecidos[e] = (uint8_t) conhecido;
+        a->tamanho--;
+    }
+}
+
+// A condição do laço é falsa na primeira avaliação e não tem efeitos colaterais?
+static int nunca_executa(Dobrador* d, NoAst condicao) {
+    static const VisitanteAst avaliacao = { avaliar_entrada, NULL, avaliar_saida };
+    Avaliacao a = { d, NULL, NULL, 0, 0, 0, 0 };
+    int resultado = 0;
+    if (percorrer_ast(d->ast, condicao, &avaliacao, &a) == 0 && !a.sem_memoria && !a.impura &&
+        a.tamanho == 1 && a.conhecidos[0] && a.valores[0] == 0) {
+        resultado = 1;
+    }
+    free(a.valores);
+    free(a.conhecidos);
+    return resultado;
+}
+
+// Esquece as variáveis atribuídas ou lidas em qualquer ponto do laço
+static unsigned esquecer_atribuidas(void* dados, NoAst no, intptr_t* salvo) {
+    Dobrador* d = (Dobrador*) dados;
+    switch (AST_TIPO(d->ast, no)) {
+        case NO_ATRIBUICAO:
+        case NO_LEIA:
+            esquecer_id(d, AST_FILHO(d->ast, no, 0));
+            return AST_TIPO(d->ast, no) == NO_ATRIBUICAO ? 1u << 1 : PERCURSO_NENHUM;
+        case NO_DECL_VAR:
+        case NO_ID:
+            return PERCURSO_NENHUM;
+        default:
+            return PERCURSO_TODOS;
+    }
+}
+
+// --- Percurso principal ---
+
+static unsigned entrar_no(void* dados, NoAst no, intptr_t* salvo) {
+    static const VisitanteAst atribuidas = { esquecer_atribuidas, NULL, NULL };
+    Dobrador* d = (Dobrador*) dados;
+    Ast* ast = d->ast;
+
+    switch (AST_TIPO(ast, no)) {
+        case NO_PROGRAMA:
+            d->programa = no;
+            iniciar_quadro(d, (uint32_t) AST_NUM_LOCAIS(ast, no), 0);
+            return PERCURSO_TODOS;
+
+        case NO_DECL_FUNC:
+        {
+            uint32_t num_params = 0;
+            for (NoAst p = AST_FILHO(ast, no, 1); p != NO_NENHUM; p = AST_PROX(ast, p)) num_params++;
+            iniciar_quadro(d, (uint32_t) AST_NUM_LOCAIS(ast, no), num_params);
+            return 1u << 2; // Corpo
+        }
+
+        case NO_DECL_VAR:
+        case NO_NULO:
+            return PERCURSO_NENHUM;
+
+        case NO_BLOCO:
+            // Os slots das declarações podem ter sido de variáveis de um bloco irmão
+            for (NoAst decl = AST_FILHO(ast, no, 0); decl != NO_NENHUM; decl = AST_PROX(ast, decl)) {
+                if (AST_TIPO(ast, decl) == NO_DECL_VAR) esquecer_id(d, AST_FILHO(ast, decl, 0));
+            }
+            return 1u << 1; // Comandos
+
+        case NO_ATRIBUICAO:
+        case NO_CHAMADA_FUNC:
+            return 1u << 1; // Valor; argumentos
+
+        case NO_LEIA:
+            esquecer_id(d, AST_FILHO(ast, no, 0));
+            return PERCURSO_NENHUM;
+
+        case NO_SE:
+        case NO_E:
+        case NO_OU:
+        {
+            QuadroSe* quadro = calloc(1, sizeof(QuadroSe));
+            if (!quadro) {
+                d->sem_memoria = 1;
+                d->num_vars = 0;
+                return PERCURSO_NENHUM;
+            }
+            d->abertos++;
+            *salvo = (intptr_t) quadro;
+            return PERCURSO_TODOS;
+        }
+
+        case NO_ENQUANTO:
+            if (nunca_executa(d, AST_FILHO(ast, no, 0))) {
+                *salvo = -1;
+                return PERCURSO_NENHUM;
+            }
+            d->abertos++;
+            if (percorrer_ast(ast, no, &atribuidas, d) != 0) {
+                d->sem_memoria = 1;
+                d->num_vars = 0;
+            }
+            *salvo = (intptr_t) d->tamanho_rastro;
+            return PERCURSO_TODOS;
+
+        case NO_ID:
+        {
+            // Só usos chegam aqui: alvos de atribuição, leia e chamada não são visitados
+            int64_t i = indice_variavel(d, no);
+            if (i >= 0 && d->conhecido[i]) {
+                virar_constante(ast, no, d->valor[i]);
+                d->est->propagados++;
+            }
+            return PERCURSO_NENHUM;
+        }
+
+        default:
+            return PERCURSO_TODOS;
+    }
+}
+
+// Guarda os valores do fim do ramo então e volta ao estado de antes dos ramos
+static void ramo_entao(Dobrador* d, QuadroSe* quadro) {
+    size_t n = d->tamanho_rastro - quadro->marca;
+    if (n > 0) {
+        quadro->entao = malloc(n * sizeof(Alteracao));
+        if (!quadro->entao) {
+            d->sem_memoria = 1;
+            d->num_vars = 0;
+            return;
+        }
+    }
+    uint32_t epoca = ++d->epoca;
+    for (size_t k = quadro->marca; k < d->tamanho_rastro; k++) {
+        uint32_t i = d->rastro[k].variavel;
+        if (i >= d->num_vars || d->marca[i] == epoca) continue;
+        d->marca[i] = epoca;
+        Alteracao* a = &quadro->entao[quadro->num_entao++];
+        a->variavel = i;
+        a->conhecido = d->conhecido[i];
+        a->valor = d->valor[i];
+    }
+    desfazer_ate(d, quadro->marca);
+}
+
+/* Junta os dois ramos: uma variável só continua conhecida se tem o mesmo
+ * valor no fim de ambos. O estado atual é o do fim do senão. */
+static void juntar_ramos(Dobrador* d, QuadroSe* quadro) {
+    uint32_t epoca = ++d->epoca;
+    for (uint32_t k = 0; k < quadro->num_entao; k++) {
+        const Alteracao* a = &quadro->entao[k];
+        if (a->variavel >= d->num_vars) continue;
+        d->marca[a->variavel] = epoca;
+        if (!a->conhecido || !d->conhecido[a->variavel] || d->valor[a->variavel] != a->valor) {
+            if (d->conhecido[a->variavel]) definir(d, a->variavel, 0, 0);
+        }
+    }
+    // Alteradas só no senão: no fim do então valem o que valiam antes dos ramos
+    size_t fim = d->tamanho_rastro;
+    for (size_t k = quadro->marca; k < fim; k++) {
+        Alteracao antes = d->rastro[k];
+        uint32_t i = antes.variavel;
+        if (i >= d->num_vars || d->marca[i] == epoca) continue;
+        d->marca[i] = epoca; // A primeira alteração do ramo guarda o valor de antes
+        if (!antes.conhecido || !d->conhecido[i] || d->valor[i] != antes.valor) {
+            if (d->conhecido[i]) definir(d, i, 0, 0);
+        }
+    }
+}
+
+// Só o ramo então executa: refaz o estado do fim dele
+static void refazer_entao(Dobrador* d, const QuadroSe* quadro) {
+    desfazer_ate(d, quadro->marca);
+    for (uint32_t k = 0; k < quadro->num_entao; k++) {
+        const Alteracao* alt = &quadro->entao[k];
+        if (alt->variavel < d->num_vars) definir(d, alt->variavel, alt->conhecido, alt->valor);
+    }
+}
+
+/*
+ * Saída de um 'e' ou 'ou'. O operando direito só executa se o esquerdo não
+ * decide: com o esquerdo constante, ele nunca executa (e o nó vira a
+ * constante) ou sempre executa; senão, o estado é a junção dele com o de
+ * antes dele.
+ */
+static void sair_logico(Dobrador* d, NoAst no, QuadroSe* quadro) {
+    Ast* ast = d->ast;
+    TipoNo tipo = (TipoNo) AST_TIPO(ast, no);
+    int32_t a, b, r;
+    if (quadro == NULL) return;
+    if (!valor_constante(ast, AST_FILHO(ast, no, 0), &a)) {
+        juntar_ramos(d, quadro);
+    } else if (decide(tipo, a)) {
+        virar_constante(ast, no, tipo == NO_OU);
+        d->est->dobrados++;
+    } else {
+        refazer_entao(d, quadro);
+        if (valor_constante(ast, AST_FILHO(ast, no, 1), &b) && calcular(tipo, a, b, &r)) {
+            virar_constante(ast, no, r);
+            d->est->dobrados++;
+        }
+    }
+    free(quadro->entao);
+    free(quadro);
+    fechar(d);
+}
+
+static void depois_filho(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo) {
+    Dobrador* d = (Dobrador*) dados;
+    TipoNo tipo = (TipoNo) AST_TIPO(d->ast, no);
+    if ((tipo != NO_SE && tipo != NO_E && tipo != NO_OU) || *salvo == 0) return;
+
+    QuadroSe* quadro = (QuadroSe*) *salvo;
+    if (filho == 0) {
+        quadro->marca = d->tamanho_rastro;
+    } else if (filho == 1) {
+        ramo_entao(d, quadro);
+    }
+}
+
+static void sair_no(void* dados, NoAst no, intptr_t salvo) {
+    Dobrador* d = (Dobrador*) dados;
+    Ast* ast = d->ast;
+    TipoNo tipo = (TipoNo) AST_TIPO(ast, no);
+    int32_t a, b, r;
+
+    if (tipo == NO_E || tipo == NO_OU) {
+        sair_logico(d, no, (QuadroSe*) salvo);
+        return;
+    }
+    if (eh_binario(tipo)) {
+        if (valor_constante(ast, AST_FILHO(ast, no, 0), &a) &&
+            valor_constante(ast, AST_FILHO(ast, no, 1), &b) && calcular(tipo, a, b, &r)) {
+            virar_constante(ast, no, r);
+            d->est->dobrados++;
+        }
+        return;
+    }
+
+    switch (tipo) {
+        case NO_NEG:
+            if (valor_constante(ast, AST_FILHO(ast, no, 0), &a)) {
+                virar_constante(ast, no, a == 0);
+                d->est->dobrados++;
+            }
+            break;
+
+        case NO_ATRIBUICAO:
+        {
+            int64_t i = indice_variavel(d, AST_FILHO(ast, no, 0));
+            if (i < 0) break;
+            if (valor_constante(ast, AST_FILHO(ast, no, 1), &a)) {
+                definir(d, (uint32_t) i, 1, a);
+            } else if (d->conhecido[i]) {
+                definir(d, (uint32_t) i, 0, 0);
+            }
+            break;
+        }
+
+        case NO_DECL_FUNC:
+            // De volta ao escopo do bloco principal, ainda sem valores conhecidos
+            iniciar_quadro(d, (uint32_t) AST_NUM_LOCAIS(ast, d->programa), 0);
+            break;
+
+        case NO_SE:
+        {
+            QuadroSe* quadro = (QuadroSe*) salvo;
+            if (quadro == NULL) break;
+            NoAst entao = AST_FILHO(ast, no, 1);
+            NoAst senao = AST_FILHO(ast, no, 2);
+            if (!valor_constante(ast, AST_FILHO(ast, no, 0), &a)) {
+                juntar_ramos(d, quadro);
+            } else {
+                if (a != 0) refazer_entao(d, quadro);
+                substituir(ast, no, a != 0 ? entao : senao);
+                d->est->desvios++;
+            }
+            free(quadro->entao);
+            free(quadro);
+            fechar(d);
+            break;
+        }
+
+        case NO_ENQUANTO:
+            if (salvo < 0) {
+                substituir(ast, no, NO_NENHUM);
+                d->est->lacos++;
+                break;
+            }
+            // Depois do laço, só vale o que já valia antes de cada iteração
+            desfazer_ate(d, (size_t) salvo);
+            fechar(d);
+            break;
+
+        default:
+            break;
+    }
+}
+
+int dobrar_constantes(Ast* ast, NoAst raiz, EstatisticasOtimizacao* est) {
+    static const VisitanteAst dobramento = { entrar_no, depois_filho, sair_no };
+    Dobrador d;
+    memset(&d, 0, sizeof(d));
+    d.ast = ast;
+    d.est = est;
+
+    int resultado = percorrer_ast(ast, raiz, &dobramento, &d);
+    free(d.conhecido);
+    free(d.valor);
+    free(d.marca);
+    free(d.rastro);
+    return resultado != 0 || d.sem_memoria ? -1 : 0;
+}
+
+void imprimir_estatisticas_otimizacao(FILE* saida, const EstatisticasOtimizacao* est) {
+    fprintf(saida, "--- Otimizacoes ---\n");
+    fprintf(saida, "  Nos dobrados: %u | Constantes propagadas: %u\n", est->dobrados, est->propagados);
+    fprintf(saida, "  Desvios com condicao constante: %u | Lacos removidos: %u\n", est->desvios, est->lacos);
+    fprintf(saida, "  Subexpressoes reaproveitadas: %u\n", est->subexpressoes);
+    fprintf(saida, "  Recursoes finais em laco: %u | Acumuladores: %u\n", est->recursoes_finais, est->acumuladores);
+    fprintf(saida, "  Chamadas integradas: %u\n", est->integradas);
+    fprintf(saida, "  Invariantes movidas: %u | Inducoes reduzidas: %u\n", est->invariantes, est->inducoes);
+}
@@ -0,0 +1,93 @@
+#ifndef OTIMIZADOR_H
+#define OTIMIZADOR_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "ri.h"
+
+/* Contagem das transformações feitas sobre a AST */
+typedef struct {
+    unsigned dobrados;      /* Operadores substituídos pelo resultado constante */
+    unsigned propagados;    /* Usos de variáveis substituídos pelo valor constante */
+    unsigned desvios;       /* 'se' com condição constante, trocados pelo ramo tomado */
+    unsigned lacos;         /* 'enquanto' que nunca executam, removidos */
+    unsigned subexpressoes; /* Subexpressões repetidas trocadas pelo valor já calculado */
+    unsigned recursoes_finais; /* Chamadas finais a si mesma trocadas por um salto */
+    unsigned acumuladores;  /* Funções em que 'retorne x * f(...)' ganhou um acumulador */
+    unsigned integradas;    /* Chamadas trocadas pelo corpo da função chamada */
+    unsigned invariantes;   /* Instruções invariantes levadas para antes do laço */
+    unsigned inducoes;      /* Produtos por variável de indução trocados por somas */
+} EstatisticasOtimizacao;
+
+/*
+ * Dobramento e propagação de constantes sobre a AST verificada pela análise
+ * semântica (os nós precisam das ligações). Operadores cujos operandos são
+ * constantes viram NO_INT_CONST (com o tipo do dado original); usos de
+ * variáveis locais e parâmetros com valor constante conhecido também. Um
+ * 'se' com condição constante é trocado pelo ramo tomado, e um 'enquanto'
+ * cuja condição (sem chamadas) é falsa na entrada é removido.
+ *
+ * O resultado em tempo de execução não muda: somas e subtrações que
+ * estourariam 32 bits (o 'add' do MIPS gera exceção) e divisões por zero
+ * ficam para a execução. Variáveis globais não são propagadas, pois
+ * qualquer chamada pode alterá-las.
+ *
+ * Soma as transformações em 'est'. Retorna 0, ou -1 se faltar memória (a
+ * árvore continua válida, só menos otimizada).
+ */
+int dobrar_constantes(Ast* ast, NoAst raiz, EstatisticasOtimizacao* est);
+
+/*
+ * Eliminação de subexpressões comuns por numeração de valores local
+ * (subexpressoes.c), em regiões de código em linha reta de cada função.
+ * Um operador que calcula de novo um valor já calculado na região (mesmos
+ * operandos, sem atribuição, 'leia' ou, para globais, chamada no meio) vira
+ * um NO_TEMP, e a primeira ocorrência vira um NO_GUARDA que guarda o valor
+ * num slot local novo, além dos da função.
+ *
+ * Soma as trocas em 'est'. Retorna 0, ou -1 se faltar memória (as trocas já
+ * feitas continuam válidas).
+ */
+int eliminar_subexpressoes(Ast* ast, NoAst raiz, EstatisticasOtimizacao* est);
+
+/*
+ * Eliminação da recursão final sobre a RI (ri_cauda.c), com as análises de
+ * ri_analisar feitas. Em cada função, 'retorne f(args)' da própria f vira
+ * cópias dos argumentos para os parâmetros e um salto de volta ao começo do
+ * corpo, e 'retorne x * f(args)' também, com um acumulador que multiplica
+ * os demais retornos. Refaz as análises das funções alteradas.
+ *
+ * Soma as trocas em 'est'. Retorna 0, ou -1 se faltar memória.
+ */
+int eliminar_recursao_final(ProgramaRI* prog, EstatisticasOtimizacao* est);
+
+/*
+ * Integração de funções sobre a RI (ri_integracao.c), depois da recursão
+ * final: uma chamada a uma função pequena, ou a uma chamada uma vez só no
+ * programa, vira uma cópia do corpo dela, com os registradores renomeados
+ * e cada 'retorne' trocado por uma cópia para o resultado e um salto. O
+ * limite de tamanho cresce com a profundidade de laços da chamada, e
+ * funções recursivas nunca são integradas. Se 'relatorio' não é NULL,
+ * escreve nele a decisão tomada em cada chamada. Refaz as análises das
+ * funções alteradas.
+ *
+ * Soma as integrações em 'est'. Retorna 0, ou -1 se faltar memória.
+ */
+int integrar_funcoes(ProgramaRI* prog, FILE* relatorio, EstatisticasOtimizacao* est);
+
+/*
+ * Otimizações de laços sobre a RI. Cada laço ganha um pré-cabeçalho, e as
+ * instruções invariantes (operandos definidos fora do laço) vão para ele;
+ * as que podem gerar exceção só saem do próprio cabeçalho. Um produto
+ * t = i * k, com i incrementado por uma constante no laço e k invariante,
+ * vira uma variável que soma c * k a cada passo. Refaz as análises das
+ * funções com laços.
+ *
+ * Soma as instruções movidas e reduzidas em 'est'. Retorna 0, ou -1 se
+ * faltar memória.
+ */
+int otimizar_lacos(ProgramaRI* prog, EstatisticasOtimizacao* est);
+
+void imprimir_estatisticas_otimizacao(FILE* saida, const EstatisticasOtimizacao* est);
+
+#endif
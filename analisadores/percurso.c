@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include "percurso.h"
+
+// Nó em visita na pilha de trabalho
+typedef struct {
+    NoAst no;
+    NoAst elemento;     // Elemento do filho em visita (NO_NENHUM antes do primeiro)
+    uint32_t indice;    // Posição de 'elemento' na lista do filho
+    uint8_t filho;      // Quantas posições de filho já passaram (na ordem pedida)
+    uint8_t mascara;    // Filhos pedidos por 'pre'
+    intptr_t salvo;
+} QuadroPercurso;
+
+typedef struct {
+    QuadroPercurso* quadros;
+    uint32_t tamanho;
+    uint32_t capacidade;
+} PilhaPercurso;
+
+// Empilha 'no' e chama o gancho de entrada
+static int entrar(PilhaPercurso* pilha, NoAst no, const VisitanteAst* v, void* dados) {
+    if (pilha->tamanho == pilha->capacidade) {
+        uint32_t nova = pilha->capacidade ? pilha->capacidade * 2 : 64;
+        QuadroPercurso* quadros = realloc(pilha->quadros, nova * sizeof(QuadroPercurso));
+        if (!quadros) return 0;
+        pilha->quadros = quadros;
+        pilha->capacidade = nova;
+    }
+    QuadroPercurso* q = &pilha->quadros[pilha->tamanho++];
+    q->no = no;
+    q->elemento = NO_NENHUM;
+    q->indice = 0;
+    q->filho = 0;
+    q->salvo = 0;
+    q->mascara = (uint8_t) (v->pre ? v->pre(dados, no, &q->salvo) : PERCURSO_TODOS);
+    return 1;
+}
+
+// Posição de filho em visita: a 'filho'-ésima da esquerda, ou da direita se invertido
+static int posicao(const QuadroPercurso* q, int num_filhos) {
+    return (q->mascara & PERCURSO_INVERTIDO) ? num_filhos - 1 - q->filho : q->filho;
+}
+
+int percorrer_ast(const Ast* ast, NoAst raiz, const VisitanteAst* v, void* dados) {
+    if (raiz == NO_NENHUM) return 0;
+
+    PilhaPercurso pilha = { NULL, 0, 0 };
+    if (!entrar(&pilha, raiz, v, dados)) return -1;
+
+    while (pilha.tamanho > 0) {
+        QuadroPercurso* q = &pilha.quadros[pilha.tamanho - 1];
+        int num_filhos = aridade(AST_TIPO(ast, q->no));
+        NoAst proximo = NO_NENHUM;
+
+        // Acabou de visitar 'elemento': segue na mesma lista ou passa ao próximo filho
+        if (q->elemento != NO_NENHUM) {
+            if (v->depois) v->depois(dados, q->no, posicao(q, num_filhos), q->elemento, q->indice, &q->salvo);
+            proximo = AST_PROX(ast, q->elemento);
+            q->indice++;
+            if (proximo == NO_NENHUM) q->filho++;
+        }
+        while (proximo == NO_NENHUM && q->filho < num_filhos) {
+            int filho = posicao(q, num_filhos);
+            if (q->mascara & (1u << filho)) {
+                proximo = AST_FILHO(ast, q->no, filho);
+                q->indice = 0;
+                if (proximo != NO_NENHUM) break;
+            }
+            q->filho++;
+        }
+
+        if (proximo == NO_NENHUM) {
+            if (v->pos) v->pos(dados, q->no, q->salvo);
+            pilha.tamanho--;
+            continue;
+        }
+        q->elemento = proximo;
+        if (!entrar(&pilha, proximo, v, dados)) {
+            free(pilha.quadros);
+            return -1;
+        }
+    }
+
+    free(pilha.quadros);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef PERCURSO_H
+#define PERCURSO_H
+
+#include <stdint.h>
+#include "ast.h"
+
+/*
+ * Percurso da AST com pilha explícita. A profundidade da árvore (listas de
+ * comandos, cadeias de 'senao se', expressões como a+b+c+...) só consome a
+ * pilha de trabalho, alocada no heap, e nunca a pilha de chamadas em C.
+ *
+ * Cada posição de filho de um nó é uma lista encadeada por 'prox' (com um
+ * elemento só, nos filhos que não são listas): o percurso visita todos os
+ * elementos, em ordem. Para cada nó visitado:
+ *
+ *   pre(no)                  ao entrar; devolve a máscara das posições de
+ *                            filhos a visitar (bit i = filho i), com
+ *                            PERCURSO_INVERTIDO para visitá-las da última
+ *                            para a primeira
+ *   depois(no, i, elemento)  após cada elemento visitado do filho i
+ *   pos(no)                  ao sair, depois de todos os filhos
+ *
+ * 'salvo' é um valor de cada nó, guardado entre as três chamadas: é onde os
+ * ganchos deixam o que a recursão guardaria em variáveis locais (o slot livre
+ * antes de um bloco, o primeiro rótulo de um 'se'...). Começa em 0.
+ */
+
+#define PERCURSO_NENHUM 0u
+#define PERCURSO_TODOS  7u
+#define PERCURSO_INVERTIDO 8u
+
+typedef struct {
+    unsigned (*pre)(void* dados, NoAst no, intptr_t* salvo);
+    void (*depois)(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo);
+    void (*pos)(void* dados, NoAst no, intptr_t salvo);
+} VisitanteAst;
+
+/*
+ * Visita 'raiz' e sua subárvore (sem os irmãos de 'raiz' na lista em que ela
+ * estiver). Ganchos nulos são ignorados; sem 'pre', todos os filhos são
+ * visitados. Retorna 0, ou -1 se faltar memória para a pilha de trabalho.
+ */
+int percorrer_ast(const Ast* ast, NoAst raiz, const VisitanteAst* visitante, void* dados);
+
+#endif
@@ -0,0 +1,290 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ri.h"
+
+// --- Construção ---
+
+RegRI ri_novo_reg(FuncaoRI* f) {
+    if (f->num_regs == RI_NENHUM - 1) return RI_NENHUM;
+    return f->num_regs++;
+}
+
+uint32_t ri_novo_bloco(FuncaoRI* f) {
+    if (f->num_blocos == f->capacidade_blocos) {
+        uint32_t nova = f->capacidade_blocos ? f->capacidade_blocos * 2 : 16;
+        BlocoRI* blocos = realloc(f->blocos, nova * sizeof(BlocoRI));
+        if (!blocos) return RI_NENHUM;
+        f->blocos = blocos;
+        f->capacidade_blocos = nova;
+    }
+    BlocoRI* b = &f->blocos[f->num_blocos];
+    memset(b, 0, sizeof(BlocoRI));
+    b->primeira = f->num_instrs;
+    return f->num_blocos++;
+}
+
+static int reservar_instrs(FuncaoRI* f, uint32_t n) {
+    if (f->num_instrs + n <= f->capacidade_instrs) return 1;
+    uint32_t nova = f->capacidade_instrs ? f->capacidade_instrs : 64;
+    while (nova < f->num_instrs + n) nova *= 2;
+    InstrRI* instrs = realloc(f->instrs, nova * sizeof(InstrRI));
+    if (!instrs) return 0;
+    f->instrs = instrs;
+    f->capacidade_instrs = nova;
+    return 1;
+}
+
+/*
+ * As instruções de um bloco só crescem no fim do array da função: um bloco
+ * que não está no fim é copiado para lá antes (a cópia antiga vira espaço
+ * perdido). A tradução preenche um bloco de cada vez, então só as passagens
+ * que editam blocos já prontos pagam a cópia.
+ */
+InstrRI* ri_inserir(FuncaoRI* f, uint32_t bloco, uint32_t pos) {
+    BlocoRI* b = &f->blocos[bloco];
+    if (b->primeira + b->num_instrs != f->num_instrs) {
+        if (!reservar_instrs(f, b->num_instrs + 1)) return NULL;
+        memcpy(&f->instrs[f->num_instrs], &f->instrs[b->primeira], b->num_instrs * sizeof(InstrRI));
+        b->primeira = f->num_instrs;
+        f->num_instrs += b->num_instrs;
+    } else if (!reservar_instrs(f, 1)) {
+        return NULL;
+    }
+    InstrRI* in = &f->instrs[b->primeira + pos];
+    memmove(in + 1, in, (b->num_instrs - pos) * sizeof(InstrRI));
+    b->num_instrs++;
+    f->num_instrs++;
+    memset(in, 0, sizeof(InstrRI));
+    in->d = in->a = in->b = RI_NENHUM;
+    return in;
+}
+
+void ri_remover(FuncaoRI* f, uint32_t bloco, uint32_t pos) {
+    BlocoRI* b = &f->blocos[bloco];
+    InstrRI* in = &f->instrs[b->primeira + pos];
+    memmove(in, in + 1, (b->num_instrs - pos - 1) * sizeof(InstrRI));
+    b->num_instrs--;
+    if (b->primeira + b->num_instrs + 1 == f->num_instrs) f->num_instrs--;
+}
+
+int ri_usos(const InstrRI* in, RegRI usos[2]) {
+    int n = 0;
+    switch ((OpRI) in->op) {
+        case RI_SOMA: case RI_SUB: case RI_MULT: case RI_DIV:
+        case RI_IGUAL: case RI_DIF: case RI_MAIOR: case RI_MENOR:
+        case RI_MAIOR_IGUAL: case RI_MENOR_IGUAL: case RI_E: case RI_OU:
+        case RI_DESVIO:
+            usos[n++] = in->a;
+            if (!in->imediato) usos[n++] = in->b;
+            break;
+        case RI_COPIA:
+        case RI_ESCREVA:
+        case RI_ESCREVA_CAR:
+        case RI_RETORNE:
+            if (!in->imediato && in->a != RI_NENHUM) usos[n++] = in->a;
+            break;
+        case RI_NAO:
+        case RI_GUARDA:
+            usos[n++] = in->a;
+            break;
+        default:
+            break;
+    }
+    return n;
+}
+
+RegRI ri_definicao(const InstrRI* in) {
+    switch ((OpRI) in->op) {
+        case RI_COPIA:
+        case RI_SOMA: case RI_SUB: case RI_MULT: case RI_DIV:
+        case RI_IGUAL: case RI_DIF: case RI_MAIOR: case RI_MENOR:
+        case RI_MAIOR_IGUAL: case RI_MENOR_IGUAL: case RI_E: case RI_OU:
+        case RI_NAO:
+        case RI_CARREGA:
+        case RI_ENDERECO:
+        case RI_LEIA:
+        case RI_CHAMADA:
+            return in->d;
+        default:
+            return RI_NENHUM;
+    }
+}
+
+// --- Liberação ---
+
+static void liberar_funcao(FuncaoRI* f) {
+    free(f->blocos);
+    free(f->instrs);
+    free(f->argumentos);
+    free(f->inicio_pred);
+    free(f->pred);
+    free(f->rpo);
+    free(f->ordem_rpo);
+    free(f->idom);
+    free(f->dom_pre);
+    free(f->dom_pos);
+    free(f->global_de);
+    free(f->globais_vivacidade);
+    free(f->vivos_entrada);
+    free(f->vivos_saida);
+    memset(f, 0, sizeof(FuncaoRI));
+}
+
+void ri_liberar(ProgramaRI* prog) {
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) liberar_funcao(&prog->funcoes[i]);
+    free(prog->funcoes);
+    liberar_funcao(&prog->principal);
+    free(prog->globais);
+    free(prog->cadeias);
+    memset(prog, 0, sizeof(ProgramaRI));
+}
+
+// --- Texto ---
+
+static const char* const g_simbolos[] = {
+    [RI_SOMA] = "+", [RI_SUB] = "-", [RI_MULT] = "*", [RI_DIV] = "/",
+    [RI_IGUAL] = "==", [RI_DIF] = "!=", [RI_MAIOR] = ">", [RI_MENOR] = "<",
+    [RI_MAIOR_IGUAL] = ">=", [RI_MENOR_IGUAL] = "<=", [RI_E] = "e", [RI_OU] = "ou",
+};
+
+// Locais 'l', parâmetros 'p' e temporários 't', cada um numerado a partir de 0
+static void imprimir_reg(FILE* saida, const FuncaoRI* f, RegRI r) {
+    if (r < f->num_locais) {
+        fprintf(saida, "l%u", r);
+    } else if (r < f->num_locais + f->num_params) {
+        fprintf(saida, "p%u", r - f->num_locais);
+    } else {
+        fprintf(saida, "t%u", r - f->num_locais - f->num_params);
+    }
+}
+
+// Último operando: registrador 'r', ou a constante se 'imediato'
+static void imprimir_operando(FILE* saida, const FuncaoRI* f, const InstrRI* in, RegRI r) {
+    if (in->imediato) {
+        fprintf(saida, "%d", in->k);
+    } else {
+        imprimir_reg(saida, f, r);
+    }
+}
+
+static void imprimir_instr(FILE* saida, const ProgramaRI* prog, const FuncaoRI* f, const BlocoRI* b,
+                           const InstrRI* in) {
+    fprintf(saida, "  ");
+    RegRI d = ri_definicao(in);
+    if (d != RI_NENHUM) {
+        imprimir_reg(saida, f, d);
+        fprintf(saida, " = ");
+    }
+    switch ((OpRI) in->op) {
+        case RI_COPIA:
+            imprimir_operando(saida, f, in, in->a);
+            break;
+        case RI_SOMA: case RI_SUB: case RI_MULT: case RI_DIV:
+        case RI_IGUAL: case RI_DIF: case RI_MAIOR: case RI_MENOR:
+        case RI_MAIOR_IGUAL: case RI_MENOR_IGUAL: case RI_E: case RI_OU:
+            imprimir_reg(saida, f, in->a);
+            fprintf(saida, " %s%s ", g_simbolos[in->op], in->circular ? "u" : "");
+            imprimir_operando(saida, f, in, in->b);
+            break;
+        case RI_NAO:
+            fprintf(saida, "!");
+            imprimir_reg(saida, f, in->a);
+            break;
+        case RI_CARREGA:
+            fprintf(saida, "@%s", prog->globais[in->k]);
+            break;
+        case RI_GUARDA:
+            fprintf(saida, "@%s = ", prog->globais[in->k]);
+            imprimir_reg(saida, f, in->a);
+            break;
+        case RI_ENDERECO:
+            fprintf(saida, "&%s", prog->funcoes[in->k].nome);
+            break;
+        case RI_LEIA:
+            fprintf(saida, "leia");
+            break;
+        case RI_ESCREVA:
+        case RI_ESCREVA_CAR:
+            fprintf(saida, in->op == RI_ESCREVA ? "escreva " : "escreva_car ");
+            imprimir_operando(saida, f, in, in->a);
+            break;
+        case RI_ESCREVA_CADEIA:
+            fprintf(saida, "escreva %.*s", prog->cadeias[in->k].tamanho, prog->cadeias[in->k].texto);
+            break;
+        case RI_NOVALINHA:
+            fprintf(saida, "novalinha");
+            break;
+        case RI_CHAMADA:
+            fprintf(saida, "%s(", prog->funcoes[in->k].nome);
+            for (uint32_t i = 0; i < in->b; i++) {
+                if (i > 0) fprintf(saida, ", ");
+                imprimir_reg(saida, f, RI_ARGUMENTOS(f, in)[i]);
+            }
+            fprintf(saida, ")");
+            break;
+        case RI_SALTO:
+            fprintf(saida, "salte B%u", b->sucessor[0]);
+            break;
+        case RI_DESVIO:
+            fprintf(saida, "desvie ");
+            imprimir_reg(saida, f, in->a);
+            fprintf(saida, " %s ", g_simbolos[in->cond]);
+            imprimir_operando(saida, f, in, in->b);
+            fprintf(saida, " ? B%u : B%u", b->sucessor[0], b->sucessor[1]);
+            break;
+        case RI_RETORNE:
+            fprintf(saida, "retorne");
+            if (in->imediato || in->a != RI_NENHUM) {
+                fprintf(saida, " ");
+                imprimir_operando(saida, f, in, in->a);
+            }
+            break;
+    }
+    fprintf(saida, "\n");
+}
+
+static void imprimir_funcao(FILE* saida, const ProgramaRI* prog, const FuncaoRI* f) {
+    fprintf(saida, "funcao %s(", f->nome);
+    for (uint32_t i = 0; i < f->num_params; i++) fprintf(saida, i > 0 ? ", p%u" : "p%u", i);
+    fprintf(saida, ")  ; locais: %u, temporarios: %u, blocos: %u\n", f->num_locais,
+            f->num_regs - f->num_locais - f->num_params, f->num_blocos);
+
+    for (uint32_t b = 0; b < f->num_blocos; b++) {
+        const BlocoRI* bloco = &f->blocos[b];
+        fprintf(saida, "B%u:", b);
+        if (f->ordem_rpo != NULL && f->ordem_rpo[b] == RI_NENHUM) {
+            fprintf(saida, "  ; inalcancavel\n");
+        } else {
+            if (f->inicio_pred != NULL) {
+                fprintf(saida, "  ; pred:");
+                for (uint32_t i = f->inicio_pred[b]; i < f->inicio_pred[b + 1]; i++) fprintf(saida, " B%u", f->pred[i]);
+                if (f->inicio_pred[b] == f->inicio_pred[b + 1]) fprintf(saida, " -");
+            }
+            if (f->idom != NULL && f->idom[b] != RI_NENHUM) fprintf(saida, " | idom: B%u", f->idom[b]);
+            if (f->vivos_entrada != NULL) {
+                fprintf(saida, " | vivos:");
+                int algum = 0;
+                for (uint32_t g = 0; g < f->num_globais_vivacidade; g++) {
+                    if (f->vivos_entrada[(size_t) b * f->palavras + g / 64] & (1ull << (g % 64))) {
+                        fprintf(saida, " ");
+                        imprimir_reg(saida, f, f->globais_vivacidade[g]);
+                        algum = 1;
+                    }
+                }
+                if (!algum) fprintf(saida, " -");
+            }
+            fprintf(saida, "\n");
+        }
+        for (uint32_t i = 0; i < bloco->num_instrs; i++) {
+            imprimir_instr(saida, prog, f, bloco, &f->instrs[bloco->primeira + i]);
+        }
+    }
+    fprintf(saida, "\n");
+}
+
+void ri_imprimir(FILE* saida, const ProgramaRI* prog) {
+    for (uint32_t i = 0; i < prog->num_globais; i++) fprintf(saida, "global @%s\n", prog->globais[i]);
+    if (prog->num_globais > 0) fprintf(saida, "\n");
+    imprimir_funcao(saida, prog, &prog->principal);
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) imprimir_funcao(saida, prog, &prog->funcoes[i]);
+}
@@ -0,0 +1,190 @@
+#ifndef RI_H
+#define RI_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ast.h"
+
+/*
+ * Representação intermediária (RI): código de três endereços sobre
+ * registradores virtuais, em blocos básicos com as arestas do grafo de fluxo
+ * de controle explícitas. Há uma FuncaoRI por NO_DECL_FUNC e uma para o
+ * bloco principal.
+ *
+ * Registradores virtuais de uma função, em ordem:
+ *   [0, num_locais)                   variáveis locais (o slot da análise semântica);
+ *   [num_locais, num_locais+num_params)  parâmetros, na ordem da declaração;
+ *   [num_locais+num_params, num_regs)    temporários.
+ * Locais e parâmetros podem ser definidos várias vezes; os temporários
+ * criados pela tradução têm uma única definição, exceto o resultado de um
+ * 'e' ou 'ou' usado como valor (1 num ramo, 0 no outro). Globais só são
+ * lidas e escritas por RI_CARREGA e RI_GUARDA.
+ *
+ * Cada bloco é uma sequência de instruções terminada por exatamente um
+ * RI_SALTO, RI_DESVIO ou RI_RETORNE. Os destinos dos desvios ficam no bloco
+ * ('sucessor'), não na instrução.
+ */
+
+typedef uint32_t RegRI;
+#define RI_NENHUM UINT32_MAX
+
+typedef enum {
+    RI_COPIA,       /* d = a | k */
+    RI_SOMA, RI_SUB, RI_MULT, RI_DIV,                  /* d = a op (b | k) */
+    RI_IGUAL, RI_DIF, RI_MAIOR, RI_MENOR, RI_MAIOR_IGUAL, RI_MENOR_IGUAL,
+    RI_E, RI_OU,    /* Lógicos: o resultado é 0 ou 1 */
+    RI_NAO,         /* d = (a == 0) */
+    RI_CARREGA,     /* d = global k */
+    RI_GUARDA,      /* global k = a */
+    RI_ENDERECO,    /* d = endereço da função k */
+    RI_LEIA,        /* d = inteiro lido */
+    RI_ESCREVA,     /* Escreve a | k como inteiro */
+    RI_ESCREVA_CAR, /* Escreve a | k como caractere */
+    RI_ESCREVA_CADEIA, /* Escreve a cadeia k do programa */
+    RI_NOVALINHA,
+    RI_CHAMADA,     /* d = função k (argumentos[a .. a+b)) */
+    /* Terminadores */
+    RI_SALTO,       /* Vai para sucessor[0] */
+    RI_DESVIO,      /* Se a cond (b | k): sucessor[0], senão sucessor[1] */
+    RI_RETORNE      /* Sai da função com a | k (ou sem valor, se a == RI_NENHUM e sem 'imediato') */
+} OpRI;
+
+typedef struct {
+    uint8_t op;         /* OpRI */
+    uint8_t imediato;   /* O último operando é a constante 'k': no lugar de 'b' nos operadores
+                           binários e no RI_DESVIO, de 'a' em RI_COPIA, RI_ESCREVA(_CAR)
+                           e RI_RETORNE */
+    uint8_t cond;       /* RI_DESVIO: a comparação (RI_IGUAL .. RI_MENOR_IGUAL) */
+    uint8_t circular;   /* RI_SOMA sem a exceção de estouro do 'add' (módulo 2^32, como
+                           a multiplicação); só as otimizações da RI a criam */
+    RegRI d, a, b;
+    int32_t k;
+} InstrRI;
+
+/* Bloco básico: as instruções ocupam instrs[primeira .. primeira+num_instrs)
+ * da função, não necessariamente na ordem dos blocos */
+typedef struct {
+    uint32_t primeira;
+    uint32_t num_instrs;
+    uint32_t sucessor[2];
+    uint8_t num_sucessores;
+} BlocoRI;
+
+typedef struct {
+    const char* nome;   /* Texto do átomo; bloco principal: "main" */
+    NoAst no;           /* NO_DECL_FUNC, ou NO_PROGRAMA */
+    uint32_t num_locais;
+    uint32_t num_params;
+    uint32_t num_regs;
+
+    BlocoRI* blocos;    /* O bloco 0 é a entrada */
+    uint32_t num_blocos;
+    uint32_t capacidade_blocos;
+    InstrRI* instrs;
+    uint32_t num_instrs;
+    uint32_t capacidade_instrs;
+    RegRI* argumentos;  /* Argumentos das chamadas */
+    uint32_t num_argumentos;
+    uint32_t capacidade_argumentos;
+
+    /* Grafo de fluxo derivado (ri_calcular_cfg): predecessores do bloco b em
+     * pred[inicio_pred[b] .. inicio_pred[b+1]) e blocos alcançáveis em pós-ordem
+     * reversa; ordem_rpo[b] é a posição de b (RI_NENHUM se inalcançável) */
+    uint32_t* inicio_pred;
+    uint32_t* pred;
+    uint32_t* rpo;
+    uint32_t num_rpo;
+    uint32_t* ordem_rpo;
+
+    /* Dominadores (ri_calcular_dominadores): idom[b], RI_NENHUM na entrada e
+     * nos blocos inalcançáveis; 'a' domina 'b' se o intervalo de 'b' na
+     * numeração da árvore ([dom_pre, dom_pos]) está dentro do de 'a' */
+    uint32_t* idom;
+    uint32_t* dom_pre;
+    uint32_t* dom_pos;
+
+    /* Vivacidade (ri_calcular_vivacidade), só dos registradores lidos antes
+     * de serem definidos em algum bloco; os demais nunca estão vivos entre
+     * blocos. 'global_de[r]' é o índice de r nos conjuntos (ou RI_NENHUM), e
+     * cada bloco tem 'palavras' palavras de vivos na entrada e na saída */
+    uint32_t* global_de;
+    RegRI* globais_vivacidade;
+    uint32_t num_globais_vivacidade;
+    uint32_t palavras;
+    uint64_t* vivos_entrada;
+    uint64_t* vivos_saida;
+} FuncaoRI;
+
+typedef struct {
+    const char* texto;  /* Lexema, com as aspas */
+    int tamanho;
+} CadeiaRI;
+
+typedef struct {
+    const Ast* ast;
+    FuncaoRI* funcoes;  /* Funções na ordem da declaração */
+    uint32_t num_funcoes;
+    FuncaoRI principal;
+    const char** globais; /* Textos dos átomos, na ordem da declaração */
+    uint32_t num_globais;
+    CadeiaRI* cadeias;
+    uint32_t num_cadeias;
+} ProgramaRI;
+
+/* --- Construção (ri_traducao.c e ri.c) --- */
+
+/* Traduz a AST verificada pela análise semântica (e talvez otimizada) para a
+ * RI, com as análises de ri_analisar feitas. Retorna 0, ou -1 se faltar
+ * memória (sem nada para liberar). */
+int ri_traduzir(const Ast* ast, NoAst raiz, ProgramaRI* prog);
+void ri_liberar(ProgramaRI* prog);
+
+/* Criação dentro de uma função. Retornam RI_NENHUM (ou NULL) se faltar memória. */
+RegRI ri_novo_reg(FuncaoRI* f);
+uint32_t ri_novo_bloco(FuncaoRI* f);
+/* Abre espaço para uma instrução na posição 'pos' do bloco e a devolve
+ * (válida até a próxima inserção na função) */
+InstrRI* ri_inserir(FuncaoRI* f, uint32_t bloco, uint32_t pos);
+void ri_remover(FuncaoRI* f, uint32_t bloco, uint32_t pos);
+
+#define RI_INSTR(f, b, i)     (&(f)->instrs[(f)->blocos[b].primeira + (i)])
+#define RI_TERMINADOR(f, b)   RI_INSTR(f, b, (f)->blocos[b].num_instrs - 1)
+#define RI_EH_TEMPORARIO(f, r) ((r) >= (f)->num_locais + (f)->num_params)
+
+/* Registradores lidos pela instrução: até dois, em 'usos' (o retorno é
+ * quantos). Numa RI_CHAMADA são os argumentos, lidos com RI_ARGUMENTOS. */
+int ri_usos(const InstrRI* in, RegRI usos[2]);
+#define RI_ARGUMENTOS(f, in)  (&(f)->argumentos[(in)->a])
+/* Registrador definido pela instrução, ou RI_NENHUM */
+RegRI ri_definicao(const InstrRI* in);
+
+/* --- Análises (ri_analise.c). Retornam 0, ou -1 se faltar memória. --- */
+
+/* Predecessores e pós-ordem reversa, a partir dos sucessores dos blocos.
+ * Deve ser chamada de novo depois de mudar o grafo. */
+int ri_calcular_cfg(FuncaoRI* f);
+/* Árvore de dominadores (Cooper, Harvey e Kennedy); precisa do grafo */
+int ri_calcular_dominadores(FuncaoRI* f);
+/* 'a' domina 'b'? (ambos alcançáveis) */
+int ri_domina(const FuncaoRI* f, uint32_t a, uint32_t b);
+/* Vivos na entrada e na saída de cada bloco; precisa do grafo */
+int ri_calcular_vivacidade(FuncaoRI* f);
+/* 'r' está vivo na entrada (ou saída) do bloco? */
+int ri_vivo_entrada(const FuncaoRI* f, uint32_t bloco, RegRI r);
+int ri_vivo_saida(const FuncaoRI* f, uint32_t bloco, RegRI r);
+
+/* Profundidade de laços de cada bloco ('profundidade' com num_blocos
+ * posições; até RI_PROFUNDIDADE_MAXIMA); precisa dos dominadores */
+#define RI_PROFUNDIDADE_MAXIMA 6
+int ri_calcular_profundidade(const FuncaoRI* f, uint8_t* profundidade);
+
+/* Calcula as três análises em todas as funções */
+int ri_analisar(ProgramaRI* prog);
+
+/* --- Texto (ri.c) --- */
+
+/* Escreve o programa em texto legível, com predecessores, dominador imediato
+ * e vivos na entrada de cada bloco (se calculados) */
+void ri_imprimir(FILE* saida, const ProgramaRI* prog);
+
+#endif
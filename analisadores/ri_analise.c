@@ -0,0 +1,372 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ri.h"
+
+// --- Grafo de fluxo ---
+
+int ri_calcular_cfg(FuncaoRI* f) {
+    uint32_t n = f->num_blocos;
+    free(f->inicio_pred);
+    free(f->pred);
+    free(f->rpo);
+    free(f->ordem_rpo);
+    f->inicio_pred = calloc((size_t) n + 1, sizeof(uint32_t));
+    f->rpo = malloc(n * sizeof(uint32_t));
+    f->ordem_rpo = malloc(n * sizeof(uint32_t));
+    f->pred = NULL;
+    f->num_rpo = 0;
+    // Pilha da busca em profundidade: o bloco e o próximo sucessor a visitar
+    uint32_t* pilha = malloc(n * sizeof(uint32_t));
+    uint8_t* proximo = calloc(n, sizeof(uint8_t));
+    if (!f->inicio_pred || !f->rpo || !f->ordem_rpo || !pilha || !proximo) {
+        free(pilha);
+        free(proximo);
+        return -1;
+    }
+
+    // Pós-ordem a partir da entrada; 'ordem_rpo' marca os blocos já vistos
+    for (uint32_t b = 0; b < n; b++) f->ordem_rpo[b] = RI_NENHUM;
+    uint32_t tamanho = 0, num_pos = 0;
+    if (n > 0) {
+        pilha[tamanho++] = 0;
+        f->ordem_rpo[0] = 0;
+    }
+    while (tamanho > 0) {
+        uint32_t b = pilha[tamanho - 1];
+        if (proximo[b] < f->blocos[b].num_sucessores) {
+            uint32_t s = f->blocos[b].sucessor[proximo[b]++];
+            if (f->ordem_rpo[s] == RI_NENHUM) {
+                f->ordem_rpo[s] = 0;
+                pilha[tamanho++] = s;
+            }
+        } else {
+            f->rpo[num_pos++] = b;
+            tamanho--;
+        }
+    }
+    for (uint32_t i = 0; i < num_pos / 2; i++) {
+        uint32_t t = f->rpo[i];
+        f->rpo[i] = f->rpo[num_pos - 1 - i];
+        f->rpo[num_pos - 1 - i] = t;
+    }
+    f->num_rpo = num_pos;
+    for (uint32_t i = 0; i < num_pos; i++) f->ordem_rpo[f->rpo[i]] = i;
+    free(pilha);
+    free(proximo);
+
+    // Predecessores, só dos blocos alcançáveis
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < num_pos; i++) {
+        const BlocoRI* bloco = &f->blocos[f->rpo[i]];
+        for (int s = 0; s < bloco->num_sucessores; s++) f->inicio_pred[bloco->sucessor[s] + 1]++;
+        total += bloco->num_sucessores;
+    }
+    for (uint32_t b = 0; b < n; b++) f->inicio_pred[b + 1] += f->inicio_pred[b];
+    f->pred = malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+    uint32_t* livre = malloc(((size_t) n + 1) * sizeof(uint32_t));
+    if (!f->pred || !livre) {
+        free(livre);
+        return -1;
+    }
+    memcpy(livre, f->inicio_pred, ((size_t) n + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < num_pos; i++) {
+        uint32_t b = f->rpo[i];
+        const BlocoRI* bloco = &f->blocos[b];
+        for (int s = 0; s < bloco->num_sucessores; s++) f->pred[livre[bloco->sucessor[s]]++] = b;
+    }
+    free(livre);
+    return 0;
+}
+
+// --- Dominadores ---
+
+static uint32_t intersectar(const FuncaoRI* f, uint32_t a, uint32_t b) {
+    while (a != b) {
+        while (f->ordem_rpo[a] > f->ordem_rpo[b]) a = f->idom[a];
+        while (f->ordem_rpo[b] > f->ordem_rpo[a]) b = f->idom[b];
+    }
+    return a;
+}
+
+/*
+ * Algoritmo iterativo de Cooper, Harvey e Kennedy ("A Simple, Fast Dominance
+ * Algorithm"): percorre os blocos em pós-ordem reversa até que nenhum
+ * dominador imediato mude. Depois numera a árvore em profundidade.
+ */
+int ri_calcular_dominadores(FuncaoRI* f) {
+    uint32_t n = f->num_blocos;
+    free(f->idom);
+    free(f->dom_pre);
+    free(f->dom_pos);
+    f->idom = malloc(n * sizeof(uint32_t));
+    f->dom_pre = malloc(n * sizeof(uint32_t));
+    f->dom_pos = malloc(n * sizeof(uint32_t));
+    if (!f->idom || !f->dom_pre || !f->dom_pos) return -1;
+    for (uint32_t b = 0; b < n; b++) f->idom[b] = f->dom_pre[b] = f->dom_pos[b] = RI_NENHUM;
+    if (f->num_rpo == 0) return 0;
+
+    uint32_t entrada = f->rpo[0];
+    f->idom[entrada] = entrada;
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (uint32_t i = 1; i < f->num_rpo; i++) {
+            uint32_t b = f->rpo[i];
+            uint32_t novo = RI_NENHUM;
+            // Predecessores de trás para frente na pós-ordem reversa: o
+            // resultado parcial só sobe na árvore, e um destino comum a uma
+            // cadeia de desvios (um 'e' ou 'ou' longo) não a refaz inteira
+            for (uint32_t p = f->inicio_pred[b + 1]; p-- > f->inicio_pred[b];) {
+                uint32_t q = f->pred[p];
+                if (f->idom[q] == RI_NENHUM) continue;
+                novo = novo == RI_NENHUM ? q : intersectar(f, q, novo);
+            }
+            if (novo != f->idom[b]) {
+                f->idom[b] = novo;
+                mudou = 1;
+            }
+        }
+    }
+    f->idom[entrada] = RI_NENHUM;
+
+    // Filhos de cada bloco na árvore, para a numeração
+    uint32_t* inicio = calloc((size_t) n + 1, sizeof(uint32_t));
+    uint32_t* filhos = malloc(n * sizeof(uint32_t));
+    uint32_t* pilha = malloc(n * sizeof(uint32_t));
+    uint32_t* proximo = malloc(n * sizeof(uint32_t));
+    if (!inicio || !filhos || !pilha || !proximo) {
+        free(inicio);
+        free(filhos);
+        free(pilha);
+        free(proximo);
+        return -1;
+    }
+    for (uint32_t b = 0; b < n; b++) {
+        if (f->idom[b] != RI_NENHUM) inicio[f->idom[b] + 1]++;
+    }
+    for (uint32_t b = 0; b < n; b++) inicio[b + 1] += inicio[b];
+    memcpy(proximo, inicio, n * sizeof(uint32_t));
+    for (uint32_t b = 0; b < n; b++) {
+        if (f->idom[b] != RI_NENHUM) filhos[proximo[f->idom[b]]++] = b;
+    }
+    memcpy(proximo, inicio, n * sizeof(uint32_t));
+
+    uint32_t tamanho = 0, contador = 0;
+    pilha[tamanho++] = entrada;
+    f->dom_pre[entrada] = contador++;
+    while (tamanho > 0) {
+        uint32_t b = pilha[tamanho - 1];
+        if (proximo[b] < inicio[b + 1]) {
+            uint32_t filho = filhos[proximo[b]++];
+            f->dom_pre[filho] = contador++;
+            pilha[tamanho++] = filho;
+        } else {
+            f->dom_pos[b] = contador++;
+            tamanho--;
+        }
+    }
+    free(inicio);
+    free(filhos);
+    free(pilha);
+    free(proximo);
+    return 0;
+}
+
+int ri_domina(const FuncaoRI* f, uint32_t a, uint32_t b) {
+    return f->dom_pre[a] <= f->dom_pre[b] && f->dom_pos[b] <= f->dom_pos[a];
+}
+
+// --- Vivacidade ---
+
+#define BIT(conjunto, g)  ((conjunto)[(g) / 64] & (1ull << ((g) % 64)))
+#define LIGAR(conjunto, g) ((conjunto)[(g) / 64] |= 1ull << ((g) % 64))
+
+/*
+ * Análise para trás, iterada em pós-ordem até o ponto fixo, sobre conjuntos
+ * de bits. Só entram nos conjuntos os registradores lidos num bloco antes de
+ * qualquer definição nele ("nomes globais" de Briggs): os outros, como os
+ * temporários de uma expressão, nunca estão vivos na fronteira de um bloco,
+ * e os conjuntos ficam pequenos mesmo com milhões de blocos.
+ */
+int ri_calcular_vivacidade(FuncaoRI* f) {
+    uint32_t n = f->num_blocos;
+    free(f->global_de);
+    free(f->globais_vivacidade);
+    free(f->vivos_entrada);
+    free(f->vivos_saida);
+    f->globais_vivacidade = NULL;
+    f->vivos_entrada = f->vivos_saida = NULL;
+    f->num_globais_vivacidade = 0;
+    f->global_de = malloc(((size_t) f->num_regs + 1) * sizeof(uint32_t));
+    uint32_t* definido_em = malloc(((size_t) f->num_regs + 1) * sizeof(uint32_t));
+    if (!f->global_de || !definido_em) {
+        free(definido_em);
+        return -1;
+    }
+    for (uint32_t r = 0; r < f->num_regs; r++) f->global_de[r] = definido_em[r] = RI_NENHUM;
+
+    // Nomes globais: lidos antes de definidos em algum bloco alcançável
+    uint32_t capacidade = 0;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            RegRI usos[2];
+            int nu = ri_usos(in, usos);
+            uint32_t na = in->op == RI_CHAMADA ? in->b : 0;
+            for (uint32_t u = 0; u < nu + na; u++) {
+                RegRI r = u < (uint32_t) nu ? usos[u] : RI_ARGUMENTOS(f, in)[u - nu];
+                if (definido_em[r] == b || f->global_de[r] != RI_NENHUM) continue;
+                if (f->num_globais_vivacidade == capacidade) {
+                    capacidade = capacidade ? capacidade * 2 : 64;
+                    RegRI* globais = realloc(f->globais_vivacidade, capacidade * sizeof(RegRI));
+                    if (!globais) {
+                        free(definido_em);
+                        return -1;
+                    }
+                    f->globais_vivacidade = globais;
+                }
+                f->global_de[r] = f->num_globais_vivacidade;
+                f->globais_vivacidade[f->num_globais_vivacidade++] = r;
+            }
+            RegRI d = ri_definicao(in);
+            if (d != RI_NENHUM) definido_em[d] = b;
+        }
+    }
+    free(definido_em);
+
+    uint32_t palavras = (f->num_globais_vivacidade + 63) / 64;
+    f->palavras = palavras;
+    size_t total = (size_t) n * palavras;
+    f->vivos_entrada = calloc(total > 0 ? total : 1, sizeof(uint64_t));
+    f->vivos_saida = calloc(total > 0 ? total : 1, sizeof(uint64_t));
+    uint64_t* gerados = calloc(total > 0 ? total : 1, sizeof(uint64_t));  // Lidos antes de definidos
+    uint64_t* mortos = calloc(total > 0 ? total : 1, sizeof(uint64_t));   // Definidos no bloco
+    if (!f->vivos_entrada || !f->vivos_saida || !gerados || !mortos) {
+        free(gerados);
+        free(mortos);
+        return -1;
+    }
+    if (palavras == 0) {
+        free(gerados);
+        free(mortos);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        uint64_t* gen = &gerados[(size_t) b * palavras];
+        uint64_t* kill = &mortos[(size_t) b * palavras];
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            RegRI usos[2];
+            int nu = ri_usos(in, usos);
+            uint32_t na = in->op == RI_CHAMADA ? in->b : 0;
+            for (uint32_t u = 0; u < nu + na; u++) {
+                RegRI r = u < (uint32_t) nu ? usos[u] : RI_ARGUMENTOS(f, in)[u - nu];
+                uint32_t g = f->global_de[r];
+                if (g != RI_NENHUM && !BIT(kill, g)) LIGAR(gen, g);
+            }
+            RegRI d = ri_definicao(in);
+            if (d != RI_NENHUM && f->global_de[d] != RI_NENHUM) LIGAR(kill, f->global_de[d]);
+        }
+    }
+
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (uint32_t i = f->num_rpo; i-- > 0;) {
+            uint32_t b = f->rpo[i];
+            uint64_t* saida = &f->vivos_saida[(size_t) b * palavras];
+            uint64_t* entrada = &f->vivos_entrada[(size_t) b * palavras];
+            const uint64_t* gen = &gerados[(size_t) b * palavras];
+            const uint64_t* kill = &mortos[(size_t) b * palavras];
+            const BlocoRI* bloco = &f->blocos[b];
+            for (uint32_t w = 0; w < palavras; w++) {
+                uint64_t s = 0;
+                for (int k = 0; k < bloco->num_sucessores; k++) {
+                    s |= f->vivos_entrada[(size_t) bloco->sucessor[k] * palavras + w];
+                }
+                saida[w] = s;
+                uint64_t e = gen[w] | (s & ~kill[w]);
+                if (e != entrada[w]) {
+                    entrada[w] = e;
+                    mudou = 1;
+                }
+            }
+        }
+    }
+    free(gerados);
+    free(mortos);
+    return 0;
+}
+
+int ri_vivo_entrada(const FuncaoRI* f, uint32_t bloco, RegRI r) {
+    uint32_t g = f->global_de[r];
+    return g != RI_NENHUM && BIT(&f->vivos_entrada[(size_t) bloco * f->palavras], g);
+}
+
+int ri_vivo_saida(const FuncaoRI* f, uint32_t bloco, RegRI r) {
+    uint32_t g = f->global_de[r];
+    return g != RI_NENHUM && BIT(&f->vivos_saida[(size_t) bloco * f->palavras], g);
+}
+
+// --- Laços ---
+
+/*
+ * Cada aresta de volta b -> h (h domina b) fecha o laço natural de h, os
+ * blocos que chegam a b sem passar por h. As arestas de volta de um mesmo
+ * cabeçalho formam um laço só.
+ */
+int ri_calcular_profundidade(const FuncaoRI* f, uint8_t* profundidade) {
+    uint32_t* marca = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    uint32_t* pilha = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    if (!marca || !pilha) {
+        free(marca);
+        free(pilha);
+        return -1;
+    }
+    memset(profundidade, 0, f->num_blocos);
+    for (uint32_t b = 0; b < f->num_blocos; b++) marca[b] = RI_NENHUM;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t h = f->rpo[i], topo = 0;
+        for (uint32_t p = f->inicio_pred[h]; p < f->inicio_pred[h + 1]; p++) {
+            uint32_t origem = f->pred[p];
+            if (f->ordem_rpo[origem] == RI_NENHUM || !ri_domina(f, h, origem) || marca[origem] == h) continue;
+            marca[origem] = h;
+            pilha[topo++] = origem;
+        }
+        if (topo == 0) continue;
+        marca[h] = h;
+        if (profundidade[h] < RI_PROFUNDIDADE_MAXIMA) profundidade[h]++;
+        while (topo > 0) {
+            uint32_t x = pilha[--topo];
+            if (x == h) continue;
+            if (profundidade[x] < RI_PROFUNDIDADE_MAXIMA) profundidade[x]++;
+            for (uint32_t p = f->inicio_pred[x]; p < f->inicio_pred[x + 1]; p++) {
+                uint32_t y = f->pred[p];
+                if (f->ordem_rpo[y] == RI_NENHUM || marca[y] == h) continue;
+                marca[y] = h;
+                pilha[topo++] = y;
+            }
+        }
+    }
+    free(marca);
+    free(pilha);
+    return 0;
+}
+
+// --- Todas as análises ---
+
+static int analisar_funcao(FuncaoRI* f) {
+    if (ri_calcular_cfg(f) != 0 || ri_calcular_dominadores(f) != 0) return -1;
+    return ri_calcular_vivacidade(f);
+}
+
+int ri_analisar(ProgramaRI* prog) {
+    if (analisar_funcao(&prog->principal) != 0) return -1;
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) {
+        if (analisar_funcao(&prog->funcoes[i]) != 0) return -1;
+    }
+    return 0;
+}
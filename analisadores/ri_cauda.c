@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <string.h>
+#include "otimizador.h"
+
+/*
+ * Recursão final sobre a RI. Um bloco que termina em
+ *
+ *   c = CHAMADA f(args); RETORNE c                 (chamada final)
+ *   c = CHAMADA f(args); t = x * c; RETORNE t      (com acumulador)
+ *
+ * dentro da própria f vira cópias dos argumentos para os parâmetros e um
+ * salto de volta ao começo do corpo, que passa a um bloco novo: a entrada
+ * fica só com o salto (e com acc = 1, se há acumulador). Com acumulador, o
+ * bloco faz acc = acc * x antes das cópias e todo outro retorno v de f vira
+ * RETORNE acc * v. Só a multiplicação entra: o 'mul' do MIPS não gera
+ * exceção, então reassociar o produto não muda o resultado, enquanto uma
+ * soma reassociada poderia estourar onde a original não estourava.
+ */
+
+typedef struct {
+    uint32_t bloco;
+    uint32_t chamada;   /* Posição da CHAMADA no bloco */
+    int acumula;        /* Há a multiplicação entre a chamada e o retorno */
+    InstrRI mult;
+} ChamadaFinal;
+
+// Chamada final de 'f' (índice 'indice') a si mesma no fim do bloco 'b'?
+static int chamada_final(const FuncaoRI* f, uint32_t indice, uint32_t b, ChamadaFinal* cf) {
+    const BlocoRI* bloco = &f->blocos[b];
+    const InstrRI* ret = RI_TERMINADOR(f, b);
+    if (ret->op != RI_RETORNE || ret->imediato || ret->a == RI_NENHUM || bloco->num_instrs < 2) return 0;
+
+    const InstrRI* anterior = RI_INSTR(f, b, bloco->num_instrs - 2);
+    if (anterior->op == RI_CHAMADA && anterior->k == (int32_t) indice && anterior->d == ret->a) {
+        cf->bloco = b;
+        cf->chamada = bloco->num_instrs - 2;
+        cf->acumula = 0;
+        return 1;
+    }
+    if (anterior->op != RI_MULT || anterior->d != ret->a || bloco->num_instrs < 3) return 0;
+    const InstrRI* ch = RI_INSTR(f, b, bloco->num_instrs - 3);
+    if (ch->op != RI_CHAMADA || ch->k != (int32_t) indice) return 0;
+    InstrRI mult = *anterior;
+    if (!mult.imediato && mult.b == ch->d && mult.a != ch->d) {
+        // x * c com o resultado da chamada à direita: o produto comuta
+        mult.b = mult.a;
+        mult.a = ch->d;
+    }
+    if (mult.a != ch->d || (!mult.imediato && mult.b == ch->d)) return 0;
+    cf->bloco = b;
+    cf->chamada = bloco->num_instrs - 3;
+    cf->acumula = 1;
+    cf->mult = mult;
+    return 1;
+}
+
+static InstrRI* acrescentar(FuncaoRI* f, uint32_t b, OpRI op) {
+    InstrRI* in = ri_inserir(f, b, f->blocos[b].num_instrs);
+    if (in != NULL) in->op = (uint8_t) op;
+    return in;
+}
+
+// Troca a chamada final 'cf' por cópias para os parâmetros e um salto para 'cabecalho'
+static int trocar_por_salto(FuncaoRI* f, const ChamadaFinal* cf, uint32_t cabecalho, RegRI acc) {
+    uint32_t b = cf->bloco;
+    InstrRI chamada = *RI_INSTR(f, b, cf->chamada);
+    f->blocos[b].num_instrs = cf->chamada;
+
+    if (cf->acumula) {
+        InstrRI* in = acrescentar(f, b, RI_MULT);
+        if (in == NULL) return -1;
+        in->d = acc;
+        in->a = acc;
+        in->imediato = cf->mult.imediato;
+        in->b = cf->mult.b;
+        in->k = cf->mult.k;
+    }
+
+    // Cópia paralela: um argumento que lê outro parâmetro passa antes por um temporário
+    RegRI param = f->num_locais;
+    RegRI* origem = malloc((chamada.b > 0 ? chamada.b : 1) * sizeof(RegRI));
+    if (origem == NULL) return -1;
+    for (uint32_t i = 0; i < chamada.b; i++) {
+        RegRI arg = f->argumentos[chamada.a + i];
+        origem[i] = arg;
+        if (arg == param + i || RI_EH_TEMPORARIO(f, arg) || arg < f->num_locais) continue;
+        RegRI t = ri_novo_reg(f);
+        InstrRI* in = t == RI_NENHUM ? NULL : acrescentar(f, b, RI_COPIA);
+        if (in == NULL) {
+            free(origem);
+            return -1;
+        }
+        in->d = t;
+        in->a = arg;
+        origem[i] = t;
+    }
+    for (uint32_t i = 0; i < chamada.b; i++) {
+        if (origem[i] == param + i) continue;
+        InstrRI* in = acrescentar(f, b, RI_COPIA);
+        if (in == NULL) {
+            free(origem);
+            return -1;
+        }
+        in->d = param + i;
+        in->a = origem[i];
+    }
+    free(origem);
+
+    if (acrescentar(f, b, RI_SALTO) == NULL) return -1;
+    f->blocos[b].sucessor[0] = cabecalho;
+    f->blocos[b].num_sucessores = 1;
+    return 0;
+}
+
+// RETORNE v vira RETORNE acc * v
+static int multiplicar_retorno(FuncaoRI* f, uint32_t b, RegRI acc) {
+    InstrRI ret = *RI_TERMINADOR(f, b);
+    if (ret.op != RI_RETORNE || (!ret.imediato && ret.a == RI_NENHUM)) return 0;
+    if (ret.imediato && ret.k == 1) {
+        InstrRI* in = RI_TERMINADOR(f, b);
+        in->imediato = 0;
+        in->a = acc;
+        return 0;
+    }
+    RegRI t = ri_novo_reg(f);
+    InstrRI* in = t == RI_NENHUM ? NULL : ri_inserir(f, b, f->blocos[b].num_instrs - 1);
+    if (in == NULL) return -1;
+    in->op = RI_MULT;
+    in->d = t;
+    in->a = acc;
+    in->imediato = ret.imediato;
+    in->b = ret.imediato ? RI_NENHUM : ret.a;
+    in->k = ret.k;
+    in = RI_TERMINADOR(f, b);
+    in->imediato = 0;
+    in->a = t;
+    return 0;
+}
+
+static int eliminar_na_funcao(FuncaoRI* f, uint32_t indice, EstatisticasOtimizacao* est) {
+    ChamadaFinal* finais = malloc(((size_t) f->num_blocos + 1) * sizeof(ChamadaFinal));
+    if (finais == NULL) return -1;
+    uint32_t num_finais = 0;
+    int acumula = 0;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        if (chamada_final(f, indice, f->rpo[i], &finais[num_finais])) {
+            acumula |= finais[num_finais].acumula;
+            num_finais++;
+        }
+    }
+    if (num_finais == 0) {
+        free(finais);
+        return 0;
+    }
+
+    // O corpo passa para o cabeçalho do laço; a entrada só salta para ele
+    uint32_t cabecalho = ri_novo_bloco(f);
+    RegRI acc = acumula ? ri_novo_reg(f) : RI_NENHUM;
+    if (cabecalho == RI_NENHUM || (acumula && acc == RI_NENHUM)) {
+        free(finais);
+        return -1;
+    }
+    f->blocos[cabecalho] = f->blocos[0];
+    f->blocos[0].primeira = f->num_instrs;
+    f->blocos[0].num_instrs = 0;
+    for (uint32_t b = 1; b < f->num_blocos; b++) {
+        for (uint8_t s = 0; s < f->blocos[b].num_sucessores; s++) {
+            if (f->blocos[b].sucessor[s] == 0) f->blocos[b].sucessor[s] = cabecalho;
+        }
+    }
+    for (uint32_t i = 0; i < num_finais; i++) {
+        if (finais[i].bloco == 0) finais[i].bloco = cabecalho;
+    }
+
+    int resultado = 0;
+    if (acumula) {
+        InstrRI* in = acrescentar(f, 0, RI_COPIA);
+        if (in == NULL) resultado = -1;
+        else {
+            in->d = acc;
+            in->imediato = 1;
+            in->k = 1;
+        }
+    }
+    if (resultado == 0 && acrescentar(f, 0, RI_SALTO) == NULL) resultado = -1;
+    f->blocos[0].sucessor[0] = cabecalho;
+    f->blocos[0].num_sucessores = 1;
+
+    for (uint32_t i = 0; i < num_finais && resultado == 0; i++) {
+        resultado = trocar_por_salto(f, &finais[i], cabecalho, acc);
+    }
+    // Os demais retornos alcançáveis (os blocos novos não retornam)
+    for (uint32_t i = 0; i < f->num_rpo && acumula && resultado == 0; i++) {
+        uint32_t b = f->rpo[i] == 0 ? cabecalho : f->rpo[i];
+        resultado = multiplicar_retorno(f, b, acc);
+    }
+    free(finais);
+    if (resultado != 0) return -1;
+
+    est->recursoes_finais += num_finais;
+    est->acumuladores += (unsigned) acumula;
+    if (ri_calcular_cfg(f) != 0 || ri_calcular_dominadores(f) != 0 || ri_calcular_vivacidade(f) != 0) return -1;
+    return 0;
+}
+
+int eliminar_recursao_final(ProgramaRI* prog, EstatisticasOtimizacao* est) {
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) {
+        if (eliminar_na_funcao(&prog->funcoes[i], i, est) != 0) return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <string.h>
+#include "otimizador.h"
+
+/*
+ * Integração de funções sobre a RI. A chamada 'd = CHAMADA f(args)' no bloco
+ * b de g vira uma cópia do corpo de f dentro de g:
+ *
+ *   b:     (instruções antes da chamada)  p'i = args[i]  salte f'0
+ *   f'k:   bloco k de f, com os registradores de f trocados por novos de g;
+ *          RETORNE v vira d = v; salte cont
+ *   cont:  (instruções depois da chamada), com os sucessores de b
+ *
+ * Locais, parâmetros e temporários de f viram temporários novos de g, então
+ * nenhum nome da cópia colide com os de g ou com os de outra cópia. Um
+ * parâmetro que f nunca altera usa direto o argumento, se ele é um
+ * temporário de g com uma definição só.
+ *
+ * As funções são visitadas na ordem da declaração, e cada uma só chama as
+ * declaradas antes dela ou a si mesma: quando g é visitada, as funções que
+ * ela chama já receberam as suas integrações, e o único ciclo possível no
+ * grafo de chamadas é a recursão direta, que nunca é integrada (a final já
+ * virou laço em eliminar_recursao_final).
+ *
+ * Custo: o tamanho de f é o número de instruções dos blocos alcançáveis,
+ * sem os saltos. A chamada é integrada se o tamanho cabe no limite, que
+ * começa em INTEGRACAO_PEQUENA e quadruplica a cada nível de laço em volta
+ * da chamada (a frequência estimada), e vale ao menos INTEGRACAO_UNICA se
+ * esta é a única chamada a f no programa. Nenhuma função passa de
+ * INTEGRACAO_MAXIMA instruções por integrações.
+ */
+
+#define INTEGRACAO_PEQUENA 10
+#define INTEGRACAO_UNICA   200
+#define INTEGRACAO_MAXIMA  4000
+#define INTEGRACAO_NIVEIS  3    /* Níveis de laço que ainda aumentam o limite */
+
+typedef struct {
+    ProgramaRI* prog;
+    FILE* relatorio;
+    EstatisticasOtimizacao* est;
+    uint32_t* tamanho;      /* Por função (o main por último) */
+    uint32_t* chamadas;     /* Chamadas a cada função em todo o programa */
+    uint8_t* recursiva;
+    RegRI* mapa_regs;       /* Da função integrada para a que recebe a cópia */
+    uint32_t* mapa_blocos;
+    uint32_t* definicoes;   /* Na função que recebe: definições de cada registrador */
+} Integrador;
+
+typedef struct {
+    uint32_t bloco;
+    uint32_t posicao;
+} LocalChamada;
+
+static FuncaoRI* funcao(Integrador* it, uint32_t i) {
+    return i < it->prog->num_funcoes ? &it->prog->funcoes[i] : &it->prog->principal;
+}
+
+// Tamanho e chamadas feitas por 'f', somadas a 'chamadas'; marca a recursão direta
+static uint32_t medir(const FuncaoRI* f, uint32_t indice, uint32_t* chamadas, uint8_t* recursiva) {
+    uint32_t tamanho = 0;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            if (in->op != RI_SALTO) tamanho++;
+            if (in->op != RI_CHAMADA) continue;
+            chamadas[in->k]++;
+            if ((uint32_t) in->k == indice) recursiva[indice] = 1;
+        }
+    }
+    return tamanho;
+}
+
+static int reservar_argumentos(FuncaoRI* f, uint32_t n) {
+    if (f->num_argumentos + n <= f->capacidade_argumentos) return 0;
+    uint32_t nova = f->capacidade_argumentos ? f->capacidade_argumentos : 64;
+    while (nova < f->num_argumentos + n) nova *= 2;
+    RegRI* argumentos = realloc(f->argumentos, nova * sizeof(RegRI));
+    if (!argumentos) return -1;
+    f->argumentos = argumentos;
+    f->capacidade_argumentos = nova;
+    return 0;
+}
+
+static InstrRI* acrescentar(FuncaoRI* f, uint32_t b, const InstrRI* modelo) {
+    InstrRI* in = ri_inserir(f, b, f->blocos[b].num_instrs);
+    if (in != NULL) *in = *modelo;
+    return in;
+}
+
+// Definições de cada registrador de 'g' nos blocos alcançáveis
+static void contar_definicoes(const FuncaoRI* g, uint32_t* definicoes) {
+    memset(definicoes, 0, g->num_regs * sizeof(uint32_t));
+    for (uint32_t i = 0; i < g->num_rpo; i++) {
+        uint32_t b = g->rpo[i];
+        for (uint32_t j = 0; j < g->blocos[b].num_instrs; j++) {
+            RegRI d = ri_definicao(RI_INSTR(g, b, j));
+            if (d != RI_NENHUM) definicoes[d]++;
+        }
+    }
+}
+
+// Registradores de 'f' para 'g': parâmetros não alterados usam o argumento
+static int mapear_registradores(Integrador* it, FuncaoRI* g, const FuncaoRI* f, const RegRI* args) {
+    for (RegRI r = 0; r < f->num_regs; r++) it->mapa_regs[r] = RI_NENHUM;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            RegRI d = ri_definicao(RI_INSTR(f, b, j));
+            if (d != RI_NENHUM) it->mapa_regs[d] = 0;     // Marca: definido na função
+        }
+    }
+    for (uint32_t i = 0; i < f->num_params; i++) {
+        RegRI p = f->num_locais + i;
+        int direto = it->mapa_regs[p] == RI_NENHUM && RI_EH_TEMPORARIO(g, args[i]) && it->definicoes[args[i]] == 1;
+        it->mapa_regs[p] = direto ? args[i] : RI_NENHUM;
+    }
+    for (RegRI r = 0; r < f->num_regs; r++) {
+        if (r >= f->num_locais && r < f->num_locais + f->num_params && it->mapa_regs[r] != RI_NENHUM) continue;
+        it->mapa_regs[r] = ri_novo_reg(g);
+        if (it->mapa_regs[r] == RI_NENHUM) return -1;
+    }
+    return 0;
+}
+
+// Cópia da instrução 'in' de 'f' no fim do bloco 'nb' de 'g', com os registradores trocados
+static int copiar_instr(Integrador* it, FuncaoRI* g, uint32_t nb, const FuncaoRI* f, const InstrRI* in) {
+    InstrRI x = *in;
+    if (x.op == RI_CHAMADA) {
+        if (reservar_argumentos(g, x.b) != 0) return -1;
+        for (uint32_t i = 0; i < x.b; i++) {
+            g->argumentos[g->num_argumentos + i] = it->mapa_regs[RI_ARGUMENTOS(f, in)[i]];
+        }
+        x.a = g->num_argumentos;
+        g->num_argumentos += x.b;
+        it->chamadas[x.k]++;
+    } else {
+        RegRI usos[2];
+        int n = ri_usos(in, usos);
+        if (n >= 1) x.a = it->mapa_regs[x.a];
+        if (n == 2) x.b = it->mapa_regs[x.b];
+    }
+    if (ri_definicao(in) != RI_NENHUM) x.d = it->mapa_regs[x.d];
+    return acrescentar(g, nb, &x) == NULL ? -1 : 0;
+}
+
+// Troca a chamada na posição 'pos' do bloco 'b' de 'g' pelo corpo de 'f'
+static int integrar(Integrador* it, FuncaoRI* g, uint32_t b, uint32_t pos, const FuncaoRI* f) {
+    InstrRI chamada = *RI_INSTR(g, b, pos);
+
+    // As instruções depois da chamada passam para o bloco de continuação
+    uint32_t cont = ri_novo_bloco(g);
+    if (cont == RI_NENHUM) return -1;
+    for (uint32_t j = pos + 1; j < g->blocos[b].num_instrs; j++) {
+        InstrRI x = *RI_INSTR(g, b, j);
+        if (acrescentar(g, cont, &x) == NULL) return -1;
+    }
+    memcpy(g->blocos[cont].sucessor, g->blocos[b].sucessor, sizeof(g->blocos[b].sucessor));
+    g->blocos[cont].num_sucessores = g->blocos[b].num_sucessores;
+    g->blocos[b].num_instrs = pos;
+
+    if (mapear_registradores(it, g, f, RI_ARGUMENTOS(g, &chamada)) != 0) return -1;
+    for (uint32_t cb = 0; cb < f->num_blocos; cb++) {
+        it->mapa_blocos[cb] = RI_NENHUM;
+        if (f->ordem_rpo[cb] == RI_NENHUM) continue;
+        it->mapa_blocos[cb] = ri_novo_bloco(g);
+        if (it->mapa_blocos[cb] == RI_NENHUM) return -1;
+    }
+
+    // Argumentos para os parâmetros da cópia, e o salto para a entrada dela
+    for (uint32_t i = 0; i < f->num_params; i++) {
+        InstrRI copia = { .op = RI_COPIA, .d = it->mapa_regs[f->num_locais + i],
+                          .a = RI_ARGUMENTOS(g, &chamada)[i], .b = RI_NENHUM };
+        if (copia.d == copia.a) continue;
+        if (acrescentar(g, b, &copia) == NULL) return -1;
+    }
+    InstrRI salto = { .op = RI_SALTO, .d = RI_NENHUM, .a = RI_NENHUM, .b = RI_NENHUM };
+    if (acrescentar(g, b, &salto) == NULL) return -1;
+    g->blocos[b].sucessor[0] = it->mapa_blocos[0];
+    g->blocos[b].num_sucessores = 1;
+
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t cb = f->rpo[i], nb = it->mapa_blocos[cb];
+        const BlocoRI* bloco = &f->blocos[cb];
+        for (uint32_t j = 0; j + 1 < bloco->num_instrs; j++) {
+            if (copiar_instr(it, g, nb, f, RI_INSTR(f, cb, j)) != 0) return -1;
+        }
+        const InstrRI* fim = RI_TERMINADOR(f, cb);
+        if (fim->op == RI_RETORNE) {
+            // O valor devolvido vai para o destino da chamada
+            if ((fim->imediato || fim->a != RI_NENHUM) && chamada.d != RI_NENHUM) {
+                InstrRI copia = { .op = RI_COPIA, .imediato = fim->imediato, .d = chamada.d,
+                                  .a = fim->imediato ? RI_NENHUM : it->mapa_regs[fim->a], .b = RI_NENHUM,
+                                  .k = fim->k };
+                if (acrescentar(g, nb, &copia) == NULL) return -1;
+            }
+            if (acrescentar(g, nb, &salto) == NULL) return -1;
+            g->blocos[nb].sucessor[0] = cont;
+            g->blocos[nb].num_sucessores = 1;
+            continue;
+        }
+        if (copiar_instr(it, g, nb, f, fim) != 0) return -1;
+        for (uint8_t s = 0; s < bloco->num_sucessores; s++) {
+            g->blocos[nb].sucessor[s] = it->mapa_blocos[bloco->sucessor[s]];
+        }
+        g->blocos[nb].num_sucessores = bloco->num_sucessores;
+    }
+    return 0;
+}
+
+// Decide e faz as integrações nas chamadas de 'g' (índice 'ig')
+static int integrar_em(Integrador* it, uint32_t ig) {
+    FuncaoRI* g = funcao(it, ig);
+    uint8_t* profundidade = malloc((size_t) g->num_blocos + 1);
+    LocalChamada* locais = NULL;
+    uint32_t num_locais = 0, capacidade = 0;
+    if (profundidade == NULL || ri_calcular_profundidade(g, profundidade) != 0) {
+        free(profundidade);
+        return -1;
+    }
+    for (uint32_t i = 0; i < g->num_rpo; i++) {
+        uint32_t b = g->rpo[i];
+        for (uint32_t j = 0; j < g->blocos[b].num_instrs; j++) {
+            if (RI_INSTR(g, b, j)->op != RI_CHAMADA) continue;
+            if (num_locais == capacidade) {
+                capacidade = capacidade ? capacidade * 2 : 16;
+                LocalChamada* novo = realloc(locais, capacidade * sizeof(LocalChamada));
+                if (novo == NULL) {
+                    free(locais);
+                    free(profundidade);
+                    return -1;
+                }
+                locais = novo;
+            }
+            locais[num_locais].bloco = b;
+            locais[num_locais].posicao = j;
+            num_locais++;
+        }
+    }
+
+    // De trás para a frente: dividir um bloco não muda a posição das chamadas antes
+    int resultado = 0, mudou = 0;
+    for (uint32_t c = num_locais; c-- > 0 && resultado == 0;) {
+        uint32_t b = locais[c].bloco;
+        uint32_t k = (uint32_t) RI_INSTR(g, b, locais[c].posicao)->k;
+        const FuncaoRI* f = &it->prog->funcoes[k];
+        uint32_t nivel = profundidade[b] < INTEGRACAO_NIVEIS ? profundidade[b] : INTEGRACAO_NIVEIS;
+        uint32_t limite = (uint32_t) INTEGRACAO_PEQUENA << (2 * nivel);
+        if (it->chamadas[k] == 1 && limite < INTEGRACAO_UNICA) limite = INTEGRACAO_UNICA;
+
+        if (it->relatorio != NULL) {
+            fprintf(it->relatorio, "Integracao: '%s' em '%s' (laco de profundidade %u): ", f->nome, g->nome,
+                    (unsigned) profundidade[b]);
+        }
+        if (it->recursiva[k]) {
+            if (it->relatorio != NULL) fprintf(it->relatorio, "mantida, recursiva\n");
+            continue;
+        }
+        if (it->tamanho[k] > limite) {
+            if (it->relatorio != NULL) {
+                fprintf(it->relatorio, "mantida, %u instrucoes (limite %u)\n", it->tamanho[k], limite);
+            }
+            continue;
+        }
+        if (it->tamanho[ig] + it->tamanho[k] > INTEGRACAO_MAXIMA) {
+            if (it->relatorio != NULL) {
+                fprintf(it->relatorio, "mantida, '%s' passaria de %u instrucoes\n", g->nome, INTEGRACAO_MAXIMA);
+            }
+            continue;
+        }
+        if (it->relatorio != NULL) {
+            fprintf(it->relatorio, "integrada, %u instrucoes (limite %u)\n", it->tamanho[k], limite);
+        }
+        if (!mudou) contar_definicoes(g, it->definicoes);
+        resultado = integrar(it, g, b, locais[c].posicao, f);
+        it->chamadas[k]--;
+        it->tamanho[ig] += it->tamanho[k];
+        it->est->integradas++;
+        mudou = 1;
+    }
+    free(locais);
+    free(profundidade);
+    if (resultado != 0) return -1;
+    if (mudou && (ri_calcular_cfg(g) != 0 || ri_calcular_dominadores(g) != 0 || ri_calcular_vivacidade(g) != 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+int integrar_funcoes(ProgramaRI* prog, FILE* relatorio, EstatisticasOtimizacao* est) {
+    Integrador it = { 0 };
+    it.prog = prog;
+    it.relatorio = relatorio;
+    it.est = est;
+    uint32_t n = prog->num_funcoes + 1;
+    it.tamanho = malloc(n * sizeof(uint32_t));
+    it.chamadas = calloc(n, sizeof(uint32_t));
+    it.recursiva = calloc(n, 1);
+    int resultado = it.tamanho && it.chamadas && it.recursiva ? 0 : -1;
+
+    uint32_t maior_regs = 1, maior_blocos = 1;
+    for (uint32_t i = 0; i < n && resultado == 0; i++) {
+        const FuncaoRI* f = funcao(&it, i);
+        it.tamanho[i] = medir(f, i, it.chamadas, it.recursiva);
+        if (f->num_regs > maior_regs) maior_regs = f->num_regs;
+        if (f->num_blocos > maior_blocos) maior_blocos = f->num_blocos;
+    }
+    if (resultado == 0) {
+        it.mapa_regs = malloc(maior_regs * sizeof(RegRI));
+        it.mapa_blocos = malloc(maior_blocos * sizeof(uint32_t));
+        if (!it.mapa_regs || !it.mapa_blocos) resultado = -1;
+    }
+
+    // Cada função, na ordem da declaração, depois das que ela chama; o main por último
+    for (uint32_t i = 0; i < n && resultado == 0; i++) {
+        FuncaoRI* g = funcao(&it, i);
+        free(it.definicoes);
+        it.definicoes = malloc(((size_t) g->num_regs + 1) * sizeof(uint32_t));
+        if (it.definicoes == NULL) resultado = -1;
+        else resultado = integrar_em(&it, i);
+        // Uma função que recebeu cópias pode ser copiada depois, com mais registradores e blocos
+        if (resultado == 0 && (g->num_regs > maior_regs || g->num_blocos > maior_blocos)) {
+            maior_regs = g->num_regs > maior_regs ? g->num_regs : maior_regs;
+            maior_blocos = g->num_blocos > maior_blocos ? g->num_blocos : maior_blocos;
+            RegRI* regs = realloc(it.mapa_regs, maior_regs * sizeof(RegRI));
+            if (regs != NULL) it.mapa_regs = regs;
+            uint32_t* blocos = realloc(it.mapa_blocos, maior_blocos * sizeof(uint32_t));
+            if (blocos != NULL) it.mapa_blocos = blocos;
+            if (regs == NULL || blocos == NULL) resultado = -1;
+        }
+    }
+    free(it.tamanho);
+    free(it.chamadas);
+    free(it.recursiva);
+    free(it.mapa_regs);
+    free(it.mapa_blocos);
+    free(it.definicoes);
+    return resultado;
+}
@@ -0,0 +1,426 @@
+#include <stdlib.h>
+#include <string.h>
+#include "otimizador.h"
+
+/*
+ * Otimizações de laços sobre a RI. Cada laço natural (o cabeçalho h e os
+ * blocos que chegam a uma aresta de volta sem passar por h) ganha um
+ * pré-cabeçalho, o único bloco de fora que salta para h. Dos laços internos
+ * para os externos:
+ *
+ * Código invariante: uma instrução sem efeito colateral cujos operandos não
+ * são definidos no laço, e cujo destino tem uma definição só na função e
+ * não está vivo na entrada de h, vai para o fim do pré-cabeçalho. Uma carga
+ * de global também, se o laço não guarda nela nem chama funções. Somas,
+ * subtrações e divisões podem gerar exceção: só saem do próprio h, que
+ * sempre executa depois do pré-cabeçalho, e se nada antes delas em h tem
+ * efeito ou pode gerar exceção.
+ *
+ * Variáveis de indução: se a única definição de i no laço é i = i + c, um
+ * t = i * k (k constante ou invariante) vira t = j, com j = i * k calculado
+ * no pré-cabeçalho e j = j + c * k logo depois de cada i = i + c. O produto
+ * é módulo 2^32, então a soma de j é a circular (sem exceção), e j é igual
+ * a i * k em todo ponto do laço.
+ */
+
+typedef struct {
+    ProgramaRI* prog;
+    FuncaoRI* f;
+    EstatisticasOtimizacao* est;
+    uint32_t* definicoes;   /* Definições de cada registrador na função */
+    uint32_t* dentro;       /* Definições no laço 'contado[r]' (as do atual, se for ele) */
+    uint32_t* contado;
+    uint32_t capacidade_regs;
+    uint32_t regs_vivacidade; /* Registradores com a vivacidade calculada */
+    uint32_t atual;         /* Cabeçalho do laço atual */
+    uint32_t* marca;        /* Por bloco: cabeçalho do último laço que o contém */
+    uint32_t* corpo;        /* Blocos do laço atual, em pós-ordem reversa */
+    uint32_t num_corpo;
+    uint32_t* pilha;
+    uint8_t* guardada;      /* Por global: guardada no laço atual */
+} Lacos;
+
+static int garantir_regs(Lacos* l) {
+    uint32_t n = l->f->num_regs;
+    if (n <= l->capacidade_regs) return 0;
+    uint32_t nova = l->capacidade_regs ? l->capacidade_regs : 64;
+    while (nova < n) nova *= 2;
+    uint32_t* definicoes = realloc(l->definicoes, nova * sizeof(uint32_t));
+    if (definicoes != NULL) l->definicoes = definicoes;
+    uint32_t* dentro = realloc(l->dentro, nova * sizeof(uint32_t));
+    if (dentro != NULL) l->dentro = dentro;
+    uint32_t* contado = realloc(l->contado, nova * sizeof(uint32_t));
+    if (contado != NULL) l->contado = contado;
+    if (definicoes == NULL || dentro == NULL || contado == NULL) return -1;
+    memset(l->definicoes + l->capacidade_regs, 0, (nova - l->capacidade_regs) * sizeof(uint32_t));
+    memset(l->contado + l->capacidade_regs, 0xff, (nova - l->capacidade_regs) * sizeof(uint32_t));
+    l->capacidade_regs = nova;
+    return 0;
+}
+
+// Pode gerar exceção (estouro do 'add' e do 'sub', divisão por zero)
+static int pode_falhar(const InstrRI* in) {
+    switch ((OpRI) in->op) {
+        case RI_SOMA: return !in->circular;
+        case RI_SUB: return 1;
+        case RI_DIV: return !in->imediato || in->k == 0 || in->k == -1;
+        default: return 0;
+    }
+}
+
+// Só calcula o destino a partir dos operandos (e, na carga, da global)
+static int pura(const InstrRI* in) {
+    switch ((OpRI) in->op) {
+        case RI_COPIA:
+        case RI_SOMA: case RI_SUB: case RI_MULT: case RI_DIV:
+        case RI_IGUAL: case RI_DIF: case RI_MAIOR: case RI_MENOR:
+        case RI_MAIOR_IGUAL: case RI_MENOR_IGUAL: case RI_E: case RI_OU:
+        case RI_NAO:
+        case RI_CARREGA:
+        case RI_ENDERECO:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Pré-cabeçalho de cada cabeçalho de laço: o único predecessor de fora, se
+ * ele só salta para h, ou um bloco novo que recebe as arestas de fora.
+ * 'pre[h]' fica RI_NENHUM nos demais blocos (e na entrada, que não tem
+ * predecessor de fora). Retorna quantos blocos foram criados, ou -1.
+ */
+static int criar_pre_cabecalhos(FuncaoRI* f, uint32_t* pre) {
+    int criados = 0;
+    uint32_t num_blocos = f->num_blocos;
+    for (uint32_t b = 0; b < num_blocos; b++) pre[b] = RI_NENHUM;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t h = f->rpo[i], de_volta = 0, de_fora = 0, unico = RI_NENHUM;
+        for (uint32_t p = f->inicio_pred[h]; p < f->inicio_pred[h + 1]; p++) {
+            uint32_t origem = f->pred[p];
+            if (f->ordem_rpo[origem] == RI_NENHUM) continue;
+            if (ri_domina(f, h, origem)) {
+                de_volta++;
+            } else {
+                de_fora++;
+                unico = origem;
+            }
+        }
+        if (de_volta == 0 || de_fora == 0) continue;
+        if (de_fora == 1 && f->blocos[unico].num_sucessores == 1) {
+            pre[h] = unico;
+            continue;
+        }
+        uint32_t novo = ri_novo_bloco(f);
+        InstrRI* salto = novo == RI_NENHUM ? NULL : ri_inserir(f, novo, 0);
+        if (salto == NULL) return -1;
+        salto->op = RI_SALTO;
+        f->blocos[novo].sucessor[0] = h;
+        f->blocos[novo].num_sucessores = 1;
+        for (uint32_t p = f->inicio_pred[h]; p < f->inicio_pred[h + 1]; p++) {
+            uint32_t origem = f->pred[p];
+            if (f->ordem_rpo[origem] == RI_NENHUM || ri_domina(f, h, origem)) continue;
+            for (uint8_t s = 0; s < f->blocos[origem].num_sucessores; s++) {
+                if (f->blocos[origem].sucessor[s] == h) f->blocos[origem].sucessor[s] = novo;
+            }
+        }
+        pre[h] = novo;
+        criados++;
+    }
+    return criados;
+}
+
+// Blocos do laço de 'h' em l->corpo, na pós-ordem reversa, e as definições dentro dele
+static void medir_laco(Lacos* l, uint32_t h, int* chama) {
+    FuncaoRI* f = l->f;
+    uint32_t topo = 0;
+    l->marca[h] = h;
+    for (uint32_t p = f->inicio_pred[h]; p < f->inicio_pred[h + 1]; p++) {
+        uint32_t origem = f->pred[p];
+        if (f->ordem_rpo[origem] == RI_NENHUM || !ri_domina(f, h, origem) || l->marca[origem] == h) continue;
+        l->marca[origem] = h;
+        l->pilha[topo++] = origem;
+    }
+    while (topo > 0) {
+        uint32_t x = l->pilha[--topo];
+        for (uint32_t p = f->inicio_pred[x]; p < f->inicio_pred[x + 1]; p++) {
+            uint32_t y = f->pred[p];
+            if (f->ordem_rpo[y] == RI_NENHUM || l->marca[y] == h) continue;
+            l->marca[y] = h;
+            l->pilha[topo++] = y;
+        }
+    }
+
+    // Os blocos do laço vêm depois de h na ordem: basta percorrer dali em diante
+    l->atual = h;
+    l->num_corpo = 0;
+    *chama = 0;
+    memset(l->guardada, 0, l->prog->num_globais);
+    for (uint32_t i = f->ordem_rpo[h]; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        if (l->marca[b] != h) continue;
+        l->corpo[l->num_corpo++] = b;
+        for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            RegRI d = ri_definicao(in);
+            if (d != RI_NENHUM) {
+                if (l->contado[d] != h) {
+                    l->contado[d] = h;
+                    l->dentro[d] = 0;
+                }
+                l->dentro[d]++;
+            }
+            if (in->op == RI_CHAMADA) *chama = 1;
+            if (in->op == RI_GUARDA) l->guardada[in->k] = 1;
+        }
+    }
+}
+
+static uint32_t definido_dentro(const Lacos* l, RegRI r) {
+    return l->contado[r] == l->atual ? l->dentro[r] : 0;
+}
+
+static int invariante(const Lacos* l, uint32_t h, uint32_t b, uint32_t j, int chama) {
+    const FuncaoRI* f = l->f;
+    const InstrRI* in = RI_INSTR(f, b, j);
+    RegRI d = ri_definicao(in);
+    if (!pura(in) || d == RI_NENHUM || l->definicoes[d] != 1) return 0;
+    // Os registradores criados aqui são definidos antes de qualquer leitura
+    if (d < l->regs_vivacidade && ri_vivo_entrada(f, h, d)) return 0;
+    RegRI usos[2];
+    int n = ri_usos(in, usos);
+    for (int u = 0; u < n; u++) {
+        if (definido_dentro(l, usos[u]) != 0) return 0;
+    }
+    if (in->op == RI_CARREGA && (chama || l->guardada[in->k])) return 0;
+    if (!pode_falhar(in)) return 1;
+    if (b != h) return 0;
+    for (uint32_t i = 0; i < j; i++) {
+        const InstrRI* antes = RI_INSTR(f, h, i);
+        if (!pura(antes) || pode_falhar(antes)) return 0;
+    }
+    return 1;
+}
+
+// Leva a instrução 'j' do bloco 'b' para o fim do pré-cabeçalho 'pre'
+static int mover(Lacos* l, uint32_t b, uint32_t j, uint32_t pre) {
+    FuncaoRI* f = l->f;
+    InstrRI x = *RI_INSTR(f, b, j);
+    ri_remover(f, b, j);
+    InstrRI* in = ri_inserir(f, pre, f->blocos[pre].num_instrs - 1);
+    if (in == NULL) return -1;
+    *in = x;
+    l->dentro[x.d]--;
+    l->est->invariantes++;
+    return 0;
+}
+
+static int mover_invariantes(Lacos* l, uint32_t h, uint32_t pre, int chama) {
+    FuncaoRI* f = l->f;
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (uint32_t c = 0; c < l->num_corpo; c++) {
+            uint32_t b = l->corpo[c];
+            for (uint32_t j = 0; j + 1 < f->blocos[b].num_instrs;) {
+                if (!invariante(l, h, b, j, chama)) {
+                    j++;
+                    continue;
+                }
+                if (mover(l, b, j, pre) != 0) return -1;
+                mudou = 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// i = i + c (ou i - c), com c em '*passo'?
+static int incremento(const InstrRI* in, RegRI* i, int32_t* passo) {
+    if ((in->op != RI_SOMA && in->op != RI_SUB) || !in->imediato || in->d != in->a) return 0;
+    if (in->op == RI_SUB && in->k == INT32_MIN) return 0;
+    *i = in->d;
+    *passo = in->op == RI_SOMA ? in->k : -in->k;
+    return 1;
+}
+
+static InstrRI* inserir(FuncaoRI* f, uint32_t b, uint32_t pos, OpRI op, RegRI d, RegRI a) {
+    InstrRI* in = ri_inserir(f, b, pos);
+    if (in != NULL) {
+        in->op = (uint8_t) op;
+        in->d = d;
+        in->a = a;
+    }
+    return in;
+}
+
+/*
+ * Troca t = i * k (na posição 'j' do bloco 'b') por t = j, com i de passo
+ * 'passo' incrementado no bloco 'bi'. 'fator' é o registrador de k, ou
+ * RI_NENHUM se k é a constante da instrução.
+ */
+static int reduzir(Lacos* l, uint32_t b, uint32_t j, RegRI i, int32_t passo, uint32_t bi, RegRI fator,
+                   uint32_t pre) {
+    FuncaoRI* f = l->f;
+    InstrRI mult = *RI_INSTR(f, b, j);
+    RegRI novo = ri_novo_reg(f);
+    RegRI incremento_reg = RI_NENHUM;
+    if (novo == RI_NENHUM) return -1;
+    if (fator != RI_NENHUM && passo != 1) {
+        incremento_reg = ri_novo_reg(f);
+        if (incremento_reg == RI_NENHUM) return -1;
+    }
+    if (garantir_regs(l) != 0) return -1;
+
+    // No pré-cabeçalho: j = i * k e, com k num registrador, o passo c * k
+    uint32_t fim = f->blocos[pre].num_instrs - 1;
+    InstrRI* in = inserir(f, pre, fim++, RI_MULT, novo, i);
+    if (in == NULL) return -1;
+    in->imediato = fator == RI_NENHUM;
+    in->b = fator;
+    in->k = mult.k;
+    if (incremento_reg != RI_NENHUM) {
+        in = inserir(f, pre, fim, RI_MULT, incremento_reg, fator);
+        if (in == NULL) return -1;
+        in->imediato = 1;
+        in->b = RI_NENHUM;
+        in->k = passo;
+    }
+
+    // t = j no lugar do produto
+    in = RI_INSTR(f, b, j);
+    in->op = RI_COPIA;
+    in->a = novo;
+    in->b = RI_NENHUM;
+    in->imediato = 0;
+    in->k = 0;
+
+    // j = j + c * k depois do incremento de i
+    uint32_t pos = 0;
+    while (!(RI_INSTR(f, bi, pos)->d == i && ri_definicao(RI_INSTR(f, bi, pos)) == i)) pos++;
+    in = inserir(f, bi, pos + 1, RI_SOMA, novo, novo);
+    if (in == NULL) return -1;
+    in->circular = 1;
+    if (fator == RI_NENHUM) {
+        in->imediato = 1;
+        in->b = RI_NENHUM;
+        in->k = (int32_t) ((uint32_t) passo * (uint32_t) mult.k);
+    } else {
+        in->b = passo != 1 ? incremento_reg : fator;
+    }
+    l->definicoes[novo] = 2;
+    if (incremento_reg != RI_NENHUM) l->definicoes[incremento_reg] = 1;
+    l->contado[novo] = l->atual;
+    l->dentro[novo] = 1;
+    l->est->inducoes++;
+    return 0;
+}
+
+static int reduzir_inducoes(Lacos* l, uint32_t pre) {
+    FuncaoRI* f = l->f;
+    for (uint32_t c = 0; c < l->num_corpo; c++) {
+        uint32_t b = l->corpo[c];
+        for (uint32_t j = 0; j + 1 < f->blocos[b].num_instrs; j++) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            if (in->op != RI_MULT || l->definicoes[in->d] != 1) continue;
+            // Um dos lados é variável de indução; o outro, constante ou invariante
+            RegRI lados[2] = { in->a, in->imediato ? RI_NENHUM : in->b };
+            for (int lado = 0; lado < 2; lado++) {
+                RegRI i = lados[lado], fator = lados[1 - lado];
+                if (i == RI_NENHUM || definido_dentro(l, i) != 1) continue;
+                if (fator != RI_NENHUM && definido_dentro(l, fator) != 0) continue;
+                if (fator == RI_NENHUM && lado == 1) continue;
+                // A definição de i no laço
+                uint32_t bi = RI_NENHUM;
+                int32_t passo = 0;
+                for (uint32_t c2 = 0; c2 < l->num_corpo && bi == RI_NENHUM; c2++) {
+                    uint32_t x = l->corpo[c2];
+                    for (uint32_t k = 0; k < f->blocos[x].num_instrs; k++) {
+                        RegRI r;
+                        if (ri_definicao(RI_INSTR(f, x, k)) == i) {
+                            if (incremento(RI_INSTR(f, x, k), &r, &passo)) bi = x;
+                            else c2 = l->num_corpo;
+                            break;
+                        }
+                    }
+                }
+                if (bi == RI_NENHUM) continue;
+                if (reduzir(l, b, j, i, passo, bi, fator, pre) != 0) return -1;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+static int otimizar_funcao(Lacos* l, FuncaoRI* f) {
+    l->f = f;
+    l->regs_vivacidade = f->num_regs;
+    uint32_t originais = f->num_blocos;
+    uint32_t* pre = malloc(((size_t) originais + 1) * sizeof(uint32_t));
+    if (pre == NULL) return -1;
+    int criados = criar_pre_cabecalhos(f, pre);
+    if (criados < 0 || (criados > 0 && (ri_calcular_cfg(f) != 0 || ri_calcular_dominadores(f) != 0))) {
+        free(pre);
+        return -1;
+    }
+    uint32_t num_cabecalhos = 0;
+    for (uint32_t b = 0; b < originais; b++) num_cabecalhos += pre[b] != RI_NENHUM;
+    if (num_cabecalhos == 0) {
+        free(pre);
+        return 0;
+    }
+
+    int resultado = garantir_regs(l);
+    l->marca = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    l->corpo = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    l->pilha = malloc(((size_t) f->num_blocos + 1) * sizeof(uint32_t));
+    if (resultado != 0 || !l->marca || !l->corpo || !l->pilha) resultado = -1;
+    if (resultado == 0) {
+        memset(l->definicoes, 0, l->capacidade_regs * sizeof(uint32_t));
+        memset(l->contado, 0xff, l->capacidade_regs * sizeof(uint32_t));
+        for (uint32_t i = 0; i < f->num_rpo; i++) {
+            uint32_t b = f->rpo[i];
+            for (uint32_t j = 0; j < f->blocos[b].num_instrs; j++) {
+                RegRI d = ri_definicao(RI_INSTR(f, b, j));
+                if (d != RI_NENHUM) l->definicoes[d]++;
+            }
+        }
+        for (uint32_t b = 0; b < f->num_blocos; b++) l->marca[b] = RI_NENHUM;
+    }
+
+    // Dos laços internos para os externos: o cabeçalho interno vem depois na ordem
+    uint32_t num_rpo = f->num_rpo;
+    for (uint32_t i = num_rpo; i-- > 0 && resultado == 0;) {
+        uint32_t h = f->rpo[i];
+        if (h >= originais || pre[h] == RI_NENHUM) continue;
+        int chama;
+        medir_laco(l, h, &chama);
+        resultado = mover_invariantes(l, h, pre[h], chama);
+        if (resultado == 0) resultado = reduzir_inducoes(l, pre[h]);
+    }
+    free(pre);
+    free(l->marca);
+    free(l->corpo);
+    free(l->pilha);
+    l->marca = l->corpo = l->pilha = NULL;
+    if (resultado != 0) return -1;
+    if (ri_calcular_cfg(f) != 0 || ri_calcular_dominadores(f) != 0 || ri_calcular_vivacidade(f) != 0) return -1;
+    return 0;
+}
+
+int otimizar_lacos(ProgramaRI* prog, EstatisticasOtimizacao* est) {
+    Lacos l = { 0 };
+    l.prog = prog;
+    l.est = est;
+    l.guardada = malloc(prog->num_globais + 1);
+    int resultado = l.guardada != NULL ? otimizar_funcao(&l, &prog->principal) : -1;
+    for (uint32_t i = 0; i < prog->num_funcoes && resultado == 0; i++) {
+        resultado = otimizar_funcao(&l, &prog->funcoes[i]);
+    }
+    free(l.guardada);
+    free(l.definicoes);
+    free(l.dentro);
+    free(l.contado);
+    return resultado;
+}
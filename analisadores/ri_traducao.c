@@ -0,0 +1,940 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ri.h"
+#include "percurso.h"
+
+/*
+ * Tradução da AST para a RI, com o mesmo percurso de pilha explícita do
+ * gerador de código. Cada expressão deixa seu valor numa pilha de valores:
+ * uma constante (que pode virar operando imediato) ou um registrador. Locais
+ * e parâmetros entram na pilha como o próprio registrador, sem cópia; por
+ * isso, antes de uma atribuição à variável, os valores pendentes que ainda
+ * a leem são copiados para temporários (ex: 'x + (x = 3)').
+ *
+ * Os operandos de um operador sem efeitos colaterais (sem atribuições nem
+ * chamadas) são calculados primeiro o que precisa de mais temporários, na
+ * numeração de Sethi e Ullman: em 'a + (b * (c - d))' a subárvore direita
+ * vem antes e o valor de 'a' nunca espera num registrador.
+ *
+ * A condição de um 'se' ou 'enquanto' termina o bloco com desvios para o
+ * bloco do verdadeiro ou do falso, sem deixar valor. O pai marca o nó da
+ * condição em 'proxima' antes de visitá-lo, e ao entrar ele passa para a
+ * pilha de condições. 'e' e 'ou' marcam os operandos, o esquerdo com o
+ * bloco do meio (onde começa o direito) no lugar de um dos destinos, então
+ * o direito só é avaliado se o esquerdo não decide; '!' marca o operando
+ * com os destinos trocados. Os demais nós calculam o valor e desviam se ele
+ * não é zero; a comparação que o calculou vira a do RI_DESVIO. Fora de
+ * condições, 'e' e 'ou' desviam para blocos que dão 1 ou 0 ao resultado.
+ */
+
+typedef struct {
+    uint8_t constante;
+    int32_t k;
+    RegRI reg;
+} ValorRI;
+
+// Condição em tradução: desvia para o bloco 'verdadeiro' ou o 'falso'
+typedef struct {
+    NoAst no;
+    uint32_t verdadeiro;
+    uint32_t falso;
+    uint32_t meio;      // 'e' e 'ou': onde começa o operando direito
+    uint32_t fim;       // 'e' e 'ou' fora de condição: depois do valor
+    RegRI valor;        // 'e' e 'ou' fora de condição: o resultado (RI_NENHUM nas condições)
+} CondicaoRI;
+
+// Tabela de átomos (nomes de globais e funções) para o índice no programa
+typedef struct {
+    Atomo* chaves;
+    uint32_t* indices;
+    uint32_t mascara;
+} MapaNomes;
+
+typedef struct {
+    const Ast* ast;
+    ProgramaRI* prog;
+    FuncaoRI* f;
+    uint32_t bloco;             // Bloco em construção
+    ValorRI* valores;
+    uint32_t num_valores;
+    uint32_t capacidade_valores;
+    uint32_t variaveis_pendentes; // Valores na pilha que são locais ou parâmetros
+    uint8_t* necessidade;       // Por nó: temporários para calculá-lo (NECESSIDADE_*)
+    MapaNomes globais;
+    MapaNomes funcoes;
+    uint32_t capacidade_cadeias;
+    CondicaoRI proxima;         // O próximo nó a traduzir como condição, e seus destinos
+    CondicaoRI* condicoes;      // Condições em tradução, a mais interna no topo
+    uint32_t num_condicoes;
+    uint32_t capacidade_condicoes;
+    int sem_memoria;
+} Tradutor;
+
+// --- Nomes ---
+
+static int mapa_iniciar(MapaNomes* m, uint32_t n) {
+    uint32_t capacidade = 16;
+    while (capacidade < 2 * n) capacidade *= 2;
+    m->chaves = calloc(capacidade, sizeof(Atomo));
+    m->indices = malloc(capacidade * sizeof(uint32_t));
+    m->mascara = capacidade - 1;
+    return m->chaves && m->indices ? 0 : -1;
+}
+
+static void mapa_inserir(MapaNomes* m, Atomo nome, uint32_t indice) {
+    uint32_t i = hash_atomo(nome) & m->mascara;
+    while (m->chaves[i].texto != NULL && !MESMO_ATOMO(m->chaves[i], nome)) i = (i + 1) & m->mascara;
+    m->chaves[i] = nome;
+    m->indices[i] = indice;
+}
+
+static uint32_t mapa_buscar(const MapaNomes* m, Atomo nome) {
+    uint32_t i = hash_atomo(nome) & m->mascara;
+    while (m->chaves[i].texto != NULL) {
+        if (MESMO_ATOMO(m->chaves[i], nome)) return m->indices[i];
+        i = (i + 1) & m->mascara;
+    }
+    return RI_NENHUM;
+}
+
+static void mapa_liberar(MapaNomes* m) {
+    free(m->chaves);
+    free(m->indices);
+}
+
+// --- Emissão ---
+
+// Acrescenta uma instrução ao bloco em construção (NULL se faltar memória)
+static InstrRI* emitir(Tradutor* t, OpRI op) {
+    InstrRI* in = ri_inserir(t->f, t->bloco, t->f->blocos[t->bloco].num_instrs);
+    if (in == NULL) {
+        t->sem_memoria = 1;
+        return NULL;
+    }
+    in->op = (uint8_t) op;
+    return in;
+}
+
+static RegRI novo_temp(Tradutor* t) {
+    RegRI r = ri_novo_reg(t->f);
+    if (r == RI_NENHUM) t->sem_memoria = 1;
+    return r;
+}
+
+// Termina o bloco em construção e passa a construir 'proximo'
+static InstrRI* terminar(Tradutor* t, OpRI op, uint32_t s0, uint32_t s1, uint32_t proximo) {
+    InstrRI* in = emitir(t, op);
+    BlocoRI* b = &t->f->blocos[t->bloco];
+    b->num_sucessores = 0;
+    if (s0 != RI_NENHUM) b->sucessor[b->num_sucessores++] = s0;
+    if (s1 != RI_NENHUM) b->sucessor[b->num_sucessores++] = s1;
+    t->bloco = proximo;
+    return in;
+}
+
+static uint32_t novo_bloco(Tradutor* t) {
+    uint32_t b = ri_novo_bloco(t->f);
+    if (b == RI_NENHUM) t->sem_memoria = 1;
+    return b;
+}
+
+// --- Pilha de valores ---
+
+static void empilhar(Tradutor* t, ValorRI v) {
+    if (t->num_valores == t->capacidade_valores) {
+        uint32_t nova = t->capacidade_valores ? t->capacidade_valores * 2 : 64;
+        ValorRI* valores = realloc(t->valores, nova * sizeof(ValorRI));
+        if (!valores) {
+            t->sem_memoria = 1;
+            return;
+        }
+        t->valores = valores;
+        t->capacidade_valores = nova;
+    }
+    if (!v.constante && !RI_EH_TEMPORARIO(t->f, v.reg)) t->variaveis_pendentes++;
+    t->valores[t->num_valores++] = v;
+}
+
+static void empilhar_reg(Tradutor* t, RegRI r) {
+    ValorRI v = { 0, 0, r };
+    empilhar(t, v);
+}
+
+static void empilhar_constante(Tradutor* t, int32_t k) {
+    ValorRI v = { 1, k, RI_NENHUM };
+    empilhar(t, v);
+}
+
+static ValorRI desempilhar(Tradutor* t) {
+    if (t->num_valores == 0) {
+        // Só depois de uma falha de memória ao empilhar
+        ValorRI v = { 1, 0, RI_NENHUM };
+        return v;
+    }
+    ValorRI v = t->valores[--t->num_valores];
+    if (!v.constante && !RI_EH_TEMPORARIO(t->f, v.reg)) t->variaveis_pendentes--;
+    return v;
+}
+
+// Registrador com o valor: constantes são copiadas para um temporário
+static RegRI materializar(Tradutor* t, ValorRI v) {
+    if (!v.constante) return v.reg;
+    RegRI r = novo_temp(t);
+    InstrRI* in = emitir(t, RI_COPIA);
+    if (in == NULL) return r;
+    in->d = r;
+    in->imediato = 1;
+    in->k = v.k;
+    return r;
+}
+
+// Antes de redefinir 'x': os valores pendentes que o leem passam a ler uma cópia
+static void preservar_pendentes(Tradutor* t, RegRI x) {
+    if (t->variaveis_pendentes == 0) return;
+    RegRI copia = RI_NENHUM;
+    for (uint32_t i = 0; i < t->num_valores; i++) {
+        ValorRI* v = &t->valores[i];
+        if (v->constante || v->reg != x) continue;
+        if (copia == RI_NENHUM) {
+            copia = novo_temp(t);
+            InstrRI* in = emitir(t, RI_COPIA);
+            if (in == NULL) return;
+            in->d = copia;
+            in->a = x;
+        }
+        v->reg = copia;
+        t->variaveis_pendentes--;
+    }
+}
+
+// Antes de código que nem sempre executa: todos os valores pendentes passam a ler cópias
+static void copiar_pendentes(Tradutor* t) {
+    for (uint32_t i = 0; i < t->num_valores && t->variaveis_pendentes > 0; i++) {
+        const ValorRI* v = &t->valores[i];
+        if (!v->constante && !RI_EH_TEMPORARIO(t->f, v->reg)) preservar_pendentes(t, v->reg);
+    }
+}
+
+/*
+ * x = v para um local ou parâmetro 'x'. Se 'v' é o temporário que a última
+ * instrução do bloco acabou de definir (e nenhuma cópia de 'x' entrou depois
+ * dela), a instrução passa a definir 'x' direto.
+ * Deixa o valor atribuído na pilha.
+ */
+static void atribuir_variavel(Tradutor* t, RegRI x, ValorRI v) {
+    if (!v.constante && v.reg == x) {
+        empilhar(t, v);
+        return;
+    }
+    preservar_pendentes(t, x);
+    const BlocoRI* b = &t->f->blocos[t->bloco];
+    if (!v.constante && RI_EH_TEMPORARIO(t->f, v.reg) && b->num_instrs > 0 &&
+        ri_definicao(RI_INSTR(t->f, t->bloco, b->num_instrs - 1)) == v.reg) {
+        RI_INSTR(t->f, t->bloco, b->num_instrs - 1)->d = x;
+    } else {
+        InstrRI* in = emitir(t, RI_COPIA);
+        if (in == NULL) return;
+        in->d = x;
+        in->a = v.reg;
+        in->imediato = v.constante;
+        in->k = v.k;
+    }
+    if (v.constante) {
+        empilhar(t, v);
+    } else {
+        empilhar_reg(t, x);
+    }
+}
+
+// Registrador de um local ou parâmetro (RI_NENHUM para globais e funções)
+static RegRI reg_variavel(Tradutor* t, NoAst id_node) {
+    const Ligacao* lig = &AST_LIGACAO(t->ast, id_node);
+    if (lig->classe == LIG_LOCAL) return (RegRI) lig->slot;
+    if (lig->classe == LIG_PARAMETRO) return t->f->num_locais + (RegRI) lig->slot;
+    return RI_NENHUM;
+}
+
+static uint32_t indice_global(Tradutor* t, NoAst id_node) {
+    return mapa_buscar(&t->globais, AST_ATOMO(t->ast, id_node));
+}
+
+// --- Numeração de Sethi e Ullman ---
+
+/* Os 7 bits baixos contam os temporários (saturados); o alto marca os nós
+ * com efeitos colaterais, cujos operandos não podem trocar de ordem */
+#define NECESSIDADE_MAXIMA 127u
+#define NECESSIDADE_IMPURO 128u
+#define NECESSIDADE(t, no) ((t)->necessidade[no] & NECESSIDADE_MAXIMA)
+#define EH_PURO(t, no)     (!((t)->necessidade[no] & NECESSIDADE_IMPURO))
+
+// O valor do nó ocupa um temporário enquanto espera o outro operando?
+static int ocupa_temporario(Tradutor* t, NoAst no) {
+    return NECESSIDADE(t, no) > 0;
+}
+
+// Temporários para calcular 'primeiro' e depois 'segundo' e combiná-los
+static unsigned custo_ordem(Tradutor* t, NoAst primeiro, NoAst segundo) {
+    unsigned custo = NECESSIDADE(t, primeiro);
+    unsigned depois = (unsigned) ocupa_temporario(t, primeiro) + NECESSIDADE(t, segundo);
+    if (depois > custo) custo = depois;
+    return custo > 0 ? custo : 1;
+}
+
+// Calcula o direito antes do esquerdo? Só entre operandos sem efeitos colaterais
+static int inverter_operandos(Tradutor* t, NoAst no) {
+    NoAst esq = AST_FILHO(t->ast, no, 0), dir = AST_FILHO(t->ast, no, 1);
+    return EH_PURO(t, esq) && EH_PURO(t, dir) && custo_ordem(t, dir, esq) < custo_ordem(t, esq, dir);
+}
+
+static void numerar_no(void* dados, NoAst no, intptr_t salvo) {
+    Tradutor* t = (Tradutor*) dados;
+    const Ast* ast = t->ast;
+    unsigned n = 0, impuro = 0;
+
+    switch (AST_TIPO(ast, no)) {
+        case NO_INT_CONST:
+        case NO_CAR_CONST:
+        case NO_TEMP:
+            break;
+        case NO_ID:
+        {
+            ClasseLigacao classe = AST_LIGACAO(ast, no).classe;
+            n = classe == LIG_GLOBAL || classe == LIG_FUNCAO;
+            break;
+        }
+        case NO_NEG:
+        {
+            NoAst filho = AST_FILHO(ast, no, 0);
+            n = NECESSIDADE(t, filho) > 0 ? NECESSIDADE(t, filho) : 1;
+            impuro = !EH_PURO(t, filho);
+            break;
+        }
+        case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL:
+        {
+            NoAst esq = AST_FILHO(ast, no, 0), dir = AST_FILHO(ast, no, 1);
+            n = inverter_operandos(t, no) ? custo_ordem(t, dir, esq) : custo_ordem(t, esq, dir);
+            impuro = !EH_PURO(t, esq) || !EH_PURO(t, dir);
+            break;
+        }
+        case NO_E:
+        case NO_OU:
+        {
+            // Os operandos desviam um depois do outro, e nenhum espera pelo outro
+            NoAst esq = AST_FILHO(ast, no, 0), dir = AST_FILHO(ast, no, 1);
+            n = NECESSIDADE(t, esq) > NECESSIDADE(t, dir) ? NECESSIDADE(t, esq) : NECESSIDADE(t, dir);
+            if (n == 0) n = 1;
+            impuro = !EH_PURO(t, esq) || !EH_PURO(t, dir);
+            break;
+        }
+        case NO_CHAMADA_FUNC:
+        {
+            // Cada argumento espera num temporário enquanto os seguintes são calculados
+            unsigned i = 0;
+            n = 1;
+            for (NoAst arg = AST_FILHO(ast, no, 1); arg != NO_NENHUM; arg = AST_PROX(ast, arg), i++) {
+                if (i + NECESSIDADE(t, arg) > n) n = i + NECESSIDADE(t, arg);
+            }
+            impuro = 1;
+            break;
+        }
+        case NO_ATRIBUICAO:
+        case NO_GUARDA:
+            n = NECESSIDADE(t, AST_FILHO(ast, no, AST_TIPO(ast, no) == NO_ATRIBUICAO ? 1 : 0));
+            impuro = 1;
+            break;
+        default:
+            impuro = 1;
+            break;
+    }
+    if (n > NECESSIDADE_MAXIMA) n = NECESSIDADE_MAXIMA;
+    t->necessidade[no] = (uint8_t) (n | (impuro ? NECESSIDADE_IMPURO : 0));
+}
+
+// --- Percurso ---
+
+static int eh_expressao(TipoNo tipo) {
+    switch (tipo) {
+        case NO_ATRIBUICAO:
+        case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL: case NO_E: case NO_OU: case NO_NEG:
+        case NO_ID: case NO_INT_CONST: case NO_CAR_CONST: case NO_CHAMADA_FUNC:
+        case NO_GUARDA: case NO_TEMP:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Desvia para 'verdadeiro' se o valor no topo da pilha não é zero, senão
+ * para 'falso'. Se o valor é o temporário da comparação que a última
+ * instrução do bloco acabou de fazer, o desvio faz a comparação no lugar dela.
+ */
+static void desviar(Tradutor* t, uint32_t verdadeiro, uint32_t falso) {
+    ValorRI c = desempilhar(t);
+    if (c.constante) {
+        terminar(t, RI_SALTO, c.k != 0 ? verdadeiro : falso, RI_NENHUM, verdadeiro);
+        return;
+    }
+    InstrRI comparacao = { RI_DIF, 1, 0, 0, RI_NENHUM, c.reg, RI_NENHUM, 0 };
+    const BlocoRI* b = &t->f->blocos[t->bloco];
+    if (RI_EH_TEMPORARIO(t->f, c.reg) && b->num_instrs > 0) {
+        const InstrRI* ultima = RI_INSTR(t->f, t->bloco, b->num_instrs - 1);
+        if (ultima->op >= RI_IGUAL && ultima->op <= RI_MENOR_IGUAL && ultima->d == c.reg) {
+            comparacao = *ultima;
+            ri_remover(t->f, t->bloco, b->num_instrs - 1);
+        }
+    }
+    InstrRI* in = terminar(t, RI_DESVIO, verdadeiro, falso, verdadeiro);
+    if (in == NULL) return;
+    in->cond = comparacao.op;
+    in->a = comparacao.a;
+    in->b = comparacao.b;
+    in->imediato = comparacao.imediato;
+    in->k = comparacao.k;
+}
+
+// O nó 'no' será traduzido como condição
+static void marcar_condicao(Tradutor* t, NoAst no, uint32_t verdadeiro, uint32_t falso) {
+    CondicaoRI c = { no, verdadeiro, falso, RI_NENHUM, RI_NENHUM, RI_NENHUM };
+    t->proxima = c;
+}
+
+static CondicaoRI* empilhar_condicao(Tradutor* t, const CondicaoRI* c) {
+    if (t->num_condicoes == t->capacidade_condicoes) {
+        uint32_t nova = t->capacidade_condicoes ? t->capacidade_condicoes * 2 : 16;
+        CondicaoRI* condicoes = realloc(t->condicoes, nova * sizeof(CondicaoRI));
+        if (!condicoes) {
+            t->sem_memoria = 1;
+            return NULL;
+        }
+        t->condicoes = condicoes;
+        t->capacidade_condicoes = nova;
+    }
+    CondicaoRI* topo = &t->condicoes[t->num_condicoes++];
+    *topo = *c;
+    return topo;
+}
+
+// Condição do nó 'no', se ele está sendo traduzido como uma
+static CondicaoRI* condicao_de(Tradutor* t, NoAst no) {
+    if (t->num_condicoes == 0 || t->condicoes[t->num_condicoes - 1].no != no) return NULL;
+    return &t->condicoes[t->num_condicoes - 1];
+}
+
+// r = k no bloco 'b', que segue para 'fim'
+static void definir_valor(Tradutor* t, uint32_t b, RegRI r, int32_t k, uint32_t fim) {
+    t->bloco = b;
+    InstrRI* in = emitir(t, RI_COPIA);
+    if (in == NULL) return;
+    in->d = r;
+    in->imediato = 1;
+    in->k = k;
+    terminar(t, RI_SALTO, fim, RI_NENHUM, fim);
+}
+
+static OpRI operador(TipoNo tipo) {
+    switch (tipo) {
+        case NO_SOMA: return RI_SOMA;
+        case NO_SUB: return RI_SUB;
+        case NO_MULT: return RI_MULT;
+        case NO_DIV: return RI_DIV;
+        case NO_IGUAL: return RI_IGUAL;
+        case NO_DIF: return RI_DIF;
+        case NO_MAIOR: return RI_MAIOR;
+        case NO_MENOR: return RI_MENOR;
+        case NO_MAIOR_IGUAL: return RI_MAIOR_IGUAL;
+        default: return RI_MENOR_IGUAL;
+    }
+}
+
+// Operador com os operandos trocados (a op b == b troca(op) a), ou -1
+static int trocado(OpRI op) {
+    switch (op) {
+        case RI_SOMA: case RI_MULT: case RI_IGUAL: case RI_DIF:
+            return op;
+        case RI_MAIOR: return RI_MENOR;
+        case RI_MENOR: return RI_MAIOR;
+        case RI_MAIOR_IGUAL: return RI_MENOR_IGUAL;
+        case RI_MENOR_IGUAL: return RI_MAIOR_IGUAL;
+        default: return -1;
+    }
+}
+
+static void traduzir_binario(Tradutor* t, OpRI op, int invertido) {
+    ValorRI dir, esq;
+    if (invertido) {
+        esq = desempilhar(t);
+        dir = desempilhar(t);
+    } else {
+        dir = desempilhar(t);
+        esq = desempilhar(t);
+    }
+    if (esq.constante && !dir.constante && trocado(op) >= 0) {
+        ValorRI v = esq;
+        esq = dir;
+        dir = v;
+        op = (OpRI) trocado(op);
+    }
+    RegRI a = materializar(t, esq);
+    RegRI d = novo_temp(t);
+    InstrRI* in = emitir(t, op);
+    if (in == NULL) return;
+    in->d = d;
+    in->a = a;
+    in->b = dir.reg;
+    in->imediato = dir.constante;
+    in->k = dir.k;
+    empilhar_reg(t, d);
+}
+
+static unsigned entrar_no(void* dados, NoAst no, intptr_t* salvo) {
+    Tradutor* t = (Tradutor*) dados;
+    const Ast* ast = t->ast;
+
+    if (t->proxima.no == no) {
+        t->proxima.no = NO_NENHUM;
+        CondicaoRI c = t->proxima;
+        c.no = no;
+        if (empilhar_condicao(t, &c) == NULL) return PERCURSO_NENHUM;
+    }
+
+    switch (AST_TIPO(ast, no)) {
+        case NO_DECL_VAR:
+        case NO_DECL_FUNC:
+        case NO_NULO:
+            return PERCURSO_NENHUM;
+
+        case NO_BLOCO:
+            return 1u << 1;
+
+        case NO_ATRIBUICAO:
+            return 1u << 1;
+
+        case NO_SE:
+        {
+            // Então, senão (se houver) e fim, em blocos consecutivos
+            uint32_t primeiro = novo_bloco(t);
+            novo_bloco(t);
+            if (AST_FILHO(ast, no, 2) != NO_NENHUM) novo_bloco(t);
+            *salvo = primeiro;
+            marcar_condicao(t, AST_FILHO(ast, no, 0), primeiro, primeiro + 1);
+            return PERCURSO_TODOS;
+        }
+
+        case NO_ENQUANTO:
+        {
+            // Teste, corpo e saída
+            uint32_t teste = novo_bloco(t);
+            novo_bloco(t);
+            novo_bloco(t);
+            *salvo = teste;
+            if (!t->sem_memoria) terminar(t, RI_SALTO, teste, RI_NENHUM, teste);
+            marcar_condicao(t, AST_FILHO(ast, no, 0), teste + 1, teste + 2);
+            return PERCURSO_TODOS;
+        }
+
+        case NO_LEIA:
+        {
+            NoAst id_node = AST_FILHO(ast, no, 0);
+            RegRI x = reg_variavel(t, id_node);
+            InstrRI* in = emitir(t, RI_LEIA);
+            if (in == NULL) return PERCURSO_NENHUM;
+            if (x != RI_NENHUM) {
+                in->d = x;
+            } else {
+                in->d = novo_temp(t);
+                RegRI lido = in->d;
+                in = emitir(t, RI_GUARDA);
+                if (in == NULL) return PERCURSO_NENHUM;
+                in->a = lido;
+                in->k = (int32_t) indice_global(t, id_node);
+            }
+            return PERCURSO_NENHUM;
+        }
+
+        case NO_ESCREVA:
+        {
+            NoAst valor = AST_FILHO(ast, no, 0);
+            if (AST_TIPO(ast, valor) != NO_CADEIA_CAR) return PERCURSO_TODOS;
+            ProgramaRI* prog = t->prog;
+            if (prog->num_cadeias == t->capacidade_cadeias) {
+                uint32_t nova = t->capacidade_cadeias ? t->capacidade_cadeias * 2 : 16;
+                CadeiaRI* cadeias = realloc(prog->cadeias, nova * sizeof(CadeiaRI));
+                if (!cadeias) {
+                    t->sem_memoria = 1;
+                    return PERCURSO_NENHUM;
+                }
+                prog->cadeias = cadeias;
+                t->capacidade_cadeias = nova;
+            }
+            prog->cadeias[prog->num_cadeias].texto = AST_LEXEMA(ast, valor);
+            prog->cadeias[prog->num_cadeias].tamanho = AST_FOLHA(ast, valor).tamanho;
+            InstrRI* in = emitir(t, RI_ESCREVA_CADEIA);
+            if (in != NULL) in->k = (int32_t) prog->num_cadeias++;
+            return PERCURSO_NENHUM;
+        }
+
+        case NO_CHAMADA_FUNC:
+            return 1u << 1;
+
+        case NO_NOVALINHA:
+            emitir(t, RI_NOVALINHA);
+            return PERCURSO_NENHUM;
+
+        case NO_INT_CONST:
+            empilhar_constante(t, AST_VALOR_INT(ast, no));
+            return PERCURSO_NENHUM;
+        case NO_CAR_CONST:
+            empilhar_constante(t, AST_FOLHA(ast, no).valor);
+            return PERCURSO_NENHUM;
+
+        case NO_ID:
+        {
+            const Ligacao* lig = &AST_LIGACAO(ast, no);
+            if (lig->classe == LIG_LOCAL || lig->classe == LIG_PARAMETRO) {
+                empilhar_reg(t, reg_variavel(t, no));
+            } else {
+                RegRI d = novo_temp(t);
+                InstrRI* in = emitir(t, lig->classe == LIG_GLOBAL ? RI_CARREGA : RI_ENDERECO);
+                if (in == NULL) return PERCURSO_NENHUM;
+                in->d = d;
+                in->k = (int32_t) (lig->classe == LIG_GLOBAL ? indice_global(t, no)
+                                                             : mapa_buscar(&t->funcoes, AST_ATOMO(ast, no)));
+                empilhar_reg(t, d);
+            }
+            return PERCURSO_NENHUM;
+        }
+
+        case NO_TEMP:
+            empilhar_reg(t, (RegRI) AST_SLOT(ast, no));
+            return PERCURSO_NENHUM;
+
+        case NO_E:
+        case NO_OU:
+        {
+            CondicaoRI* c = condicao_de(t, no);
+            if (c == NULL) {
+                // Valor 0 ou 1: verdadeiro, falso e fim. Uma atribuição no
+                // operando direito não pode alcançar os valores pendentes
+                if (!EH_PURO(t, no)) copiar_pendentes(t);
+                CondicaoRI valor = { no, RI_NENHUM, RI_NENHUM, RI_NENHUM, RI_NENHUM, novo_temp(t) };
+                valor.verdadeiro = novo_bloco(t);
+                valor.falso = novo_bloco(t);
+                valor.fim = novo_bloco(t);
+                c = empilhar_condicao(t, &valor);
+                if (c == NULL || t->sem_memoria) return PERCURSO_NENHUM;
+            }
+            c->meio = novo_bloco(t);
+            if (AST_TIPO(ast, no) == NO_E) {
+                marcar_condicao(t, AST_FILHO(ast, no, 0), c->meio, c->falso);
+            } else {
+                marcar_condicao(t, AST_FILHO(ast, no, 0), c->verdadeiro, c->meio);
+            }
+            return PERCURSO_TODOS;
+        }
+
+        case NO_NEG:
+        {
+            const CondicaoRI* c = condicao_de(t, no);
+            if (c != NULL) marcar_condicao(t, AST_FILHO(ast, no, 0), c->falso, c->verdadeiro);
+            return PERCURSO_TODOS;
+        }
+
+        case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL:
+            if (inverter_operandos(t, no)) {
+                *salvo = 1;
+                return PERCURSO_TODOS | PERCURSO_INVERTIDO;
+            }
+            return PERCURSO_TODOS;
+
+        default:
+            return PERCURSO_TODOS;
+    }
+}
+
+static void depois_filho(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo) {
+    Tradutor* t = (Tradutor*) dados;
+    const Ast* ast = t->ast;
+
+    // Comando de expressão: o valor é descartado
+    TipoNo tipo = AST_TIPO(ast, no);
+    if ((tipo == NO_BLOCO || ((tipo == NO_SE || tipo == NO_ENQUANTO) && filho > 0)) &&
+        eh_expressao(AST_TIPO(ast, elemento))) {
+        desempilhar(t);
+    }
+    if (t->sem_memoria) return;
+
+    switch (tipo) {
+        case NO_SE:
+        {
+            uint32_t entao = (uint32_t) *salvo;
+            int tem_senao = AST_FILHO(ast, no, 2) != NO_NENHUM;
+            uint32_t fim = entao + (tem_senao ? 2 : 1);
+            if (filho == 0) {
+                t->bloco = entao; // A condição já desviou
+            } else if (filho == 1) {
+                terminar(t, RI_SALTO, fim, RI_NENHUM, tem_senao ? entao + 1 : fim);
+            } else {
+                terminar(t, RI_SALTO, fim, RI_NENHUM, fim);
+            }
+            break;
+        }
+
+        case NO_ENQUANTO:
+        {
+            uint32_t teste = (uint32_t) *salvo;
+            if (filho == 0) {
+                t->bloco = teste + 1;
+            } else {
+                terminar(t, RI_SALTO, teste, RI_NENHUM, teste + 2);
+            }
+            break;
+        }
+
+        case NO_E:
+        case NO_OU:
+        {
+            // O esquerdo não decidiu: o direito começa no bloco do meio
+            const CondicaoRI* c = condicao_de(t, no);
+            if (filho == 0 && c != NULL) {
+                t->bloco = c->meio;
+                marcar_condicao(t, AST_FILHO(ast, no, 1), c->verdadeiro, c->falso);
+            }
+            break;
+        }
+
+        case NO_CHAMADA_FUNC:
+            (*salvo)++;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Saída de um nó que deixa o valor na pilha
+static void sair_valor(Tradutor* t, NoAst no, intptr_t salvo) {
+    const Ast* ast = t->ast;
+
+    switch (AST_TIPO(ast, no)) {
+        case NO_ATRIBUICAO:
+        {
+            NoAst id_node = AST_FILHO(ast, no, 0);
+            ValorRI v = desempilhar(t);
+            RegRI x = reg_variavel(t, id_node);
+            if (x != RI_NENHUM) {
+                atribuir_variavel(t, x, v);
+                break;
+            }
+            RegRI a = materializar(t, v);
+            InstrRI* in = emitir(t, RI_GUARDA);
+            if (in == NULL) break;
+            in->a = a;
+            in->k = (int32_t) indice_global(t, id_node);
+            empilhar(t, v);
+            break;
+        }
+
+        case NO_GUARDA:
+            atribuir_variavel(t, (RegRI) AST_SLOT(ast, no), desempilhar(t));
+            break;
+
+        case NO_ESCREVA:
+        {
+            NoAst valor = AST_FILHO(ast, no, 0);
+            if (AST_TIPO(ast, valor) == NO_CADEIA_CAR) break;
+            ValorRI v = desempilhar(t);
+            InstrRI* in = emitir(t, AST_TIPO_DADO(ast, valor) == TIPO_CAR ? RI_ESCREVA_CAR : RI_ESCREVA);
+            if (in == NULL) break;
+            in->a = v.reg;
+            in->imediato = v.constante;
+            in->k = v.k;
+            break;
+        }
+
+        case NO_CHAMADA_FUNC:
+        {
+            FuncaoRI* f = t->f;
+            uint32_t n = (uint32_t) salvo;
+            if (f->num_argumentos + n > f->capacidade_argumentos) {
+                uint32_t nova = f->capacidade_argumentos ? f->capacidade_argumentos : 64;
+                while (nova < f->num_argumentos + n) nova *= 2;
+                RegRI* argumentos = realloc(f->argumentos, nova * sizeof(RegRI));
+                if (!argumentos) {
+                    t->sem_memoria = 1;
+                    break;
+                }
+                f->argumentos = argumentos;
+                f->capacidade_argumentos = nova;
+            }
+            // Argumentos da esquerda para a direita, a partir do fundo da pilha
+            uint32_t base = t->num_valores - n;
+            uint32_t inicio = f->num_argumentos;
+            for (uint32_t i = 0; i < n; i++) {
+                f->argumentos[inicio + i] = materializar(t, t->valores[base + i]);
+            }
+            for (uint32_t i = 0; i < n; i++) desempilhar(t);
+            f->num_argumentos += n;
+            RegRI d = novo_temp(t);
+            InstrRI* in = emitir(t, RI_CHAMADA);
+            if (in == NULL) break;
+            in->d = d;
+            in->a = inicio;
+            in->b = n;
+            in->k = (int32_t) mapa_buscar(&t->funcoes, AST_ATOMO(ast, AST_FILHO(ast, no, 0)));
+            empilhar_reg(t, d);
+            break;
+        }
+
+        case NO_RETORNE:
+        {
+            ValorRI v = desempilhar(t);
+            // No bloco principal o valor é calculado e descartado, como no gerador da AST
+            if (t->f != &t->prog->principal) {
+                uint32_t seguinte = novo_bloco(t);
+                InstrRI* in = terminar(t, RI_RETORNE, RI_NENHUM, RI_NENHUM, seguinte);
+                if (in == NULL) break;
+                in->a = v.reg;
+                in->imediato = v.constante;
+                in->k = v.k;
+            }
+            break;
+        }
+
+        case NO_NEG:
+        {
+            RegRI a = materializar(t, desempilhar(t));
+            RegRI d = novo_temp(t);
+            InstrRI* in = emitir(t, RI_NAO);
+            if (in == NULL) break;
+            in->d = d;
+            in->a = a;
+            empilhar_reg(t, d);
+            break;
+        }
+
+        case NO_SOMA: case NO_SUB: case NO_MULT: case NO_DIV:
+        case NO_IGUAL: case NO_DIF: case NO_MAIOR: case NO_MENOR:
+        case NO_MAIOR_IGUAL: case NO_MENOR_IGUAL:
+            traduzir_binario(t, operador(AST_TIPO(ast, no)), (int) salvo);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Saída de um nó traduzido como condição: o bloco termina com os desvios
+static void sair_condicao(Tradutor* t, NoAst no, intptr_t salvo) {
+    CondicaoRI c = t->condicoes[--t->num_condicoes];
+    switch (AST_TIPO(t->ast, no)) {
+        case NO_E:
+        case NO_OU:
+            // Os operandos já desviaram; fora de condição, falta o valor
+            if (c.valor != RI_NENHUM) {
+                definir_valor(t, c.verdadeiro, c.valor, 1, c.fim);
+                definir_valor(t, c.falso, c.valor, 0, c.fim);
+                empilhar_reg(t, c.valor);
+            }
+            break;
+
+        case NO_NEG:
+            break; // O operando já desviou, com os destinos trocados
+
+        default:
+            sair_valor(t, no, salvo);
+            desviar(t, c.verdadeiro, c.falso);
+            break;
+    }
+}
+
+static void sair_no(void* dados, NoAst no, intptr_t salvo) {
+    Tradutor* t = (Tradutor*) dados;
+    if (t->sem_memoria) return;
+    if (condicao_de(t, no) != NULL) {
+        sair_condicao(t, no, salvo);
+    } else {
+        sair_valor(t, no, salvo);
+    }
+}
+
+// Traduz o corpo 'corpo' para 'f', que termina com um retorno sem valor
+static int traduzir_corpo(Tradutor* t, FuncaoRI* f, NoAst corpo) {
+    static const VisitanteAst traducao = { entrar_no, depois_filho, sair_no };
+    t->f = f;
+    t->num_valores = 0;
+    t->variaveis_pendentes = 0;
+    f->num_regs = f->num_locais + f->num_params;
+    t->bloco = novo_bloco(t);
+    if (t->sem_memoria) return -1;
+    if (percorrer_ast(t->ast, corpo, &traducao, t) != 0 || t->sem_memoria) return -1;
+    terminar(t, RI_RETORNE, RI_NENHUM, RI_NENHUM, RI_NENHUM);
+    return t->sem_memoria ? -1 : 0;
+}
+
+int ri_traduzir(const Ast* ast, NoAst raiz, ProgramaRI* prog) {
+    memset(prog, 0, sizeof(ProgramaRI));
+    prog->ast = ast;
+    if (raiz == NO_NENHUM) return -1;
+
+    Tradutor t;
+    memset(&t, 0, sizeof(Tradutor));
+    t.ast = ast;
+    t.prog = prog;
+    int resultado = -1;
+    static const VisitanteAst numeracao = { NULL, NULL, numerar_no };
+    t.necessidade = malloc(ast->num_nos);
+    if (t.necessidade == NULL || percorrer_ast(ast, raiz, &numeracao, &t) != 0) goto fim;
+
+    // Globais e funções, na ordem da declaração
+    uint32_t num_globais = 0, num_funcoes = 0;
+    for (NoAst decl = AST_FILHO(ast, raiz, 0); decl != NO_NENHUM; decl = AST_PROX(ast, decl)) {
+        if (AST_TIPO(ast, decl) == NO_DECL_VAR) num_globais++;
+        if (AST_TIPO(ast, decl) == NO_DECL_FUNC) num_funcoes++;
+    }
+    prog->globais = malloc((num_globais > 0 ? num_globais : 1) * sizeof(const char*));
+    prog->funcoes = calloc(num_funcoes > 0 ? num_funcoes : 1, sizeof(FuncaoRI));
+    if (!prog->globais || !prog->funcoes || mapa_iniciar(&t.globais, num_globais) != 0 ||
+        mapa_iniciar(&t.funcoes, num_funcoes) != 0) {
+        goto fim;
+    }
+    for (NoAst decl = AST_FILHO(ast, raiz, 0); decl != NO_NENHUM; decl = AST_PROX(ast, decl)) {
+        Atomo nome = AST_ATOMO(ast, AST_FILHO(ast, decl, 0));
+        if (AST_TIPO(ast, decl) == NO_DECL_VAR) {
+            mapa_inserir(&t.globais, nome, prog->num_globais);
+            prog->globais[prog->num_globais++] = nome.texto;
+        } else if (AST_TIPO(ast, decl) == NO_DECL_FUNC) {
+            FuncaoRI* f = &prog->funcoes[prog->num_funcoes];
+            mapa_inserir(&t.funcoes, nome, prog->num_funcoes++);
+            f->nome = nome.texto;
+            f->no = decl;
+            f->num_locais = (uint32_t) AST_NUM_LOCAIS(ast, decl);
+            for (NoAst p = AST_FILHO(ast, decl, 1); p != NO_NENHUM; p = AST_PROX(ast, p)) f->num_params++;
+        }
+    }
+
+    prog->principal.nome = "main";
+    prog->principal.no = raiz;
+    prog->principal.num_locais = (uint32_t) AST_NUM_LOCAIS(ast, raiz);
+    if (traduzir_corpo(&t, &prog->principal, AST_FILHO(ast, raiz, 1)) != 0) goto fim;
+    for (uint32_t i = 0; i < prog->num_funcoes; i++) {
+        FuncaoRI* f = &prog->funcoes[i];
+        if (traduzir_corpo(&t, f, AST_FILHO(ast, f->no, 2)) != 0) goto fim;
+    }
+    resultado = ri_analisar(prog);
+
+fim:
+    free(t.necessidade);
+    free(t.valores);
+    free(t.condicoes);
+    mapa_liberar(&t.globais);
+    mapa_liberar(&t.funcoes);
+    if (resultado != 0) ri_liberar(prog);
+    return resultado;
+}
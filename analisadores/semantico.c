@@ -3,16 +3,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include "semantico.h"
+#include "percurso.h"
 
-// Variáveis globais para controle interno da análise
-static int g_erros_semanticos = 0;
-static Tipo g_tipo_retorno_esperado = TIPO_INT; // Para validar 'retorne'
-static int g_dentro_de_funcao = 0; // Flag para saber se estamos dentro de uma função
+// Estado da análise de uma compilação
+typedef struct {
+    Ast* ast;                   // Árvore verificada: recebe tipos, ligações e quadros
+    ScopeStack* pilha;
+    FILE* diagnosticos;         // Onde os erros são escritos
+    int erros;
+    Tipo tipo_retorno_esperado; // Para validar 'retorne'
+    int dentro_de_funcao;       // Flag para saber se estamos dentro de uma função
+    int proximo_slot;           // Próximo slot local livre no quadro atual
+    int max_slots;              // Maior número de slots locais vivos no quadro atual
+    int corpo_de_funcao;        // O próximo bloco é o corpo da função (sem escopo novo)
+} AnaliseSemantica;
 
 // Para imprimir erros com linha
-void erro_semantico(int linha, const char* mensagem) {
-    fprintf(stderr, "ERRO SEMANTICO (Linha %d): %s\n", linha, mensagem);
-    g_erros_semanticos++;
+static void erro_semantico(AnaliseSemantica* s, int linha, const char* mensagem) {
+    fprintf(s->diagnosticos, "ERRO SEMANTICO (Linha %d): %s\n", linha, mensagem);
+    s->erros++;
 }
 
 // Auxiliar para mensagens de erro
@@ -22,274 +31,310 @@ const char* nome_tipo(Tipo t) {
     return "indefinido";
 }
 
-// Funções internas para percorrer a árvore recursivamente
-void analisar_no(ASTNode* no, ScopeStack* pilha);
-Tipo inferir_tipo_expressao(ASTNode* no, ScopeStack* pilha);
+// Registra no nó NO_ID a declaração que ele referencia
+static void ligar_simbolo(AnaliseSemantica* s, NoAst id_node, Symbol* sym) {
+    Ligacao* lig = &AST_LIGACAO(s->ast, id_node);
+    if (sym->categoria == CAT_FUNCAO) {
+        lig->classe = LIG_FUNCAO;
+        lig->funcao = sym;
+    } else if (sym->nivel == 0) {
+        lig->classe = LIG_GLOBAL;
+    } else if (sym->categoria == CAT_PARAMETRO) {
+        lig->classe = LIG_PARAMETRO;
+    } else {
+        lig->classe = LIG_LOCAL;
+    }
+    lig->slot = sym->ordem;
+}
 
-/* --- Função Principal --- */
-int verificar_semantica(ASTNode* raiz, ScopeStack* pilha_semantica) {
-    g_erros_semanticos = 0;
-    
-    printf("\n--- Iniciando Analise Semantica ---\n");
-    
-    // Começa a percorrer a árvore
-    if (raiz != NULL) {
-        analisar_no(raiz, pilha_semantica);
+/* --- Declarações --- */
+
+static void declarar_variavel(AnaliseSemantica* s, NoAst decl) {
+    NoAst id_node = AST_FILHO(s->ast, decl, 0); // NO_ID
+
+    // Variáveis locais recebem o próximo slot livre do quadro
+    int slot = -1;
+    if (s->pilha->topo->nivel > 0) {
+        slot = s->proximo_slot;
     }
-    
-    if (g_erros_semanticos == 0) {
-        printf("Analise semantica concluida com SUCESSO.\n");
-        return 0;
+
+    // Tenta inserir. Se falhar, é redeclaração no mesmo escopo.
+    Symbol* sym = inserir_variavel(s->pilha, AST_ATOMO(s->ast, id_node), AST_TIPO_DADO(s->ast, decl), slot);
+    if (sym == NULL) {
+        char msg[100];
+        sprintf(msg, "Variavel '%s' ja declarada neste escopo.", AST_LEXEMA(s->ast, id_node));
+        erro_semantico(s, AST_LINHA(s->ast, decl), msg);
     } else {
-        printf("Analise semantica concluida com %d ERROS.\n", g_erros_semanticos);
-        return 1;
+        if (slot >= 0 && ++s->proximo_slot > s->max_slots) {
+            s->max_slots = s->proximo_slot;
+        }
+        ligar_simbolo(s, id_node, sym);
     }
 }
 
-void analisar_no(ASTNode* no, ScopeStack* pilha) {
-    if (no == NULL) return;
+static void entrar_funcao(AnaliseSemantica* s, NoAst no) {
+    NoAst id_func = AST_FILHO(s->ast, no, 0);
+    Symbol* sym_func = inserir_funcao(s->pilha, AST_ATOMO(s->ast, id_func), AST_TIPO_DADO(s->ast, no), 0);
 
-    switch (no->tipo) {
-        case NO_PROGRAMA:
-            analisar_no(no->filho[0], pilha); // DeclFuncVar
-            analisar_no(no->filho[1], pilha); // DeclProg
-            break;
+    if (sym_func == NULL) {
+        char msg[100];
+        sprintf(msg, "Funcao '%s' ja declarada.", AST_LEXEMA(s->ast, id_func));
+        erro_semantico(s, AST_LINHA(s->ast, no), msg);
+    }
 
-        case NO_DECL_VAR:
-        {
-            ASTNode* atual = no;
-            while (atual != NULL && atual->tipo == NO_DECL_VAR) {
-                ASTNode* id_node = atual->filho[0]; // NO_ID
-                
-                // Tenta inserir. Se falhar, é redeclaração no mesmo escopo.
-                if (inserir_variavel(pilha, id_node->valor_lexico, atual->tipo_dado, 0) == NULL) {
-                    char msg[100];
-                    sprintf(msg, "Variavel '%s' ja declarada neste escopo.", id_node->valor_lexico);
-                    erro_semantico(atual->linha, msg);
-                }
-                atual = atual->prox;
-            }
-            // Continua declarações globais (caso a próxima seja função, o loop para sem concluir tudo)
-            if (atual != NULL)
-                analisar_no(atual, pilha);
+    if (sym_func != NULL) {
+        ligar_simbolo(s, id_func, sym_func);
+    }
+
+    // Contexto para validação de retorno
+    s->tipo_retorno_esperado = AST_TIPO_DADO(s->ast, no);
+    s->dentro_de_funcao = 1;
+    s->proximo_slot = 0;
+    s->max_slots = 0;
+
+    criar_novo_escopo(s->pilha);
+
+    // Processamento dos parâmetros: o slot é a posição na lista
+    int ordem_param = 0;
+    for (NoAst p = AST_FILHO(s->ast, no, 1); p != NO_NENHUM; p = AST_PROX(s->ast, p), ordem_param++) {
+        NoAst p_id = AST_FILHO(s->ast, p, 0);
+        Symbol* sym_param = inserir_parametro(s->pilha, AST_ATOMO(s->ast, p_id), AST_TIPO_DADO(s->ast, p), ordem_param);
+        if (sym_param == NULL) {
+            char msg[100];
+            sprintf(msg, "Variavel '%s' ja declarada neste escopo.", AST_LEXEMA(s->ast, p_id));
+            erro_semantico(s, AST_LINHA(s->ast, p), msg);
+        } else {
+            ligar_simbolo(s, p_id, sym_param);
         }
-        break;
+
+        if (sym_func != NULL) {
+            adicionar_info_parametro(sym_func, AST_ATOMO(s->ast, p_id), AST_TIPO_DADO(s->ast, p));
+            sym_func->num_args++;
+        }
+    }
+
+    // O bloco do corpo compartilha o escopo dos parâmetros
+    s->corpo_de_funcao = 1;
+}
+
+/* --- Percurso --- */
+
+/*
+ * Ao entrar num nó: declara nomes, abre escopos e resolve identificadores.
+ * Devolve os filhos a visitar; os tipos das expressões são conferidos na
+ * saída (sair_no), quando os tipos dos operandos já estão nos filhos.
+ */
+static unsigned entrar_no(void* dados, NoAst no, intptr_t* salvo) {
+    AnaliseSemantica* s = (AnaliseSemantica*) dados;
+
+    switch (AST_TIPO(s->ast, no)) {
+        case NO_DECL_VAR:
+            declarar_variavel(s, no);
+            return PERCURSO_NENHUM;
 
         case NO_DECL_FUNC:
+            entrar_funcao(s, no);
+            return 1u << 2; // Só o corpo: os parâmetros já foram declarados
+
+        case NO_BLOCO:
+            if (s->corpo_de_funcao) {
+                s->corpo_de_funcao = 0;
+                *salvo = -1;
+            } else {
+                // Blocos irmãos reaproveitam os slots locais uns dos outros
+                *salvo = s->proximo_slot;
+                criar_novo_escopo(s->pilha);
+            }
+            return PERCURSO_TODOS;
+
+        case NO_ESCREVA:
+            // String literal, não há tipo para inferir
+            return AST_TIPO(s->ast, AST_FILHO(s->ast, no, 0)) == NO_CADEIA_CAR ? PERCURSO_NENHUM : PERCURSO_TODOS;
+
+        case NO_LEIA:
         {
-            ASTNode* id_func = no->filho[0];
-            Symbol* sym_func = inserir_funcao(pilha, id_func->valor_lexico, no->tipo_dado, 0);
-            
-            if (sym_func == NULL) {
+            NoAst id_node = AST_FILHO(s->ast, no, 0);
+            Symbol* sym = pesquisar_simbolo(s->pilha, AST_ATOMO(s->ast, id_node));
+            if (sym == NULL || sym->categoria == CAT_FUNCAO) {
                 char msg[100];
-                sprintf(msg, "Funcao '%s' ja declarada.", id_func->valor_lexico);
-                erro_semantico(no->linha, msg);
+                sprintf(msg, "Variavel '%s' nao declarada.", AST_LEXEMA(s->ast, id_node));
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
+            } else {
+                ligar_simbolo(s, id_node, sym);
+                AST_TIPO_DADO(s->ast, id_node) = sym->tipo;
             }
+            return PERCURSO_NENHUM;
+        }
 
-            // Contexto para validação de retorno
-            Tipo tipo_anterior = g_tipo_retorno_esperado;
-            int flag_anterior = g_dentro_de_funcao;
-            g_tipo_retorno_esperado = no->tipo_dado;
-            g_dentro_de_funcao = 1;
-
-            criar_novo_escopo(pilha);
-
-            // Processamento dos parâmetros
-            ASTNode* params = no->filho[1];
-            if (params != NULL) {
-                analisar_no(params, pilha);
-                
-                if (sym_func != NULL) {
-                    ASTNode* p = params;
-                    while(p != NULL) {
-                        ASTNode* p_id = p->filho[0];
-                        adicionar_info_parametro(sym_func, p_id->valor_lexico, p->tipo_dado);
-                        sym_func->num_args++;
-                        p = p->prox;
-                    }
-                }
-            }
-            
-            // Processamento do corpo da função
-            ASTNode* bloco_corpo = no->filho[2];
-            if (bloco_corpo != NULL && bloco_corpo->tipo == NO_BLOCO) {
-                // Analisa variáveis locais
-                analisar_no(bloco_corpo->filho[0], pilha);
-                // Analisa comandos
-                analisar_no(bloco_corpo->filho[1], pilha);
+        case NO_RETORNE:
+            if (!s->dentro_de_funcao) {
+                erro_semantico(s, AST_LINHA(s->ast, no), "'retorne' utilizado fora de funcao.");
+                return PERCURSO_NENHUM;
             }
+            return PERCURSO_TODOS;
 
-            remover_escopo_atual(pilha);
-            
-            // Restaura contexto anterior
-            g_tipo_retorno_esperado = tipo_anterior;
-            g_dentro_de_funcao = flag_anterior;
-        }
-        break;
+        case NO_INT_CONST:
+            AST_TIPO_DADO(s->ast, no) = TIPO_INT;
+            return PERCURSO_NENHUM;
 
-        case NO_BLOCO:
-            criar_novo_escopo(pilha);
-            analisar_no(no->filho[0], pilha); // Analisa variáveis locais
-            analisar_no(no->filho[1], pilha); // Analisa comandos
-            remover_escopo_atual(pilha);
-            break;
+        case NO_CAR_CONST:
+            AST_TIPO_DADO(s->ast, no) = TIPO_CAR;
+            return PERCURSO_NENHUM;
 
-        case NO_ATRIBUICAO:
+        case NO_ID:
         {
-            ASTNode* id_node = no->filho[0];
-            ASTNode* expr = no->filho[1];
+            Symbol* sym = pesquisar_simbolo(s->pilha, AST_ATOMO(s->ast, no));
+            if (sym == NULL) {
+                char msg[100];
+                sprintf(msg, "Identificador '%s' nao declarado.", AST_LEXEMA(s->ast, no));
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
+                return PERCURSO_NENHUM; /* Fica INT para evitar erros em cascata */
+            }
+            ligar_simbolo(s, no, sym);
+            AST_TIPO_DADO(s->ast, no) = sym->tipo;
+            return PERCURSO_NENHUM;
+        }
 
-            Symbol* sym = pesquisar_simbolo(pilha, id_node->valor_lexico);
+        // Atribuição também é expressão (ex: a = b = 0): seu tipo é o da variável
+        case NO_ATRIBUICAO:
+        {
+            NoAst id_node = AST_FILHO(s->ast, no, 0);
+            Symbol* sym = pesquisar_simbolo(s->pilha, AST_ATOMO(s->ast, id_node));
             if (sym == NULL) {
                 char msg[100];
-                sprintf(msg, "Variavel '%s' nao declarada.", id_node->valor_lexico);
-                erro_semantico(no->linha, msg);
-            } else {
-                Tipo t_expr = inferir_tipo_expressao(expr, pilha);
-                if (t_expr != sym->tipo) {
-                    char msg[100];
-                    sprintf(msg, "Atribuicao incompativel: Variavel '%s' eh %s, mas expressao eh %s.",
-                            id_node->valor_lexico, nome_tipo(sym->tipo), nome_tipo(t_expr));
-                    erro_semantico(no->linha, msg);
-                }
+                sprintf(msg, "Variavel '%s' nao declarada.", AST_LEXEMA(s->ast, id_node));
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
+                return PERCURSO_NENHUM;
             }
+            ligar_simbolo(s, id_node, sym);
+            AST_TIPO_DADO(s->ast, id_node) = sym->tipo;
+            *salvo = 1; // Variável encontrada: a expressão será conferida na saída
+            return 1u << 1;
         }
-        break;
 
-        case NO_SE:
-        case NO_ENQUANTO:
+        case NO_CHAMADA_FUNC:
         {
-            ASTNode* expr = no->filho[0];
-            // Avalia expressão condicional
-            inferir_tipo_expressao(expr, pilha);
-            
-            analisar_no(no->filho[1], pilha); /* Bloco Then */
-            if (no->filho[2] != NULL) {
-                analisar_no(no->filho[2], pilha); /* Bloco Else */
+            NoAst id_func = AST_FILHO(s->ast, no, 0);
+            Symbol* func = pesquisar_simbolo(s->pilha, AST_ATOMO(s->ast, id_func));
+            if (func == NULL) {
+                char msg[100];
+                sprintf(msg, "Funcao '%s' nao declarada.", AST_LEXEMA(s->ast, id_func));
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
+                return PERCURSO_NENHUM;
             }
+            ligar_simbolo(s, id_func, func);
+            *salvo = (intptr_t) func->params_info; // Parâmetro do próximo argumento
+            return 1u << 1;
         }
-        break;
-        
-        case NO_ESCREVA:
-            if (no->filho[0]->tipo == NO_CADEIA_CAR) {
-                // String literal, não há tipo para inferir
-            } else if (no->filho[0]->tipo != NO_ID || pesquisar_simbolo(pilha, no->filho[0]->valor_lexico) != NULL) {
-                 inferir_tipo_expressao(no->filho[0], pilha);
+
+        default:
+            return PERCURSO_TODOS;
+    }
+}
+
+static void depois_filho(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo) {
+    AnaliseSemantica* s = (AnaliseSemantica*) dados;
+
+    switch (AST_TIPO(s->ast, no)) {
+        case NO_PROGRAMA:
+            // O bloco principal tem seu próprio quadro de variáveis locais
+            if (filho == 0) {
+                s->proximo_slot = 0;
+                s->max_slots = 0;
             }
             break;
 
-        case NO_RETORNE:
+        case NO_CHAMADA_FUNC:
         {
-            if (!g_dentro_de_funcao) {
-                erro_semantico(no->linha, "'retorne' utilizado fora de funcao.");
-            } else {
-                Tipo t_expr = inferir_tipo_expressao(no->filho[0], pilha);
-                if (t_expr != g_tipo_retorno_esperado) {
-                    char msg[100];
-                    sprintf(msg, "Tipo de retorno invalido. Esperado %s, encontrado %s.",
-                            nome_tipo(g_tipo_retorno_esperado), nome_tipo(t_expr));
-                    erro_semantico(no->linha, msg);
-                }
+            // Confere cada argumento com o parâmetro correspondente
+            ParametroInfo* param_def = (ParametroInfo*) *salvo;
+            if (param_def == NULL) break; // Sobram argumentos: checado na saída
+            Tipo t_arg = AST_TIPO_DADO(s->ast, elemento);
+            if (t_arg != param_def->tipo) {
+                char msg[150];
+                sprintf(msg, "Argumento %u da funcao '%s' incompativel. Esperado %s, dado %s.",
+                        indice + 1, AST_LEXEMA(s->ast, AST_FILHO(s->ast, no, 0)),
+                        nome_tipo(param_def->tipo), nome_tipo(t_arg));
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
             }
+            *salvo = (intptr_t) param_def->proximo;
         }
         break;
-        
-        // Chamada recursiva padrão para nós que são apenas containers ou expressões isoladas como comando
-        case NO_LISTA: 
-        case NO_CHAMADA_FUNC:
-             inferir_tipo_expressao(no, pilha);
-             break;
 
         default:
-            // Visita genérica aos filhos se não houver tratamento específico para o nó
-            if (no->filho[0]) analisar_no(no->filho[0], pilha);
-            if (no->filho[1]) analisar_no(no->filho[1], pilha);
-            if (no->filho[2]) analisar_no(no->filho[2], pilha);
-            if (no->prox) analisar_no(no->prox, pilha);
             break;
     }
-    
-    // Processa comandos adicionais da lista, caso existam
-    if (no->prox != NULL && 
-        /* A lista de declarações globais (DeclFuncVar) é uma lista encadeada via 'prox'.
-         * A exceção para NO_DECL_VAR é para evitar re-processar listas de variáveis
-         * que já são tratadas em um loop interno no seu próprio case. */
-        no->tipo != NO_DECL_VAR) {
-        
-        analisar_no(no->prox, pilha);
-    }
 }
 
-/* --- Inferência e Validação de Tipos em Expressões --- */
-Tipo inferir_tipo_expressao(ASTNode* no, ScopeStack* pilha) {
-    if (no == NULL) return TIPO_INT; /* Fallback seguro */
+static void sair_no(void* dados, NoAst no, intptr_t salvo) {
+    AnaliseSemantica* s = (AnaliseSemantica*) dados;
 
-    switch (no->tipo) {
-        case NO_INT_CONST:
-            no->tipo_dado = TIPO_INT;
-            return TIPO_INT;
+    switch (AST_TIPO(s->ast, no)) {
+        case NO_PROGRAMA:
+            AST_NUM_LOCAIS(s->ast, no) = s->max_slots;
+            break;
 
-        case NO_CAR_CONST:
-            no->tipo_dado = TIPO_CAR;
-            return TIPO_CAR;
+        case NO_DECL_FUNC:
+            remover_escopo_atual(s->pilha);
+            AST_NUM_LOCAIS(s->ast, no) = s->max_slots;
 
-        case NO_ID:
-        {
-            Symbol* sym = pesquisar_simbolo(pilha, no->valor_lexico);
-            if (sym == NULL) {
-                char msg[100];
-                sprintf(msg, "Identificador '%s' nao declarado.", no->valor_lexico);
-                erro_semantico(no->linha, msg);
-                return TIPO_INT; /* Assume INT para evitar erros em cascata */
+            // Funções só são declaradas no escopo global
+            s->tipo_retorno_esperado = TIPO_INT;
+            s->dentro_de_funcao = 0;
+            break;
+
+        case NO_BLOCO:
+            if (salvo >= 0) {
+                remover_escopo_atual(s->pilha);
+                s->proximo_slot = (int) salvo;
             }
-            no->tipo_dado = sym->tipo;
-            return sym->tipo;
-        }
+            break;
+
+        case NO_RETORNE:
+            if (s->dentro_de_funcao) {
+                Tipo t_expr = AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 0));
+                if (t_expr != s->tipo_retorno_esperado) {
+                    char msg[100];
+                    sprintf(msg, "Tipo de retorno invalido. Esperado %s, encontrado %s.",
+                            nome_tipo(s->tipo_retorno_esperado), nome_tipo(t_expr));
+                    erro_semantico(s, AST_LINHA(s->ast, no), msg);
+                }
+            }
+            break;
+
+        case NO_ATRIBUICAO:
+            if (salvo) {
+                NoAst id_node = AST_FILHO(s->ast, no, 0);
+                Tipo t_var = AST_TIPO_DADO(s->ast, id_node);
+                Tipo t_expr = AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 1));
+                if (t_expr != t_var) {
+                    char msg[100];
+                    sprintf(msg, "Atribuicao incompativel: Variavel '%s' eh %s, mas expressao eh %s.",
+                            AST_LEXEMA(s->ast, id_node), nome_tipo(t_var), nome_tipo(t_expr));
+                    erro_semantico(s, AST_LINHA(s->ast, no), msg);
+                }
+                AST_TIPO_DADO(s->ast, no) = t_var;
+            }
+            break;
 
         case NO_CHAMADA_FUNC:
         {
-            Symbol* func = pesquisar_simbolo(pilha, no->filho[0]->valor_lexico);
-            if (func == NULL) {
-                char msg[100];
-                sprintf(msg, "Funcao '%s' nao declarada.", no->filho[0]->valor_lexico);
-                erro_semantico(no->linha, msg);
-                return TIPO_INT;
-            }
-            
-            ASTNode* arg = no->filho[1];
+            Symbol* func = pesquisar_simbolo(s->pilha, AST_ATOMO(s->ast, AST_FILHO(s->ast, no, 0)));
+            if (func == NULL) break; // Já reportada na entrada
+
             int count = 0;
-            
-            ParametroInfo* param_def = func->params_info;
-            
-            while (arg != NULL) {
-                Tipo t_arg = inferir_tipo_expressao(arg, pilha);
+            for (NoAst arg = AST_FILHO(s->ast, no, 1); arg != NO_NENHUM; arg = AST_PROX(s->ast, arg)) {
                 count++;
-                
-                if (param_def != NULL) {
-                    if (t_arg != param_def->tipo) {
-                        char msg[150];
-                        sprintf(msg, "Argumento %d da funcao '%s' incompativel. Esperado %s, dado %s.",
-                                count, func->nome, nome_tipo(param_def->tipo), nome_tipo(t_arg));
-                        erro_semantico(no->linha, msg);
-                    }
-                    param_def = param_def->proximo;
-                } else {
-                    // Mais argumentos do que parâmetros declarados
-                    // Será checado abaixo no count != num_args
-                }
-                arg = arg->prox;
             }
-
             if (count != func->num_args) {
                 char msg[100];
                 sprintf(msg, "Numero incorreto de argumentos para '%s'. Esperado %d, dado %d.",
-                        func->nome, func->num_args, count);
-                erro_semantico(no->linha, msg);
+                        func->nome.texto, func->num_args, count);
+                erro_semantico(s, AST_LINHA(s->ast, no), msg);
             }
-
-            no->tipo_dado = func->tipo;
-            return func->tipo;
+            AST_TIPO_DADO(s->ast, no) = func->tipo;
         }
+        break;
 
         // Operações Aritméticas: Exigem INT e retornam INT
         case NO_SOMA:
@@ -297,21 +342,14 @@ Tipo inferir_tipo_expressao(ASTNode* no, ScopeStack* pilha) {
         case NO_MULT:
         case NO_DIV:
         {
-            Tipo t1 = inferir_tipo_expressao(no->filho[0], pilha);
-            Tipo t2 = TIPO_INT; // Assume INT para checagem unária
-            ASTNode* op2 = no->filho[1];
-            
-            if (op2 != NULL) { // Se for operação binária, confere o segundo operando
-                t2 = inferir_tipo_expressao(op2, pilha);
-            }
-
+            Tipo t1 = AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 0));
+            Tipo t2 = AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 1));
             if (t1 != TIPO_INT || t2 != TIPO_INT) {
-                erro_semantico(no->linha, "Operacoes aritmeticas requerem operandos do tipo INT.");
+                erro_semantico(s, AST_LINHA(s->ast, no), "Operacoes aritmeticas requerem operandos do tipo INT.");
             }
-            
-            no->tipo_dado = TIPO_INT;
-            return TIPO_INT;
+            AST_TIPO_DADO(s->ast, no) = TIPO_INT;
         }
+        break;
 
         // Operações Relacionais/Lógicas: Operandos devem ser iguais, Retorna INT (pseudo-bool)
         case NO_IGUAL:
@@ -320,31 +358,33 @@ Tipo inferir_tipo_expressao(ASTNode* no, ScopeStack* pilha) {
         case NO_MENOR:
         case NO_MAIOR_IGUAL:
         case NO_MENOR_IGUAL:
-        {
-            Tipo t1 = inferir_tipo_expressao(no->filho[0], pilha);
-            Tipo t2 = inferir_tipo_expressao(no->filho[1], pilha);
-            
-            if (t1 != t2) {
-                erro_semantico(no->linha, "Comparacao entre tipos diferentes.");
+            if (AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 0)) != AST_TIPO_DADO(s->ast, AST_FILHO(s->ast, no, 1))) {
+                erro_semantico(s, AST_LINHA(s->ast, no), "Comparacao entre tipos diferentes.");
             }
-            
-            no->tipo_dado = TIPO_INT;
-            return TIPO_INT;
-        }
+            AST_TIPO_DADO(s->ast, no) = TIPO_INT;
+            break;
 
+        /* Lógicos operam sobre INT (verdadeiro/falso) */
         case NO_E:
         case NO_OU:
         case NO_NEG:
-        {
-             /* Lógicos operam sobre INT (verdadeiro/falso) */
-             inferir_tipo_expressao(no->filho[0], pilha);
-             if (no->filho[1]) inferir_tipo_expressao(no->filho[1], pilha);
-             
-             no->tipo_dado = TIPO_INT;
-             return TIPO_INT;
-        }
+            AST_TIPO_DADO(s->ast, no) = TIPO_INT;
+            break;
 
         default:
-            return TIPO_INT;
+            break;
+    }
+}
+
+/* --- Função Principal --- */
+int verificar_semantica(Ast* ast, NoAst raiz, ScopeStack* pilha_semantica, FILE* diagnosticos) {
+    static const VisitanteAst analise = { entrar_no, depois_filho, sair_no };
+    AnaliseSemantica estado = { ast, pilha_semantica, diagnosticos, 0, TIPO_INT, 0, 0, 0, 0 };
+
+    // Percorre a árvore com pilha explícita: a profundidade não depende da pilha de C
+    if (percorrer_ast(ast, raiz, &analise, &estado) != 0) {
+        fprintf(diagnosticos, "Erro: memoria insuficiente para a analise semantica\n");
+        estado.erros++;
     }
-}
\ No newline at end of file
+    return estado.erros;
+}
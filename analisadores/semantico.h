@@ -5,9 +5,12 @@
 #include "tabela_simbolos.h"
 #include "ast.h"
 
-/* * Função principal que inicia a análise semântica percorrendo a AST.
- * Retorna 1 se houver erros semânticos, 0 se sucesso.
+#include <stdio.h>
+
+/* * Função principal que inicia a análise semântica percorrendo a AST a partir de 'raiz'.
+ * Os erros são escritos em 'diagnosticos'. Retorna o número de erros semânticos.
+ * Não usa estado global: compilações distintas podem ser verificadas em paralelo.
  */
-int verificar_semantica(ASTNode* raiz, ScopeStack* pilha);
+int verificar_semantica(Ast* ast, NoAst raiz, ScopeStack* pilha, FILE* diagnosticos);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,753 @@
+#define _POSIX_C_SOURCE 200809L /* open_memstream, fdopen */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "servidor.h"
+#include "compilador.h"
+#include "gerador_codigo.h"
+#include "percurso.h"
+#include "y.tab.h"
+
+#define TAMANHO_CABECALHO 4096
+
+// --- Estado de um arquivo ---
+
+/*
+ * O texto de um arquivo se divide em itens, as declarações de nível superior
+ * na ordem do programa: uma lista de variáveis globais (int a, b;), uma função
+ * ou o bloco principal, sempre o último. Cada item ocupa o trecho do texto
+ * que vai do seu primeiro token ao primeiro token do item seguinte (o primeiro
+ * item começa no início do texto): espaços e comentários entre dois itens
+ * ficam com o anterior.
+ */
+typedef enum {
+    ITEM_VARIAVEIS,
+    ITEM_FUNCAO,
+    ITEM_PROGRAMA
+} TipoItem;
+
+// Nome global declarado por um item, e o que o código de quem o usa vê dele
+typedef struct {
+    Atomo nome;             // No repositório do arquivo
+    Tipo tipo;              // Da variável, ou de retorno da função
+    int funcao;
+    int num_params;
+    Tipo* params;
+} DeclaracaoGlobal;
+
+typedef struct {
+    TipoItem tipo;
+    size_t inicio;          // Início do trecho do item no texto
+    DeclaracaoGlobal* declaracoes;
+    int num_declaracoes;
+    Atomo* dependencias;    // Nomes globais que o código do item usa
+    int num_dependencias;
+    char* assembly;
+    size_t tamanho_assembly;
+} ItemServidor;
+
+// Entrada do índice dos nomes globais (endereçamento aberto, por átomo)
+typedef struct {
+    Atomo nome;             // NULL: entrada livre
+    int item;               // Item que declara o nome
+    int declaracao;         // Posição em itens[item].declaracoes
+    int usos;               // Itens que dependem do nome
+} EntradaGlobal;
+
+typedef struct ArquivoServidor {
+    char* nome;
+    char* texto;            // Texto dos itens abaixo (NULL: nada guardado)
+    size_t tamanho;
+    RepositorioAtomos atomos;
+    ItemServidor* itens;
+    int num_itens;
+    EntradaGlobal* indice;
+    unsigned capacidade_indice; // Potência de 2 (0: índice vazio)
+    struct ArquivoServidor* proximo;
+} ArquivoServidor;
+
+typedef struct {
+    ArquivoServidor* arquivos;
+    const CompilerContext* opcoes;
+} Servidor;
+
+typedef struct {
+    int sucesso;
+    char* assembly;
+    size_t tamanho_assembly;
+    char* diagnosticos;
+    size_t tamanho_diagnosticos;
+    int reaproveitadas;
+    int geradas;
+} ResultadoServidor;
+
+static void* realocar(void* bloco, size_t tamanho) {
+    void* novo = realloc(bloco, tamanho);
+    if (novo == NULL) {
+        perror("Falha ao alocar memória no servidor");
+        exit(EXIT_FAILURE);
+    }
+    return novo;
+}
+
+static char* duplicar_n(const char* texto, size_t tamanho) {
+    char* copia = (char*) realocar(NULL, tamanho + 1);
+    memcpy(copia, texto, tamanho);
+    copia[tamanho] = '\0';
+    return copia;
+}
+
+static void liberar_itens(ItemServidor* itens, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int d = 0; d < itens[i].num_declaracoes; d++) free(itens[i].declaracoes[d].params);
+        free(itens[i].declaracoes);
+        free(itens[i].dependencias);
+        free(itens[i].assembly);
+    }
+}
+
+static void descartar_estado(ArquivoServidor* arq) {
+    liberar_itens(arq->itens, arq->num_itens);
+    free(arq->itens);
+    free(arq->indice);
+    free(arq->texto);
+    liberar_repositorio(&arq->atomos);
+    arq->itens = NULL;
+    arq->num_itens = 0;
+    arq->indice = NULL;
+    arq->capacidade_indice = 0;
+    arq->texto = NULL;
+    arq->tamanho = 0;
+}
+
+static void liberar_arquivo(ArquivoServidor* arq) {
+    descartar_estado(arq);
+    free(arq->nome);
+    free(arq);
+}
+
+static ArquivoServidor* obter_arquivo(ArquivoServidor** arquivos, const char* nome) {
+    for (ArquivoServidor* arq = *arquivos; arq != NULL; arq = arq->proximo) {
+        if (strcmp(arq->nome, nome) == 0) return arq;
+    }
+    ArquivoServidor* arq = (ArquivoServidor*) realocar(NULL, sizeof(ArquivoServidor));
+    memset(arq, 0, sizeof(*arq));
+    RepositorioAtomos atomos = REPOSITORIO_ATOMOS_VAZIO;
+    arq->atomos = atomos;
+    arq->nome = duplicar_n(nome, strlen(nome));
+    arq->proximo = *arquivos;
+    *arquivos = arq;
+    return arq;
+}
+
+static void esquecer_arquivo(ArquivoServidor** arquivos, const char* nome) {
+    for (ArquivoServidor** p = arquivos; *p != NULL; p = &(*p)->proximo) {
+        if (strcmp((*p)->nome, nome) == 0) {
+            ArquivoServidor* arq = *p;
+            *p = arq->proximo;
+            liberar_arquivo(arq);
+            return;
+        }
+    }
+}
+
+// --- Índice dos nomes globais ---
+
+static EntradaGlobal* buscar_global(const ArquivoServidor* arq, Atomo nome) {
+    if (arq->capacidade_indice == 0) return NULL;
+    unsigned mascara = arq->capacidade_indice - 1;
+    for (unsigned h = hash_atomo(nome) & mascara; arq->indice[h].nome.texto != NULL; h = (h + 1) & mascara) {
+        if (MESMO_ATOMO(arq->indice[h].nome, nome)) return &arq->indice[h];
+    }
+    return NULL;
+}
+
+// Refaz o índice a partir dos itens: quem declara cada nome e quantos o usam
+static void indexar_globais(ArquivoServidor* arq) {
+    unsigned total = 0;
+    for (int i = 0; i < arq->num_itens; i++) total += (unsigned) arq->itens[i].num_declaracoes;
+    unsigned capacidade = 16;
+    while (capacidade < 2 * total) capacidade *= 2;
+
+    free(arq->indice);
+    arq->indice = (EntradaGlobal*) realocar(NULL, capacidade * sizeof(EntradaGlobal));
+    memset(arq->indice, 0, capacidade * sizeof(EntradaGlobal));
+    arq->capacidade_indice = capacidade;
+
+    for (int i = 0; i < arq->num_itens; i++) {
+        for (int d = 0; d < arq->itens[i].num_declaracoes; d++) {
+            Atomo nome = arq->itens[i].declaracoes[d].nome;
+            unsigned h = hash_atomo(nome) & (capacidade - 1);
+            while (arq->indice[h].nome.texto != NULL && !MESMO_ATOMO(arq->indice[h].nome, nome)) h = (h + 1) & (capacidade - 1);
+            EntradaGlobal entrada = { nome, i, d, 0 };
+            arq->indice[h] = entrada;
+        }
+    }
+    for (int i = 0; i < arq->num_itens; i++) {
+        for (int k = 0; k < arq->itens[i].num_dependencias; k++) {
+            EntradaGlobal* e = buscar_global(arq, arq->itens[i].dependencias[k]);
+            if (e != NULL) e->usos++;
+        }
+    }
+}
+
+// Usos de 'nome' por itens fora de [a, b]
+static int usos_fora(const ArquivoServidor* arq, Atomo nome, int a, int b) {
+    const EntradaGlobal* e = buscar_global(arq, nome);
+    if (e == NULL) return 0;
+    int usos = e->usos;
+    for (int i = a; i <= b; i++) {
+        for (int k = 0; k < arq->itens[i].num_dependencias; k++) {
+            if (MESMO_ATOMO(arq->itens[i].dependencias[k], nome)) usos--;
+        }
+    }
+    return usos;
+}
+
+// --- Itens de uma compilação ---
+
+#define CODIGO(tokens, i) ((tokens)->tipo[i] == 0 ? 0 : (tokens)->tipo[i] + 256)
+
+// Primeiro token a partir de i que não é um erro léxico (que o parser ignora)
+static size_t pular_erros(const BufferTokens* t, size_t i) {
+    while (mensagem_erro_lexico(CODIGO(t, i)) != NULL) i++;
+    return i;
+}
+
+typedef struct {
+    const Ast* ast;
+    RepositorioAtomos* atomos;
+    ItemServidor* item;
+} ColetaDependencias;
+
+static unsigned coletar_dependencia(void* dados, NoAst no, intptr_t* salvo) {
+    ColetaDependencias* coleta = (ColetaDependencias*) dados;
+    const Ast* ast = coleta->ast;
+    ItemServidor* item = coleta->item;
+    if (AST_TIPO(ast, no) != NO_ID ||
+        (AST_LIGACAO(ast, no).classe != LIG_GLOBAL && AST_LIGACAO(ast, no).classe != LIG_FUNCAO)) {
+        return PERCURSO_TODOS;
+    }
+    Atomo nome = internar_em(coleta->atomos, AST_LEXEMA(ast, no), tamanho_atomo(AST_ATOMO(ast, no)));
+    for (int i = 0; i < item->num_dependencias; i++) {
+        if (MESMO_ATOMO(item->dependencias[i], nome)) return PERCURSO_TODOS;
+    }
+    item->dependencias = (Atomo*) realocar(item->dependencias, sizeof(Atomo) * (item->num_dependencias + 1));
+    item->dependencias[item->num_dependencias++] = nome;
+    return PERCURSO_TODOS;
+}
+
+// Nomes globais usados em 'no'. Retorna 0, ou -1 se faltar memória.
+static int coletar_dependencias(const Ast* ast, NoAst no, RepositorioAtomos* atomos, ItemServidor* item) {
+    static const VisitanteAst coleta = { coletar_dependencia, NULL, NULL };
+    ColetaDependencias dados = { ast, atomos, item };
+    return percorrer_ast(ast, no, &coleta, &dados);
+}
+
+static void declarar(ItemServidor* item, RepositorioAtomos* atomos, const Ast* ast, NoAst decl) {
+    Atomo lexema = AST_ATOMO(ast, AST_FILHO(ast, decl, 0));
+    item->declaracoes = (DeclaracaoGlobal*) realocar(item->declaracoes,
+                                                     sizeof(DeclaracaoGlobal) * (item->num_declaracoes + 1));
+    DeclaracaoGlobal* d = &item->declaracoes[item->num_declaracoes++];
+    memset(d, 0, sizeof(*d));
+    d->nome = internar_em(atomos, lexema.texto, tamanho_atomo(lexema));
+    d->tipo = AST_TIPO_DADO(ast, decl);
+    if (AST_TIPO(ast, decl) != NO_DECL_FUNC) return;
+    d->funcao = 1;
+    for (NoAst p = AST_FILHO(ast, decl, 1); p != NO_NENHUM; p = AST_PROX(ast, p)) {
+        d->params = (Tipo*) realocar(d->params, sizeof(Tipo) * (d->num_params + 1));
+        d->params[d->num_params++] = AST_TIPO_DADO(ast, p);
+    }
+}
+
+static int mesma_declaracao(const DeclaracaoGlobal* a, const DeclaracaoGlobal* b) {
+    return MESMO_ATOMO(a->nome, b->nome) && a->tipo == b->tipo && a->funcao == b->funcao && a->num_params == b->num_params &&
+           (a->num_params == 0 || memcmp(a->params, b->params, sizeof(Tipo) * a->num_params) == 0);
+}
+
+// Código de um item: o bloco principal e cada função com rótulos prefixados pelo nome
+static int gerar_item(const CompilerContext* ctx, ItemServidor* item, NoAst no, int num_nos) {
+    const Ast* ast = &ctx->ast;
+    ConvencaoChamada convencao = compilador_convencao(ctx);
+    FILE* saida = open_memstream(&item->assembly, &item->tamanho_assembly);
+    if (saida == NULL) return -1;
+
+    int resultado = 0;
+    if (item->tipo == ITEM_VARIAVEIS) {
+        for (int i = 0; i < num_nos; i++, no = AST_PROX(ast, no)) gerar_codigo_global(ast, no, saida);
+    } else if (item->tipo == ITEM_PROGRAMA) {
+        resultado = gerar_codigo_principal(ast, no, saida, "main_", convencao);
+    } else {
+        Atomo nome = AST_ATOMO(ast, AST_FILHO(ast, no, 0));
+        char* prefixo = (char*) realocar(NULL, tamanho_atomo(nome) + 2);
+        sprintf(prefixo, "%s_", nome.texto);
+        resultado = gerar_codigo_funcao(ast, no, saida, prefixo, convencao);
+        free(prefixo);
+    }
+    if (fclose(saida) != 0) resultado = -1;
+
+    // A janela só vê o próprio item: um salto para fora dele deixa todos os registradores vivos
+    unsigned regras = compilador_regras_janela(ctx);
+    if (resultado == 0 && regras != 0 && item->tipo != ITEM_VARIAVEIS) {
+        char* otimizado;
+        size_t tamanho;
+        EstatisticasJanela estatisticas;
+        memset(&estatisticas, 0, sizeof(estatisticas));
+        if (otimizar_janela(item->assembly, item->tamanho_assembly, regras, &otimizado, &tamanho, &estatisticas) != 0) {
+            return -1;
+        }
+        free(item->assembly);
+        item->assembly = otimizado;
+        item->tamanho_assembly = tamanho;
+    }
+    return resultado;
+}
+
+/*
+ * Divide o programa já verificado de 'ctx' em itens, com declarações,
+ * dependências (átomos de 'atomos') e código. 'base' é a posição do texto de
+ * 'ctx' no texto do arquivo; itens que começam a partir de 'limite' no texto
+ * de 'ctx' ficam de fora. Retorna o número de itens, ou -1 se faltar memória.
+ */
+static int construir_itens(const CompilerContext* ctx, RepositorioAtomos* atomos, size_t base, size_t limite,
+                           ItemServidor** saida) {
+    const BufferTokens* t = &ctx->tokens;
+    const Ast* ast = &ctx->ast;
+    NoAst decl = AST_FILHO(ast, ctx->raiz, 0);
+    ItemServidor* itens = NULL;
+    int n = 0;
+
+    for (size_t i = pular_erros(t, 0); CODIGO(t, i) != 0 && t->deslocamento[i] < limite;) {
+        ItemServidor item;
+        memset(&item, 0, sizeof(item));
+        item.inicio = n == 0 ? base : base + t->deslocamento[i];
+        if (CODIGO(t, i) == T_PROGRAMA) {
+            item.tipo = ITEM_PROGRAMA;
+        } else if (CODIGO(t, pular_erros(t, pular_erros(t, i + 1) + 1)) == T_LPAREN) {
+            item.tipo = ITEM_FUNCAO;
+        } else {
+            item.tipo = ITEM_VARIAVEIS;
+        }
+
+        // O item termina num ';' fora de chaves ou no '}' que as fecha
+        int nivel = 0, nomes = 0;
+        for (;; i++) {
+            int c = CODIGO(t, i);
+            if (c == T_LCHAVE) nivel++;
+            if (c == T_RCHAVE && --nivel == 0) break;
+            if (c == T_PVIRGULA && nivel == 0) break;
+            if (c == T_ID && nivel == 0) nomes++;
+        }
+        i = pular_erros(t, i + 1);
+
+        NoAst no = decl;
+        int num_nos = 0, erro = 0;
+        if (item.tipo == ITEM_PROGRAMA) {
+            no = ctx->raiz;
+            erro = coletar_dependencias(ast, AST_FILHO(ast, ctx->raiz, 1), atomos, &item) != 0;
+        } else if (item.tipo == ITEM_FUNCAO) {
+            erro = decl == NO_NENHUM || AST_TIPO(ast, decl) != NO_DECL_FUNC;
+            if (!erro) {
+                declarar(&item, atomos, ast, decl);
+                erro = coletar_dependencias(ast, AST_FILHO(ast, decl, 2), atomos, &item) != 0;
+                decl = AST_PROX(ast, decl);
+            }
+        } else {
+            for (num_nos = 0; num_nos < nomes && !erro; num_nos++) {
+                erro = decl == NO_NENHUM || AST_TIPO(ast, decl) != NO_DECL_VAR;
+                if (!erro) {
+                    declarar(&item, atomos, ast, decl);
+                    decl = AST_PROX(ast, decl);
+                }
+            }
+        }
+        if (!erro) erro = gerar_item(ctx, &item, no, num_nos) != 0;
+
+        itens = (ItemServidor*) realocar(itens, sizeof(ItemServidor) * (n + 1));
+        itens[n++] = item;
+        if (erro) {
+            liberar_itens(itens, n);
+            free(itens);
+            return -1;
+        }
+    }
+    *saida = itens;
+    return n;
+}
+
+static int contar_funcoes(const ItemServidor* itens, int n) {
+    int funcoes = 0;
+    for (int i = 0; i < n; i++) funcoes += itens[i].tipo == ITEM_FUNCAO;
+    return funcoes;
+}
+
+// Assembly do arquivo: .data com as globais, bloco principal e funções
+static void compor_assembly(const ArquivoServidor* arq, ResultadoServidor* res) {
+    FILE* saida = open_memstream(&res->assembly, &res->tamanho_assembly);
+    if (saida == NULL) {
+        perror("Falha ao alocar memória no servidor");
+        exit(EXIT_FAILURE);
+    }
+    gerar_codigo_dados(saida);
+    for (int i = 0; i < arq->num_itens; i++) {
+        if (arq->itens[i].tipo == ITEM_VARIAVEIS) fwrite(arq->itens[i].assembly, 1, arq->itens[i].tamanho_assembly, saida);
+    }
+    gerar_codigo_texto(saida);
+    for (int i = 0; i < arq->num_itens; i++) {
+        if (arq->itens[i].tipo == ITEM_PROGRAMA) fwrite(arq->itens[i].assembly, 1, arq->itens[i].tamanho_assembly, saida);
+    }
+    for (int i = 0; i < arq->num_itens; i++) {
+        if (arq->itens[i].tipo == ITEM_FUNCAO) fwrite(arq->itens[i].assembly, 1, arq->itens[i].tamanho_assembly, saida);
+    }
+    fclose(saida);
+}
+
+// --- Compilação ---
+
+static CompilerContext* criar_contexto(const CompilerContext* opcoes, int num_fatias) {
+    CompilerContext* ctx = compilador_criar();
+    if (ctx == NULL) return NULL;
+    ctx->varredor = VARREDOR_PRE_TOKENIZADO;
+    ctx->num_fatias = num_fatias;
+    ctx->nivel_otimizacao = opcoes->nivel_otimizacao;
+    ctx->regras_janela = opcoes->regras_janela;
+    ctx->convencao = opcoes->convencao;
+    return ctx;
+}
+
+static void copiar_diagnosticos(CompilerContext* ctx, ResultadoServidor* res) {
+    size_t tamanho;
+    const char* diagnosticos = compilador_diagnosticos(ctx, &tamanho);
+    res->diagnosticos = duplicar_n(diagnosticos, tamanho);
+    res->tamanho_diagnosticos = tamanho;
+}
+
+// Nível 1: a integração de funções e o alocador veem o programa inteiro
+static void compilar_otimizado(const Servidor* servidor, const char* texto, size_t tamanho, ResultadoServidor* res) {
+    CompilerContext* ctx = criar_contexto(servidor->opcoes, servidor->opcoes->num_fatias);
+    if (ctx == NULL) return;
+    if (compilar_memoria(ctx, texto, tamanho) == 0) {
+        res->sucesso = 1;
+        res->assembly = duplicar_n(ctx->assembly, ctx->tamanho_assembly);
+        res->tamanho_assembly = ctx->tamanho_assembly;
+        for (NoAst d = AST_FILHO(&ctx->ast, ctx->raiz, 0); d != NO_NENHUM; d = AST_PROX(&ctx->ast, d)) {
+            res->geradas += AST_TIPO(&ctx->ast, d) == NO_DECL_FUNC;
+        }
+    }
+    copiar_diagnosticos(ctx, res);
+    compilador_destruir(ctx);
+}
+
+// Compila o texto inteiro e, se não houver diagnóstico algum, guarda os itens
+static void compilar_arquivo(const Servidor* servidor, ArquivoServidor* arq, const char* texto, size_t tamanho,
+                             ResultadoServidor* res) {
+    CompilerContext* ctx = criar_contexto(servidor->opcoes, servidor->opcoes->num_fatias);
+    if (ctx == NULL) return;
+
+    if (compilador_carregar_memoria(ctx, texto, tamanho) != 0 || compilador_analisar(ctx) != 0 ||
+        compilador_verificar(ctx) != 0) {
+        // O estado anterior continua valendo para o próximo pedido
+        copiar_diagnosticos(ctx, res);
+        compilador_destruir(ctx);
+        return;
+    }
+
+    RepositorioAtomos atomos = REPOSITORIO_ATOMOS_VAZIO;
+    ItemServidor* itens;
+    int n = construir_itens(ctx, &atomos, 0, ctx->fonte.tamanho, &itens);
+    descartar_estado(arq);
+    if (n < 0) {
+        fprintf(ctx->diagnosticos, "Erro: memoria insuficiente para gerar o codigo\n");
+        liberar_repositorio(&atomos);
+    } else {
+        arq->atomos = atomos;
+        arq->itens = itens;
+        arq->num_itens = n;
+        arq->texto = duplicar_n(texto, tamanho);
+        arq->tamanho = tamanho;
+        indexar_globais(arq);
+        compor_assembly(arq, res);
+        res->geradas = contar_funcoes(itens, n);
+        res->sucesso = 1;
+    }
+
+    copiar_diagnosticos(ctx, res);
+    // Erros léxicos não impedem a compilação, mas só um texto sem eles é reaproveitado
+    if (res->tamanho_diagnosticos > 0) descartar_estado(arq);
+    compilador_destruir(ctx);
+}
+
+// Último item que começa em 'posicao' ou antes
+static int item_em(const ArquivoServidor* arq, size_t posicao) {
+    int esq = 0, dir = arq->num_itens - 1;
+    while (esq < dir) {
+        int meio = (esq + dir + 1) / 2;
+        if (arq->itens[meio].inicio <= posicao) esq = meio;
+        else dir = meio - 1;
+    }
+    return esq;
+}
+
+static void declarar_externo(ScopeStack* pilha, Atomo nome, const DeclaracaoGlobal* d) {
+    if (!d->funcao) {
+        inserir_variavel(pilha, nome, d->tipo, -1);
+        return;
+    }
+    Symbol* funcao = inserir_funcao(pilha, nome, d->tipo, 0);
+    for (int i = 0; i < d->num_params; i++) {
+        adicionar_info_parametro(funcao, ATOMO_NULO, d->params[i]); // Os nomes dos parâmetros não são guardados
+        funcao->num_args++;
+    }
+}
+
+/*
+ * Recompila só os itens que o trecho alterado toca. O texto deles é analisado
+ * sozinho (com um bloco principal vazio no fim, se o verdadeiro não está entre
+ * eles), e a tabela de símbolos começa com as declarações dos itens anteriores
+ * que esse texto menciona. Retorna 0 se o pedido foi atendido, ou -1 se ele
+ * precisa de uma compilação completa: erro no trecho, nome declarado também
+ * fora dele, ou declaração alterada da qual depende um item de fora.
+ */
+static int compilar_regiao(const Servidor* servidor, ArquivoServidor* arq, const char* texto, size_t tamanho,
+                           ResultadoServidor* res) {
+    size_t minimo = arq->tamanho < tamanho ? arq->tamanho : tamanho;
+    size_t prefixo = 0, sufixo = 0;
+    while (prefixo < minimo && arq->texto[prefixo] == texto[prefixo]) prefixo++;
+    while (sufixo < minimo - prefixo && arq->texto[arq->tamanho - 1 - sufixo] == texto[tamanho - 1 - sufixo]) sufixo++;
+
+    int funcoes = contar_funcoes(arq->itens, arq->num_itens);
+    if (prefixo == arq->tamanho && prefixo == tamanho) {
+        compor_assembly(arq, res);
+        res->reaproveitadas = funcoes;
+        res->sucesso = 1;
+        return 0;
+    }
+
+    // Itens [a, b] tocados pelo trecho [prefixo, arq->tamanho - sufixo) do texto antigo
+    int a = item_em(arq, prefixo);
+    int b = arq->tamanho - sufixo > prefixo ? item_em(arq, arq->tamanho - sufixo - 1) : a;
+    int com_principal = b == arq->num_itens - 1;
+    size_t inicio = arq->itens[a].inicio;
+    size_t fim = com_principal ? arq->tamanho : arq->itens[b + 1].inicio;
+    size_t tamanho_regiao = fim + tamanho - arq->tamanho - inicio;
+
+    static const char principal_vazio[] = "\nprograma {}\n";
+    size_t extra = com_principal ? 0 : sizeof(principal_vazio) - 1;
+    char* regiao = (char*) realocar(NULL, tamanho_regiao + extra);
+    memcpy(regiao, texto + inicio, tamanho_regiao);
+    memcpy(regiao + tamanho_regiao, principal_vazio, extra);
+
+    CompilerContext* ctx = criar_contexto(servidor->opcoes, 1);
+    if (ctx == NULL || compilador_carregar_memoria(ctx, regiao, tamanho_regiao + extra) != 0 ||
+        compilador_analisar(ctx) != 0) {
+        free(regiao);
+        compilador_destruir(ctx);
+        return -1;
+    }
+    free(regiao);
+
+    size_t diagnosticos;
+    compilador_diagnosticos(ctx, &diagnosticos);
+    ctx->tabela_simbolos = iniciar_pilha_tabela_simbolos();
+    const BufferTokens* t = &ctx->tokens;
+    for (size_t i = 0; i < t->quantidade && diagnosticos == 0; i++) {
+        if (CODIGO(t, i) != T_ID) continue;
+        const char* lexema = ctx->fonte.dados + t->deslocamento[i];
+        const EntradaGlobal* e = buscar_global(arq, internar_em(&arq->atomos, lexema, t->tamanho[i]));
+        if (e == NULL || e->item >= a) continue;
+        Atomo nome = internar_em(&ctx->atomos, lexema, t->tamanho[i]);
+        if (pesquisar_simbolo(ctx->tabela_simbolos, nome) == NULL) {
+            declarar_externo(ctx->tabela_simbolos, nome, &arq->itens[e->item].declaracoes[e->declaracao]);
+        }
+    }
+
+    ItemServidor* novos = NULL;
+    int n = -1;
+    if (diagnosticos == 0 && compilador_verificar(ctx) == 0) {
+        n = construir_itens(ctx, &arq->atomos, inicio, tamanho_regiao, &novos);
+    }
+    compilador_destruir(ctx);
+
+    // Um nome do trecho declarado também fora dele é erro: a compilação completa o relata
+    int refazer = n < 0;
+    for (int i = 0; i < n && !refazer; i++) {
+        for (int d = 0; d < novos[i].num_declaracoes && !refazer; d++) {
+            const EntradaGlobal* e = buscar_global(arq, novos[i].declaracoes[d].nome);
+            refazer = e != NULL && (e->item < a || e->item > b);
+        }
+    }
+
+    // Se as declarações do trecho mudaram, ninguém de fora dele pode depender delas
+    int mudou = n != b - a + 1;
+    for (int i = 0; i < n && !mudou; i++) {
+        const ItemServidor* antigo = &arq->itens[a + i];
+        mudou = novos[i].num_declaracoes != antigo->num_declaracoes;
+        for (int d = 0; d < novos[i].num_declaracoes && !mudou; d++) {
+            mudou = !mesma_declaracao(&novos[i].declaracoes[d], &antigo->declaracoes[d]);
+        }
+    }
+    for (int i = a; i <= b && mudou && !refazer; i++) {
+        for (int d = 0; d < arq->itens[i].num_declaracoes && !refazer; d++) {
+            refazer = usos_fora(arq, arq->itens[i].declaracoes[d].nome, a, b) > 0;
+        }
+    }
+    if (refazer) {
+        if (n > 0) liberar_itens(novos, n);
+        free(novos);
+        return -1;
+    }
+
+    // Troca os itens [a, b] pelos novos; os seguintes se deslocam no texto
+    if (!mudou) {
+        for (int i = a; i <= b; i++) {
+            for (int k = 0; k < arq->itens[i].num_dependencias; k++) buscar_global(arq, arq->itens[i].dependencias[k])->usos--;
+        }
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < novos[i].num_dependencias; k++) buscar_global(arq, novos[i].dependencias[k])->usos++;
+        }
+    }
+    int antigos = b - a + 1;
+    int total = arq->num_itens - antigos + n;
+    liberar_itens(arq->itens + a, antigos);
+    if (n > antigos) arq->itens = (ItemServidor*) realocar(arq->itens, sizeof(ItemServidor) * total);
+    memmove(arq->itens + a + n, arq->itens + b + 1, sizeof(ItemServidor) * (arq->num_itens - b - 1));
+    memcpy(arq->itens + a, novos, sizeof(ItemServidor) * n);
+    free(novos);
+    for (int i = a + n; i < total; i++) arq->itens[i].inicio = arq->itens[i].inicio + tamanho - arq->tamanho;
+    arq->num_itens = total;
+    if (mudou) indexar_globais(arq);
+
+    free(arq->texto);
+    arq->texto = duplicar_n(texto, tamanho);
+    arq->tamanho = tamanho;
+
+    compor_assembly(arq, res);
+    res->geradas = contar_funcoes(arq->itens + a, n);
+    res->reaproveitadas = contar_funcoes(arq->itens, total) - res->geradas;
+    res->sucesso = 1;
+    return 0;
+}
+
+static void compilar_pedido(const Servidor* servidor, ArquivoServidor* arq, const char* texto, size_t tamanho,
+                            ResultadoServidor* res) {
+    if (servidor->opcoes->nivel_otimizacao >= 1) {
+        compilar_otimizado(servidor, texto, tamanho, res);
+    } else if (arq->texto == NULL || compilar_regiao(servidor, arq, texto, tamanho, res) != 0) {
+        compilar_arquivo(servidor, arq, texto, tamanho, res);
+    }
+}
+
+// --- Protocolo ---
+
+static void responder(FILE* saida, const char* estado, const ResultadoServidor* res, long microssegundos) {
+    fprintf(saida, "%s %zu %zu %d %d %ld\n", estado, res->tamanho_assembly, res->tamanho_diagnosticos,
+            res->reaproveitadas, res->geradas, microssegundos);
+    if (res->tamanho_assembly > 0) fwrite(res->assembly, 1, res->tamanho_assembly, saida);
+    if (res->tamanho_diagnosticos > 0) fwrite(res->diagnosticos, 1, res->tamanho_diagnosticos, saida);
+    fflush(saida);
+}
+
+// Atende pedidos de 'entrada' até o fim dela. Retorna 1 se recebeu SAIR.
+static int atender(Servidor* servidor, FILE* entrada, FILE* saida) {
+    char linha[TAMANHO_CABECALHO];
+    char comando[16], nome[TAMANHO_CABECALHO];
+    size_t tamanho;
+    ResultadoServidor vazio;
+    memset(&vazio, 0, sizeof(vazio));
+
+    while (fgets(linha, sizeof(linha), entrada) != NULL) {
+        int campos = sscanf(linha, "%15s %4095s %zu", comando, nome, &tamanho);
+        if (campos >= 1 && strcmp(comando, "SAIR") == 0) {
+            return 1;
+        }
+        if (campos == 2 && strcmp(comando, "ESQUECER") == 0) {
+            esquecer_arquivo(&servidor->arquivos, nome);
+            responder(saida, "OK", &vazio, 0);
+            continue;
+        }
+        if (campos != 3 || strcmp(comando, "COMPILAR") != 0) {
+            fprintf(saida, "ERRO pedido invalido\n");
+            fflush(saida);
+            continue;
+        }
+
+        char* texto = (char*) malloc(tamanho + 1);
+        if (texto == NULL || fread(texto, 1, tamanho, entrada) != tamanho) {
+            free(texto);
+            return 0;
+        }
+
+        struct timespec inicio, fim;
+        ResultadoServidor res;
+        memset(&res, 0, sizeof(res));
+        clock_gettime(CLOCK_MONOTONIC, &inicio);
+        compilar_pedido(servidor, obter_arquivo(&servidor->arquivos, nome), texto, tamanho, &res);
+        clock_gettime(CLOCK_MONOTONIC, &fim);
+        long microssegundos = (fim.tv_sec - inicio.tv_sec) * 1000000L + (fim.tv_nsec - inicio.tv_nsec) / 1000;
+
+        responder(saida, res.sucesso ? "OK" : "FALHA", &res, microssegundos);
+        free(res.assembly);
+        free(res.diagnosticos);
+        free(texto);
+    }
+    return 0;
+}
+
+int executar_servidor(const char* caminho_socket, const CompilerContext* opcoes) {
+    Servidor servidor = { NULL, opcoes };
+    int status = 0;
+
+    if (caminho_socket == NULL) {
+        atender(&servidor, stdin, stdout);
+    } else {
+        struct sockaddr_un endereco;
+        memset(&endereco, 0, sizeof(endereco));
+        endereco.sun_family = AF_UNIX;
+        if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) {
+            fprintf(stderr, "Erro: caminho do socket muito longo: '%s'\n", caminho_socket);
+            return 1;
+        }
+        strcpy(endereco.sun_path, caminho_socket);
+
+        int ouvinte = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(caminho_socket);
+        if (ouvinte < 0 || bind(ouvinte, (struct sockaddr*) &endereco, sizeof(endereco)) != 0 ||
+            listen(ouvinte, 8) != 0) {
+            perror("Erro: Nao foi possivel abrir o socket");
+            if (ouvinte >= 0) close(ouvinte);
+            return 1;
+        }
+        signal(SIGPIPE, SIG_IGN); // Clientes que desconectam não derrubam o servidor
+
+        int sair = 0;
+        while (!sair) {
+            int conexao = accept(ouvinte, NULL, NULL);
+            if (conexao < 0) {
+                status = 1;
+                break;
+            }
+            FILE* entrada = fdopen(conexao, "r");
+            FILE* saida = fdopen(dup(conexao), "w");
+            if (entrada != NULL && saida != NULL) {
+                sair = atender(&servidor, entrada, saida);
+            }
+            if (saida != NULL) fclose(saida);
+            if (entrada != NULL) fclose(entrada);
+        }
+        close(ouvinte);
+        unlink(caminho_socket);
+    }
+
+    while (servidor.arquivos != NULL) {
+        ArquivoServidor* proximo = servidor.arquivos->proximo;
+        liberar_arquivo(servidor.arquivos);
+        servidor.arquivos = proximo;
+    }
+    regiao_liberar_cache();
+    return status;
+}
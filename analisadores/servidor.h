@@ -0,0 +1,52 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+/*
+ * Modo servidor (goianinha --servidor[=CAMINHO]).
+ *
+ * Um processo de longa duração atende pedidos de compilação em stdin/stdout
+ * ou, com CAMINHO, num socket Unix local (uma conexão por vez; o cache vale
+ * para todas). As opções de compilação da linha de comando (-O, --convencao,
+ * --peephole, --fatias) valem para todos os pedidos.
+ *
+ * No nível 0, o servidor guarda de cada arquivo o texto da última compilação
+ * bem-sucedida e, por declaração de nível superior (lista de globais, função
+ * ou bloco principal): onde ela começa no texto, os nomes que declara com seus
+ * tipos e parâmetros, os nomes globais que o seu código usa e o assembly dela.
+ * Os nomes ficam num índice por átomo: quem declara cada um e quantos o usam.
+ *
+ * Num novo pedido, o texto é comparado com o guardado e só as declarações que
+ * o trecho alterado toca são analisadas, verificadas e geradas de novo: a
+ * tabela de símbolos do trecho começa com as declarações anteriores que ele
+ * menciona, e o assembly das demais é reaproveitado. Se o trecho não compila
+ * sozinho, declara um nome que também existe fora dele, ou muda uma declaração
+ * da qual depende alguma declaração de fora, o pedido vira uma compilação
+ * completa, então o resultado e os diagnósticos são sempre os dela.
+ *
+ * Os rótulos do bloco principal e de cada função são prefixados pelo nome
+ * dele (ver gerar_codigo_funcao), e as regras de janela se aplicam a cada um
+ * em separado, o que torna o código de cada parte independente das demais.
+ *
+ * No nível 1 a integração de funções e o alocador de registradores olham o
+ * programa inteiro, então cada pedido é uma compilação completa, a mesma da
+ * linha de comando, sem reaproveitamento.
+ *
+ * Protocolo (cabeçalhos em texto, uma linha cada; corpos binários):
+ *
+ *   COMPILAR <arquivo> <bytes>\n<texto-fonte>
+ *       -> OK|FALHA <bytes asm> <bytes diag> <reaproveitadas> <geradas> <us>\n
+ *          seguido do assembly e dos diagnósticos
+ *   ESQUECER <arquivo>\n     descarta o cache do arquivo    -> OK 0 0 0 0 0\n
+ *   SAIR\n                   encerra o servidor
+ *
+ * <arquivo> é só a chave do cache (não é lido do disco); <us> é o tempo da
+ * compilação em microssegundos.
+ */
+
+struct CompilerContext;
+
+/* Atende pedidos até SAIR ou o fim da entrada, compilando com as opções de
+ * 'opcoes' (ver compilador.h). Retorna 0, ou 1 em caso de erro. */
+int executar_servidor(const char* caminho_socket, const struct CompilerContext* opcoes);
+
+#endif
@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "otimizador.h"
+#include "percurso.h"
+
+/*
+ * Numeração de valores local. Cada função (e o bloco principal) é dividida
+ * em regiões de código em linha reta: um 'se' fecha a região na condição e
+ * cada ramo começa outra; um 'enquanto' começa uma região na condição, que
+ * segue pelo corpo; o operando direito de 'e' e 'ou', que nem sempre é
+ * avaliado, é uma região, e depois dele começa outra. Dentro de uma região, nós de expressão que calculam o
+ * mesmo valor recebem o mesmo número.
+ *
+ * A primeira passagem numera os nós na ordem de avaliação (pós-ordem). A
+ * segunda, em pré-ordem, troca cada operador cujo número já apareceu antes
+ * por um NO_TEMP e o primeiro nó com aquele número por um NO_GUARDA; como é
+ * em pré-ordem, a maior subexpressão repetida é trocada inteira.
+ */
+
+// Chave de um valor: operador e números dos operandos, constante ou variável
+typedef struct {
+    uintptr_t a;
+    uint32_t b;
+    uint8_t tipo;       // TipoNo do nó (NO_ID para variáveis)
+    uint8_t classe;     // ClasseLigacao das variáveis
+    uint32_t geracao;   // Entrada vazia se diferente da geração da tabela
+    uint32_t numero;
+} EntradaValor;
+
+typedef struct {
+    Ast* ast;
+    EstatisticasOtimizacao* est;
+
+    uint32_t* numero;           // Número de valor de cada nó (0: nenhum)
+    uint32_t num_nos;           // Nós com número (os criados depois não têm)
+
+    NoAst* primeiro;            // Primeiro nó de cada número de valor
+    uint32_t* regiao_valor;     // Região de cada número de valor
+    uint32_t num_valores;
+    uint32_t capacidade_valores;
+
+    EntradaValor* tabela;       // Endereçamento aberto, potência de 2
+    uint32_t capacidade_tabela;
+    uint32_t ocupadas;
+    uint32_t geracao;           // Trocada a cada região: esvazia a tabela
+    uint32_t geracao_globais;   // Trocada a cada chamada: esquece as globais
+    uint32_t regiao;
+
+    // Slots dos valores guardados: reaproveitados a cada região
+    int base_slots;
+    int proximo_slot;
+    int maior_slot;
+    uint32_t regiao_slots;
+
+    int sem_memoria;
+} Numerador;
+
+static uint32_t espalhar(const EntradaValor* e) {
+    uint64_t h = (uint64_t) e->a * 0x9e3779b97f4a7c15ull;
+    h ^= ((uint64_t) e->b << 16) ^ ((uint64_t) e->tipo << 8) ^ e->classe;
+    h *= 0xff51afd7ed558ccdull;
+    return (uint32_t) (h >> 32);
+}
+
+static int mesma_chave(const EntradaValor* x, const EntradaValor* y) {
+    return x->a == y->a && x->b == y->b && x->tipo == y->tipo && x->classe == y->classe;
+}
+
+// Número novo, cujo primeiro nó é 'no'. Retorna 0 se faltar memória.
+static uint32_t novo_valor(Numerador* n, NoAst no) {
+    if (n->num_valores == n->capacidade_valores) {
+        uint32_t nova = n->capacidade_valores ? n->capacidade_valores * 2 : 256;
+        NoAst* primeiro = realloc(n->primeiro, nova * sizeof(NoAst));
+        if (primeiro) n->primeiro = primeiro;
+        uint32_t* regiao = realloc(n->regiao_valor, nova * sizeof(uint32_t));
+        if (regiao) n->regiao_valor = regiao;
+        if (!primeiro || !regiao) {
+            n->sem_memoria = 1;
+            return 0;
+        }
+        n->capacidade_valores = nova;
+    }
+    n->primeiro[n->num_valores] = no;
+    n->regiao_valor[n->num_valores] = n->regiao;
+    return n->num_valores++;
+}
+
+static int crescer_tabela(Numerador* n) {
+    uint32_t nova = n->capacidade_tabela ? n->capacidade_tabela * 2 : 1024;
+    EntradaValor* tabela = calloc(nova, sizeof(EntradaValor));
+    if (!tabela) return 0;
+    // Só as entradas da geração atual são levadas; a geração 0 nunca é usada
+    for (uint32_t i = 0; i < n->capacidade_tabela; i++) {
+        const EntradaValor* e = &n->tabela[i];
+        if (e->geracao != n->geracao) continue;
+        uint32_t j = espalhar(e) & (nova - 1);
+        while (tabela[j].geracao == n->geracao) j = (j + 1) & (nova - 1);
+        tabela[j] = *e;
+    }
+    free(n->tabela);
+    n->tabela = tabela;
+    n->capacidade_tabela = nova;
+    return 1;
+}
+
+/* Entrada da chave na região atual; se não existe, é criada com 'numero' 0.
+ * Retorna NULL se faltar memória. */
+static EntradaValor* buscar(Numerador* n, const EntradaValor* chave) {
+    if (2 * (n->ocupadas + 1) > n->capacidade_tabela && !crescer_tabela(n)) {
+        n->sem_memoria = 1;
+        return NULL;
+    }
+    uint32_t mascara = n->capacidade_tabela - 1;
+    uint32_t i = espalhar(chave) & mascara;
+    while (n->tabela[i].geracao == n->geracao) {
+        if (mesma_chave(&n->tabela[i], chave)) return &n->tabela[i];
+        i = (i + 1) & mascara;
+    }
+    EntradaValor* e = &n->tabela[i];
+    *e = *chave;
+    e->geracao = n->geracao;
+    e->numero = 0;
+    n->ocupadas++;
+    return e;
+}
+
+// Número do valor com a chave dada, criado em 'no' se é a primeira vez
+static uint32_t numerar(Numerador* n, NoAst no, uint8_t tipo, uintptr_t a, uint32_t b) {
+    EntradaValor chave = { a, b, tipo, 0, 0, 0 };
+    EntradaValor* e = buscar(n, &chave);
+    if (e == NULL) return 0;
+    if (e->numero == 0) e->numero = novo_valor(n, no);
+    return e->numero;
+}
+
+static void nova_regiao(Numerador* n) {
+    n->regiao++;
+    n->ocupadas = 0;
+    if (++n->geracao == 0) {
+        // Volta completa: as entradas antigas poderiam parecer atuais
+        if (n->capacidade_tabela > 0) memset(n->tabela, 0, n->capacidade_tabela * sizeof(EntradaValor));
+        n->geracao = 1;
+    }
+}
+
+// --- Variáveis ---
+
+// Chave do valor atual de uma variável (globais mudam a cada chamada)
+static EntradaValor chave_variavel(const Numerador* n, NoAst id) {
+    Ligacao lig = AST_LIGACAO(n->ast, id);
+    EntradaValor chave = { 0, 0, NO_ID, (uint8_t) lig.classe, 0, 0 };
+    if (lig.classe == LIG_GLOBAL) {
+        chave.a = (uintptr_t) AST_LEXEMA(n->ast, id);
+        chave.b = n->geracao_globais;
+    } else {
+        chave.a = (uintptr_t) (uint32_t) lig.slot;
+    }
+    return chave;
+}
+
+// A variável passa a valer o valor de número 'numero' (0: um valor novo)
+static void definir_variavel(Numerador* n, NoAst id, uint32_t numero) {
+    EntradaValor chave = chave_variavel(n, id);
+    EntradaValor* e = buscar(n, &chave);
+    if (e != NULL) e->numero = numero != 0 ? numero : novo_valor(n, id);
+}
+
+// --- Primeira passagem: numeração ---
+
+static int eh_operador(TipoNo tipo) {
+    return (tipo >= NO_SOMA && tipo <= NO_OU) || tipo == NO_NEG;
+}
+
+static unsigned numerar_entrada(void* dados, NoAst no, intptr_t* salvo) {
+    Numerador* n = (Numerador*) dados;
+    Ast* ast = n->ast;
+
+    switch (AST_TIPO(ast, no)) {
+        case NO_DECL_VAR:
+        case NO_NULO:
+        case NO_NOVALINHA:
+        case NO_CADEIA_CAR:
+            return PERCURSO_NENHUM;
+
+        case NO_BLOCO:
+        case NO_ATRIBUICAO:
+        case NO_CHAMADA_FUNC:
+            return 1u << 1; // Comandos; valor; argumentos
+
+        case NO_LEIA:
+            definir_variavel(n, AST_FILHO(ast, no, 0), 0);
+            return PERCURSO_NENHUM;
+
+        case NO_ENQUANTO:
+            // A condição é avaliada a cada volta: começa a região do corpo
+            nova_regiao(n);
+            return PERCURSO_TODOS;
+
+        case NO_ID:
+        {
+            EntradaValor chave = chave_variavel(n, no);
+            EntradaValor* e = buscar(n, &chave);
+            if (e != NULL && e->numero == 0) e->numero = novo_valor(n, no);
+            n->numero[no] = e != NULL ? e->numero : 0;
+            return PERCURSO_NENHUM;
+        }
+
+        case NO_INT_CONST:
+            n->numero[no] = numerar(n, no, NO_INT_CONST, (uintptr_t) (uint32_t) AST_VALOR_INT(ast, no), 0);
+            return PERCURSO_NENHUM;
+        case NO_CAR_CONST:
+            n->numero[no] = numerar(n, no, NO_INT_CONST, (uintptr_t) (uint32_t) AST_FOLHA(ast, no).valor, 0);
+            return PERCURSO_NENHUM;
+
+        case NO_TEMP:
+            n->numero[no] = novo_valor(n, no);
+            return PERCURSO_NENHUM;
+
+        default:
+            return PERCURSO_TODOS;
+    }
+}
+
+static void numerar_filho(void* dados, NoAst no, int filho, NoAst elemento, uint32_t indice, intptr_t* salvo) {
+    Numerador* n = (Numerador*) dados;
+    // Cada ramo de um 'se' é uma região, e a condição fica com a anterior
+    TipoNo tipo = (TipoNo) AST_TIPO(n->ast, no);
+    if ((tipo == NO_SE && filho < 2) || ((tipo == NO_E || tipo == NO_OU) && filho == 0)) nova_regiao(n);
+}
+
+static void numerar_saida(void* dados, NoAst no, intptr_t salvo) {
+    Numerador* n = (Numerador*) dados;
+    Ast* ast = n->ast;
+    TipoNo tipo = (TipoNo) AST_TIPO(ast, no);
+
+    if (tipo == NO_E || tipo == NO_OU) {
+        // Nada calculado no operando direito vale depois dele
+        n->numero[no] = novo_valor(n, no);
+        nova_regiao(n);
+        return;
+    }
+    if (tipo >= NO_SOMA && tipo <= NO_MENOR_IGUAL) {
+        uint32_t a = n->numero[AST_FILHO(ast, no, 0)];
+        uint32_t b = n->numero[AST_FILHO(ast, no, 1)];
+        if (a == 0 || b == 0) {
+            n->numero[no] = novo_valor(n, no);
+            return;
+        }
+        // Formas equivalentes ficam com a mesma chave: a>b é b<a, a+b é b+a
+        if (tipo == NO_MAIOR || tipo == NO_MAIOR_IGUAL) {
+            tipo = tipo == NO_MAIOR ? NO_MENOR : NO_MENOR_IGUAL;
+            uint32_t t = a; a = b; b = t;
+        } else if ((tipo == NO_SOMA || tipo == NO_MULT || tipo == NO_IGUAL || tipo == NO_DIF) && a > b) {
+            uint32_t t = a; a = b; b = t;
+        }
+        n->numero[no] = numerar(n, no, (uint8_t) tipo, a, b);
+        return;
+    }
+
+    switch (tipo) {
+        case NO_NEG:
+        {
+            uint32_t a = n->numero[AST_FILHO(ast, no, 0)];
+            n->numero[no] = a != 0 ? numerar(n, no, NO_NEG, a, 0) : novo_valor(n, no);
+            break;
+        }
+
+        case NO_GUARDA:
+            n->numero[no] = n->numero[AST_FILHO(ast, no, 0)];
+            break;
+
+        case NO_CHAMADA_FUNC:
+            // A função chamada pode alterar qualquer global
+            n->numero[no] = novo_valor(n, no);
+            n->geracao_globais++;
+            break;
+
+        case NO_ATRIBUICAO:
+            definir_variavel(n, AST_FILHO(ast, no, 0), n->numero[AST_FILHO(ast, no, 1)]);
+            break;
+
+        case NO_SE:
+        case NO_ENQUANTO:
+            nova_regiao(n);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// --- Segunda passagem: troca das repetições ---
+
+// Slot onde fica o valor do número 'v', guardado pelo seu primeiro nó
+static int guardar(Numerador* n, uint32_t v) {
+    Ast* ast = n->ast;
+    NoAst primeiro = n->primeiro[v];
+    if (AST_TIPO(ast, primeiro) == NO_GUARDA) return AST_SLOT(ast, primeiro);
+
+    // O operador vai para um nó novo; o original vira o NO_GUARDA, na mesma posição
+    NoAst copia = criar_no(ast, NO_GUARDA, NO_NENHUM, NO_NENHUM, NO_NENHUM, 0);
+    if (copia == NO_NENHUM) {
+        n->sem_memoria = 1;
+        return -1;
+    }
+    if (n->regiao_valor[v] != n->regiao_slots) {
+        n->regiao_slots = n->regiao_valor[v];
+        n->proximo_slot = n->base_slots;
+    }
+    int slot = n->proximo_slot++;
+    if (n->proximo_slot > n->maior_slot) n->maior_slot = n->proximo_slot;
+
+    uint32_t filhos_guarda = ast->primeiro_filho[copia];
+    AST_TIPO(ast, copia) = AST_TIPO(ast, primeiro);
+    AST_TIPO_DADO(ast, copia) = AST_TIPO_DADO(ast, primeiro);
+    ast->primeiro_filho[copia] = ast->primeiro_filho[primeiro];
+    ast->dado[copia] = ast->dado[primeiro];
+    AST_LINHA(ast, copia) = AST_LINHA(ast, primeiro);
+
+    AST_TIPO(ast, primeiro) = NO_GUARDA;
+    ast->primeiro_filho[primeiro] = filhos_guarda;
+    AST_FILHO(ast, primeiro, 0) = copia;
+    AST_SLOT(ast, primeiro) = slot;
+    return slot;
+}
+
+static unsigned trocar_entrada(void* dados, NoAst no, intptr_t* salvo) {
+    Numerador* n = (Numerador*) dados;
+    Ast* ast = n->ast;
+    TipoNo tipo = (TipoNo) AST_TIPO(ast, no);
+
+    if (tipo == NO_DECL_VAR) return PERCURSO_NENHUM;
+    if (!eh_operador(tipo) || no >= n->num_nos || n->sem_memoria) return PERCURSO_TODOS;
+
+    uint32_t v = n->numero[no];
+    if (v == 0 || n->primeiro[v] == no) return PERCURSO_TODOS;
+
+    int slot = guardar(n, v);
+    if (slot < 0) return PERCURSO_NENHUM;
+    AST_TIPO(ast, no) = NO_TEMP;
+    ast->primeiro_filho[no] = 0;
+    AST_SLOT(ast, no) = slot;
+    n->est->subexpressoes++;
+    return PERCURSO_NENHUM;
+}
+
+// Numera e troca as repetições no corpo de uma função ou do bloco principal
+static int processar_corpo(Numerador* n, NoAst dono, NoAst corpo) {
+    static const VisitanteAst numeracao = { numerar_entrada, numerar_filho, numerar_saida };
+    static const VisitanteAst troca = { trocar_entrada, NULL, NULL };
+
+    n->num_valores = 0;
+    novo_valor(n, NO_NENHUM); // O número 0 fica reservado
+    if (n->sem_memoria) return -1;
+    nova_regiao(n);
+    n->base_slots = AST_NUM_LOCAIS(n->ast, dono);
+    n->maior_slot = n->base_slots;
+    n->regiao_slots = 0;
+
+    if (percorrer_ast(n->ast, corpo, &numeracao, n) != 0 || n->sem_memoria) return -1;
+    int resultado = percorrer_ast(n->ast, corpo, &troca, n);
+    AST_NUM_LOCAIS(n->ast, dono) = n->maior_slot;
+    return resultado != 0 || n->sem_memoria ? -1 : 0;
+}
+
+int eliminar_subexpressoes(Ast* ast, NoAst raiz, EstatisticasOtimizacao* est) {
+    if (raiz == NO_NENHUM) return 0;
+
+    Numerador n;
+    memset(&n, 0, sizeof(n));
+    n.ast = ast;
+    n.est = est;
+    n.num_nos = ast->num_nos;
+    n.numero = calloc(n.num_nos, sizeof(uint32_t));
+    if (n.numero == NULL) return -1;
+
+    int resultado = 0;
+    for (NoAst decl = AST_FILHO(ast, raiz, 0); decl != NO_NENHUM && resultado == 0; decl = AST_PROX(ast, decl)) {
+        if (AST_TIPO(ast, decl) == NO_DECL_FUNC) resultado = processar_corpo(&n, decl, AST_FILHO(ast, decl, 2));
+    }
+    if (resultado == 0) resultado = processar_corpo(&n, raiz, AST_FILHO(ast, raiz, 1));
+
+    free(n.numero);
+    free(n.primeiro);
+    free(n.regiao_valor);
+    free(n.tabela);
+    return resultado;
+}
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "tokens.h"
+#include "varredor.h"
+#include "compilador.h"
+#include "y.tab.h"
+
+// Abaixo disto, dividir o arquivo não compensa o custo das threads
+#define TAMANHO_MINIMO_FATIA (256 * 1024)
+#define MAXIMO_FATIAS 64
+
+#define CODIGO_TOKEN(t) ((t) == 0 ? 0 : (t) + 256)
+
+// --- Buffer ---
+
+static int reservar_tokens(BufferTokens* b, size_t minimo) {
+    if (minimo <= b->capacidade) return 1;
+    size_t nova = b->capacidade ? b->capacidade : 1024;
+    while (nova < minimo) nova *= 2;
+
+    uint8_t* tipo = realloc(b->tipo, nova * sizeof(uint8_t));
+    if (tipo) b->tipo = tipo;
+    uint32_t* deslocamento = realloc(b->deslocamento, nova * sizeof(uint32_t));
+    if (deslocamento) b->deslocamento = deslocamento;
+    uint32_t* tamanho = realloc(b->tamanho, nova * sizeof(uint32_t));
+    if (tamanho) b->tamanho = tamanho;
+    uint32_t* linha = realloc(b->linha, nova * sizeof(uint32_t));
+    if (linha) b->linha = linha;
+    if (!tipo || !deslocamento || !tamanho || !linha) return 0;
+
+    b->capacidade = nova;
+    return 1;
+}
+
+static int anexar_token(BufferTokens* b, int codigo, size_t deslocamento, size_t tamanho, int linha) {
+    if (b->quantidade == b->capacidade && !reservar_tokens(b, b->quantidade + 1)) return 0;
+    size_t i = b->quantidade++;
+    b->tipo[i] = (uint8_t) (codigo == 0 ? 0 : codigo - 256);
+    b->deslocamento[i] = (uint32_t) deslocamento;
+    b->tamanho[i] = (uint32_t) tamanho;
+    b->linha[i] = (uint32_t) linha;
+    return 1;
+}
+
+void liberar_tokens(BufferTokens* buffer) {
+    free(buffer->tipo);
+    free(buffer->deslocamento);
+    free(buffer->tamanho);
+    free(buffer->linha);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+// --- Tokenização de um trecho ---
+
+typedef struct {
+    const char* texto;
+    size_t tamanho;
+    size_t inicio;         // Onde a varredura começa
+    size_t limite;         // Início do trecho seguinte
+    BufferTokens tokens;   // Linhas relativas: a linha de 'inicio' é 1
+    size_t fim;            // Onde a varredura parou (>= limite)
+    int quebras;           // Quebras de linha consumidas entre inicio e fim
+    int ok;
+} Trecho;
+
+static void tokenizar_trecho(Trecho* t) {
+    Varredor v;
+    varredor_iniciar(&v, t->texto, t->tamanho);
+    v.pos = t->inicio;
+    v.limite = t->limite;
+
+    reservar_tokens(&t->tokens, (t->limite - t->inicio) / 4 + 16);
+    t->ok = 1;
+    for (;;) {
+        size_t inicio, tamanho;
+        int codigo = varredor_token(&v, &inicio, &tamanho);
+        if (codigo == 0) break;
+        if (!anexar_token(&t->tokens, codigo, inicio, tamanho, v.linha)) {
+            t->ok = 0;
+            break;
+        }
+    }
+    t->fim = v.pos;
+    t->quebras = v.linha - 1;
+}
+
+static void* executar_trecho(void* arg) {
+    tokenizar_trecho((Trecho*) arg);
+    return NULL;
+}
+
+// Início da primeira linha, a partir de 'pos', que abre uma declaração de nível superior
+static size_t proxima_declaracao(const char* s, size_t n, size_t pos) {
+    static const char* inicios[] = { "int", "car", "programa" };
+    while (pos < n) {
+        const char* quebra = memchr(s + pos, '\n', n - pos);
+        if (quebra == NULL) return n;
+        size_t linha = (size_t) (quebra - s) + 1;
+        for (int i = 0; i < 3; i++) {
+            size_t k = strlen(inicios[i]);
+            if (linha + k < n && memcmp(s + linha, inicios[i], k) == 0 &&
+                (s[linha + k] == ' ' || s[linha + k] == '\t' || s[linha + k] == '{' ||
+                 s[linha + k] == '\n' || s[linha + k] == '\r')) {
+                return linha;
+            }
+        }
+        pos = linha;
+    }
+    return n;
+}
+
+static int numero_de_fatias(size_t tamanho, int pedido) {
+    int fatias = pedido;
+    if (fatias <= 0) {
+        long processadores = sysconf(_SC_NPROCESSORS_ONLN);
+        fatias = processadores > 0 ? (int) processadores : 1;
+        size_t por_tamanho = tamanho / TAMANHO_MINIMO_FATIA;
+        if ((size_t) fatias > por_tamanho) fatias = por_tamanho > 0 ? (int) por_tamanho : 1;
+    }
+    return fatias > MAXIMO_FATIAS ? MAXIMO_FATIAS : fatias;
+}
+
+// --- Tokenização do arquivo ---
+
+int tokenizar_fonte(const char* texto, size_t tamanho, int num_fatias, BufferTokens* buffer) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    memset(buffer, 0, sizeof(*buffer));
+    if (tamanho > UINT32_MAX) return -1;
+
+    // Divide o texto em trechos que começam em declarações de nível superior
+    Trecho trechos[MAXIMO_FATIAS];
+    int n = 0;
+    int fatias = numero_de_fatias(tamanho, num_fatias);
+    size_t inicio = 0;
+    while (inicio < tamanho || n == 0) {
+        size_t limite = tamanho;
+        if (n + 1 < fatias) {
+            size_t alvo = tamanho / (size_t) fatias * (size_t) (n + 1);
+            if (alvo <= inicio) alvo = inicio + 1;
+            limite = proxima_declaracao(texto, tamanho, alvo - 1);
+        }
+        memset(&trechos[n], 0, sizeof(Trecho));
+        trechos[n].texto = texto;
+        trechos[n].tamanho = tamanho;
+        trechos[n].inicio = inicio;
+        trechos[n].limite = limite;
+        n++;
+        inicio = limite;
+    }
+
+    // Os trechos 1..n-1 vão para threads; o primeiro é feito nesta
+    pthread_t threads[MAXIMO_FATIAS];
+    int criada[MAXIMO_FATIAS] = { 0 };
+    for (int i = 1; i < n; i++) {
+        criada[i] = pthread_create(&threads[i], NULL, executar_trecho, &trechos[i]) == 0;
+        if (!criada[i]) tokenizar_trecho(&trechos[i]);
+    }
+    tokenizar_trecho(&trechos[0]);
+    for (int i = 1; i < n; i++) {
+        if (criada[i]) pthread_join(threads[i], NULL);
+    }
+
+    // Junta os trechos em ordem. Se o anterior parou depois do início deste
+    // (um comentário atravessou a fronteira), este é refeito de onde aquele parou.
+    int ok = 1;
+    size_t esperado = 0;
+    int quebras = 0;
+    for (int i = 0; i < n && ok; i++) {
+        Trecho* t = &trechos[i];
+        if (t->inicio != esperado) {
+            liberar_tokens(&t->tokens);
+            t->inicio = esperado;
+            tokenizar_trecho(t);
+        }
+        ok = t->ok && reservar_tokens(buffer, buffer->quantidade + t->tokens.quantidade + 1);
+        for (size_t k = 0; ok && k < t->tokens.quantidade; k++) {
+            size_t j = buffer->quantidade++;
+            buffer->tipo[j] = t->tokens.tipo[k];
+            buffer->deslocamento[j] = t->tokens.deslocamento[k];
+            buffer->tamanho[j] = t->tokens.tamanho[k];
+            buffer->linha[j] = t->tokens.linha[k] + (uint32_t) quebras;
+        }
+        esperado = t->fim;
+        quebras += t->quebras;
+    }
+    ok = ok && anexar_token(buffer, 0, tamanho, 0, quebras + 1);
+
+    for (int i = 0; i < n; i++) {
+        liberar_tokens(&trechos[i].tokens);
+    }
+    if (!ok) {
+        liberar_tokens(buffer);
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    buffer->fatias_usadas = n;
+    buffer->tempo_tokenizacao = (double) (t1.tv_sec - t0.tv_sec) + (double) (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    return 0;
+}
+
+// --- Leitura pelo parser ---
+
+int tokens_proximo(CompilerContext* ctx, YYSTYPE* valor) {
+    const BufferTokens* buffer = &ctx->tokens;
+    for (;;) {
+        size_t i = ctx->proximo_token;
+        int codigo = CODIGO_TOKEN(buffer->tipo[i]);
+        ctx->linha = (int) buffer->linha[i];
+        if (codigo == 0) return 0; // O fim de arquivo não é consumido
+        ctx->proximo_token++;
+
+        const char* erro = mensagem_erro_lexico(codigo);
+        if (erro != NULL) {
+            fprintf(ctx->diagnosticos, "ERRO: %s na linha %d\n", erro, ctx->linha);
+            continue;
+        }
+        valor_semantico(&ctx->atomos, codigo, ctx->fonte.dados + buffer->deslocamento[i],
+                        buffer->tamanho[i], valor);
+        return codigo;
+    }
+}
+
+// --- Depuração ---
+
+static const char* nome_token(int codigo) {
+    static const char* nomes[256] = {
+        [0] = "FIM",
+        [T_ID - 256] = "ID", [T_CADEIA - 256] = "CADEIA", [T_CARCONST - 256] = "CARCONST",
+        [T_INTCONST - 256] = "INTCONST", [T_PROGRAMA - 256] = "programa", [T_CAR - 256] = "car",
+        [T_INT - 256] = "int", [T_RETORNE - 256] = "retorne", [T_LEIA - 256] = "leia",
+        [T_ESCREVA - 256] = "escreva", [T_NOVALINHA - 256] = "novalinha", [T_SE - 256] = "se",
+        [T_ENTAO - 256] = "entao", [T_SENAO - 256] = "senao", [T_ENQUANTO - 256] = "enquanto",
+        [T_EXECUTE - 256] = "execute", [T_OU - 256] = "ou", [T_E - 256] = "e",
+        [T_EQ - 256] = "==", [T_NE - 256] = "!=", [T_GE - 256] = ">=", [T_LE - 256] = "<=",
+        [T_SOMA - 256] = "+", [T_SUB - 256] = "-", [T_MULT - 256] = "*", [T_DIV - 256] = "/",
+        [T_ATRIB - 256] = "=", [T_MENOR - 256] = "<", [T_MAIOR - 256] = ">", [T_NEG - 256] = "!",
+        [T_LPAREN - 256] = "(", [T_RPAREN - 256] = ")", [T_LCHAVE - 256] = "{", [T_RCHAVE - 256] = "}",
+        [T_PVIRGULA - 256] = ";", [T_VIRGULA - 256] = ",",
+        [ERRO_COMENTARIO_NAO_TERMINA - 256] = "ERRO", [ERRO_CARACTERE_INVALIDO - 256] = "ERRO",
+        [ERRO_CADEIA_MULTILINHA - 256] = "ERRO",
+    };
+    const char* nome = nomes[codigo == 0 ? 0 : codigo - 256];
+    return nome ? nome : "?";
+}
+
+// Bloco alocado por malloc para 'n' bytes na glibc x86-64 (cabeçalho de 8, mínimo 32)
+static size_t bloco_heap(size_t n) {
+    size_t bloco = (n + 8 + 15) & ~(size_t) 15;
+    return bloco < 32 ? 32 : bloco;
+}
+
+void imprimir_tokens(FILE* saida, const BufferTokens* buffer, const char* texto) {
+    size_t bytes_heap = 0;
+
+    fprintf(saida, "%-8s %-10s %-12s %-8s %s\n", "LINHA", "TOKEN", "DESLOCAMENTO", "TAMANHO", "LEXEMA");
+    for (size_t i = 0; i < buffer->quantidade; i++) {
+        int codigo = CODIGO_TOKEN(buffer->tipo[i]);
+        fprintf(saida, "%-8u %-10s %-12u %-8u ", buffer->linha[i], nome_token(codigo),
+                buffer->deslocamento[i], buffer->tamanho[i]);
+        const char* erro = mensagem_erro_lexico(codigo);
+        if (erro != NULL) {
+            fprintf(saida, "%s\n", erro);
+        } else if (codigo == T_ID || codigo == T_INTCONST || codigo == T_CADEIA || codigo == T_CARCONST) {
+            fprintf(saida, "%.*s\n", (int) buffer->tamanho[i], texto + buffer->deslocamento[i]);
+        } else {
+            fprintf(saida, "\n");
+        }
+
+        // Referência: um registro { tipo, linha, valor, lexema } alocado por token,
+        // mais uma cópia do lexema para IDs e literais
+        bytes_heap += bloco_heap(2 * sizeof(int) + 2 * sizeof(void*));
+        if (codigo == T_ID || codigo == T_CADEIA || codigo == T_CARCONST) {
+            bytes_heap += bloco_heap(buffer->tamanho[i] + 1);
+        }
+    }
+
+    size_t por_token = sizeof(uint8_t) + 3 * sizeof(uint32_t);
+    size_t bytes_compacto = buffer->quantidade * por_token;
+    fprintf(saida, "\n--- Fluxo de tokens ---\n");
+    fprintf(saida, "tokens: %zu (incluindo erros lexicos e o fim de arquivo)\n", buffer->quantidade);
+    fprintf(saida, "fatias tokenizadas em paralelo: %d\n", buffer->fatias_usadas);
+    fprintf(saida, "tempo de tokenizacao: %.6f s\n", buffer->tempo_tokenizacao);
+    fprintf(saida, "fluxo compacto: %zu bytes (%zu por token)\n", bytes_compacto, por_token);
+    fprintf(saida, "tokens com lexema no heap (estimativa): %zu bytes\n", bytes_heap);
+    if (bytes_heap > 0) {
+        fprintf(saida, "economia: %.1f%%\n", 100.0 * (1.0 - (double) bytes_compacto / (double) bytes_heap));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fluxo de tokens do arquivo inteiro, produzido antes da análise sintática.
+ *
+ * Os campos de cada token ficam em arrays paralelos (struct-of-arrays): o
+ * parser percorre 'tipo' e 'linha' sequencialmente e só toca o texto-fonte
+ * para os tokens que têm valor semântico. Nenhum lexema é copiado; IDs são
+ * internados apenas quando o parser os consome.
+ *
+ * Erros léxicos ficam no fluxo como pseudo-tokens (ERRO_* de varredor.h) e são
+ * reportados quando o parser chega a eles, na mesma ordem em que o scanner
+ * incremental os reportaria. O último token é sempre o fim de arquivo.
+ */
+typedef struct {
+    uint8_t*  tipo;          /* Código do token - 256 (0 = fim de arquivo) */
+    uint32_t* deslocamento;  /* Início do lexema no texto-fonte */
+    uint32_t* tamanho;       /* Tamanho do lexema em bytes */
+    uint32_t* linha;         /* Valor de yylineno ao ler o token */
+    size_t quantidade;
+    size_t capacidade;
+
+    int fatias_usadas;        /* Trechos tokenizados em paralelo */
+    double tempo_tokenizacao; /* Em segundos */
+} BufferTokens;
+
+/*
+ * Tokeniza 'texto' em 'buffer'. Com num_fatias > 1, o texto é dividido em até
+ * num_fatias trechos, começando em declarações de nível superior (linhas
+ * iniciadas por "int", "car" ou "programa"), tokenizados em paralelo. Um
+ * trecho cujo início caiu dentro de um comentário é refeito sequencialmente,
+ * então o resultado é sempre idêntico ao da tokenização sequencial.
+ * num_fatias == 0 escolhe automaticamente pelo número de processadores.
+ * Retorna 0 em caso de sucesso, ou -1 se o texto exceder 4 GB ou faltar memória.
+ */
+int tokenizar_fonte(const char* texto, size_t tamanho, int num_fatias, BufferTokens* buffer);
+
+void liberar_tokens(BufferTokens* buffer);
+
+/* yylex() do modo pré-tokenizado: devolve o próximo token de ctx->tokens */
+struct CompilerContext;
+union YYSTYPE;
+int tokens_proximo(struct CompilerContext* ctx, union YYSTYPE* valor);
+
+/*
+ * --dump-tokens: lista os tokens e compara o tamanho do fluxo compacto com o
+ * de uma representação com um registro e uma cópia do lexema no heap por token.
+ */
+void imprimir_tokens(FILE* saida, const BufferTokens* buffer, const char* texto);
+
+#endif
@@ -0,0 +1,451 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include "varredor.h"
+#include "atomos.h"
+#include "compilador.h"
+#include "y.tab.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define VARREDOR_SIMD 1
+#endif
+
+/*
+ * Scanner manual equivalente a goianinha.l.
+ *
+ * Regras do Flex reproduzidas aqui (casamento mais longo; empate resolvido
+ * pela regra que aparece antes):
+ *   - palavras-reservadas têm precedência sobre ID de mesmo tamanho;
+ *   - barra seguida de asterisco abre comentário; sem o fechamento até o fim
+ *     do arquivo, reporta COMENTARIO NAO TERMINA na última linha e encerra;
+ *   - uma aspa que não inicia CADEIA pode casar \"[^"\n]*\n (cadeia em mais de
+ *     uma linha); o Flex conta a quebra de linha antes da ação, então o erro
+ *     é reportado na linha seguinte. Se nem isso casar, é CARACTERE INVALIDO;
+ *   - qualquer outro byte não reconhecido é CARACTERE INVALIDO.
+ *
+ * O texto é percorrido pelo tamanho, não pelo terminador: bytes nulos no
+ * meio do arquivo são caracteres inválidos, como no Flex.
+ */
+
+// Reporta um erro léxico na linha atual da compilação
+static void reportar_erro(CompilerContext* ctx, const char* mensagem) {
+    fprintf(ctx->diagnosticos, "ERRO: %s na linha %d\n", mensagem, ctx->linha);
+}
+
+// --- Classificação de caracteres ---
+
+static int eh_inicio_id(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int eh_digito(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int eh_branco(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// --- Varreduras em bloco ---
+// Cada função recebe a posição inicial e devolve a primeira posição que não
+// pertence à sequência. Blocos de 16 bytes só são lidos quando cabem inteiros
+// no texto; o restante é tratado byte a byte.
+
+static size_t pular_brancos(const char* s, size_t n, size_t i, int* linha) {
+#ifdef VARREDOR_SIMD
+    const __m128i espaco = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (i + 16 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i quebras = _mm_cmpeq_epi8(v, lf);
+        __m128i brancos = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, espaco), _mm_cmpeq_epi8(v, tab)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, cr), quebras));
+        unsigned mascara = (unsigned) _mm_movemask_epi8(brancos);
+        unsigned linhas = (unsigned) _mm_movemask_epi8(quebras);
+        if (mascara != 0xFFFF) {
+            unsigned k = (unsigned) __builtin_ctz(~mascara);
+            *linha += __builtin_popcount(linhas & ((1u << k) - 1));
+            return i + k;
+        }
+        *linha += __builtin_popcount(linhas);
+        i += 16;
+    }
+#endif
+    while (i < n && eh_branco((unsigned char) s[i])) {
+        if (s[i] == '\n') (*linha)++;
+        i++;
+    }
+    return i;
+}
+
+// Posição logo após o "*/" que fecha o comentário, ou SEM_FIM se ele não termina
+#define SEM_FIM ((size_t) -1)
+
+static size_t fim_comentario(const char* s, size_t n, size_t i, int* linha) {
+#ifdef VARREDOR_SIMD
+    const __m128i asterisco = _mm_set1_epi8('*');
+    const __m128i barra = _mm_set1_epi8('/');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (i + 17 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i seguinte = _mm_loadu_si128((const __m128i*) (s + i + 1));
+        unsigned fecha = (unsigned) _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(v, asterisco), _mm_cmpeq_epi8(seguinte, barra)));
+        unsigned linhas = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(v, lf));
+        if (fecha != 0) {
+            unsigned k = (unsigned) __builtin_ctz(fecha);
+            *linha += __builtin_popcount(linhas & ((1u << k) - 1));
+            return i + k + 2;
+        }
+        *linha += __builtin_popcount(linhas);
+        i += 16;
+    }
+#endif
+    while (i < n) {
+        if (s[i] == '*' && i + 1 < n && s[i + 1] == '/') return i + 2;
+        if (s[i] == '\n') (*linha)++;
+        i++;
+    }
+    return SEM_FIM;
+}
+
+static size_t fim_identificador(const char* s, size_t n, size_t i) {
+#ifdef VARREDOR_SIMD
+    // Comparações com sinal: bytes >= 0x80 são negativos e ficam fora das faixas
+    const __m128i a_menos_1 = _mm_set1_epi8('a' - 1);
+    const __m128i z_mais_1 = _mm_set1_epi8('z' + 1);
+    const __m128i zero_menos_1 = _mm_set1_epi8('0' - 1);
+    const __m128i nove_mais_1 = _mm_set1_epi8('9' + 1);
+    const __m128i minuscula = _mm_set1_epi8(0x20);
+    const __m128i sublinhado = _mm_set1_epi8('_');
+    while (i + 16 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i l = _mm_or_si128(v, minuscula);
+        __m128i letra = _mm_and_si128(_mm_cmpgt_epi8(l, a_menos_1), _mm_cmplt_epi8(l, z_mais_1));
+        __m128i digito = _mm_and_si128(_mm_cmpgt_epi8(v, zero_menos_1), _mm_cmplt_epi8(v, nove_mais_1));
+        __m128i classe = _mm_or_si128(_mm_or_si128(letra, digito), _mm_cmpeq_epi8(v, sublinhado));
+        unsigned mascara = (unsigned) _mm_movemask_epi8(classe);
+        if (mascara != 0xFFFF) {
+            return i + (size_t) __builtin_ctz(~mascara);
+        }
+        i += 16;
+    }
+#endif
+    while (i < n && (eh_inicio_id((unsigned char) s[i]) || eh_digito((unsigned char) s[i]))) i++;
+    return i;
+}
+
+// Primeira posição com '"', '\\' ou '\n' (ou n)
+static size_t proximo_delimitador_cadeia(const char* s, size_t n, size_t i) {
+#ifdef VARREDOR_SIMD
+    const __m128i aspas = _mm_set1_epi8('"');
+    const __m128i barra_inv = _mm_set1_epi8('\\');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (i + 16 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i delim = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, aspas), _mm_cmpeq_epi8(v, barra_inv)),
+                                     _mm_cmpeq_epi8(v, lf));
+        unsigned mascara = (unsigned) _mm_movemask_epi8(delim);
+        if (mascara != 0) {
+            return i + (size_t) __builtin_ctz(mascara);
+        }
+        i += 16;
+    }
+#endif
+    while (i < n && s[i] != '"' && s[i] != '\\' && s[i] != '\n') i++;
+    return i;
+}
+
+// Tamanho do casamento de CADEIA a partir da aspa em 'p', ou 0
+static size_t casar_cadeia(const char* s, size_t n, size_t p) {
+    size_t i = p + 1;
+    for (;;) {
+        i = proximo_delimitador_cadeia(s, n, i);
+        if (i >= n || s[i] == '\n') return 0;
+        if (s[i] == '"') return i + 1 - p;
+        // Barra invertida escapa qualquer caractere exceto a quebra de linha
+        if (i + 1 >= n || s[i + 1] == '\n') return 0;
+        i += 2;
+    }
+}
+
+// Tamanho do casamento de \"[^"\n]*\n a partir da aspa em 'p', ou 0
+static size_t casar_cadeia_multilinha(const char* s, size_t n, size_t p) {
+    size_t i = p + 1;
+    for (;;) {
+        i = proximo_delimitador_cadeia(s, n, i);
+        if (i >= n || s[i] == '"') return 0;
+        if (s[i] == '\n') return i + 1 - p;
+        i++;
+    }
+}
+
+// Tamanho do casamento de CARCONST a partir do apóstrofo em 'p', ou 0
+static size_t casar_caractere(const char* s, size_t n, size_t p) {
+    if (p + 2 < n && s[p + 1] != '\'' && s[p + 1] != '\n' && s[p + 1] != '\\' && s[p + 2] == '\'') {
+        return 3;
+    }
+    if (p + 3 < n && s[p + 1] == '\\' && s[p + 2] != '\n' && s[p + 3] == '\'') {
+        return 4;
+    }
+    return 0;
+}
+
+// --- Palavras-reservadas ---
+// Hash perfeito sobre (tamanho, primeiro e último caractere) para as 14 palavras.
+
+typedef struct {
+    const char* texto;
+    int tamanho;
+    int token;
+} PalavraReservada;
+
+#define HASH_PALAVRA(s, n) (((n) + (unsigned char) (s)[0] + 15u * (unsigned char) (s)[(n) - 1]) & 31u)
+
+static const PalavraReservada g_palavras[32] = {
+    [0]  = { "se", 2, T_SE },
+    [4]  = { "retorne", 7, T_RETORNE },
+    [6]  = { "novalinha", 9, T_NOVALINHA },
+    [7]  = { "programa", 8, T_PROGRAMA },
+    [11] = { "entao", 5, T_ENTAO },
+    [12] = { "ou", 2, T_OU },
+    [14] = { "enquanto", 8, T_ENQUANTO },
+    [17] = { "e", 1, T_E },
+    [20] = { "car", 3, T_CAR },
+    [23] = { "execute", 7, T_EXECUTE },
+    [24] = { "int", 3, T_INT },
+    [25] = { "senao", 5, T_SENAO },
+    [27] = { "escreva", 7, T_ESCREVA },
+    [31] = { "leia", 4, T_LEIA },
+};
+
+static int palavra_reservada(const char* s, size_t n) {
+    if (n > 9) return 0;
+    const PalavraReservada* p = &g_palavras[HASH_PALAVRA(s, n)];
+    if (p->tamanho != (int) n) return 0;
+    for (size_t i = 0; i < n; i++) {
+        if (p->texto[i] != s[i]) return 0;
+    }
+    return p->token;
+}
+
+// --- Núcleo reentrante ---
+
+void varredor_iniciar(Varredor* v, const char* texto, size_t tamanho) {
+    v->texto = texto;
+    v->tamanho = tamanho;
+    v->limite = tamanho;
+    v->pos = 0;
+    v->linha = 1;
+}
+
+// Token de um caractere ou, se o seguinte for '=', de dois
+#define OPERADOR(simples, composto) \
+    (d == '=' ? (*tamanho = 2, (composto)) : (*tamanho = 1, (simples)))
+
+int varredor_token(Varredor* v, size_t* inicio, size_t* tamanho) {
+    const char* s = v->texto;
+    size_t n = v->tamanho;
+    size_t p = v->pos;
+    unsigned char c, d;
+    int token;
+
+    for (;;) {
+        p = pular_brancos(s, n, p, &v->linha);
+        if (p >= v->limite) {
+            v->pos = p;
+            *inicio = p;
+            *tamanho = 0;
+            return 0;
+        }
+
+        c = (unsigned char) s[p];
+        d = p + 1 < n ? (unsigned char) s[p + 1] : '\0';
+        *inicio = p;
+
+        if (c == '/' && d == '*') {
+            size_t q = fim_comentario(s, n, p + 2, &v->linha);
+            if (q == SEM_FIM) {
+                v->pos = n;
+                *tamanho = n - p;
+                return ERRO_COMENTARIO_NAO_TERMINA;
+            }
+            p = q;
+            continue;
+        }
+        break;
+    }
+
+    if (eh_inicio_id(c)) {
+        size_t fim = fim_identificador(s, n, p + 1);
+        *tamanho = fim - p;
+        token = palavra_reservada(s + p, *tamanho);
+        if (token == 0) token = T_ID;
+    } else if (eh_digito(c)) {
+        size_t fim = p + 1;
+        while (fim < n && eh_digito((unsigned char) s[fim])) fim++;
+        *tamanho = fim - p;
+        token = T_INTCONST;
+    } else {
+        *tamanho = 1;
+        switch (c) {
+            case '"':
+                if ((*tamanho = casar_cadeia(s, n, p)) > 0) {
+                    token = T_CADEIA;
+                } else if ((*tamanho = casar_cadeia_multilinha(s, n, p)) > 0) {
+                    v->linha++;
+                    token = ERRO_CADEIA_MULTILINHA;
+                } else {
+                    *tamanho = 1;
+                    token = ERRO_CARACTERE_INVALIDO;
+                }
+                break;
+            case '\'':
+                if ((*tamanho = casar_caractere(s, n, p)) > 0) {
+                    token = T_CARCONST;
+                } else {
+                    *tamanho = 1;
+                    token = ERRO_CARACTERE_INVALIDO;
+                }
+                break;
+            case '=': token = OPERADOR(T_ATRIB, T_EQ); break;
+            case '!': token = OPERADOR(T_NEG, T_NE); break;
+            case '>': token = OPERADOR(T_MAIOR, T_GE); break;
+            case '<': token = OPERADOR(T_MENOR, T_LE); break;
+            case '+': token = T_SOMA; break;
+            case '-': token = T_SUB; break;
+            case '*': token = T_MULT; break;
+            case '/': token = T_DIV; break;
+            case ',': token = T_VIRGULA; break;
+            case ';': token = T_PVIRGULA; break;
+            case '(': token = T_LPAREN; break;
+            case ')': token = T_RPAREN; break;
+            case '{': token = T_LCHAVE; break;
+            case '}': token = T_RCHAVE; break;
+            default: token = ERRO_CARACTERE_INVALIDO; break;
+        }
+    }
+
+    v->pos = p + *tamanho;
+    return token;
+}
+
+const char* mensagem_erro_lexico(int token) {
+    switch (token) {
+        case ERRO_COMENTARIO_NAO_TERMINA: return "COMENTARIO NAO TERMINA";
+        case ERRO_CARACTERE_INVALIDO: return "CARACTERE INVALIDO";
+        case ERRO_CADEIA_MULTILINHA: return "CADEIA DE CARACTERES OCUPA MAIS DE UMA LINHA";
+        default: return NULL;
+    }
+}
+
+// Equivalente a atoi() sobre a sequência de dígitos (strtol satura em LONG_MAX)
+static int valor_inteiro(const char* s, size_t n) {
+    long valor = 0;
+    for (size_t i = 0; i < n; i++) {
+        int d = s[i] - '0';
+        if (valor > (LONG_MAX - d) / 10) return (int) LONG_MAX;
+        valor = valor * 10 + d;
+    }
+    return (int) valor;
+}
+
+void valor_semantico(RepositorioAtomos* atomos, int token, const char* lexema, size_t tamanho,
+                     union YYSTYPE* valor) {
+    switch (token) {
+        case T_ID:
+            valor->str_val = internar_em(atomos, lexema, tamanho);
+            break;
+        case T_INTCONST:
+            valor->num_val = valor_inteiro(lexema, tamanho);
+            break;
+        case T_CADEIA:
+        case T_CARCONST:
+            valor->fatia_val.inicio = lexema;
+            valor->fatia_val.tamanho = (int) tamanho;
+            break;
+    }
+}
+
+// --- Adaptador para yylex() ---
+
+static int varredor_manual_proximo(CompilerContext* ctx, YYSTYPE* valor) {
+    for (;;) {
+        size_t inicio, tamanho;
+        int token = varredor_token(&ctx->manual, &inicio, &tamanho);
+        ctx->linha = ctx->manual.linha;
+        const char* erro = mensagem_erro_lexico(token);
+        if (erro != NULL) {
+            reportar_erro(ctx, erro);
+            continue;
+        }
+        valor_semantico(&ctx->atomos, token, ctx->manual.texto + inicio, tamanho, valor);
+        return token;
+    }
+}
+
+int yylex(YYSTYPE* valor, CompilerContext* ctx) {
+    switch (ctx->varredor) {
+        case VARREDOR_PRE_TOKENIZADO:
+            return tokens_proximo(ctx, valor);
+#ifndef SEM_FLEX
+        case VARREDOR_FLEX:
+            return varredor_flex_proximo(ctx, valor);
+#endif
+        default:
+            return varredor_manual_proximo(ctx, valor);
+    }
+}
+
+// --- Medição ---
+
+static unsigned long long misturar(unsigned long long h, const char* s, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char) s[i];
+        h *= 1099511628211ULL; // FNV-1a
+    }
+    return h;
+}
+
+void medir_varredor(CompilerContext* ctx, FILE* relatorio) {
+    struct timespec inicio, fim;
+    unsigned long long soma = 14695981039346656037ULL;
+    size_t tamanho_fonte = ctx->fonte.tamanho;
+    long tokens = 0;
+    YYSTYPE yylval;
+    int token;
+
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    while ((token = yylex(&yylval, ctx)) != 0) {
+        int dados[2] = { token, ctx->linha };
+        soma = misturar(soma, (const char*) dados, sizeof(dados));
+        switch (token) {
+            case T_ID:
+                soma = misturar(soma, yylval.str_val.texto, tamanho_atomo(yylval.str_val));
+                break;
+            case T_CADEIA:
+            case T_CARCONST:
+                soma = misturar(soma, yylval.fatia_val.inicio, (size_t) yylval.fatia_val.tamanho);
+                break;
+            case T_INTCONST:
+                soma = misturar(soma, (const char*) &yylval.num_val, sizeof(yylval.num_val));
+                break;
+        }
+        tokens++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+
+    double segundos = (double) (fim.tv_sec - inicio.tv_sec) + (double) (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+    static const char* nomes[] = { "flex", "manual", "pre-tokenizado" };
+    fprintf(relatorio, "varredor: %s\n", nomes[ctx->varredor]);
+    fprintf(relatorio, "bytes: %zu\n", tamanho_fonte);
+    fprintf(relatorio, "tokens: %ld\n", tokens);
+    fprintf(relatorio, "linhas: %d\n", ctx->linha);
+    fprintf(relatorio, "tempo: %.6f s\n", segundos);
+    fprintf(relatorio, "vazao: %.1f MB/s\n", segundos > 0 ? (double) tamanho_fonte / segundos / 1e6 : 0.0);
+    fprintf(relatorio, "verificacao: %016llx\n", soma);
+}
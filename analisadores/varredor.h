@@ -0,0 +1,91 @@
+#ifndef VARREDOR_H
+#define VARREDOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "atomos.h"
+
+/*
+ * Seleção do analisador léxico usado por yylex() (campo 'varredor' do
+ * CompilerContext).
+ *
+ * VARREDOR_FLEX é o scanner gerado a partir de goianinha.l. VARREDOR_MANUAL é
+ * um scanner escrito à mão (varredor.c) que percorre o texto inteiro em memória
+ * e usa SSE2, quando disponível, para pular espaços, comentários, cadeias e
+ * identificadores 16 bytes por vez. Ambos produzem a mesma sequência de tokens,
+ * os mesmos valores semânticos e as mesmas mensagens de erro léxico.
+ *
+ * VARREDOR_PRE_TOKENIZADO usa o mesmo scanner manual, mas o arquivo inteiro é
+ * tokenizado antes da análise sintática (ver tokens.h) e yylex() apenas lê o
+ * buffer de tokens.
+ *
+ * Compilado com SEM_FLEX (make SEM_FLEX=1), o scanner do Flex não existe.
+ */
+typedef enum {
+    VARREDOR_FLEX,
+    VARREDOR_MANUAL,
+    VARREDOR_PRE_TOKENIZADO
+} TipoVarredor;
+
+/*
+ * Erros léxicos, devolvidos por varredor_token() no lugar de um token. Ficam
+ * acima dos códigos de token do Bison (até 293) e abaixo de 512, de modo que
+ * 'código - 256' cabe em um byte.
+ */
+#define ERRO_COMENTARIO_NAO_TERMINA 0x1F0
+#define ERRO_CARACTERE_INVALIDO     0x1F1
+#define ERRO_CADEIA_MULTILINHA      0x1F2
+
+/*
+ * Estado do scanner manual. Não usa variáveis globais: vários varredores
+ * podem percorrer trechos do mesmo texto ao mesmo tempo.
+ */
+typedef struct {
+    const char* texto;
+    size_t tamanho;
+    size_t limite;  /* Tokens que começariam a partir daqui não são lidos */
+    size_t pos;
+    int linha;
+} Varredor;
+
+/* Varredor sobre todo o texto, a partir da linha 1 */
+void varredor_iniciar(Varredor* v, const char* texto, size_t tamanho);
+
+/*
+ * Próximo token a partir de v->pos: devolve o código do token (0 ao atingir
+ * v->limite) ou um ERRO_*, e a posição e o tamanho do lexema no texto. Depois
+ * da chamada, v->linha é o valor que yylineno teria no Flex. Não interna nem
+ * imprime nada.
+ */
+int varredor_token(Varredor* v, size_t* inicio, size_t* tamanho);
+
+/* Mensagem de um ERRO_*, ou NULL se 'token' não for um erro */
+const char* mensagem_erro_lexico(int token);
+
+/* Preenche o valor semântico (yylval) de um token a partir do lexema; IDs são
+ * internados em 'atomos' */
+union YYSTYPE;
+void valor_semantico(RepositorioAtomos* atomos, int token, const char* lexema, size_t tamanho,
+                     union YYSTYPE* valor);
+
+/*
+ * yylex() do parser reentrante: próximo token da compilação 'ctx', lido pelo
+ * backend escolhido em ctx->varredor. Atualiza ctx->linha e escreve os erros
+ * léxicos em ctx->diagnosticos.
+ */
+struct CompilerContext;
+int yylex(union YYSTYPE* valor, struct CompilerContext* ctx);
+
+/* Backend do Flex (goianinha.l): scanner reentrante sobre ctx->fonte */
+int varredor_flex_iniciar(struct CompilerContext* ctx);
+int varredor_flex_proximo(struct CompilerContext* ctx, union YYSTYPE* valor);
+void varredor_flex_finalizar(struct CompilerContext* ctx);
+
+/*
+ * Consome todos os tokens via yylex() e imprime em 'relatorio' a contagem,
+ * o tempo, a vazão em MB/s e uma soma de verificação da sequência de tokens
+ * (tipo, linha e lexema), que deve coincidir entre os dois scanners.
+ */
+void medir_varredor(struct CompilerContext* ctx, FILE* relatorio);
+
+#endif
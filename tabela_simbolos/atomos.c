@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "atomos.h"
+#include "regiao.h"
+
+#define CAPACIDADE_INICIAL_ATOMOS 256
+
+// Cabeçalho armazenado imediatamente antes do texto de cada átomo
+typedef struct {
+    unsigned int hash;
+    unsigned int tamanho;
+} CabecalhoAtomo;
+
+#define CABECALHO(atomo) ((CabecalhoAtomo*) ((atomo).texto - sizeof(CabecalhoAtomo)))
+
+// Repositório usado pelas funções sem repositório explícito
+static RepositorioAtomos g_repositorio = REPOSITORIO_ATOMOS_VAZIO;
+
+// Hash FNV-1a de um trecho de memória
+static unsigned int hash_texto(const char* texto, size_t tamanho) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++) {
+        h ^= (unsigned char) texto[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void redimensionar_repositorio(RepositorioAtomos* repo) {
+    unsigned int capacidade_antiga = repo->capacidade;
+    Atomo* antigos = repo->atomos;
+
+    repo->capacidade = capacidade_antiga ? capacidade_antiga * 2 : CAPACIDADE_INICIAL_ATOMOS;
+    repo->atomos = (Atomo*) calloc(repo->capacidade, sizeof(Atomo));
+    if (!repo->atomos) {
+        perror("Falha ao alocar memória para o repositório de átomos");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int mascara = repo->capacidade - 1;
+    for (unsigned int k = 0; k < capacidade_antiga; k++) {
+        if (antigos[k].texto == NULL) continue;
+        unsigned int i = CABECALHO(antigos[k])->hash & mascara;
+        while (repo->atomos[i].texto != NULL) {
+            i = (i + 1) & mascara;
+        }
+        repo->atomos[i] = antigos[k];
+    }
+    free(antigos);
+}
+
+Atomo internar_em(RepositorioAtomos* repo, const char* texto, size_t tamanho) {
+    if (2 * (repo->ocupadas + 1) > repo->capacidade) {
+        redimensionar_repositorio(repo);
+    }
+
+    unsigned int hash = hash_texto(texto, tamanho);
+    unsigned int mascara = repo->capacidade - 1;
+    unsigned int i = hash & mascara;
+
+    while (repo->atomos[i].texto != NULL) {
+        CabecalhoAtomo* cab = CABECALHO(repo->atomos[i]);
+        if (cab->hash == hash && cab->tamanho == tamanho &&
+            memcmp(repo->atomos[i].texto, texto, tamanho) == 0) {
+            repo->acertos++;
+            return repo->atomos[i];
+        }
+        i = (i + 1) & mascara;
+    }
+
+    // Primeira ocorrência: armazena cabeçalho e texto num único bloco
+    size_t bytes = sizeof(CabecalhoAtomo) + tamanho + 1;
+    CabecalhoAtomo* cab = (CabecalhoAtomo*) regiao_alocar(&repo->regiao, bytes);
+    cab->hash = hash;
+    cab->tamanho = (unsigned int) tamanho;
+    char* destino = (char*) (cab + 1);
+    memcpy(destino, texto, tamanho);
+    destino[tamanho] = '\0';
+
+    repo->atomos[i].texto = destino;
+    repo->ocupadas++;
+    repo->faltas++;
+    repo->bytes += bytes;
+    return repo->atomos[i];
+}
+
+Atomo internar_n(const char* texto, size_t tamanho) {
+    return internar_em(&g_repositorio, texto, tamanho);
+}
+
+Atomo internar(const char* texto) {
+    return internar_em(&g_repositorio, texto, strlen(texto));
+}
+
+unsigned int hash_atomo(Atomo atomo) {
+    return CABECALHO(atomo)->hash;
+}
+
+size_t tamanho_atomo(Atomo atomo) {
+    return CABECALHO(atomo)->tamanho;
+}
+
+void imprimir_estatisticas_repositorio(FILE* saida, const RepositorioAtomos* repo) {
+    unsigned long total = repo->acertos + repo->faltas;
+    fprintf(saida, "--- Estatisticas de Atomos ---\n");
+    fprintf(saida, "  Internacoes: %lu (acertos: %lu, faltas: %lu, taxa de acerto: %.1f%%)\n",
+            total, repo->acertos, repo->faltas, total ? 100.0 * repo->acertos / total : 0.0);
+    fprintf(saida, "  Atomos distintos: %u | Bytes armazenados: %lu | Capacidade da tabela: %u\n",
+            repo->ocupadas, repo->bytes, repo->capacidade);
+}
+
+void imprimir_estatisticas_atomos(FILE* saida) {
+    imprimir_estatisticas_repositorio(saida, &g_repositorio);
+}
+
+void liberar_repositorio(RepositorioAtomos* repo) {
+    regiao_limpar(&repo->regiao);
+    free(repo->atomos);
+    RepositorioAtomos vazio = REPOSITORIO_ATOMOS_VAZIO;
+    *repo = vazio;
+}
+
+void liberar_atomos(void) {
+    liberar_repositorio(&g_repositorio);
+}
@@ -0,0 +1,109 @@
+#ifndef ATOMOS_H
+#define ATOMOS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "regiao.h"
+
+/*
+ * Átomo: representação única e estável de um lexema.
+ *
+ * Cada texto distinto é armazenado uma única vez no repositório de átomos;
+ * duas ocorrências do mesmo texto produzem o mesmo átomo. Por isso, átomos
+ * são comparados por identidade (MESMO_ATOMO) e nunca liberados
+ * individualmente.
+ *
+ * O texto fica logo depois de um cabeçalho com o hash e o tamanho, que
+ * hash_atomo() e tamanho_atomo() leem antes do ponteiro. Um 'const char*'
+ * qualquer nesse lugar faria a leitura cair fora do buffer; por isso Atomo é
+ * um tipo próprio, que só internar*() e AST_ATOMO (ast.h) produzem, e não
+ * uma string: um texto não internado não passa por engano.
+ */
+typedef struct {
+    const char* texto;  /* Terminado em '\0'; válido até liberar o repositório */
+} Atomo;
+
+#define ATOMO_NULO ((Atomo) { NULL })
+#define MESMO_ATOMO(a, b) ((a).texto == (b).texto)
+
+/*
+ * Repositório de átomos: tabela hash com endereçamento aberto e a região onde
+ * os textos são armazenados. Átomos de repositórios diferentes não são
+ * comparáveis entre si. Cada repositório deve ser usado por uma thread por vez;
+ * as funções sem repositório explícito usam um repositório padrão do processo.
+ */
+typedef struct {
+    Atomo* atomos;
+    unsigned int capacidade;
+    unsigned int ocupadas;
+    Regiao regiao;
+
+    // Estatísticas
+    unsigned long acertos;
+    unsigned long faltas;
+    unsigned long bytes;
+} RepositorioAtomos;
+
+#define REPOSITORIO_ATOMOS_VAZIO { NULL, 0, 0, REGIAO_VAZIA, 0, 0, 0 }
+
+/**
+ * @brief Obtém o átomo correspondente a uma string terminada em '\0'.
+ *
+ * @param texto O texto a ser internado.
+ * @return O átomo (texto estável) associado ao texto.
+ */
+Atomo internar(const char* texto);
+
+/**
+ * @brief Obtém o átomo correspondente aos 'tamanho' primeiros bytes de 'texto'.
+ *
+ * O texto não precisa ser terminado em '\0' (ex: yytext antes da cópia).
+ *
+ * @param texto Início do texto.
+ * @param tamanho Número de bytes do texto.
+ * @return O átomo associado ao texto.
+ */
+Atomo internar_n(const char* texto, size_t tamanho);
+
+/**
+ * @brief Retorna o hash do átomo, calculado uma única vez na internação.
+ *
+ * @param atomo Um átomo obtido por internar()/internar_n().
+ */
+unsigned int hash_atomo(Atomo atomo);
+
+/**
+ * @brief Retorna o comprimento do átomo em bytes, sem percorrê-lo.
+ *
+ * @param atomo Um átomo obtido por internar()/internar_n().
+ */
+size_t tamanho_atomo(Atomo atomo);
+
+/**
+ * @brief Imprime estatísticas do repositório (acertos, faltas, bytes).
+ *
+ * @param saida Arquivo onde as estatísticas serão escritas.
+ */
+void imprimir_estatisticas_atomos(FILE* saida);
+
+/**
+ * @brief Libera todos os átomos. Átomos obtidos anteriormente tornam-se inválidos.
+ */
+void liberar_atomos(void);
+
+/**
+ * @brief Como internar_n(), mas no repositório 'repo'.
+ */
+Atomo internar_em(RepositorioAtomos* repo, const char* texto, size_t tamanho);
+
+/**
+ * @brief Como imprimir_estatisticas_atomos(), para o repositório 'repo'.
+ */
+void imprimir_estatisticas_repositorio(FILE* saida, const RepositorioAtomos* repo);
+
+/**
+ * @brief Libera os átomos de 'repo', que volta ao estado REPOSITORIO_ATOMOS_VAZIO.
+ */
+void liberar_repositorio(RepositorioAtomos* repo);
+
+#endif // ATOMOS_H
@@ -3,7 +3,7 @@
 
 void testar_pesquisa(ScopeStack* pilha, const char* nome) {
     printf("Pesquisando por '%s': ", nome);
-    Symbol* s = pesquisar_simbolo(pilha, nome);
+    Symbol* s = pesquisar_simbolo(pilha, internar(nome));
     if (s) {
         printf("Encontrado! Categoria: %s\n", s->categoria == CAT_VARIAVEL ? "Variavel" : (s->categoria == CAT_PARAMETRO ? "Parametro" : "Funcao"));
     } else {
@@ -21,14 +21,14 @@ int main() {
 
     // Inserindo variável global
     printf("Inserindo variável global 'g_var' (tipo int, ordem 1).\n");
-    inserir_variavel(minha_pilha, "g_var", TIPO_INT, 1);
+    inserir_variavel(minha_pilha, internar("g_var"), TIPO_INT, 1);
     
     // e) Inserindo uma função no escopo global
     printf("Inserindo função 'soma' (retorno int, 2 args) no escopo global.\n");
-    Symbol* func_soma = inserir_funcao(minha_pilha, "soma", TIPO_INT, 2);
+    Symbol* func_soma = inserir_funcao(minha_pilha, internar("soma"), TIPO_INT, 2);
     // Adicionando info dos parâmetros para a função
-    adicionar_info_parametro(func_soma, "a", TIPO_INT);
-    adicionar_info_parametro(func_soma, "b", TIPO_INT);
+    adicionar_info_parametro(func_soma, internar("a"), TIPO_INT);
+    adicionar_info_parametro(func_soma, internar("b"), TIPO_INT);
 
     imprimir_pilha(minha_pilha);
 
@@ -39,12 +39,12 @@ int main() {
 
     // g) Inserindo os parâmetros no escopo da função
     printf("Inserindo parâmetros 'a' (int, 1) e 'b' (int, 2) no novo escopo.\n");
-    inserir_parametro(minha_pilha, "a", TIPO_INT, 1);
-    inserir_parametro(minha_pilha, "b", TIPO_INT, 2);
+    inserir_parametro(minha_pilha, internar("a"), TIPO_INT, 1);
+    inserir_parametro(minha_pilha, internar("b"), TIPO_INT, 2);
 
     // f) Inserindo uma variável local
     printf("Inserindo variável local 'resultado' (int, 1) no escopo da função.\n");
-    inserir_variavel(minha_pilha, "resultado", TIPO_INT, 1);
+    inserir_variavel(minha_pilha, internar("resultado"), TIPO_INT, 1);
     imprimir_pilha(minha_pilha);
 
     // c) Testando a pesquisa de símbolos
@@ -56,11 +56,11 @@ int main() {
     printf("\nEntrando em um bloco aninhado (ex: dentro de um 'se'). Criando novo escopo.\n");
     criar_novo_escopo(minha_pilha);
     printf("Inserindo variável 'g_var' (tipo car, ordem 1) neste escopo (shadowing).\n");
-    inserir_variavel(minha_pilha, "g_var", TIPO_CAR, 1);
+    inserir_variavel(minha_pilha, internar("g_var"), TIPO_CAR, 1);
     imprimir_pilha(minha_pilha);
 
     printf("Pesquisando por 'g_var' no escopo mais interno...\n");
-    Symbol* s_gvar = pesquisar_simbolo(minha_pilha, "g_var");
+    Symbol* s_gvar = pesquisar_simbolo(minha_pilha, internar("g_var"));
     if (s_gvar) {
         printf("Encontrado! Tipo: %s. (Corretamente encontrou a variável local)\n", s_gvar->tipo == TIPO_CAR ? "car" : "int");
     }
@@ -71,7 +71,7 @@ int main() {
     imprimir_pilha(minha_pilha);
 
     printf("Pesquisando por 'g_var' novamente...\n");
-    s_gvar = pesquisar_simbolo(minha_pilha, "g_var");
+    s_gvar = pesquisar_simbolo(minha_pilha, internar("g_var"));
      if (s_gvar) {
         printf("Encontrado! Tipo: %s. (Corretamente encontrou a variável global)\n", s_gvar->tipo == TIPO_CAR ? "car" : "int");
     }
@@ -85,5 +85,9 @@ int main() {
     eliminar_pilha_tabelas(minha_pilha);
     printf("Pilha eliminada.\n");
 
+    imprimir_estatisticas_atomos(stdout);
+    liberar_atomos();
+    regiao_liberar_cache();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "regiao.h"
+
+// Tamanho dos blocos comuns; pedidos maiores recebem um bloco exclusivo
+#define TAMANHO_BLOCO_PADRAO (16 * 1024)
+#define ALINHAMENTO 8
+
+// Blocos de tamanho padrão devolvidos por regiões esvaziadas. O cache (e as
+// estatísticas) são compartilhados por todas as threads, sob g_trava; só a
+// fase atual é de cada thread.
+static BlocoRegiao* g_blocos_livres = NULL;
+static pthread_mutex_t g_trava = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef REGIAO_ESTATISTICAS
+#define MAX_FASES 16
+
+typedef struct {
+    const char* nome;
+    unsigned long bytes;
+    unsigned long alocacoes;
+    unsigned long blocos;
+} EstatisticaFase;
+
+static EstatisticaFase g_fases[MAX_FASES];
+static int g_num_fases = 0;
+static _Thread_local int g_fase_atual = -1;
+
+// As duas funções abaixo são chamadas com g_trava adquirida
+static void definir_fase_travada(const char* fase) {
+    for (int i = 0; i < g_num_fases; i++) {
+        if (strcmp(g_fases[i].nome, fase) == 0) {
+            g_fase_atual = i;
+            return;
+        }
+    }
+    if (g_num_fases < MAX_FASES) {
+        g_fases[g_num_fases].nome = fase;
+        g_fase_atual = g_num_fases++;
+    }
+}
+
+static EstatisticaFase* fase_atual() {
+    if (g_fase_atual < 0) definir_fase_travada("inicial");
+    return &g_fases[g_fase_atual];
+}
+#endif
+
+void regiao_definir_fase(const char* fase) {
+#ifdef REGIAO_ESTATISTICAS
+    pthread_mutex_lock(&g_trava);
+    definir_fase_travada(fase);
+    pthread_mutex_unlock(&g_trava);
+#else
+    (void) fase;
+#endif
+}
+
+void regiao_imprimir_estatisticas(FILE* saida) {
+#ifdef REGIAO_ESTATISTICAS
+    unsigned long total = 0;
+    pthread_mutex_lock(&g_trava);
+    fprintf(saida, "--- Memoria Alocada por Fase ---\n");
+    for (int i = 0; i < g_num_fases; i++) {
+        fprintf(saida, "  %-12s %10lu bytes em %8lu alocacoes (%lu blocos novos)\n",
+                g_fases[i].nome, g_fases[i].bytes, g_fases[i].alocacoes, g_fases[i].blocos);
+        total += g_fases[i].bytes;
+    }
+    fprintf(saida, "  %-12s %10lu bytes\n", "total", total);
+    pthread_mutex_unlock(&g_trava);
+#else
+    (void) saida;
+#endif
+}
+
+void regiao_iniciar(Regiao* regiao) {
+    regiao->atual = NULL;
+}
+
+static BlocoRegiao* novo_bloco(size_t minimo) {
+    BlocoRegiao* bloco = NULL;
+    if (minimo <= TAMANHO_BLOCO_PADRAO) {
+        pthread_mutex_lock(&g_trava);
+        bloco = g_blocos_livres;
+        if (bloco != NULL) g_blocos_livres = bloco->anterior;
+        pthread_mutex_unlock(&g_trava);
+    }
+    if (bloco == NULL) {
+        size_t tamanho = minimo > TAMANHO_BLOCO_PADRAO ? minimo : TAMANHO_BLOCO_PADRAO;
+        bloco = (BlocoRegiao*) malloc(sizeof(BlocoRegiao) + tamanho);
+        if (!bloco) {
+            perror("Falha ao alocar memória para bloco de região");
+            exit(EXIT_FAILURE);
+        }
+        bloco->tamanho = tamanho;
+#ifdef REGIAO_ESTATISTICAS
+        pthread_mutex_lock(&g_trava);
+        fase_atual()->blocos++;
+        pthread_mutex_unlock(&g_trava);
+#endif
+    }
+    bloco->usado = 0;
+    bloco->anterior = NULL;
+    return bloco;
+}
+
+void* regiao_alocar(Regiao* regiao, size_t tamanho) {
+    tamanho = (tamanho + ALINHAMENTO - 1) & ~(size_t) (ALINHAMENTO - 1);
+
+    BlocoRegiao* bloco = regiao->atual;
+    if (bloco == NULL || bloco->tamanho - bloco->usado < tamanho) {
+        BlocoRegiao* novo = novo_bloco(tamanho);
+        novo->anterior = bloco;
+        regiao->atual = novo;
+        bloco = novo;
+    }
+
+    void* ptr = bloco->dados + bloco->usado;
+    bloco->usado += tamanho;
+#ifdef REGIAO_ESTATISTICAS
+    pthread_mutex_lock(&g_trava);
+    fase_atual()->bytes += tamanho;
+    fase_atual()->alocacoes++;
+    pthread_mutex_unlock(&g_trava);
+#endif
+    return ptr;
+}
+
+char* regiao_strdup(Regiao* regiao, const char* texto) {
+    size_t tamanho = strlen(texto) + 1;
+    char* copia = (char*) regiao_alocar(regiao, tamanho);
+    memcpy(copia, texto, tamanho);
+    return copia;
+}
+
+void regiao_limpar(Regiao* regiao) {
+    // Encadeia os blocos padrão localmente e os devolve ao cache de uma vez
+    BlocoRegiao* primeiro = NULL;
+    BlocoRegiao* ultimo = NULL;
+    BlocoRegiao* bloco = regiao->atual;
+    while (bloco) {
+        BlocoRegiao* anterior = bloco->anterior;
+        if (bloco->tamanho == TAMANHO_BLOCO_PADRAO) {
+            bloco->anterior = primeiro;
+            primeiro = bloco;
+            if (ultimo == NULL) ultimo = bloco;
+        } else {
+            free(bloco);
+        }
+        bloco = anterior;
+    }
+    regiao->atual = NULL;
+
+    if (primeiro != NULL) {
+        pthread_mutex_lock(&g_trava);
+        ultimo->anterior = g_blocos_livres;
+        g_blocos_livres = primeiro;
+        pthread_mutex_unlock(&g_trava);
+    }
+}
+
+void regiao_liberar_cache(void) {
+    pthread_mutex_lock(&g_trava);
+    BlocoRegiao* bloco = g_blocos_livres;
+    g_blocos_livres = NULL;
+    pthread_mutex_unlock(&g_trava);
+
+    while (bloco) {
+        BlocoRegiao* anterior = bloco->anterior;
+        free(bloco);
+        bloco = anterior;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef REGIAO_H
+#define REGIAO_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/*
+ * Região (arena) de memória com alocação por avanço de ponteiro.
+ *
+ * Os objetos alocados numa região não são liberados individualmente: toda a
+ * região é esvaziada de uma só vez com regiao_limpar()/regiao_liberar().
+ * Os blocos de tamanho padrão são reaproveitados entre regiões, de modo que
+ * criar e esvaziar regiões repetidamente (ex: a cada escopo) não chama malloc.
+ *
+ * Compilando com -DREGIAO_ESTATISTICAS, os bytes alocados são contabilizados
+ * por fase da compilação (ver regiao_definir_fase()). A fase atual é de cada
+ * thread, então compilações em threads diferentes não trocam as fases umas
+ * das outras; os totais de cada fase somam todas as threads.
+ *
+ * Uma região pertence a uma única thread por vez; o cache de blocos e as
+ * estatísticas são compartilhados e protegidos internamente.
+ */
+
+typedef struct BlocoRegiao {
+    struct BlocoRegiao* anterior; // Bloco preenchido anteriormente na mesma região
+    size_t tamanho;               // Capacidade de 'dados' em bytes
+    size_t usado;                 // Bytes já entregues deste bloco
+    char dados[];
+} BlocoRegiao;
+
+typedef struct Regiao {
+    BlocoRegiao* atual;           // Bloco onde ocorre a próxima alocação
+} Regiao;
+
+#define REGIAO_VAZIA { NULL }
+
+/**
+ * @brief Prepara uma região vazia.
+ */
+void regiao_iniciar(Regiao* regiao);
+
+/**
+ * @brief Aloca 'tamanho' bytes alinhados na região. Nunca retorna NULL.
+ */
+void* regiao_alocar(Regiao* regiao, size_t tamanho);
+
+/**
+ * @brief Copia uma string para dentro da região.
+ */
+char* regiao_strdup(Regiao* regiao, const char* texto);
+
+/**
+ * @brief Esvazia a região, devolvendo todos os seus blocos de uma só vez.
+ *
+ * A região continua utilizável após a chamada.
+ */
+void regiao_limpar(Regiao* regiao);
+
+/**
+ * @brief Libera os blocos mantidos em cache para reaproveitamento.
+ */
+void regiao_liberar_cache(void);
+
+/**
+ * @brief Define a fase da compilação à qual as próximas alocações da thread
+ * que chama serão atribuídas nas estatísticas. Sem efeito se
+ * REGIAO_ESTATISTICAS não estiver definido.
+ */
+void regiao_definir_fase(const char* fase);
+
+/**
+ * @brief Imprime os bytes alocados por fase (apenas com REGIAO_ESTATISTICAS).
+ */
+void regiao_imprimir_estatisticas(FILE* saida);
+
+#define regiao_novo(regiao, tipo) ((tipo*) regiao_alocar((regiao), sizeof(tipo)))
+
+#endif // REGIAO_H
@@ -3,11 +3,86 @@
 #include <string.h>
 #include "tabela_simbolos.h"
 
+#define CAPACIDADE_INICIAL 64
+
+// Localiza a entrada do nome na tabela hash. Retorna a entrada ocupada pelo
+// nome ou, se ele ainda não existir, a entrada livre onde deveria ser inserido.
+static EntradaNome* localizar_entrada(ScopeStack* pilha, Atomo nome) {
+    unsigned int mascara = (unsigned int) pilha->capacidade - 1;
+    unsigned int i = hash_atomo(nome) & mascara;
+    while (pilha->entradas[i].nome.texto != NULL) {
+        if (MESMO_ATOMO(pilha->entradas[i].nome, nome)) {
+            return &pilha->entradas[i];
+        }
+        i = (i + 1) & mascara;
+    }
+    return &pilha->entradas[i];
+}
+
+// Dobra a capacidade da tabela hash, reposicionando as entradas existentes
+static void redimensionar_tabela(ScopeStack* pilha) {
+    EntradaNome* antigas = pilha->entradas;
+    int capacidade_antiga = pilha->capacidade;
+
+    pilha->capacidade *= 2;
+    pilha->entradas = (EntradaNome*) calloc(pilha->capacidade, sizeof(EntradaNome));
+    if (!pilha->entradas) {
+        perror("Falha ao alocar memória para a tabela de nomes");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int mascara = (unsigned int) pilha->capacidade - 1;
+    for (int k = 0; k < capacidade_antiga; k++) {
+        if (antigas[k].nome.texto == NULL) continue;
+        unsigned int i = hash_atomo(antigas[k].nome) & mascara;
+        while (pilha->entradas[i].nome.texto != NULL) {
+            i = (i + 1) & mascara;
+        }
+        pilha->entradas[i] = antigas[k];
+    }
+    free(antigas);
+}
+
+// Obtém a entrada do nome, criando-a caso ainda não exista
+static EntradaNome* obter_entrada(ScopeStack* pilha, Atomo nome) {
+    EntradaNome* entrada = localizar_entrada(pilha, nome);
+    if (entrada->nome.texto != NULL) return entrada;
+
+    // Mantém o fator de carga abaixo de 1/2
+    if (2 * (pilha->ocupadas + 1) > pilha->capacidade) {
+        redimensionar_tabela(pilha);
+        entrada = localizar_entrada(pilha, nome);
+    }
+
+    entrada->nome = nome;
+    entrada->visivel = NULL;
+    entrada->global = NULL;
+    pilha->ocupadas++;
+    return entrada;
+}
+
+// Busca a entrada do nome sem criá-la. Retorna NULL se o nome nunca foi declarado.
+static EntradaNome* buscar_entrada(ScopeStack* pilha, Atomo nome) {
+    if (!pilha || !pilha->entradas || !nome.texto) return NULL;
+    EntradaNome* entrada = localizar_entrada(pilha, nome);
+    return entrada->nome.texto != NULL ? entrada : NULL;
+}
+
 // a - Iniciar a pilha de tabela de símbolos
 ScopeStack* iniciar_pilha_tabela_simbolos() {
     ScopeStack* pilha = (ScopeStack*) malloc(sizeof(ScopeStack));
-    if (pilha) {
-        pilha->topo = NULL;
+    if (!pilha) {
+        perror("Falha ao alocar memória para a pilha de escopos");
+        exit(EXIT_FAILURE);
+    }
+    pilha->topo = NULL;
+    pilha->livres = NULL;
+    pilha->capacidade = CAPACIDADE_INICIAL;
+    pilha->ocupadas = 0;
+    pilha->entradas = (EntradaNome*) calloc(pilha->capacidade, sizeof(EntradaNome));
+    if (!pilha->entradas) {
+        perror("Falha ao alocar memória para a tabela de nomes");
+        exit(EXIT_FAILURE);
     }
     // Cria o escopo global inicial
     criar_novo_escopo(pilha);
@@ -16,12 +91,19 @@ ScopeStack* iniciar_pilha_tabela_simbolos() {
 
 // b - Criar uma nova tabela de símbolos (novo escopo) e empilhá-la
 void criar_novo_escopo(ScopeStack* pilha) {
-    SymbolTable* novo_escopo = (SymbolTable*) malloc(sizeof(SymbolTable));
-    if (!novo_escopo) {
-        perror("Falha ao alocar memória para novo escopo");
-        exit(EXIT_FAILURE);
+    SymbolTable* novo_escopo = pilha->livres;
+    if (novo_escopo) {
+        pilha->livres = novo_escopo->proximo;
+    } else {
+        novo_escopo = (SymbolTable*) malloc(sizeof(SymbolTable));
+        if (!novo_escopo) {
+            perror("Falha ao alocar memória para novo escopo");
+            exit(EXIT_FAILURE);
+        }
     }
     novo_escopo->head = NULL;
+    regiao_iniciar(&novo_escopo->regiao);
+    novo_escopo->nivel = pilha->topo ? pilha->topo->nivel + 1 : 0;
     novo_escopo->proximo = pilha->topo;
     pilha->topo = novo_escopo;
 }
@@ -33,107 +115,98 @@ void remover_escopo_atual(ScopeStack* pilha) {
     SymbolTable* escopo_a_remover = pilha->topo;
     pilha->topo = escopo_a_remover->proximo;
 
-    // Liberar todos os símbolos do escopo removido
-    Symbol* atual = escopo_a_remover->head;
-    while (atual) {
-        Symbol* proximo = atual->proximo;
-        free(atual->nome);
-        // Se for função, liberar a lista de parâmetros
-        if (atual->categoria == CAT_FUNCAO) {
-            ParametroInfo* param_atual = atual->params_info;
-            while (param_atual) {
-                ParametroInfo* proximo_param = param_atual->proximo;
-                free(param_atual->nome);
-                free(param_atual);
-                param_atual = proximo_param;
+    // Desliga da tabela hash os símbolos do escopo removido
+    for (Symbol* atual = escopo_a_remover->head; atual; atual = atual->proximo) {
+        EntradaNome* entrada = buscar_entrada(pilha, atual->nome);
+        if (entrada) {
+            // Reexpõe a declaração que este símbolo ocultava
+            entrada->visivel = atual->sombra;
+            if (entrada->global == atual) {
+                entrada->global = NULL;
             }
         }
-        free(atual);
-        atual = proximo;
     }
-    free(escopo_a_remover);
+
+    // Símbolos e listas de parâmetros são liberados juntos com a região
+    regiao_limpar(&escopo_a_remover->regiao);
+    escopo_a_remover->proximo = pilha->livres;
+    pilha->livres = escopo_a_remover;
 }
 
-// Função auxiliar para criar um símbolo genérico
-static Symbol* criar_simbolo(const char* nome, Categoria cat, Tipo tipo, int ordem) {
-    Symbol* novo_simbolo = (Symbol*) malloc(sizeof(Symbol));
-    if (!novo_simbolo) return NULL;
-    
-    novo_simbolo->nome = strdup(nome);
-    if (!novo_simbolo->nome) {
-        free(novo_simbolo);
-        return NULL;
-    }
-    
+// Função auxiliar para criar um símbolo genérico na região do escopo
+static Symbol* criar_simbolo(SymbolTable* escopo, Atomo nome, Categoria cat, Tipo tipo, int ordem) {
+    Symbol* novo_simbolo = regiao_novo(&escopo->regiao, Symbol);
+
+    novo_simbolo->nome = nome;
     novo_simbolo->categoria = cat;
     novo_simbolo->tipo = tipo;
     novo_simbolo->ordem = ordem;
     novo_simbolo->num_args = 0;
     novo_simbolo->params_info = NULL;
+    novo_simbolo->nivel = 0;
+    novo_simbolo->sombra = NULL;
+    novo_simbolo->regiao = &escopo->regiao;
     novo_simbolo->proximo = NULL;
-    
+
     return novo_simbolo;
 }
 
 // Função auxiliar para inserir um símbolo no escopo atual
-static Symbol* inserir_no_escopo_atual(ScopeStack* pilha, Symbol* novo_simbolo) {
-    if (!pilha || !pilha->topo) {
-        free(novo_simbolo->nome);
-        free(novo_simbolo);
+static Symbol* inserir_no_escopo_atual(ScopeStack* pilha, Atomo nome, Categoria cat, Tipo tipo, int ordem) {
+    if (!pilha || !pilha->topo) return NULL;
+
+    EntradaNome* entrada = obter_entrada(pilha, nome);
+
+    // Verifica se o símbolo já existe no escopo atual: a declaração visível
+    // mais interna é a única que pode pertencer ao escopo do topo
+    if (entrada->visivel && entrada->visivel->nivel == pilha->topo->nivel) {
         return NULL;
     }
-    
-    // Verifica se o símbolo já existe no escopo atual
-    Symbol* atual = pilha->topo->head;
-    while(atual) {
-        if (strcmp(atual->nome, novo_simbolo->nome) == 0) {
-            // Símbolo já existe neste escopo
-            free(novo_simbolo->nome);
-            free(novo_simbolo);
-            return NULL; 
-        }
-        atual = atual->proximo;
+
+    Symbol* novo_simbolo = criar_simbolo(pilha->topo, entrada->nome, cat, tipo, ordem);
+
+    // Oculta a declaração externa de mesmo nome, se houver
+    novo_simbolo->nivel = pilha->topo->nivel;
+    novo_simbolo->sombra = entrada->visivel;
+    entrada->visivel = novo_simbolo;
+    if (novo_simbolo->nivel == 0) {
+        entrada->global = novo_simbolo;
     }
-    
-    // Insere no início da lista
+
+    // Insere no início da lista do escopo
     novo_simbolo->proximo = pilha->topo->head;
     pilha->topo->head = novo_simbolo;
-    
+
     return novo_simbolo;
 }
 
 // f - Inserir um nome de variável na tabela de símbolos atual
-Symbol* inserir_variavel(ScopeStack* pilha, const char* nome, Tipo tipo, int ordem) {
-    Symbol* novo_simbolo = criar_simbolo(nome, CAT_VARIAVEL, tipo, ordem);
-    if (!novo_simbolo) return NULL;
-    return inserir_no_escopo_atual(pilha, novo_simbolo);
+Symbol* inserir_variavel(ScopeStack* pilha, Atomo nome, Tipo tipo, int ordem) {
+    return inserir_no_escopo_atual(pilha, nome, CAT_VARIAVEL, tipo, ordem);
 }
 
 // g - Inserir o nome de um parâmetro na tabela de símbolos atual
-Symbol* inserir_parametro(ScopeStack* pilha, const char* nome, Tipo tipo, int ordem) {
-    Symbol* novo_simbolo = criar_simbolo(nome, CAT_PARAMETRO, tipo, ordem);
-    if (!novo_simbolo) return NULL;
-    return inserir_no_escopo_atual(pilha, novo_simbolo);
+Symbol* inserir_parametro(ScopeStack* pilha, Atomo nome, Tipo tipo, int ordem) {
+    return inserir_no_escopo_atual(pilha, nome, CAT_PARAMETRO, tipo, ordem);
 }
 
 // e - Inserir um nome de função na tabela de símbolos atual
-Symbol* inserir_funcao(ScopeStack* pilha, const char* nome, Tipo tipo_retorno, int num_args) {
-    Symbol* novo_simbolo = criar_simbolo(nome, CAT_FUNCAO, tipo_retorno, 0);
+Symbol* inserir_funcao(ScopeStack* pilha, Atomo nome, Tipo tipo_retorno, int num_args) {
+    Symbol* novo_simbolo = inserir_no_escopo_atual(pilha, nome, CAT_FUNCAO, tipo_retorno, 0);
     if (!novo_simbolo) return NULL;
     
     novo_simbolo->num_args = num_args;
     // As informações dos parâmetros serão adicionadas depois
-    return inserir_no_escopo_atual(pilha, novo_simbolo);
+    return novo_simbolo;
 }
 
 // Função auxiliar para e - conforme especificado no documento
-void adicionar_info_parametro(Symbol* simbolo_funcao, const char* nome_param, Tipo tipo_param) {
+void adicionar_info_parametro(Symbol* simbolo_funcao, Atomo nome_param, Tipo tipo_param) {
     if (!simbolo_funcao || simbolo_funcao->categoria != CAT_FUNCAO) return;
 
-    ParametroInfo* novo_param = (ParametroInfo*) malloc(sizeof(ParametroInfo));
-    if (!novo_param) return;
-    
-    novo_param->nome = strdup(nome_param);
+    // Os parâmetros vivem enquanto o escopo da própria função existir
+    ParametroInfo* novo_param = regiao_novo(simbolo_funcao->regiao, ParametroInfo);
+    novo_param->nome = nome_param;
     novo_param->tipo = tipo_param;
     novo_param->proximo = NULL;
 
@@ -151,30 +224,23 @@ void adicionar_info_parametro(Symbol* simbolo_funcao, const char* nome_param, Ti
 
 
 // c - Pesquisar por um nome na pilha de tabelas de símbolos
-Symbol* pesquisar_simbolo(ScopeStack* pilha, const char* nome) {
-    if (!pilha) return NULL;
-
-    SymbolTable* escopo_atual = pilha->topo;
-    // Itera do escopo do topo em direção à base
-    while (escopo_atual) {
-        Symbol* simbolo_atual = escopo_atual->head;
-        while (simbolo_atual) {
-            if (strcmp(simbolo_atual->nome, nome) == 0) {
-                return simbolo_atual; // Encontrado
-            }
-            simbolo_atual = simbolo_atual->proximo;
-        }
-        escopo_atual = escopo_atual->proximo;
-    }
-    
-    return NULL; // Não encontrado
+Symbol* pesquisar_simbolo(ScopeStack* pilha, Atomo nome) {
+    EntradaNome* entrada = buscar_entrada(pilha, nome);
+    return entrada ? entrada->visivel : NULL;
 }
 
 // h - Eliminar a pilha de tabelas de símbolos
 void eliminar_pilha_tabelas(ScopeStack* pilha) {
-    while (pilha && pilha->topo) {
+    if (!pilha) return;
+    while (pilha->topo) {
         remover_escopo_atual(pilha);
     }
+    while (pilha->livres) {
+        SymbolTable* proximo = pilha->livres->proximo;
+        free(pilha->livres);
+        pilha->livres = proximo;
+    }
+    free(pilha->entradas);
     free(pilha);
 }
 
@@ -195,7 +261,7 @@ void imprimir_pilha(ScopeStack* pilha) {
         }
         while (simbolo_atual) {
             printf("  > Nome: %-10s | Cat: %-9s | Tipo: %-3s | Ordem: %d",
-                   simbolo_atual->nome,
+                   simbolo_atual->nome.texto,
                    simbolo_atual->categoria == CAT_VARIAVEL ? "Variavel" : (simbolo_atual->categoria == CAT_PARAMETRO ? "Parametro" : "Funcao"),
                    simbolo_atual->tipo == TIPO_INT ? "int" : "car",
                    simbolo_atual->ordem);
@@ -203,7 +269,7 @@ void imprimir_pilha(ScopeStack* pilha) {
                 printf(" | Args: %d\n", simbolo_atual->num_args);
                 ParametroInfo* p_info = simbolo_atual->params_info;
                 while(p_info) {
-                    printf("    -> Param: %-10s | Tipo: %s\n", p_info->nome, p_info->tipo == TIPO_INT ? "int" : "car");
+                    printf("    -> Param: %-10s | Tipo: %s\n", p_info->nome.texto, p_info->tipo == TIPO_INT ? "int" : "car");
                     p_info = p_info->proximo;
                 }
             } else {
@@ -217,21 +283,7 @@ void imprimir_pilha(ScopeStack* pilha) {
     printf("==============================================================\n\n");
 }
 
-int eh_global(ScopeStack* pilha, char* nome) {
-    if (!pilha) return 0;
-
-    SymbolTable* escopo_global = pilha->topo;
-    while (escopo_global && escopo_global->proximo) {
-        escopo_global = escopo_global->proximo;
-    }
-    Symbol* simbolo_atual = escopo_global->head;
-
-    while (simbolo_atual) {
-        if (strcmp(simbolo_atual->nome, nome) == 0) {
-            return 1; // Encontrado
-        }
-        simbolo_atual = simbolo_atual->proximo;
-    }
-
-    return 0;
-}
\ No newline at end of file
+int eh_global(ScopeStack* pilha, Atomo nome) {
+    EntradaNome* entrada = buscar_entrada(pilha, nome);
+    return entrada != NULL && entrada->global != NULL;
+}
@@ -1,6 +1,9 @@
 #ifndef TABELA_SIMBOLOS_H
 #define TABELA_SIMBOLOS_H
 
+#include "atomos.h"
+#include "regiao.h"
+
 // Enum para os tipos de dados da linguagem Goianinha
 typedef enum {
     TIPO_INT,
@@ -16,31 +19,50 @@ typedef enum {
 
 // Estrutura para armazenar informações sobre os parâmetros de uma função
 typedef struct ParametroInfo {
-    char* nome;
+    Atomo nome;
     Tipo tipo;
     struct ParametroInfo* proximo;
 } ParametroInfo;
 
 // Estrutura para uma entrada na tabela de símbolos (um símbolo)
 typedef struct Symbol {
-    char* nome;                 // Lexema do identificador
+    Atomo nome;                 // Lexema do identificador
     Categoria categoria;
     Tipo tipo;                  // Tipo da variável/parâmetro ou tipo de retorno da função
     int ordem;                  // Ordem de declaração para variáveis/parâmetros
     int num_args;               // Número de argumentos (apenas para funções)
     ParametroInfo* params_info; // Lista de informações dos parâmetros (apenas para funções)
+    int nivel;                  // Nível do escopo em que foi declarado (0 = global)
+    struct Symbol* sombra;      // Símbolo de mesmo nome em escopo externo, ocultado por este
+    Regiao* regiao;             // Região do escopo onde o símbolo foi alocado
     struct Symbol* proximo;     // Ponteiro para o próximo símbolo no mesmo escopo
 } Symbol;
 
 // Estrutura para a tabela de símbolos de um escopo
 typedef struct SymbolTable {
     Symbol* head;
+    int nivel;                   // Nível deste escopo na pilha (0 = global)
+    Regiao regiao;               // Memória dos símbolos do escopo, liberada ao removê-lo
     struct SymbolTable* proximo; // Ponteiro para o próximo escopo na pilha
 } SymbolTable;
 
+// Entrada da tabela hash de nomes (endereçamento aberto, sondagem linear).
+// Cada nome distinto ocupa uma única entrada, que aponta para a declaração
+// visível mais interna; as declarações ocultadas ficam encadeadas via 'sombra'.
+// Como os nomes são átomos, a comparação de chaves é feita por identidade.
+typedef struct {
+    Atomo nome;       // Texto NULL indica entrada livre
+    Symbol* visivel;  // Declaração visível no escopo atual (NULL se nenhuma)
+    Symbol* global;   // Declaração no escopo global (NULL se nenhuma)
+} EntradaNome;
+
 // Estrutura para a pilha de escopos
 typedef struct {
     SymbolTable* topo;
+    EntradaNome* entradas;  // Tabela hash única para todos os escopos
+    int capacidade;         // Sempre potência de 2
+    int ocupadas;           // Número de nomes distintos na tabela
+    SymbolTable* livres;    // Tabelas de escopos removidos, reaproveitadas
 } ScopeStack;
 
 /**
@@ -60,6 +82,10 @@ void criar_novo_escopo(ScopeStack* pilha);
 /**
  * @brief Remove o escopo atual (do topo da pilha).
  *
+ * O custo é proporcional ao número de símbolos declarados no próprio escopo:
+ * cada um deles é desligado da tabela hash, revelando o símbolo que ocultava,
+ * e a memória de todos é devolvida de uma vez com a região do escopo.
+ *
  * @param pilha A pilha de escopos.
  */
 void remover_escopo_atual(ScopeStack* pilha);
@@ -68,12 +94,12 @@ void remover_escopo_atual(ScopeStack* pilha);
  * @brief Insere um nome de variável na tabela de símbolos do escopo atual.
  *
  * @param pilha A pilha de escopos.
- * @param nome O nome da variável.
+ * @param nome O nome da variável (átomo).
  * @param tipo O tipo da variável.
  * @param ordem A posição da variável na lista de declaração.
  * @return Ponteiro para o símbolo inserido ou NULL se já existir no escopo atual.
  */
-Symbol* inserir_variavel(ScopeStack* pilha, const char* nome, Tipo tipo, int ordem);
+Symbol* inserir_variavel(ScopeStack* pilha, Atomo nome, Tipo tipo, int ordem);
 
 /**
  * @brief Insere o nome de um parâmetro na tabela de símbolos do escopo atual.
@@ -84,7 +110,7 @@ Symbol* inserir_variavel(ScopeStack* pilha, const char* nome, Tipo tipo, int ord
  * @param ordem A posição do parâmetro na lista de declaração.
  * @return Ponteiro para o símbolo inserido ou NULL se já existir no escopo atual.
  */
-Symbol* inserir_parametro(ScopeStack* pilha, const char* nome, Tipo tipo, int ordem);
+Symbol* inserir_parametro(ScopeStack* pilha, Atomo nome, Tipo tipo, int ordem);
 
 /**
  * @brief Insere um nome de função na tabela de símbolos do escopo atual.
@@ -95,7 +121,7 @@ Symbol* inserir_parametro(ScopeStack* pilha, const char* nome, Tipo tipo, int or
  * @param num_args O número de argumentos da função.
  * @return Ponteiro para o símbolo da função inserida ou NULL se já existir.
  */
-Symbol* inserir_funcao(ScopeStack* pilha, const char* nome, Tipo tipo_retorno, int num_args);
+Symbol* inserir_funcao(ScopeStack* pilha, Atomo nome, Tipo tipo_retorno, int num_args);
 
 /**
  * @brief Adiciona informações de um parâmetro a uma função já declarada.
@@ -104,17 +130,20 @@ Symbol* inserir_funcao(ScopeStack* pilha, const char* nome, Tipo tipo_retorno, i
  * @param nome_param O nome do parâmetro.
  * @param tipo_param O tipo do parâmetro.
  */
-void adicionar_info_parametro(Symbol* simbolo_funcao, const char* nome_param, Tipo tipo_param);
+void adicionar_info_parametro(Symbol* simbolo_funcao, Atomo nome_param, Tipo tipo_param);
 
 
 /**
- * @brief Pesquisa por um nome em toda a pilha de escopos, do topo à base.
+ * @brief Pesquisa a declaração visível de um nome, do topo à base da pilha.
+ *
+ * A busca é feita em tempo constante esperado na tabela hash única, sem
+ * percorrer os escopos.
  *
  * @param pilha A pilha de escopos.
- * @param nome O nome a ser pesquisado.
+ * @param nome O nome a ser pesquisado (átomo).
  * @return Ponteiro para o símbolo encontrado ou NULL se não for encontrado.
  */
-Symbol* pesquisar_simbolo(ScopeStack* pilha, const char* nome);
+Symbol* pesquisar_simbolo(ScopeStack* pilha, Atomo nome);
 
 /**
  * @brief Elimina a pilha de tabelas de símbolos, liberando toda a memória.
@@ -130,7 +159,14 @@ void eliminar_pilha_tabelas(ScopeStack* pilha);
  */
 void imprimir_pilha(ScopeStack* pilha);
 
-int eh_global(ScopeStack* pilha, char* nome);
+/**
+ * @brief Verifica se o nome possui declaração no escopo global.
+ *
+ * @param pilha A pilha de escopos.
+ * @param nome O nome a ser verificado.
+ * @return 1 se existir declaração global com esse nome, 0 caso contrário.
+ */
+int eh_global(ScopeStack* pilha, Atomo nome);
 
 
 #endif // TABELA_SIMBOLOS_H
\ No newline at end of file
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Mede a vazão dos dois analisadores léxicos (Flex e manual) sobre uma entrada
+# grande, formada pela repetição dos programas corretos de teste, e confere se
+# ambos produzem a mesma sequência de tokens (linha "verificacao").
+#
+# Uso: benchmark_varredor.sh [repeticoes]
+
+# --- CONFIGURAÇÕES ---
+DIRETORIO_SCRIPT="$(cd "$(dirname "$0")" && pwd)"
+DIRETORIO_ENTRADA="$DIRETORIO_SCRIPT/programas_teste"
+EXECUTAVEL="${EXECUTAVEL:-$DIRETORIO_SCRIPT/../analisadores/goianinha}"
+REPETICOES="${1:-20000}"
+ENTRADA_GRANDE="$(mktemp /tmp/benchmark_varredor.XXXXXX)"
+
+if [ ! -x "$EXECUTAVEL" ]; then
+    echo "Erro: O executável '$EXECUTAVEL' não foi encontrado ou não tem permissão de execução."
+    exit 1
+fi
+
+# Só programas sem erros léxicos: um comentário não terminado engoliria o resto
+cat "$DIRETORIO_ENTRADA"/*Correto*.g > "$ENTRADA_GRANDE.base"
+for i in $(seq 1 "$REPETICOES"); do
+    cat "$ENTRADA_GRANDE.base"
+done > "$ENTRADA_GRANDE"
+rm -f "$ENTRADA_GRANDE.base"
+
+echo "Entrada: $(wc -c < "$ENTRADA_GRANDE") bytes"
+
+status=0
+verificacao_anterior=""
+for varredor in flex manual; do
+    echo "--- $varredor ---"
+    resultado="$("$EXECUTAVEL" --varredor=$varredor --medir-varredor "$ENTRADA_GRANDE")"
+    echo "$resultado"
+    verificacao="$(echo "$resultado" | grep '^verificacao:')"
+    if [ -n "$verificacao_anterior" ] && [ "$verificacao" != "$verificacao_anterior" ]; then
+        echo "  [ERRO] Os analisadores produziram sequências de tokens diferentes"
+        status=1
+    fi
+    verificacao_anterior="$verificacao"
+done
+
+rm -f "$ENTRADA_GRANDE"
+exit $status
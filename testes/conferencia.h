@@ -0,0 +1,46 @@
+#ifndef CONFERENCIA_H
+#define CONFERENCIA_H
+
+/*
+ * Apoio dos testes em C: contagem de falhas e leitura de arquivos. Cada teste
+ * inclui este cabeçalho uma vez, no seu único arquivo, e termina com falha se
+ * g_falhas > 0.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Só as primeiras falhas são impressas; as demais apenas contam */
+#define FALHAS_IMPRESSAS 20
+
+static int g_falhas = 0;
+
+#define CONFERIR(cond, ...) do { \
+    if (!(cond)) { \
+        if (g_falhas < FALHAS_IMPRESSAS) { printf("FALHA: " __VA_ARGS__); printf("\n"); } \
+        g_falhas++; \
+    } \
+} while (0)
+
+/* Conteúdo do arquivo no heap (sem '\0' no fim), ou NULL se não abrir */
+static char* ler_arquivo(const char* caminho, size_t* tamanho) {
+    FILE* f = fopen(caminho, "rb");
+    if (f == NULL) return NULL;
+    char* texto = NULL;
+    size_t capacidade = 0;
+    *tamanho = 0;
+    size_t n;
+    char bloco[4096];
+    while ((n = fread(bloco, 1, sizeof(bloco), f)) > 0) {
+        if (*tamanho + n > capacidade) {
+            capacidade = (*tamanho + n) * 2;
+            texto = realloc(texto, capacidade);
+        }
+        memcpy(texto + *tamanho, bloco, n);
+        *tamanho += n;
+    }
+    fclose(f);
+    return texto;
+}
+
+#endif
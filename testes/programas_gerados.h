@@ -0,0 +1,39 @@
+#ifndef PROGRAMAS_GERADOS_H
+#define PROGRAMAS_GERADOS_H
+
+/*
+ * Programas de Goianinha gerados com n repetições de um elemento, para os
+ * testes de escala e de profundidade. O texto é inicio, os n elementos
+ * (entre separadores), meio, n fechamentos e fim: listas longas usam só o
+ * separador; aninhamentos abrem um nível por elemento e o fecham com o
+ * fechamento.
+ */
+#include <stdio.h>
+
+typedef struct {
+    const char* nome;
+    const char* inicio;     /* Texto antes dos elementos */
+    const char* elemento;   /* printf com o índice do elemento */
+    const char* separador;  /* Entre dois elementos */
+    const char* meio;       /* printf com n, depois dos elementos */
+    const char* fechamento; /* Repetido uma vez por elemento, depois de 'meio' */
+    const char* fim;
+} Forma;
+
+/* Texto no heap (liberar com free) e seu tamanho em *tamanho */
+static char* gerar_programa(const Forma* forma, int n, size_t* tamanho) {
+    char* texto = NULL;
+    FILE* saida = open_memstream(&texto, tamanho);
+    fputs(forma->inicio, saida);
+    for (int i = 0; i < n; i++) {
+        if (i > 0) fputs(forma->separador, saida);
+        fprintf(saida, forma->elemento, i);
+    }
+    fprintf(saida, forma->meio, n);
+    for (int i = 0; i < n; i++) fputs(forma->fechamento, saida);
+    fputs(forma->fim, saida);
+    fclose(saida);
+    return texto;
+}
+
+#endif
@@ -0,0 +1,27 @@
+/* Programa correto para as convencoes de chamada: funcoes com mais de quatro
+   parametros, chamadas dentro de argumentos de outras chamadas, recursao que
+   passa os parametros adiante em outra ordem e parametros alterados no corpo. */
+int seis(int a, int b, int c, int d, int e2, int f){
+	retorne a - b + c * 2 - d + e2 * 3 - f;
+}
+
+int gira(int n, int a, int b, int c, int d, int x){
+	se (n == 0) entao retorne a + b + c + d + x;
+	retorne gira(n - 1, b, c, d, x, a + seis(n, a, b, c, d, x));
+}
+
+int tres(int p, int q, int r){
+	q = q + seis(r, q, p, 1, 2, 3);
+	retorne seis(p, q, r, seis(r, q, p, 1, 2, 3), q, p) + p;
+}
+
+programa {
+	int k;
+	leia k;
+	escreva seis(1, 2, 3, 4, 5, 6);
+	novalinha;
+	escreva gira(k, 1, 2, 3, 4, 5);
+	novalinha;
+	escreva tres(k, k + 1, seis(k, 2, 3, 4, 5, tres(1, 2, 3)));
+	novalinha;
+}
@@ -0,0 +1,39 @@
+/* Programa correto para a multiplicacao e a divisao por constantes:
+   potencias de dois, somas e diferencas de duas potencias, fatores
+   negativos e divisores com e sem numero magico, aplicados a valores
+   positivos, negativos e perto dos extremos de 32 bits. */
+int conta(int x){
+	escreva x * 8; escreva " ";
+	escreva x * 10; escreva " ";
+	escreva x * 15; escreva " ";
+	escreva x * -6; escreva " ";
+	escreva x * 1000; escreva " ";
+	escreva x / 2; escreva " ";
+	escreva x / 16; escreva " ";
+	escreva x / -4; escreva " ";
+	escreva x / 3; escreva " ";
+	escreva x / 7; escreva " ";
+	escreva x / -7; escreva " ";
+	escreva x / 10; escreva " ";
+	escreva x / 641; escreva " ";
+	escreva x / 1; escreva " ";
+	escreva x / -1;
+	novalinha;
+	retorne 0;
+}
+
+programa {
+	int k;
+	int i;
+	int grande;
+	leia k;
+	grande = 2147483647;
+	i = 0 - 40;
+	enquanto (i < 40) execute {
+		i = conta(i * k + k) + i + 9;
+	}
+	i = conta(grande / 1000 * k);
+	i = conta(0 - grande / 1000 * k);
+	i = conta(grande);
+	i = conta(0 - grande - 1);
+}
@@ -0,0 +1,43 @@
+/* Programa correto para parametros vivos atraves de uma chamada que e a
+   primeira instrucao da funcao: 'f' e 'h' comecam chamando outra funcao e
+   usam os parametros depois, inclusive o quinto e o sexto, que chegam pela
+   pilha na convencao dos registradores. Chamadas de mais de um lugar, para
+   que nao sejam integradas. */
+int g(int x){
+	se (x <= 0) entao retorne 1;
+	retorne 1 + g(x - 1);
+}
+
+int f(int a, int b){
+	escreva g(a) * a;
+	escreva " "; escreva b;
+	escreva " "; escreva a;
+	escreva " "; escreva a + b;
+	escreva " "; escreva a * b;
+	escreva " "; escreva b - a;
+	novalinha;
+	retorne b;
+}
+
+int h(int a, int b, int c, int d, int q, int r){
+	escreva g(r) + a;
+	escreva " "; escreva r;
+	se (q == 0) entao escreva " zero";
+	escreva " "; escreva a + b + c + d;
+	escreva " "; escreva q * r - c;
+	novalinha;
+	retorne a - r;
+}
+
+programa {
+	int x;
+	int y;
+	leia x;
+	leia y;
+	x = f(x, y) + f(y, x);
+	escreva x;
+	novalinha;
+	y = h(x, y, 1, 2, 0, 7) + h(y, x, 3, 4, 5, 6);
+	escreva y;
+	novalinha;
+}
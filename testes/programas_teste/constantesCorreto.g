@@ -0,0 +1,66 @@
+/* Expressoes constantes, propagacao entre ramos e lacos, blocos irmaos
+   reaproveitando slots e lacos que nunca executam (ver make otimizacao). */
+int g;
+int muda(int v) {
+    g = v;
+    retorne v * 2;
+}
+int f(int a, int b) {
+    int x;
+    x = 3;
+    a = 4;
+    se (b > 0) entao {
+        x = 5;
+    } senao {
+        x = 5;
+    }
+    escreva x; novalinha;
+    se (b > 0) entao x = 7; senao x = 8;
+    escreva x + a; novalinha;
+    retorne x * a;
+}
+programa {
+    int i, n, s;
+    car c;
+    c = 'a';
+    escreva c; novalinha;
+    i = 2 * 3 + 4;
+    escreva i; novalinha;
+    escreva (1 < 2) e (3 > 4); novalinha;
+    escreva !0 ou 0; novalinha;
+    escreva 7 / 2; escreva " "; escreva 0 - 7 / 2; novalinha;
+    escreva 100000 * 100000; novalinha;
+    s = 0;
+    enquanto (i > 0) execute {
+        s = s + i;
+        i = i - 1;
+    }
+    escreva s; escreva " "; escreva i; novalinha;
+    n = 0;
+    enquanto (n > 0) execute { escreva "nunca"; }
+    enquanto (muda(n) > 100) execute { escreva "nunca2"; }
+    escreva g; novalinha;
+    se (1) entao escreva "sim"; senao escreva "nao";
+    novalinha;
+    se (0) entao escreva "sim"; 
+    se (i == 0) entao { int t; t = 9; escreva t; } senao { int u; escreva u; }
+    novalinha;
+    { int t; t = 1; escreva t; }
+    { int u; leia u; escreva u; }
+    novalinha;
+    i = 5;
+    enquanto (i > 0) execute {
+        se (i == 3) entao n = 10; 
+        i = i - 1;
+    }
+    escreva n; novalinha;
+    n = 1;
+    se (n == 1) entao { n = 2; se (n == 2) entao n = 3; senao n = 4; } senao n = 5;
+    escreva n; novalinha;
+    escreva f(1, 2); novalinha;
+    escreva f(1, 0); novalinha;
+    i = 10;
+    leia i;
+    escreva i + 1; novalinha;
+    escreva 2147483647 + 0;
+}
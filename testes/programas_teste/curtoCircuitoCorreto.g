@@ -0,0 +1,93 @@
+/* Programa correto para a avaliacao em curto-circuito de 'e' e 'ou': o
+   operando direito, com chamadas que escrevem e atribuicoes, so executa
+   quando o esquerdo nao decide; uma divisao por zero protegida pelo 'e';
+   '!' sobre comparacoes e sobre 'e' e 'ou' nas condicoes; 'e' e 'ou' como
+   valores, dentro de contas e de outras condicoes; e cadeias aninhadas
+   em 'se' e 'enquanto'. */
+int chamadas;
+
+int marca(int v){
+	escreva "[";
+	escreva v;
+	escreva "]";
+	chamadas = chamadas + 1;
+	retorne v;
+}
+
+int protegida(int x, int d){
+	se (d != 0 e x / d > 1) entao retorne 1;
+	retorne 0;
+}
+
+int conta(int n){
+	int i;
+	int s;
+	i = 0;
+	s = 0;
+	enquanto (i < n e !(i == 7 ou s > 40)) execute {
+		se (i / 2 * 2 == i ou i == 5) entao s = s + i;
+		i = i + 1;
+	}
+	retorne s * 100 + i;
+}
+
+programa {
+	int a;
+	int b;
+	int i;
+	int x;
+	car c;
+	leia a;
+	leia b;
+	se (marca(0) e marca(1)) entao escreva "s"; senao escreva "n";
+	novalinha;
+	se (marca(1) ou marca(2)) entao escreva "s"; senao escreva "n";
+	novalinha;
+	se (marca(0) ou marca(3) e marca(0)) entao escreva "s"; senao escreva "n";
+	novalinha;
+	se (!(a < b) e !marca(0)) entao escreva "ge"; senao escreva "lt";
+	novalinha;
+	se (!(a > 0 e b > 0) ou !(!b)) entao escreva "t"; senao escreva "f";
+	novalinha;
+	escreva protegida(10, 0); escreva protegida(10, 3); escreva protegida(a, b); escreva protegida(b, 0);
+	novalinha;
+
+	x = 5;
+	se (a > 100 e (x = 7) > 0) entao escreva "nunca";
+	escreva x; escreva " ";
+	se (a >= 0 ou (x = 9) > 0) entao escreva x;
+	escreva " ";
+	se (a < 0 ou (x = 11) > 0) entao escreva x;
+	novalinha;
+
+	x = (a < b) e marca(4);
+	escreva x;
+	x = (a > b) ou !marca(5);
+	escreva x;
+	escreva (0 e marca(6)) + (1 ou marca(7)) + (a e b) + (b - b ou a - a);
+	escreva " ";
+	x = 1;
+	escreva x + (a e (x = 20));
+	escreva " ";
+	escreva x + (b > 100 e (x = 30));
+	escreva " ";
+	escreva x;
+	novalinha;
+
+	c = 'c';
+	se (c ou marca(8)) entao escreva c;
+	se ('a' e 0) entao escreva "nunca";
+	se ((a e b) + (a ou 0) == 2 e !(a e 0)) entao escreva "dois";
+	novalinha;
+
+	chamadas = 0;
+	i = 0;
+	enquanto (i < 5 ou marca(0) e i < 3) execute i = i + 1;
+	escreva " "; escreva chamadas; escreva " "; escreva i;
+	novalinha;
+	i = 0;
+	enquanto (i < 10 e !(i == a ou i == b + 5)) execute i = i + 1;
+	escreva i; escreva " ";
+	escreva conta(20); escreva " "; escreva conta(a);
+	novalinha;
+}
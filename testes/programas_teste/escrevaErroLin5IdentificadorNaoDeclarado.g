@@ -0,0 +1,7 @@
+/* Este e um programa com ERRO */
+programa {
+	int n;
+	n = 1;
+	escreva m; /* Erro: identificador nao declarado */
+	novalinha;
+}
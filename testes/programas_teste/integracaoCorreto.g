@@ -0,0 +1,59 @@
+/* Programa correto para a integracao de funcoes: acessores pequenos
+   chamados dentro de 'enquanto', funcoes com varios 'retorne', locais com o
+   mesmo nome de quem chama, cadeias escritas por uma funcao integrada em
+   dois lugares e uma funcao recursiva, que nunca e integrada. */
+int total;
+
+int dobro(int x){
+	retorne x + x;
+}
+
+int maior(int a, int b){
+	se (a > b) entao retorne a;
+	retorne b;
+}
+
+int acumula(int v){
+	total = total + v;
+	retorne total;
+}
+
+int faixa(int n){
+	int i;
+	i = n;
+	se (i < 0) entao i = 0 - i;
+	se (i > 100) entao retorne 100;
+	retorne maior(i, 10);
+}
+
+int aviso(int n){
+	escreva "valor: ";
+	escreva n;
+	novalinha;
+	retorne n;
+}
+
+int fib(int n){
+	se (n < 2) entao retorne n;
+	retorne fib(n - 1) + fib(n - 2);
+}
+
+programa {
+	int i;
+	int k;
+	int soma;
+	leia k;
+	total = 0;
+	i = 0;
+	soma = 0;
+	enquanto (i < k * 10) execute {
+		int x;
+		x = dobro(i) - maior(i, k);
+		soma = soma + faixa(x - 40);
+		x = acumula(x);
+		i = i + 1;
+	}
+	soma = aviso(soma) + aviso(total);
+	escreva fib(k + 5);
+	novalinha;
+}
@@ -0,0 +1,73 @@
+/* Programa correto para as otimizacoes de lacos: expressoes que nao mudam
+   dentro do 'enquanto' (inclusive globais lidas sem escrita no laco e uma
+   divisao na condicao), produtos pelo contador em lacos aninhados, com
+   passo negativo e por um fator lido, e lacos com chamadas e escritas em
+   globais, de onde as cargas nao podem sair. */
+int base;
+int passos;
+
+int conta(int n, int k){
+	int i;
+	int s;
+	i = 0;
+	s = 0;
+	enquanto (i < n / k) execute {
+		s = s + i * 7 + base * k;
+		i = i + 1;
+	}
+	retorne s;
+}
+
+int muda(int v){
+	base = base + v;
+	passos = passos + 1;
+	retorne base;
+}
+
+int tabela(int n, int f){
+	int i;
+	int j;
+	int s;
+	i = n;
+	s = 0;
+	enquanto (i > 0) execute {
+		j = 0;
+		enquanto (j < 4) execute {
+			s = s + i * f + j * 3 + (n + f) * 2;
+			j = j + 1;
+		}
+		i = i - 2;
+	}
+	retorne s;
+}
+
+programa {
+	int i;
+	int k;
+	int total;
+	leia k;
+	base = 5;
+	passos = 0;
+	total = conta(k * 30, 3);
+	escreva total;
+	novalinha;
+	escreva tabela(k + 9, k);
+	novalinha;
+	i = 0;
+	enquanto (i < k) execute {
+		total = total + base * 2 + muda(i);
+		i = i + 1;
+	}
+	escreva total;
+	novalinha;
+	i = 0;
+	enquanto (i < 10) execute {
+		base = base - 1;
+		total = total + base * 3;
+		i = i + 1;
+	}
+	escreva total;
+	novalinha;
+	escreva passos;
+	novalinha;
+}
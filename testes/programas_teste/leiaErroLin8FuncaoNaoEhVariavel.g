@@ -0,0 +1,11 @@
+/* Este e um programa com ERRO */
+int dobro(int x) {
+	retorne x * 2;
+}
+
+programa {
+	int n;
+	leia dobro; /* Erro: leia de um nome de funcao */
+	n = dobro(3);
+	escreva n;
+}
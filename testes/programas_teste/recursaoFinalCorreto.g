@@ -0,0 +1,44 @@
+/* Programa correto para a recursao final: chamadas finais a propria funcao
+   (com os parametros trocados de lugar e com acumulador no produto),
+   chamadas finais a outras funcoes e uma recursao funda, que so cabe na
+   pilha com o quadro reaproveitado. */
+int soma(int n, int acc){
+	se (n == 0) entao retorne acc;
+	retorne soma(n - 1, acc + n);
+}
+
+int mdc(int a, int b){
+	se (b == 0) entao retorne a;
+	retorne mdc(b, a - a / b * b);
+}
+
+int potencia(int b, int x){
+	se (x == 0) entao retorne 1;
+	retorne b * potencia(b, x - 1);
+}
+
+int triplos(int n){
+	se (n == 0) entao retorne 2;
+	se (n == 1) entao retorne n + 4;
+	retorne triplos(n - 1) * 3;
+}
+
+int ordenado(int a, int b){
+	se (a < b) entao retorne mdc(b, a);
+	retorne potencia(a - b, 3);
+}
+
+programa {
+	int k;
+	leia k;
+	escreva soma(k * 4000, 0);
+	novalinha;
+	escreva mdc(k * 252, 198);
+	novalinha;
+	escreva potencia(k, 7);
+	novalinha;
+	escreva triplos(k * 11);
+	novalinha;
+	escreva ordenado(k, 9) + ordenado(9, k);
+	novalinha;
+}
@@ -0,0 +1,52 @@
+/* Programa correto para a traducao para a representacao intermediaria:
+   atribuicoes dentro de expressoes que mudam uma variavel ja lida, argumentos
+   que mudam outros argumentos, globais lidas antes e depois de chamadas que
+   as alteram, lacos aninhados e senao encadeados. */
+int g;
+car c;
+
+int troca(int a, int b){
+	g = g + a - b;
+	retorne a * 10 + b;
+}
+
+int menor(int a, int b){
+	se (a < b) entao retorne a;
+	retorne b;
+}
+
+programa {
+	int x, y, z, i, j;
+	leia x;
+	g = 1;
+	y = x + (x = 3);
+	escreva y;
+	escreva " ";
+	z = y = x = 7;
+	escreva x + y + z;
+	escreva " ";
+	escreva troca(x, x = 2) + x;
+	escreva " ";
+	escreva g + troca(g, 1) + g;
+	novalinha;
+	i = 0;
+	enquanto (i < 4) execute {
+		j = i;
+		enquanto (j > 0) execute {
+			se (j == 1) entao escreva "a";
+			senao se (j == 2) entao escreva "b";
+			senao escreva "c";
+			j = j - 1;
+		}
+		i = i + 1;
+		escreva menor(i, 3 - i) * !(i - 2) + (i > 1 e i < 3) + (0 ou i);
+	}
+	novalinha;
+	c = 'z';
+	escreva c;
+	x = 5;
+	x;
+	(x = x - 1) + (x = x - 1);
+	escreva x;
+	novalinha;
+}
@@ -0,0 +1,46 @@
+/* Programa correto com subexpressoes repetidas: as mesmas contas aparecem
+   varias vezes entre atribuicoes, leituras e chamadas que alteram globais. */
+int total;
+
+int acumula(int v){
+	total = total + v;
+	retorne total;
+}
+
+int distancia(int a, int b){
+	se (a - b > 0)
+	entao
+		retorne (a - b) * (a - b);
+	senao
+		retorne (b - a) * (b - a);
+}
+
+programa {
+	int i, n, x, y, soma;
+	leia n;
+	leia x;
+	total = 0;
+	i = 0;
+	soma = 0;
+	enquanto (i < n) execute {
+		y = (x + i) * (x + i) + (x + i);
+		soma = soma + y - (x + i) * (x + i);
+		escreva y - (x + i);
+		escreva " ";
+		leia x;
+		escreva (x + i) * 2;
+		escreva " ";
+		i = i + 1;
+	}
+	novalinha;
+	escreva soma;
+	novalinha;
+	escreva total + n * n;
+	escreva " ";
+	escreva acumula(n * n) + total + n * n;
+	escreva " ";
+	escreva total + n * n;
+	novalinha;
+	escreva distancia(x, n) + distancia(n, x);
+	novalinha;
+}
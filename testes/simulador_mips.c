@@ -0,0 +1,503 @@
+/*
+ * Simulador do subconjunto de MIPS que o compilador gera (com as
+ * pseudoinstruções do MARS/SPIM que ele usa), para os testes das
+ * otimizações: executa um arquivo .asm, escreve a saída do programa e, em
+ * stderr, o número de instruções executadas e a profundidade máxima da pilha.
+ *
+ * As entradas de 'leia' (syscall 5) vêm dos argumentos, em ordem; esgotadas,
+ * a leitura devolve 0. Estouro em add/sub, divisão por zero, acesso fora da
+ * memória e instrução desconhecida encerram a simulação com erro.
+ *
+ * Uso: simulador_mips arquivo.asm [entradas...]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#define BASE_TEXTO   0x00400000u
+#define BASE_DADOS   0x10010000u
+#define TOPO_PILHA   0x7ffff000u
+#define PILHA_INICIAL 0x7fffeffcu
+#define TAMANHO_PILHA (64u * 1024 * 1024)
+#define LIMITE_PASSOS 2000000000ull
+
+typedef enum { OP_REG, OP_IMM, OP_MEM, OP_ROTULO } TipoOperando;
+
+typedef struct {
+    TipoOperando tipo;
+    int reg;            /* OP_REG; base de OP_MEM */
+    int64_t imm;        /* OP_IMM; deslocamento de OP_MEM e OP_ROTULO */
+    char* rotulo;       /* OP_ROTULO (e OP_MEM com rótulo) */
+    uint32_t endereco;  /* Rótulo resolvido */
+} Operando;
+
+typedef struct {
+    char nome[8];
+    Operando op[3];
+    int num_ops;
+    int linha;
+} Instrucao;
+
+typedef struct {
+    char* nome;
+    uint32_t endereco;
+} Rotulo;
+
+static Instrucao* g_texto;
+static size_t g_num_texto, g_cap_texto;
+static Rotulo* g_rotulos;
+static size_t g_num_rotulos, g_cap_rotulos;
+static uint8_t* g_dados;
+static size_t g_tam_dados, g_cap_dados;
+static uint8_t* g_pilha;
+
+static void erro(int linha, const char* msg, const char* detalhe) {
+    fprintf(stderr, "simulador: linha %d: %s%s%s\n", linha, msg, detalhe ? ": " : "", detalhe ? detalhe : "");
+    exit(2);
+}
+
+// --- Montagem ---
+
+static const char* g_nomes_reg[32] = {
+    "zero", "at", "v0", "v1", "a0", "a1", "a2", "a3",
+    "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+    "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+    "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra"
+};
+
+static int registrador(const char* texto, int linha) {
+    if (texto[0] != '$') erro(linha, "registrador esperado", texto);
+    if (isdigit((unsigned char) texto[1])) {
+        int n = atoi(texto + 1);
+        if (n >= 0 && n < 32) return n;
+    }
+    for (int i = 0; i < 32; i++) {
+        if (strcmp(texto + 1, g_nomes_reg[i]) == 0) return i;
+    }
+    erro(linha, "registrador desconhecido", texto);
+    return 0;
+}
+
+static char* aparar(char* s) {
+    while (isspace((unsigned char) *s)) s++;
+    char* fim = s + strlen(s);
+    while (fim > s && isspace((unsigned char) fim[-1])) *--fim = '\0';
+    return s;
+}
+
+static int eh_numero(const char* s) {
+    if (*s == '-' || *s == '+') s++;
+    return isdigit((unsigned char) *s);
+}
+
+static Operando operando(char* texto, int linha) {
+    Operando o;
+    memset(&o, 0, sizeof(o));
+    texto = aparar(texto);
+    char* parentese = strchr(texto, '(');
+    if (texto[0] == '$') {
+        o.tipo = OP_REG;
+        o.reg = registrador(texto, linha);
+    } else if (parentese != NULL) {
+        // desloc($reg) ou rotulo($reg)
+        char* fecha = strchr(parentese, ')');
+        if (fecha == NULL) erro(linha, "operando de memoria invalido", texto);
+        *fecha = '\0';
+        *parentese = '\0';
+        o.tipo = OP_MEM;
+        o.reg = registrador(aparar(parentese + 1), linha);
+        char* base = aparar(texto);
+        if (*base == '\0') {
+            o.imm = 0;
+        } else if (eh_numero(base)) {
+            o.imm = strtoll(base, NULL, 0);
+        } else {
+            o.rotulo = strdup(base);
+        }
+    } else if (eh_numero(texto)) {
+        o.tipo = OP_IMM;
+        o.imm = strtoll(texto, NULL, 0);
+    } else {
+        // rotulo ou rotulo+n
+        o.tipo = OP_ROTULO;
+        char* mais = strchr(texto, '+');
+        if (mais != NULL) {
+            *mais = '\0';
+            o.imm = strtoll(mais + 1, NULL, 0);
+        }
+        o.rotulo = strdup(aparar(texto));
+    }
+    return o;
+}
+
+static void definir_rotulo(const char* nome, uint32_t endereco, int linha) {
+    for (size_t i = 0; i < g_num_rotulos; i++) {
+        if (strcmp(g_rotulos[i].nome, nome) == 0) erro(linha, "rotulo duplicado", nome);
+    }
+    if (g_num_rotulos == g_cap_rotulos) {
+        g_cap_rotulos = g_cap_rotulos ? g_cap_rotulos * 2 : 256;
+        g_rotulos = realloc(g_rotulos, g_cap_rotulos * sizeof(Rotulo));
+    }
+    g_rotulos[g_num_rotulos].nome = strdup(nome);
+    g_rotulos[g_num_rotulos].endereco = endereco;
+    g_num_rotulos++;
+}
+
+static uint32_t endereco_rotulo(const char* nome, int linha) {
+    for (size_t i = 0; i < g_num_rotulos; i++) {
+        if (strcmp(g_rotulos[i].nome, nome) == 0) return g_rotulos[i].endereco;
+    }
+    erro(linha, "rotulo indefinido", nome);
+    return 0;
+}
+
+static void dados_bytes(const void* bytes, size_t n) {
+    if (g_tam_dados + n > g_cap_dados) {
+        while (g_tam_dados + n > g_cap_dados) g_cap_dados = g_cap_dados ? g_cap_dados * 2 : 4096;
+        g_dados = realloc(g_dados, g_cap_dados);
+    }
+    memcpy(g_dados + g_tam_dados, bytes, n);
+    g_tam_dados += n;
+}
+
+// .asciiz "texto" com os escapes \n \t \" \\ \0
+static void diretiva_cadeia(const char* s, int linha) {
+    s = strchr(s, '"');
+    if (s == NULL) erro(linha, ".asciiz sem cadeia", NULL);
+    for (s++; *s && *s != '"'; s++) {
+        char c = *s;
+        if (c == '\\') {
+            s++;
+            switch (*s) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '0': c = '\0'; break;
+                default:  c = *s; break;
+            }
+        }
+        dados_bytes(&c, 1);
+    }
+    char nulo = '\0';
+    dados_bytes(&nulo, 1);
+}
+
+static void montar_linha(char* linha_texto, int linha, int* secao_texto) {
+    // Comentários: '#' fora de cadeias
+    int em_cadeia = 0;
+    for (char* p = linha_texto; *p; p++) {
+        if (*p == '"' && (p == linha_texto || p[-1] != '\\')) em_cadeia = !em_cadeia;
+        if (*p == '#' && !em_cadeia) {
+            *p = '\0';
+            break;
+        }
+    }
+    char* s = aparar(linha_texto);
+
+    // Rótulos no início da linha
+    for (;;) {
+        char* p = s;
+        while (isalnum((unsigned char) *p) || *p == '_' || *p == '.' || *p == '$') p++;
+        if (p == s || *p != ':') break;
+        *p = '\0';
+        definir_rotulo(s, *secao_texto ? BASE_TEXTO + 4 * (uint32_t) g_num_texto
+                                       : BASE_DADOS + (uint32_t) g_tam_dados, linha);
+        s = aparar(p + 1);
+    }
+    if (*s == '\0') return;
+
+    if (*s == '.') {
+        if (strncmp(s, ".data", 5) == 0) {
+            *secao_texto = 0;
+        } else if (strncmp(s, ".text", 5) == 0) {
+            *secao_texto = 1;
+        } else if (strncmp(s, ".word", 5) == 0) {
+            for (char* v = strtok(s + 5, ","); v != NULL; v = strtok(NULL, ",")) {
+                int32_t w = (int32_t) strtoll(aparar(v), NULL, 0);
+                dados_bytes(&w, 4);
+            }
+        } else if (strncmp(s, ".asciiz", 7) == 0) {
+            diretiva_cadeia(s + 7, linha);
+        } else if (strncmp(s, ".space", 6) == 0) {
+            for (long n = strtol(s + 6, NULL, 0); n > 0; n--) {
+                char zero = 0;
+                dados_bytes(&zero, 1);
+            }
+        } else if (strncmp(s, ".align", 6) == 0) {
+            while (g_tam_dados % 4 != 0) {
+                char zero = 0;
+                dados_bytes(&zero, 1);
+            }
+        } else if (strncmp(s, ".globl", 6) != 0) {
+            erro(linha, "diretiva desconhecida", s);
+        }
+        return;
+    }
+    if (!*secao_texto) erro(linha, "instrucao fora de .text", s);
+
+    if (g_num_texto == g_cap_texto) {
+        g_cap_texto = g_cap_texto ? g_cap_texto * 2 : 1024;
+        g_texto = realloc(g_texto, g_cap_texto * sizeof(Instrucao));
+    }
+    Instrucao* ins = &g_texto[g_num_texto++];
+    memset(ins, 0, sizeof(*ins));
+    ins->linha = linha;
+    size_t n = strcspn(s, " \t");
+    if (n >= sizeof(ins->nome)) erro(linha, "instrucao desconhecida", s);
+    memcpy(ins->nome, s, n);
+    s = aparar(s + n);
+    if (*s != '\0') {
+        for (char* o = strtok(s, ","); o != NULL; o = strtok(NULL, ",")) {
+            if (ins->num_ops == 3) erro(linha, "operandos demais", NULL);
+            ins->op[ins->num_ops++] = operando(o, linha);
+        }
+    }
+}
+
+static void montar(FILE* arquivo) {
+    char* linha_texto = NULL;
+    size_t capacidade = 0;
+    int linha = 0, secao_texto = 1;
+    while (getline(&linha_texto, &capacidade, arquivo) != -1) {
+        montar_linha(linha_texto, ++linha, &secao_texto);
+    }
+    free(linha_texto);
+
+    for (size_t i = 0; i < g_num_texto; i++) {
+        for (int k = 0; k < g_texto[i].num_ops; k++) {
+            Operando* o = &g_texto[i].op[k];
+            if (o->rotulo != NULL) o->endereco = endereco_rotulo(o->rotulo, g_texto[i].linha);
+        }
+    }
+}
+
+// --- Execução ---
+
+static uint32_t g_reg[32];
+static uint32_t g_hi, g_lo;
+
+static uint8_t* memoria(uint32_t endereco, uint32_t tamanho, int linha) {
+    if (endereco >= BASE_DADOS && endereco - BASE_DADOS + tamanho <= g_tam_dados) {
+        return g_dados + (endereco - BASE_DADOS);
+    }
+    if (endereco < TOPO_PILHA && endereco >= TOPO_PILHA - TAMANHO_PILHA && endereco + tamanho <= TOPO_PILHA) {
+        return g_pilha + (endereco - (TOPO_PILHA - TAMANHO_PILHA));
+    }
+    char detalhe[32];
+    snprintf(detalhe, sizeof(detalhe), "0x%08x", endereco);
+    erro(linha, "acesso fora da memoria", detalhe);
+    return NULL;
+}
+
+static uint32_t ler_palavra(uint32_t endereco, int linha) {
+    if (endereco % 4 != 0) erro(linha, "lw desalinhado", NULL);
+    uint32_t v;
+    memcpy(&v, memoria(endereco, 4, linha), 4);
+    return v;
+}
+
+static void escrever_palavra(uint32_t endereco, uint32_t v, int linha) {
+    if (endereco % 4 != 0) erro(linha, "sw desalinhado", NULL);
+    memcpy(memoria(endereco, 4, linha), &v, 4);
+}
+
+static uint32_t endereco_efetivo(const Operando* o) {
+    switch (o->tipo) {
+        case OP_MEM:    return (o->rotulo ? o->endereco : (uint32_t) o->imm) + g_reg[o->reg];
+        case OP_ROTULO: return o->endereco + (uint32_t) o->imm;
+        default:        return (uint32_t) o->imm;
+    }
+}
+
+// Valor de um operando-fonte: registrador ou imediato
+static int32_t fonte(const Instrucao* ins, int k) {
+    const Operando* o = &ins->op[k];
+    if (o->tipo == OP_REG) return (int32_t) g_reg[o->reg];
+    if (o->tipo == OP_IMM) return (int32_t) o->imm;
+    erro(ins->linha, "operando invalido em", ins->nome);
+    return 0;
+}
+
+static void escrever_reg(const Instrucao* ins, int k, int64_t valor) {
+    if (ins->op[k].tipo != OP_REG) erro(ins->linha, "registrador esperado em", ins->nome);
+    if (ins->op[k].reg != 0) g_reg[ins->op[k].reg] = (uint32_t) valor;
+}
+
+static size_t indice_texto(uint32_t endereco, int linha) {
+    if (endereco < BASE_TEXTO || (endereco - BASE_TEXTO) % 4 != 0 ||
+        (endereco - BASE_TEXTO) / 4 >= g_num_texto) {
+        erro(linha, "desvio para fora do codigo", NULL);
+    }
+    return (endereco - BASE_TEXTO) / 4;
+}
+
+#define EH(n) (strcmp(ins->nome, n) == 0)
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s arquivo.asm [entradas...]\n", argv[0]);
+        return 1;
+    }
+    FILE* arquivo = fopen(argv[1], "r");
+    if (arquivo == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    montar(arquivo);
+    fclose(arquivo);
+    g_pilha = calloc(1, TAMANHO_PILHA);
+    int proxima_entrada = 2;
+
+    g_reg[29] = PILHA_INICIAL;
+    uint32_t menor_sp = PILHA_INICIAL;
+    size_t pc = indice_texto(endereco_rotulo("main", 0), 0);
+    unsigned long long passos = 0;
+
+    for (;;) {
+        if (pc >= g_num_texto) erro(0, "execucao passou do fim do codigo", NULL);
+        const Instrucao* ins = &g_texto[pc++];
+        if (++passos > LIMITE_PASSOS) erro(ins->linha, "limite de instrucoes", NULL);
+        int32_t a, b;
+        int64_t r;
+
+        if (EH("li")) {
+            escrever_reg(ins, 0, ins->op[1].imm);
+        } else if (EH("la")) {
+            escrever_reg(ins, 0, endereco_efetivo(&ins->op[1]));
+        } else if (EH("lw")) {
+            escrever_reg(ins, 0, ler_palavra(endereco_efetivo(&ins->op[1]), ins->linha));
+        } else if (EH("sw")) {
+            escrever_palavra(endereco_efetivo(&ins->op[1]), (uint32_t) fonte(ins, 0), ins->linha);
+        } else if (EH("lb")) {
+            escrever_reg(ins, 0, (int8_t) *memoria(endereco_efetivo(&ins->op[1]), 1, ins->linha));
+        } else if (EH("lbu")) {
+            escrever_reg(ins, 0, *memoria(endereco_efetivo(&ins->op[1]), 1, ins->linha));
+        } else if (EH("sb")) {
+            *memoria(endereco_efetivo(&ins->op[1]), 1, ins->linha) = (uint8_t) fonte(ins, 0);
+        } else if (EH("move")) {
+            escrever_reg(ins, 0, fonte(ins, 1));
+        } else if (EH("add") || EH("addi") || EH("addu") || EH("addiu")) {
+            r = (int64_t) fonte(ins, 1) + fonte(ins, 2);
+            if ((EH("add") || EH("addi")) && (r < INT32_MIN || r > INT32_MAX)) {
+                erro(ins->linha, "estouro aritmetico", ins->nome);
+            }
+            escrever_reg(ins, 0, r);
+        } else if (EH("sub") || EH("subu")) {
+            r = (int64_t) fonte(ins, 1) - fonte(ins, 2);
+            if (EH("sub") && (r < INT32_MIN || r > INT32_MAX)) erro(ins->linha, "estouro aritmetico", ins->nome);
+            escrever_reg(ins, 0, r);
+        } else if (EH("neg") || EH("negu")) {
+            escrever_reg(ins, 0, -(int64_t) fonte(ins, 1));
+        } else if (EH("not")) {
+            escrever_reg(ins, 0, ~(uint32_t) fonte(ins, 1));
+        } else if (EH("mul")) {
+            escrever_reg(ins, 0, (int64_t) fonte(ins, 1) * fonte(ins, 2));
+        } else if (EH("mult") || EH("multu")) {
+            uint64_t p = EH("mult") ? (uint64_t) ((int64_t) fonte(ins, 0) * fonte(ins, 1))
+                                    : (uint64_t) (uint32_t) fonte(ins, 0) * (uint32_t) fonte(ins, 1);
+            g_lo = (uint32_t) p;
+            g_hi = (uint32_t) (p >> 32);
+        } else if (EH("div") || EH("divu") || EH("rem") || EH("remu")) {
+            int tres = ins->num_ops == 3;
+            a = fonte(ins, tres ? 1 : 0);
+            b = fonte(ins, tres ? 2 : 1);
+            if (b == 0) erro(ins->linha, "divisao por zero", NULL);
+            if (EH("divu") || EH("remu")) {
+                g_lo = (uint32_t) a / (uint32_t) b;
+                g_hi = (uint32_t) a % (uint32_t) b;
+            } else if (a == INT32_MIN && b == -1) {
+                g_lo = (uint32_t) a;
+                g_hi = 0;
+            } else {
+                g_lo = (uint32_t) (a / b);
+                g_hi = (uint32_t) (a % b);
+            }
+            if (tres) escrever_reg(ins, 0, (EH("rem") || EH("remu")) ? g_hi : g_lo);
+        } else if (EH("mflo")) {
+            escrever_reg(ins, 0, g_lo);
+        } else if (EH("mfhi")) {
+            escrever_reg(ins, 0, g_hi);
+        } else if (EH("sll") || EH("sllv")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) << (fonte(ins, 2) & 31));
+        } else if (EH("srl") || EH("srlv")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) >> (fonte(ins, 2) & 31));
+        } else if (EH("sra") || EH("srav")) {
+            escrever_reg(ins, 0, fonte(ins, 1) >> (fonte(ins, 2) & 31));
+        } else if (EH("and") || EH("andi")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) & (uint32_t) fonte(ins, 2));
+        } else if (EH("or") || EH("ori")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) | (uint32_t) fonte(ins, 2));
+        } else if (EH("xor") || EH("xori")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) ^ (uint32_t) fonte(ins, 2));
+        } else if (EH("nor")) {
+            escrever_reg(ins, 0, ~((uint32_t) fonte(ins, 1) | (uint32_t) fonte(ins, 2)));
+        } else if (EH("slt") || EH("slti")) {
+            escrever_reg(ins, 0, fonte(ins, 1) < fonte(ins, 2));
+        } else if (EH("sltu") || EH("sltiu")) {
+            escrever_reg(ins, 0, (uint32_t) fonte(ins, 1) < (uint32_t) fonte(ins, 2));
+        } else if (EH("seq")) {
+            escrever_reg(ins, 0, fonte(ins, 1) == fonte(ins, 2));
+        } else if (EH("sne")) {
+            escrever_reg(ins, 0, fonte(ins, 1) != fonte(ins, 2));
+        } else if (EH("sgt")) {
+            escrever_reg(ins, 0, fonte(ins, 1) > fonte(ins, 2));
+        } else if (EH("sge")) {
+            escrever_reg(ins, 0, fonte(ins, 1) >= fonte(ins, 2));
+        } else if (EH("sle")) {
+            escrever_reg(ins, 0, fonte(ins, 1) <= fonte(ins, 2));
+        } else if (EH("beqz") || EH("bnez") || EH("bltz") || EH("bgez") || EH("bgtz") || EH("blez")) {
+            a = fonte(ins, 0);
+            int toma = EH("beqz") ? a == 0 : EH("bnez") ? a != 0 : EH("bltz") ? a < 0 :
+                       EH("bgez") ? a >= 0 : EH("bgtz") ? a > 0 : a <= 0;
+            if (toma) pc = indice_texto(ins->op[1].endereco, ins->linha);
+        } else if (EH("beq") || EH("bne") || EH("blt") || EH("bge") || EH("bgt") || EH("ble")) {
+            a = fonte(ins, 0);
+            b = fonte(ins, 1);
+            int toma = EH("beq") ? a == b : EH("bne") ? a != b : EH("blt") ? a < b :
+                       EH("bge") ? a >= b : EH("bgt") ? a > b : a <= b;
+            if (toma) pc = indice_texto(ins->op[2].endereco, ins->linha);
+        } else if (EH("j") || EH("b")) {
+            pc = indice_texto(ins->op[0].endereco, ins->linha);
+        } else if (EH("jal")) {
+            g_reg[31] = BASE_TEXTO + 4 * (uint32_t) pc;
+            pc = indice_texto(ins->op[0].endereco, ins->linha);
+        } else if (EH("jr")) {
+            pc = indice_texto(g_reg[ins->op[0].reg], ins->linha);
+        } else if (EH("jalr")) {
+            uint32_t alvo = g_reg[ins->op[ins->num_ops - 1].reg];
+            g_reg[ins->num_ops == 2 ? ins->op[0].reg : 31] = BASE_TEXTO + 4 * (uint32_t) pc;
+            pc = indice_texto(alvo, ins->linha);
+        } else if (EH("nop")) {
+            /* nada */
+        } else if (EH("syscall")) {
+            switch (g_reg[2]) {
+                case 1:
+                    printf("%d", (int32_t) g_reg[4]);
+                    break;
+                case 4:
+                    for (uint32_t p = g_reg[4]; *memoria(p, 1, ins->linha) != 0; p++) {
+                        putchar(*memoria(p, 1, ins->linha));
+                    }
+                    break;
+                case 5:
+                    g_reg[2] = proxima_entrada < argc ? (uint32_t) atoi(argv[proxima_entrada++]) : 0;
+                    break;
+                case 10:
+                    fflush(stdout);
+                    fprintf(stderr, "instrucoes=%llu pilha_max=%u\n", passos, PILHA_INICIAL - menor_sp);
+                    return 0;
+                case 11:
+                    putchar((int) (g_reg[4] & 0xff));
+                    break;
+                default:
+                    erro(ins->linha, "syscall desconhecida", NULL);
+            }
+        } else {
+            erro(ins->linha, "instrucao desconhecida", ins->nome);
+        }
+        if (g_reg[29] < menor_sp) menor_sp = g_reg[29];
+    }
+}
@@ -0,0 +1,389 @@
+/*
+ * Confere a multiplicação e a divisão por constantes (aritmetica.h) contra o
+ * 'mul' e o 'div' do MIPS, em duas partes.
+ *
+ * Os parâmetros: cada sequência escolhida por aritmetica.c é refeita aqui em
+ * C (sll, sra, srl e addu/subu módulo 2^32; mult seguido de mfhi). Para uma
+ * constante de cada forma de sequência, todos os 2^32 valores de x são
+ * testados; para as constantes de -2^16 a 2^16, as próximas dos extremos e
+ * outras aleatórias, valores de x escolhidos: os extremos, os vizinhos dos
+ * múltiplos e aleatórios.
+ *
+ * O código emitido: programas com 'x * c' e 'x / c' para constantes de todas
+ * as formas são compilados com -O1 e executados no simulador, com os mesmos
+ * valores de x. Assim, um erro do gerador da RI ao escrever a sequência (ou
+ * da alocação e da janela em volta dela) também aparece. O assembly não pode
+ * ter 'div', e só as constantes sem sequência podem usar o 'mul'.
+ *
+ * Uso: teste_aritmetica ./simulador_mips
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "compilador.h"
+#include "aritmetica.h"
+#include "conferencia.h"
+
+// --- O que o MIPS faz ---
+
+static int32_t mul_mips(int32_t x, int32_t k) {
+    return (int32_t) ((uint32_t) x * (uint32_t) k);
+}
+
+static int32_t div_mips(int32_t x, int32_t d) {
+    if (x == INT32_MIN && d == -1) return INT32_MIN;
+    return x / d;
+}
+
+static int32_t sll(int32_t x, unsigned n) {
+    return (int32_t) ((uint32_t) x << n);
+}
+
+static int32_t srl(int32_t x, unsigned n) {
+    return (int32_t) ((uint32_t) x >> n);
+}
+
+static int32_t sra(int32_t x, unsigned n) {
+    return x >> n;
+}
+
+static int32_t addu(int32_t a, int32_t b) {
+    return (int32_t) ((uint32_t) a + (uint32_t) b);
+}
+
+static int32_t subu(int32_t a, int32_t b) {
+    return (int32_t) ((uint32_t) a - (uint32_t) b);
+}
+
+static int32_t mfhi(int32_t a, int32_t b) {
+    return (int32_t) ((uint64_t) ((int64_t) a * b) >> 32);
+}
+
+// --- As sequências, na ordem em que gerador_ri.c as escreve ---
+
+static int32_t multiplicar(int32_t x, const MultiplicacaoConstante* m) {
+    int32_t r = sll(x, m->maior);
+    if (m->termos == 2) {
+        int32_t t9 = r;
+        r = sll(x, m->menor);
+        r = m->subtrai ? subu(t9, r) : addu(t9, r);
+    }
+    if (m->negativo) r = subu(0, r);
+    return r;
+}
+
+static int32_t dividir(int32_t x, const DivisaoConstante* q) {
+    int32_t r = x;
+    if (q->potencia && q->deslocamento > 0) {
+        int32_t t9 = q->deslocamento > 1 ? srl(sra(x, 31), 32 - q->deslocamento) : srl(x, 31);
+        t9 = addu(x, t9);
+        r = sra(t9, q->deslocamento);
+    } else if (!q->potencia) {
+        int32_t t9 = mfhi(x, q->magico);
+        if (q->correcao > 0) t9 = addu(t9, x);
+        if (q->correcao < 0) t9 = subu(t9, x);
+        t9 = sra(t9, q->deslocamento);
+        r = srl(t9, 31);
+        r = addu(t9, r);
+    }
+    if (q->negativo) r = subu(0, r);
+    return r;
+}
+
+// --- Conferências ---
+
+static uint32_t g_semente = 12345;
+
+static int32_t aleatorio(void) {
+    g_semente = g_semente * 1103515245u + 12345u;
+    uint32_t alto = g_semente >> 16;
+    g_semente = g_semente * 1103515245u + 12345u;
+    return (int32_t) ((alto << 16) | (g_semente >> 16));
+}
+
+// Valores de x que costumam quebrar as sequências com a constante c
+static int amostras(int32_t c, int32_t* x) {
+    int n = 0;
+    const int32_t fixos[] = { 0, 1, -1, 2, -2, INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1 };
+    for (unsigned i = 0; i < sizeof(fixos) / sizeof(fixos[0]); i++) x[n++] = fixos[i];
+    // Vizinhos de múltiplos de c, perto de zero e dos extremos
+    const int32_t bases[] = { 1, 2, 1000, INT32_MAX / (c < 0 ? -(int64_t) c : c), INT32_MIN / (c < 0 ? -(int64_t) c : c) };
+    for (unsigned i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        int32_t m = mul_mips(bases[i], c);
+        for (int32_t v = -1; v <= 1; v++) {
+            x[n++] = addu(m, v);
+            x[n++] = subu(subu(0, m), v);
+        }
+    }
+    for (int i = 0; i < 64; i++) x[n++] = aleatorio();
+    return n;
+}
+
+static void conferir_multiplicacao(int32_t k, int exaustivo) {
+    MultiplicacaoConstante m;
+    if (multiplicacao_constante(k, &m) != 0) return;
+    if (exaustivo) {
+        const MultiplicacaoConstante plano = m;
+        uint32_t u = 0;
+        do {
+            int32_t x = (int32_t) u, r = multiplicar(x, &plano);
+            if (r != mul_mips(x, k)) CONFERIR(0, "%d * %d: %d, esperado %d", x, k, r, mul_mips(x, k));
+        } while (++u != 0);
+        return;
+    }
+    int32_t x[128];
+    int n = amostras(k, x);
+    for (int i = 0; i < n; i++) {
+        CONFERIR(multiplicar(x[i], &m) == mul_mips(x[i], k), "%d * %d: %d, esperado %d", x[i], k, multiplicar(x[i], &m),
+                 mul_mips(x[i], k));
+    }
+}
+
+static void conferir_divisao(int32_t d) {
+    DivisaoConstante q;
+    CONFERIR(divisao_constante(d, &q) == 0, "sem sequencia para / %d", d);
+    int32_t x[128];
+    int n = amostras(d, x);
+    for (int i = 0; i < n; i++) {
+        CONFERIR(dividir(x[i], &q) == div_mips(x[i], d), "%d / %d: %d, esperado %d", x[i], d, dividir(x[i], &q),
+                 div_mips(x[i], d));
+    }
+}
+
+/*
+ * Todos os x para um divisor d literal: a divisão de referência, com d
+ * conhecido, o próprio compilador C troca por uma multiplicação, e os 2^32
+ * valores cabem em poucos segundos.
+ */
+#define DIVISAO_EXAUSTIVA(d) do { \
+    DivisaoConstante q; \
+    CONFERIR(divisao_constante(d, &q) == 0, "sem sequencia para / %d", d); \
+    const DivisaoConstante plano = q; \
+    uint32_t u = 0; \
+    do { \
+        int32_t x = (int32_t) u, r = dividir(x, &plano); \
+        if (r != div_mips(x, d)) CONFERIR(0, "%d / %d: %d, esperado %d", x, d, r, div_mips(x, d)); \
+    } while (++u != 0); \
+} while (0)
+
+// --- O código emitido, no simulador ---
+
+#define CONSTANTES_POR_PROGRAMA 16
+#define MAXIMO_AMOSTRAS 128
+
+static const char* g_simulador;
+
+// A linguagem não tem literais negativos: c vira uma subtração que o -O1 dobra
+static void escrever_constante(FILE* f, int32_t c) {
+    if (c == INT32_MIN) {
+        fprintf(f, "(0 - 2147483647 - 1)");
+    } else if (c < 0) {
+        fprintf(f, "(0 - %d)", -c);
+    } else {
+        fprintf(f, "%d", c);
+    }
+}
+
+static int contar_instrucoes(const char* assembly, const char* instrucao) {
+    int n = 0;
+    for (const char* p = assembly; (p = strstr(p, instrucao)) != NULL; p++) n++;
+    return n;
+}
+
+// Executa 'arquivo' no simulador com as entradas dadas; a saída fica em 'saida'
+// e as mensagens do simulador (custo ou erro), em 'erros'. Retorna o número de
+// valores lidos, ou -1 se a simulação falhou.
+static int simular(const char* arquivo, const char* erros, const int32_t* entradas, int num_entradas,
+                   int32_t* saida, int maximo) {
+    char** argumentos = (char**) malloc(sizeof(char*) * (num_entradas + 3));
+    char* textos = (char*) malloc((size_t) num_entradas * 12);
+    if (argumentos == NULL || textos == NULL) return -1;
+    argumentos[0] = (char*) g_simulador;
+    argumentos[1] = (char*) arquivo;
+    for (int i = 0; i < num_entradas; i++) {
+        argumentos[i + 2] = textos + (size_t) i * 12;
+        sprintf(argumentos[i + 2], "%d", entradas[i]);
+    }
+    argumentos[num_entradas + 2] = NULL;
+
+    int canal[2];
+    if (pipe(canal) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(canal[1], STDOUT_FILENO);
+        close(canal[0]);
+        if (freopen(erros, "w", stderr) == NULL) _exit(127);
+        execv(g_simulador, argumentos);
+        perror("execv");
+        _exit(127);
+    }
+    close(canal[1]);
+    free(argumentos);
+    free(textos);
+
+    FILE* resultado = fdopen(canal[0], "r");
+    int n = 0;
+    int valor;
+    while (n < maximo && fscanf(resultado, "%d", &valor) == 1) saida[n++] = valor;
+    fclose(resultado);
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? n : -1;
+}
+
+// Um programa com as 'n' constantes: para cada uma, lê os x dela e escreve x * c e x / c
+static void conferir_emitido(const int32_t* constantes, int n) {
+    static int32_t entradas[CONSTANTES_POR_PROGRAMA * (MAXIMO_AMOSTRAS + 1)];
+    static int32_t esperado[CONSTANTES_POR_PROGRAMA * MAXIMO_AMOSTRAS * 2];
+    static int32_t obtido[CONSTANTES_POR_PROGRAMA * MAXIMO_AMOSTRAS * 2 + 1];
+    static struct { int32_t x, c; } casos[CONSTANTES_POR_PROGRAMA * MAXIMO_AMOSTRAS];
+    char* texto;
+    size_t tamanho;
+    FILE* programa = open_memstream(&texto, &tamanho);
+    int num_entradas = 0, num_esperados = 0, sem_sequencia = 0;
+
+    fprintf(programa, "programa {\n\tint i, x;\n");
+    for (int k = 0; k < n; k++) {
+        int32_t c = constantes[k];
+        MultiplicacaoConstante m;
+        sem_sequencia += multiplicacao_constante(c, &m) != 0;
+
+        int32_t x[MAXIMO_AMOSTRAS];
+        int num_x = amostras(c, x);
+        fprintf(programa, "\tleia i;\n\tenquanto (i > 0) execute {\n\t\tleia x;\n\t\tescreva x * ");
+        escrever_constante(programa, c);
+        fprintf(programa, "; novalinha;\n\t\tescreva x / ");
+        escrever_constante(programa, c);
+        fprintf(programa, "; novalinha;\n\t\ti = i - 1;\n\t}\n");
+        entradas[num_entradas++] = num_x;
+        for (int i = 0; i < num_x; i++) {
+            entradas[num_entradas++] = x[i];
+            casos[num_esperados / 2].x = x[i];
+            casos[num_esperados / 2].c = c;
+            esperado[num_esperados++] = mul_mips(x[i], c);
+            esperado[num_esperados++] = div_mips(x[i], c);
+        }
+    }
+    fprintf(programa, "}\n");
+    fclose(programa);
+
+    CompilerContext* ctx = compilador_criar();
+    ctx->nivel_otimizacao = 1;
+    if (compilar_memoria(ctx, texto, tamanho) != 0) {
+        CONFERIR(0, "programa das constantes %d a %d nao compila:\n%s", constantes[0], constantes[n - 1],
+                 compilador_diagnosticos(ctx, NULL));
+        compilador_destruir(ctx);
+        free(texto);
+        return;
+    }
+    const char* assembly = compilador_assembly(ctx, NULL);
+    CONFERIR(contar_instrucoes(assembly, "  div ") == 0, "'div' no codigo das constantes %d a %d", constantes[0],
+             constantes[n - 1]);
+    CONFERIR(contar_instrucoes(assembly, "  mul ") == sem_sequencia, "%d 'mul' no codigo das constantes %d a %d, esperado %d",
+             contar_instrucoes(assembly, "  mul "), constantes[0], constantes[n - 1], sem_sequencia);
+
+    char arquivo[] = "/tmp/teste_aritmetica.XXXXXX";
+    int fd = mkstemp(arquivo);
+    if (fd < 0 || write(fd, assembly, strlen(assembly)) != (ssize_t) strlen(assembly)) {
+        perror(arquivo);
+        exit(1);
+    }
+    close(fd);
+    char erros[sizeof(arquivo) + 6];
+    sprintf(erros, "%s.erros", arquivo);
+    int lidos = simular(arquivo, erros, entradas, num_entradas, obtido, num_esperados + 1);
+    if (lidos != num_esperados) {
+        CONFERIR(0, "constantes %d a %d: simulador escreveu %d valores, esperado %d", constantes[0],
+                 constantes[n - 1], lidos, num_esperados);
+        size_t tamanho;
+        char* mensagens = ler_arquivo(erros, &tamanho);
+        if (mensagens != NULL) fwrite(mensagens, 1, tamanho, stdout);
+        free(mensagens);
+    }
+    for (int i = 0; i + 1 < num_esperados && i + 1 < lidos; i += 2) {
+        int32_t x = casos[i / 2].x, c = casos[i / 2].c;
+        CONFERIR(obtido[i] == esperado[i], "codigo emitido: %d * %d: %d, esperado %d", x, c, obtido[i], esperado[i]);
+        CONFERIR(obtido[i + 1] == esperado[i + 1], "codigo emitido: %d / %d: %d, esperado %d", x, c, obtido[i + 1],
+                 esperado[i + 1]);
+    }
+    unlink(arquivo);
+    unlink(erros);
+    compilador_destruir(ctx);
+    free(texto);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Uso: %s ./simulador_mips\n", argv[0]);
+        return 1;
+    }
+    g_simulador = argv[1];
+
+    // Todos os x: números mágicos com correção para mais, para menos e sem
+    // ela, uma potência de dois negativa e o extremo negativo
+    DIVISAO_EXAUSTIVA(7);
+    DIVISAO_EXAUSTIVA(-7);
+    DIVISAO_EXAUSTIVA(10);
+    DIVISAO_EXAUSTIVA(-1024);
+    DIVISAO_EXAUSTIVA(INT32_MIN);
+    conferir_multiplicacao(-24, 1);
+
+    int32_t sequencias = 0;
+    for (int32_t c = -65536; c <= 65536; c++) {
+        MultiplicacaoConstante m;
+        sequencias += multiplicacao_constante(c, &m) == 0;
+        conferir_multiplicacao(c, 0);
+        if (c != 0) conferir_divisao(c);
+    }
+    for (int32_t c = 0; c < 65536; c++) {
+        conferir_multiplicacao(INT32_MAX - c, 0);
+        conferir_multiplicacao(INT32_MIN + c, 0);
+        conferir_divisao(INT32_MAX - c);
+        conferir_divisao(INT32_MIN + c);
+    }
+    for (int i = 0; i < 100000; i++) {
+        int32_t c = aleatorio();
+        conferir_multiplicacao(c, 0);
+        if (c != 0) conferir_divisao(c);
+    }
+    MultiplicacaoConstante m;
+    DivisaoConstante q;
+    CONFERIR(multiplicacao_constante(0, &m) != 0 && divisao_constante(0, &q) != 0, "constante zero aceita");
+
+    // O código emitido: de -64 a 64, potências de dois e vizinhas, os
+    // extremos, constantes sem sequência e aleatórias
+    int32_t constantes[512];
+    int num_constantes = 0;
+    for (int32_t c = -64; c <= 64; c++) {
+        if (c != 0) constantes[num_constantes++] = c;
+    }
+    for (int k = 7; k <= 30; k++) {
+        int32_t p = (int32_t) 1 << k;
+        const int32_t vizinhas[] = { p, -p, p - 1, p + 1, -(p - 1), -(p + 1) };
+        for (unsigned i = 0; i < sizeof(vizinhas) / sizeof(vizinhas[0]); i++) constantes[num_constantes++] = vizinhas[i];
+    }
+    const int32_t avulsas[] = { INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 1, 641, 1000, -1000, 1001,
+                                100000, 6700417, 1162261467, 0x12345, -0x12345, 0x7654321 };
+    for (unsigned i = 0; i < sizeof(avulsas) / sizeof(avulsas[0]); i++) constantes[num_constantes++] = avulsas[i];
+    for (int i = 0; i < 64; i++) {
+        int32_t c = aleatorio();
+        if (c != 0) constantes[num_constantes++] = c;
+    }
+    for (int i = 0; i < num_constantes; i += CONSTANTES_POR_PROGRAMA) {
+        int n = num_constantes - i < CONSTANTES_POR_PROGRAMA ? num_constantes - i : CONSTANTES_POR_PROGRAMA;
+        conferir_emitido(constantes + i, n);
+    }
+
+    if (g_falhas > 0) {
+        printf("%d falha(s)\n", g_falhas);
+        return 1;
+    }
+    printf("Multiplicacao e divisao por constantes conferidas (%d fatores de -2^16 a 2^16 sem 'mul'; "
+           "codigo emitido de %d constantes executado no simulador)\n",
+           sequencias, num_constantes);
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * Grava no cache (cache.h) a compilação de cada programa de teste e confere
+ * que a entrada encontrada reconstrói a mesma AST anotada e o mesmo assembly,
+ * que regenerar o código a partir da AST restaurada dá o mesmo resultado, que
+ * entradas corrompidas contam como falta e que a remoção respeita o limite,
+ * mantendo as entradas usadas por último.
+ *
+ * Uso: teste_cache DIRETORIO arquivo.g...
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "compilador.h"
+#include "cache.h"
+#include "gerador_codigo.h"
+#include "conferencia.h"
+
+static char* caminho_da_chave(const char* diretorio, ChaveCache chave) {
+    char* caminho = malloc(strlen(diretorio) + 64);
+    sprintf(caminho, "%s/%016llx%016llx.ent", diretorio,
+            (unsigned long long) chave.h[0], (unsigned long long) chave.h[1]);
+    return caminho;
+}
+
+/* As duas árvores têm os mesmos nós, filhos e folhas (lexemas pelo texto) */
+static int asts_iguais(const Ast* a, NoAst raiz_a, const Ast* b, NoAst raiz_b) {
+    if (raiz_a != raiz_b || a->num_nos != b->num_nos || a->num_filhos != b->num_filhos ||
+        a->num_folhas != b->num_folhas) {
+        return 0;
+    }
+    uint32_t n = a->num_nos;
+    if (memcmp(a->tipo, b->tipo, n) != 0 || memcmp(a->tipo_dado, b->tipo_dado, n) != 0 ||
+        memcmp(a->primeiro_filho, b->primeiro_filho, n * sizeof(uint32_t)) != 0 ||
+        memcmp(a->prox, b->prox, n * sizeof(NoAst)) != 0 ||
+        memcmp(a->linha, b->linha, n * sizeof(uint32_t)) != 0 ||
+        memcmp(a->dado, b->dado, n * sizeof(int32_t)) != 0 ||
+        memcmp(a->filhos, b->filhos, a->num_filhos * sizeof(NoAst)) != 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < a->num_folhas; i++) {
+        const FolhaAst* x = &a->folhas[i];
+        const FolhaAst* y = &b->folhas[i];
+        if (x->tamanho != y->tamanho || memcmp(x->lexema, y->lexema, (size_t) x->tamanho) != 0 ||
+            x->valor != y->valor || x->lig.classe != y->lig.classe || x->lig.slot != y->lig.slot) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Regera o assembly a partir da AST restaurada */
+static int regerar_igual(CompilerContext* ctx) {
+    char* texto = NULL;
+    size_t tamanho = 0;
+    FILE* saida = open_memstream(&texto, &tamanho);
+    int ok = gerar_codigo(&ctx->ast, ctx->raiz, saida, compilador_convencao(ctx)) == 0;
+    fclose(saida);
+    size_t esperado;
+    const char* assembly = compilador_assembly(ctx, &esperado);
+    ok = ok && tamanho == esperado && memcmp(texto, assembly, tamanho) == 0;
+    free(texto);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s DIRETORIO arquivo.g...\n", argv[0]);
+        return 1;
+    }
+    const char* diretorio = argv[1];
+
+    CacheCompilacao cache;
+    if (cache_abrir(&cache, diretorio, 0) != 0) {
+        perror(diretorio);
+        return 1;
+    }
+    cache_podar(&cache, 0); /* Começa vazio */
+
+    int compilados = 0;
+    uint64_t bytes = 0;
+    ChaveCache primeira = { { 0, 0 } }, ultima = { { 0, 0 } };
+    for (int i = 2; i < argc; i++) {
+        size_t tamanho;
+        char* texto = ler_arquivo(argv[i], &tamanho);
+        if (texto == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+
+        CompilerContext* ctx = compilador_criar();
+        if (compilar_memoria(ctx, texto, tamanho) != 0) {
+            /* Programas com erros não são guardados */
+            compilador_destruir(ctx);
+            free(texto);
+            continue;
+        }
+        compilados++;
+
+        ChaveCache chave = cache_chave(&cache, "", texto, tamanho);
+        ChaveCache outra = cache_chave(&cache, "-O1", texto, tamanho);
+        CONFERIR(chave.h[0] != outra.h[0] || chave.h[1] != outra.h[1],
+                 "%s: opcoes diferentes deram a mesma chave", argv[i]);
+
+        EntradaCache entrada;
+        CONFERIR(!cache_buscar(&cache, chave, &entrada), "%s: acerto antes da gravacao", argv[i]);
+        size_t n;
+        const char* assembly = compilador_assembly(ctx, &n);
+        CONFERIR(cache_gravar(&cache, chave, &ctx->ast, ctx->raiz, assembly, n) == 0,
+                 "%s: gravacao falhou", argv[i]);
+
+        if (cache_buscar(&cache, chave, &entrada)) {
+            size_t m;
+            const char* guardado = cache_assembly(&entrada, &m);
+            CONFERIR(m == n && memcmp(guardado, assembly, n) == 0, "%s: assembly diferente", argv[i]);
+
+            CompilerContext* restaurado = compilador_criar();
+            CONFERIR(cache_restaurar(&entrada, restaurado) == 0, "%s: restauracao falhou", argv[i]);
+            CONFERIR(asts_iguais(&ctx->ast, ctx->raiz, &restaurado->ast, restaurado->raiz),
+                     "%s: AST restaurada diferente", argv[i]);
+            CONFERIR(regerar_igual(restaurado), "%s: codigo regerado da AST restaurada difere", argv[i]);
+            compilador_destruir(restaurado);
+            cache_liberar_entrada(&entrada);
+        } else {
+            CONFERIR(0, "%s: falta logo depois da gravacao", argv[i]);
+        }
+
+        char* caminho = caminho_da_chave(diretorio, chave);
+        struct stat info;
+        if (stat(caminho, &info) == 0) bytes += (uint64_t) info.st_size;
+        free(caminho);
+        if (compilados == 1) primeira = chave;
+        ultima = chave;
+
+        compilador_destruir(ctx);
+        free(texto);
+    }
+
+    /* Um byte trocado no meio da entrada: falta (e a entrada é descartada) */
+    if (compilados > 0) {
+        char* caminho = caminho_da_chave(diretorio, ultima);
+        FILE* f = fopen(caminho, "r+b");
+        struct stat info;
+        if (f != NULL && stat(caminho, &info) == 0) {
+            fseek(f, info.st_size / 2, SEEK_SET);
+            int c = fgetc(f);
+            fseek(f, info.st_size / 2, SEEK_SET);
+            fputc(c ^ 0x5a, f);
+            fclose(f);
+            EntradaCache entrada;
+            CONFERIR(!cache_buscar(&cache, ultima, &entrada), "entrada corrompida aceita");
+            CONFERIR(stat(caminho, &info) != 0, "entrada corrompida nao foi descartada");
+        }
+        free(caminho);
+    }
+
+    /* Remoção: usa a primeira entrada por último e poda para metade dos bytes */
+    if (compilados > 2) {
+        struct timespec espera = { 0, 20 * 1000 * 1000 };
+        nanosleep(&espera, NULL);
+        EntradaCache entrada;
+        if (cache_buscar(&cache, primeira, &entrada)) cache_liberar_entrada(&entrada);
+        cache_podar(&cache, bytes / 2);
+
+        uint64_t restante = 0;
+        DIR* dir = opendir(diretorio);
+        struct dirent* d;
+        while ((d = readdir(dir)) != NULL) {
+            size_t t = strlen(d->d_name);
+            if (t > 4 && strcmp(d->d_name + t - 4, ".ent") == 0) {
+                char* caminho = malloc(strlen(diretorio) + t + 2);
+                sprintf(caminho, "%s/%s", diretorio, d->d_name);
+                struct stat info;
+                if (stat(caminho, &info) == 0) restante += (uint64_t) info.st_size;
+                free(caminho);
+            }
+        }
+        closedir(dir);
+        CONFERIR(restante <= bytes / 2, "poda deixou %llu bytes (limite %llu)",
+                 (unsigned long long) restante, (unsigned long long) (bytes / 2));
+        char* caminho = caminho_da_chave(diretorio, primeira);
+        struct stat info;
+        CONFERIR(stat(caminho, &info) == 0, "a entrada usada por ultimo foi removida");
+        free(caminho);
+    }
+
+    cache_imprimir_estatisticas(stdout, &cache);
+    cache_fechar(&cache);
+    regiao_liberar_cache();
+    printf("%d programas guardados e restaurados: %s\n", compilados, g_falhas == 0 ? "ok" : "FALHAS");
+    return g_falhas != 0;
+}
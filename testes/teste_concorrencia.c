@@ -0,0 +1,130 @@
+/*
+ * Compila os programas passados na linha de comando em várias threads ao
+ * mesmo tempo, pela API de compilador.h, e confere que cada compilação produz
+ * exatamente o assembly e os diagnósticos de uma compilação isolada.
+ *
+ * Uso: teste_concorrencia [--threads=N] [--repeticoes=N] arquivo.g...
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "compilador.h"
+
+typedef struct {
+    const char* nome;
+    char* texto;
+    size_t tamanho;
+    char* assembly;       /* Resultado de referência (NULL se não compilou) */
+    char* diagnosticos;
+} Programa;
+
+static Programa* g_programas;
+static int g_num_programas;
+static int g_repeticoes = 20;
+
+static char* duplicar(const char* texto) {
+    if (texto == NULL) return NULL;
+    size_t n = strlen(texto) + 1;
+    char* copia = malloc(n);
+    memcpy(copia, texto, n);
+    return copia;
+}
+
+static int iguais(const char* a, const char* b) {
+    if (a == NULL || b == NULL) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+/* Compila 'p' num contexto novo; devolve 1 se o resultado bate com a referência */
+static int compilar_e_conferir(Programa* p, int gravar_referencia) {
+    CompilerContext* ctx = compilador_criar();
+    if (ctx == NULL) return 0;
+    compilar_memoria(ctx, p->texto, p->tamanho);
+
+    const char* assembly = compilador_assembly(ctx, NULL);
+    const char* diagnosticos = compilador_diagnosticos(ctx, NULL);
+    int ok = 1;
+    if (gravar_referencia) {
+        p->assembly = duplicar(assembly);
+        p->diagnosticos = duplicar(diagnosticos);
+    } else {
+        ok = iguais(assembly, p->assembly) && iguais(diagnosticos, p->diagnosticos);
+    }
+    compilador_destruir(ctx);
+    return ok;
+}
+
+static void* executar_thread(void* arg) {
+    long falhas = 0;
+    int deslocamento = (int) (long) arg;
+    for (int r = 0; r < g_repeticoes; r++) {
+        for (int i = 0; i < g_num_programas; i++) {
+            /* Cada thread percorre os programas numa ordem diferente */
+            Programa* p = &g_programas[(i + deslocamento) % g_num_programas];
+            if (!compilar_e_conferir(p, 0)) {
+                fprintf(stderr, "Divergencia em %s\n", p->nome);
+                falhas++;
+            }
+        }
+    }
+    return (void*) falhas;
+}
+
+int main(int argc, char** argv) {
+    int num_threads = 8;
+    g_programas = calloc((size_t) argc, sizeof(Programa));
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--threads=", 10) == 0) {
+            num_threads = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--repeticoes=", 13) == 0) {
+            g_repeticoes = atoi(argv[i] + 13);
+        } else {
+            FonteMapeada fonte;
+            FILE* entrada = fopen(argv[i], "r");
+            if (entrada == NULL || ler_fonte(entrada, &fonte) != 0) {
+                fprintf(stderr, "Erro: Nao foi possivel ler '%s'\n", argv[i]);
+                return 1;
+            }
+            fclose(entrada);
+            Programa* p = &g_programas[g_num_programas++];
+            p->nome = argv[i];
+            p->texto = fonte.dados;
+            p->tamanho = fonte.tamanho;
+        }
+    }
+    if (g_num_programas == 0 || num_threads < 1) {
+        fprintf(stderr, "Uso: %s [--threads=N] [--repeticoes=N] arquivo.g...\n", argv[0]);
+        return 1;
+    }
+
+    /* Referência: uma compilação de cada programa, sozinha */
+    for (int i = 0; i < g_num_programas; i++) {
+        compilar_e_conferir(&g_programas[i], 1);
+    }
+
+    pthread_t* threads = malloc(sizeof(pthread_t) * (size_t) num_threads);
+    for (int t = 0; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, executar_thread, (void*) (long) t);
+    }
+    long falhas = 0;
+    for (int t = 0; t < num_threads; t++) {
+        void* resultado;
+        pthread_join(threads[t], &resultado);
+        falhas += (long) resultado;
+    }
+
+    long total = (long) num_threads * g_repeticoes * g_num_programas;
+    printf("%ld compilacoes em %d threads: %ld divergencias\n", total, num_threads, falhas);
+
+    for (int i = 0; i < g_num_programas; i++) {
+        free(g_programas[i].texto);
+        free(g_programas[i].assembly);
+        free(g_programas[i].diagnosticos);
+    }
+    free(g_programas);
+    free(threads);
+    regiao_liberar_cache();
+    return falhas != 0;
+}
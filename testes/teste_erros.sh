@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Confere que cada programa de teste com erro (nome com "Erro" ou "erro") é
+# rejeitado pelo compilador, e que os diagnósticos da análise semântica
+# listados abaixo aparecem com a linha certa.
+#
+# Uso: teste_erros.sh
+
+# --- CONFIGURAÇÕES ---
+DIRETORIO_SCRIPT="$(cd "$(dirname "$0")" && pwd)"
+DIRETORIO_ENTRADA="$DIRETORIO_SCRIPT/programas_teste"
+EXECUTAVEL="${EXECUTAVEL:-$DIRETORIO_SCRIPT/../analisadores/goianinha}"
+TRABALHO="$(mktemp -d /tmp/teste_erros.XXXXXX)"
+
+# Programa e diagnóstico esperado, um por linha
+DIAGNOSTICOS="
+escrevaErroLin5IdentificadorNaoDeclarado.g|ERRO SEMANTICO (Linha 5): Identificador 'm' nao declarado.
+leiaErroLin8FuncaoNaoEhVariavel.g|ERRO SEMANTICO (Linha 8): Variavel 'dobro' nao declarada.
+fatorialErroLin3NomeDeclaradoNoMesmoEscopo.g|ERRO SEMANTICO (Linha 3): Variavel 'n' ja declarada neste escopo.
+"
+
+if [ ! -x "$EXECUTAVEL" ]; then
+    echo "Erro: O executável '$EXECUTAVEL' não foi encontrado ou não tem permissão de execução."
+    exit 1
+fi
+
+status=0
+for arquivo in "$DIRETORIO_ENTRADA"/*[Ee]rro*.g; do
+    nome=$(basename -- "$arquivo")
+    if (cd "$TRABALHO" && "$EXECUTAVEL" "$arquivo" > "$TRABALHO/$nome.txt" 2>&1); then
+        echo "  [ERRO] $nome foi aceito"
+        status=1
+    fi
+done
+
+echo "$DIAGNOSTICOS" | while IFS='|' read -r nome mensagem; do
+    [ -z "$nome" ] && continue
+    if ! grep -qF "$mensagem" "$TRABALHO/$nome.txt"; then
+        echo "  [ERRO] $nome: esperado \"$mensagem\", obtido:"
+        cat "$TRABALHO/$nome.txt"
+        exit 1
+    fi
+done || status=1
+
+rm -rf "$TRABALHO"
+if [ $status -eq 0 ]; then
+    echo "Todos os programas com erro foram rejeitados com os diagnósticos esperados."
+fi
+exit $status
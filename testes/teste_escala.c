@@ -0,0 +1,90 @@
+/*
+ * Gera programas com 10^5 a 10^6 declarações, variáveis e comandos e mede a
+ * análise sintática de cada um pela API de compilador.h. Com as listas da
+ * gramática anexadas em O(1), o tempo por elemento não pode crescer com o
+ * tamanho do programa; o teste falha se o maior programa de cada forma for
+ * mais de FATOR_MAXIMO vezes mais lento, por elemento, que o menor.
+ *
+ * Uso: teste_escala [--maximo=N]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "compilador.h"
+#include "programas_gerados.h"
+
+#define FATOR_MAXIMO 3.0
+
+static const Forma g_formas[] = {
+    { "declaracoes globais", "", "int g%d;\n", "", "", "", "programa { }\n" },
+    { "variaveis numa declaracao", "int v", "%d", ", v", "", "", ";\nprograma { }\n" },
+    { "declaracoes locais", "programa {\n", "int l%d;\n", "", "", "", "}\n" },
+    { "comandos num bloco", "programa {\nint x;\n", "x = %d;\n", "", "", "", "}\n" },
+    { "parametros", "int f(int p", "%d", ", int p", "", "", ") { }\nprograma { }\n" },
+    { "argumentos", "programa {\nescreva f(", "%d", ", ", "", "", ");\n}\n" },
+};
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* Segundos gastos só na análise sintática (o texto já tokenizado), ou -1 */
+static double medir_analise(const char* texto, size_t tamanho) {
+    CompilerContext* ctx = compilador_criar();
+    if (ctx == NULL) return -1;
+    ctx->varredor = VARREDOR_PRE_TOKENIZADO;
+    double segundos = -1;
+    if (compilador_carregar_memoria(ctx, texto, tamanho) == 0 && compilador_iniciar_varredor(ctx) == 0) {
+        double inicio = agora();
+        int resultado = compilador_analisar(ctx);
+        if (resultado == 0) segundos = agora() - inicio;
+    }
+    compilador_destruir(ctx);
+    return segundos;
+}
+
+int main(int argc, char** argv) {
+    int maximo = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--maximo=", 9) == 0) {
+            maximo = atoi(argv[i] + 9);
+        } else {
+            fprintf(stderr, "Uso: %s [--maximo=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    const int tamanhos[] = { maximo / 10, maximo / 4, maximo / 2, maximo };
+    const int num_tamanhos = sizeof(tamanhos) / sizeof(tamanhos[0]);
+    int falhas = 0;
+
+    for (size_t f = 0; f < sizeof(g_formas) / sizeof(g_formas[0]); f++) {
+        const Forma* forma = &g_formas[f];
+        double menor = 0, maior = 0;
+        printf("%s:\n", forma->nome);
+        for (int t = 0; t < num_tamanhos; t++) {
+            size_t tamanho;
+            char* texto = gerar_programa(forma, tamanhos[t], &tamanho);
+            double segundos = medir_analise(texto, tamanho);
+            free(texto);
+            if (segundos < 0) {
+                printf("  %8d elementos: erro na analise\n", tamanhos[t]);
+                falhas++;
+                break;
+            }
+            double por_elemento = segundos * 1e9 / tamanhos[t];
+            printf("  %8d elementos: %8.2f ms (%6.1f ns/elemento)\n", tamanhos[t], segundos * 1e3, por_elemento);
+            if (t == 0) menor = por_elemento;
+            maior = por_elemento;
+        }
+        if (menor > 0 && maior > FATOR_MAXIMO * menor) {
+            printf("  ERRO: crescimento nao linear (%.1fx por elemento)\n", maior / menor);
+            falhas++;
+        }
+    }
+    regiao_liberar_cache();
+    return falhas != 0;
+}
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# Compila cada programa de teste sem otimizações (-O0) e com elas (-O1),
+# executa os dois no simulador (simulador_mips.c) com as mesmas entradas e
+# confere que a saída é a mesma. Mostra as instruções executadas em cada
+# nível: as otimizações não podem mudar o resultado, só o custo.
+#
+# Uso: teste_otimizacao.sh [opcoes do nivel otimizado]
+
+# --- CONFIGURAÇÕES ---
+DIRETORIO_SCRIPT="$(cd "$(dirname "$0")" && pwd)"
+DIRETORIO_ENTRADA="$DIRETORIO_SCRIPT/programas_teste"
+EXECUTAVEL="${EXECUTAVEL:-$DIRETORIO_SCRIPT/../analisadores/goianinha}"
+SIMULADOR="${SIMULADOR:-$DIRETORIO_SCRIPT/../analisadores/simulador_mips}"
+ENTRADAS="5 3 8 1 9 2 7 4 6 0"
+OTIMIZADO="${*:--O1}"
+TRABALHO="$(mktemp -d /tmp/teste_otimizacao.XXXXXX)"
+
+for programa in "$EXECUTAVEL" "$SIMULADOR"; do
+    if [ ! -x "$programa" ]; then
+        echo "Erro: O executável '$programa' não foi encontrado ou não tem permissão de execução."
+        exit 1
+    fi
+done
+
+# Compila 'arquivo' com as opções dadas e executa; deixa a saída em $1.saida
+# e o custo em $1.custo. Retorna 1 se o programa não compila.
+executar() {
+    local nome="$1" arquivo="$2"
+    shift 2
+    (cd "$TRABALHO" && "$EXECUTAVEL" "$@" "$arquivo" > /dev/null 2>&1) || return 1
+    "$SIMULADOR" "$TRABALHO/saida.asm" $ENTRADAS > "$TRABALHO/$nome.saida" 2> "$TRABALHO/$nome.custo"
+    echo "status $?" >> "$TRABALHO/$nome.saida"
+    return 0
+}
+
+status=0
+total_base=0
+total_otimizado=0
+printf "%-45s %12s %12s\n" "programa" "-O0" "$OTIMIZADO"
+for arquivo in "$DIRETORIO_ENTRADA"/*.g; do
+    nome="$(basename "$arquivo" .g)"
+    executar base "$arquivo" -O0 || continue
+    if ! executar otimizado "$arquivo" $OTIMIZADO; then
+        echo "  [ERRO] $nome compila com -O0 mas não com $OTIMIZADO"
+        status=1
+        continue
+    fi
+
+    base=$(sed -n 's/^instrucoes=\([0-9]*\).*/\1/p' "$TRABALHO/base.custo")
+    otimizado=$(sed -n 's/^instrucoes=\([0-9]*\).*/\1/p' "$TRABALHO/otimizado.custo")
+    printf "%-45s %12s %12s\n" "$nome" "${base:-erro}" "${otimizado:-erro}"
+    if ! cmp -s "$TRABALHO/base.saida" "$TRABALHO/otimizado.saida"; then
+        echo "  [ERRO] Saídas diferentes:"
+        diff "$TRABALHO/base.saida" "$TRABALHO/otimizado.saida" | head -10
+        status=1
+    fi
+    total_base=$((total_base + ${base:-0}))
+    total_otimizado=$((total_otimizado + ${otimizado:-0}))
+done
+printf "%-45s %12s %12s\n" "total" "$total_base" "$total_otimizado"
+
+rm -rf "$TRABALHO"
+exit $status
@@ -0,0 +1,85 @@
+/*
+ * Compila, pela API de compilador.h, programas com 10^6 termos numa
+ * expressão ou numa condição e aninhamentos de 10^6 níveis, sem e com
+ * otimizações. A compilação roda numa thread com pilha de PILHA_THREAD
+ * bytes: as passagens sobre a AST percorrem a árvore com pilha explícita
+ * (percurso.h), então a profundidade do programa não pode depender da pilha
+ * de C.
+ *
+ * Uso: teste_profundidade [--maximo=N]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "compilador.h"
+#include "programas_gerados.h"
+
+#define PILHA_THREAD (256 * 1024)
+
+static const Forma g_formas[] = {
+    { "termos numa expressao", "programa {\nint x;\nx = 0", " + %d", "", ";\n", "", "escreva x;\n}\n" },
+    { "cadeia de senao se", "programa {\nint x;\nleia x;\n", "se (x == %d) entao escreva 1; senao\n", "", "escreva 0;\n", "", "}\n" },
+    { "parenteses aninhados", "programa {\nint x;\nx = ", "(", "", "%d", ")", ";\nescreva x;\n}\n" },
+    { "e e ou numa condicao", "programa {\nint x;\nleia x;\nse (x == 0", " e x != %d ou x > 5", "", ") entao escreva 1;\n", "", "}\n" },
+    { "negacoes aninhadas", "programa {\nint x;\nleia x;\nenquanto (", "!(", "", "x > %d", ")", ") execute x = x + 1;\n}\n" },
+};
+
+typedef struct {
+    const char* texto;
+    size_t tamanho;
+    int nivel_otimizacao;
+    int resultado;
+} Compilacao;
+
+static void* compilar(void* arg) {
+    Compilacao* c = (Compilacao*) arg;
+    CompilerContext* ctx = compilador_criar();
+    if (ctx != NULL) ctx->nivel_otimizacao = c->nivel_otimizacao;
+    c->resultado = ctx != NULL ? compilar_memoria(ctx, c->texto, c->tamanho) : -1;
+    if (ctx != NULL && c->resultado != 0) {
+        fputs(compilador_diagnosticos(ctx, NULL), stdout);
+    }
+    compilador_destruir(ctx);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    int maximo = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--maximo=", 9) == 0) {
+            maximo = atoi(argv[i] + 9);
+        } else {
+            fprintf(stderr, "Uso: %s [--maximo=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    pthread_attr_setstacksize(&atributos, PILHA_THREAD);
+
+    int falhas = 0;
+    for (size_t f = 0; f < sizeof(g_formas) / sizeof(g_formas[0]); f++) {
+        size_t tamanho;
+        char* texto = gerar_programa(&g_formas[f], maximo, &tamanho);
+
+        for (int nivel = 0; nivel <= 1; nivel++) {
+            Compilacao c = { texto, tamanho, nivel, -1 };
+            pthread_t thread;
+            if (pthread_create(&thread, &atributos, compilar, &c) != 0) {
+                fprintf(stderr, "Erro ao criar a thread\n");
+                return 1;
+            }
+            pthread_join(thread, NULL);
+
+            printf("%s (%d, -O%d): %s\n", g_formas[f].nome, maximo, nivel, c.resultado == 0 ? "ok" : "ERRO");
+            if (c.resultado != 0) falhas++;
+        }
+        free(texto);
+    }
+    pthread_attr_destroy(&atributos);
+    regiao_liberar_cache();
+    return falhas != 0;
+}
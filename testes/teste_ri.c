@@ -0,0 +1,276 @@
+/*
+ * Traduz cada programa de teste para a RI (ri.h), elimina a recursão final,
+ * integra as funções, otimiza os laços (eliminar_recursao_final,
+ * integrar_funcoes e otimizar_lacos) e confere as análises contra versões
+ * ingênuas: blocos terminados por exatamente um desvio, com os sucessores
+ * que ele pede; predecessores e pós-ordem reversa coerentes com os
+ * sucessores; dominadores iguais aos do fluxo de dados clássico
+ * (dom(b) = {b} ∪ ∩ dom(p)), sobre conjuntos de blocos; e vivos iguais aos
+ * da análise para trás sobre todos os registradores, inclusive os que a
+ * versão rápida deixa fora dos conjuntos. Depois de separar as variáveis em
+ * teias, confere de novo a vivacidade e a alocação de registradores: dois
+ * valores vivos ao mesmo tempo nunca dividem um registrador, e os vivos
+ * além de uma chamada num $t são salvos nela. Também gera o texto da RI e o
+ * assembly a partir dela.
+ *
+ * Uso: teste_ri arquivo.g...
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compilador.h"
+#include "ri.h"
+#include "gerador_ri.h"
+#include "alocador.h"
+#include "conferencia.h"
+
+static int eh_terminador(uint8_t op) {
+    return op == RI_SALTO || op == RI_DESVIO || op == RI_RETORNE;
+}
+
+static void conferir_blocos(const char* nome, const FuncaoRI* f) {
+    for (uint32_t b = 0; b < f->num_blocos; b++) {
+        const BlocoRI* bloco = &f->blocos[b];
+        CONFERIR(bloco->num_instrs > 0, "%s/%s: B%u vazio", nome, f->nome, b);
+        if (bloco->num_instrs == 0) continue;
+        for (uint32_t i = 0; i + 1 < bloco->num_instrs; i++) {
+            CONFERIR(!eh_terminador(RI_INSTR(f, b, i)->op), "%s/%s: desvio no meio de B%u", nome, f->nome, b);
+        }
+        uint8_t op = RI_TERMINADOR(f, b)->op;
+        int esperados = op == RI_SALTO ? 1 : op == RI_DESVIO ? 2 : 0;
+        CONFERIR(eh_terminador(op) && bloco->num_sucessores == esperados,
+                 "%s/%s: B%u termina com %d sucessores", nome, f->nome, b, bloco->num_sucessores);
+        for (int s = 0; s < bloco->num_sucessores; s++) {
+            CONFERIR(bloco->sucessor[s] < f->num_blocos, "%s/%s: B%u desvia para fora", nome, f->nome, b);
+        }
+    }
+}
+
+static void conferir_cfg(const char* nome, const FuncaoRI* f) {
+    // Cada aresta de um bloco alcançável aparece uma vez nos predecessores
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        CONFERIR(f->ordem_rpo[b] == i, "%s/%s: ordem_rpo de B%u", nome, f->nome, b);
+        const BlocoRI* bloco = &f->blocos[b];
+        for (int s = 0; s < bloco->num_sucessores; s++) {
+            uint32_t suc = bloco->sucessor[s];
+            int vezes = 0;
+            for (uint32_t p = f->inicio_pred[suc]; p < f->inicio_pred[suc + 1]; p++) vezes += f->pred[p] == b;
+            int arestas = 0;
+            for (int t = 0; t < bloco->num_sucessores; t++) arestas += bloco->sucessor[t] == suc;
+            CONFERIR(vezes == arestas, "%s/%s: B%u falta nos predecessores de B%u", nome, f->nome, b, suc);
+            CONFERIR(f->ordem_rpo[suc] != RI_NENHUM, "%s/%s: sucessor B%u inalcancavel", nome, f->nome, suc);
+        }
+    }
+    CONFERIR(f->num_rpo > 0 && f->rpo[0] == 0, "%s/%s: a entrada nao abre a ordem", nome, f->nome);
+}
+
+// Dominadores pelo fluxo de dados sobre conjuntos, e comparação com idom/ri_domina
+static void conferir_dominadores(const char* nome, const FuncaoRI* f) {
+    uint32_t n = f->num_blocos;
+    uint8_t* dom = malloc((size_t) n * n);
+    for (uint32_t b = 0; b < n; b++) memset(&dom[(size_t) b * n], b != 0, n);
+    dom[0] = 1;
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (uint32_t i = 1; i < f->num_rpo; i++) {
+            uint32_t b = f->rpo[i];
+            for (uint32_t a = 0; a < n; a++) {
+                uint8_t v = 1;
+                for (uint32_t p = f->inicio_pred[b]; p < f->inicio_pred[b + 1]; p++) v &= dom[(size_t) f->pred[p] * n + a];
+                if (a == b) v = 1;
+                if (v != dom[(size_t) b * n + a]) {
+                    dom[(size_t) b * n + a] = v;
+                    mudou = 1;
+                }
+            }
+        }
+    }
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        for (uint32_t j = 0; j < f->num_rpo; j++) {
+            uint32_t a = f->rpo[j];
+            CONFERIR(ri_domina(f, a, b) == dom[(size_t) b * n + a], "%s/%s: B%u domina B%u?", nome, f->nome, a, b);
+        }
+        // O dominador imediato é o dominador estrito dominado por todos os outros
+        if (i == 0) {
+            CONFERIR(f->idom[b] == RI_NENHUM, "%s/%s: idom da entrada", nome, f->nome);
+            continue;
+        }
+        uint32_t d = f->idom[b];
+        CONFERIR(d != RI_NENHUM && d != b && dom[(size_t) b * n + d], "%s/%s: idom(B%u)", nome, f->nome, b);
+        for (uint32_t a = 0; a < n && d != RI_NENHUM; a++) {
+            if (a != b && dom[(size_t) b * n + a]) {
+                CONFERIR(dom[(size_t) d * n + a], "%s/%s: idom(B%u) = B%u nao e o mais proximo", nome, f->nome, b, d);
+            }
+        }
+    }
+    free(dom);
+}
+
+// Vivacidade ingênua, sobre todos os registradores, e comparação
+static void conferir_vivacidade(const char* nome, const FuncaoRI* f) {
+    uint32_t n = f->num_blocos, r = f->num_regs;
+    uint8_t* entrada = calloc((size_t) n * r + 1, 1);
+    uint8_t* saida = calloc((size_t) n * r + 1, 1);
+    uint8_t* vivo = malloc(r + 1);
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (uint32_t i = f->num_rpo; i-- > 0;) {
+            uint32_t b = f->rpo[i];
+            const BlocoRI* bloco = &f->blocos[b];
+            memset(vivo, 0, r);
+            for (int s = 0; s < bloco->num_sucessores; s++) {
+                for (uint32_t x = 0; x < r; x++) vivo[x] |= entrada[(size_t) bloco->sucessor[s] * r + x];
+            }
+            memcpy(&saida[(size_t) b * r], vivo, r);
+            for (uint32_t j = bloco->num_instrs; j-- > 0;) {
+                const InstrRI* in = RI_INSTR(f, b, j);
+                RegRI d = ri_definicao(in);
+                if (d != RI_NENHUM) vivo[d] = 0;
+                RegRI usos[2];
+                int nu = ri_usos(in, usos);
+                for (int u = 0; u < nu; u++) vivo[usos[u]] = 1;
+                if (in->op == RI_CHAMADA) {
+                    for (uint32_t a = 0; a < in->b; a++) vivo[RI_ARGUMENTOS(f, in)[a]] = 1;
+                }
+            }
+            if (memcmp(&entrada[(size_t) b * r], vivo, r) != 0) {
+                memcpy(&entrada[(size_t) b * r], vivo, r);
+                mudou = 1;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        for (uint32_t x = 0; x < r; x++) {
+            CONFERIR(ri_vivo_entrada(f, b, x) == entrada[(size_t) b * r + x],
+                     "%s/%s: registrador %u vivo na entrada de B%u?", nome, f->nome, x, b);
+            CONFERIR(ri_vivo_saida(f, b, x) == saida[(size_t) b * r + x],
+                     "%s/%s: registrador %u vivo na saida de B%u?", nome, f->nome, x, b);
+        }
+    }
+    free(entrada);
+    free(saida);
+    free(vivo);
+}
+
+/*
+ * Alocação na pós-ordem reversa: de trás para frente em cada bloco, quem
+ * uma instrução define não pode dividir registrador com outro valor vivo
+ * depois dela, e numa chamada todo valor vivo depois dela que está num $t
+ * tem de estar na máscara de salvamento.
+ */
+static void conferir_alocacao(const char* nome, const FuncaoRI* f) {
+    AlocacaoRI aloc;
+    if (alocar_registradores(f, f->rpo, f->num_rpo, 1, &aloc) != 0) {
+        CONFERIR(0, "%s/%s: alocacao falhou", nome, f->nome);
+        return;
+    }
+    uint8_t* vivo = malloc(f->num_regs + 1);
+    uint32_t chamadas = 0;
+    for (uint32_t i = 0; i < f->num_rpo; i++) {
+        uint32_t b = f->rpo[i];
+        const BlocoRI* bloco = &f->blocos[b];
+        uint32_t chamada = chamadas;
+        for (uint32_t j = 0; j < bloco->num_instrs; j++) chamada += RI_INSTR(f, b, j)->op == RI_CHAMADA;
+        chamadas = chamada;
+        for (RegRI r = 0; r < f->num_regs; r++) vivo[r] = ri_vivo_saida(f, b, r);
+        for (uint32_t j = bloco->num_instrs; j-- > 0;) {
+            const InstrRI* in = RI_INSTR(f, b, j);
+            RegRI d = ri_definicao(in);
+            if (in->op == RI_CHAMADA) chamada--;
+            for (RegRI r = 0; r < f->num_regs; r++) {
+                if (!vivo[r] || r == d || aloc.registrador[r] < 0) continue;
+                if (d != RI_NENHUM) {
+                    CONFERIR(aloc.registrador[d] != aloc.registrador[r],
+                             "%s/%s: %u e %u no mesmo registrador em B%u", nome, f->nome, d, r, b);
+                }
+                if (in->op == RI_CHAMADA && aloc.registrador[r] < ALOCADOR_PRIMEIRO_S) {
+                    CONFERIR(aloc.salvar[chamada] & (1u << (aloc.registrador[r] - ALOCADOR_PRIMEIRO_T)),
+                             "%s/%s: %u nao e salvo na chamada de B%u", nome, f->nome, r, b);
+                }
+            }
+            if (d != RI_NENHUM) vivo[d] = 0;
+            RegRI usos[2];
+            int nu = ri_usos(in, usos);
+            for (int u = 0; u < nu; u++) vivo[usos[u]] = 1;
+            if (in->op == RI_CHAMADA) {
+                for (uint32_t a = 0; a < in->b; a++) vivo[RI_ARGUMENTOS(f, in)[a]] = 1;
+            }
+        }
+    }
+    free(vivo);
+    liberar_alocacao(&aloc);
+}
+
+static void conferir_funcao(const char* nome, const FuncaoRI* f) {
+    conferir_blocos(nome, f);
+    conferir_cfg(nome, f);
+    conferir_dominadores(nome, f);
+    conferir_vivacidade(nome, f);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s arquivo.g...\n", argv[0]);
+        return 1;
+    }
+
+    int programas = 0;
+    for (int i = 1; i < argc; i++) {
+        size_t tamanho;
+        char* texto = ler_arquivo(argv[i], &tamanho);
+        if (texto == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        CompilerContext* ctx = compilador_criar();
+        if (compilador_carregar_memoria(ctx, texto, tamanho) != 0 || compilador_analisar(ctx) != 0 ||
+            compilador_verificar(ctx) != 0) {
+            // Programas com erro não chegam à RI
+            compilador_destruir(ctx);
+            free(texto);
+            continue;
+        }
+
+        ProgramaRI prog;
+        CONFERIR(ri_traduzir(&ctx->ast, ctx->raiz, &prog) == 0, "%s: traducao falhou", argv[i]);
+        // As análises refeitas depois da recursão final, da integração e dos laços também são conferidas
+        CONFERIR(eliminar_recursao_final(&prog, &ctx->otimizacao) == 0, "%s: recursao final falhou", argv[i]);
+        CONFERIR(integrar_funcoes(&prog, NULL, &ctx->otimizacao) == 0, "%s: integracao falhou", argv[i]);
+        CONFERIR(otimizar_lacos(&prog, &ctx->otimizacao) == 0, "%s: otimizacao de lacos falhou", argv[i]);
+        conferir_funcao(argv[i], &prog.principal);
+        for (uint32_t k = 0; k < prog.num_funcoes; k++) conferir_funcao(argv[i], &prog.funcoes[k]);
+        CONFERIR(separar_teias(&prog) == 0, "%s: separacao em teias falhou", argv[i]);
+        for (uint32_t k = 0; k <= prog.num_funcoes; k++) {
+            const FuncaoRI* f = k < prog.num_funcoes ? &prog.funcoes[k] : &prog.principal;
+            conferir_vivacidade(argv[i], f);
+            conferir_alocacao(argv[i], f);
+        }
+
+        char* saida = NULL;
+        size_t n = 0;
+        FILE* f = open_memstream(&saida, &n);
+        ri_imprimir(f, &prog);
+        CONFERIR(gerar_codigo_ri(&prog, f, CONVENCAO_REGISTRADORES) == 0, "%s: geracao a partir da RI falhou", argv[i]);
+        fclose(f);
+        CONFERIR(n > 0 && strstr(saida, "main:") != NULL, "%s: assembly sem main", argv[i]);
+        free(saida);
+
+        ri_liberar(&prog);
+        compilador_destruir(ctx);
+        free(texto);
+        programas++;
+    }
+
+    if (g_falhas > 0) {
+        printf("%d falha(s)\n", g_falhas);
+        return 1;
+    }
+    printf("RI conferida em %d programa(s)\n", programas);
+    return 0;
+}
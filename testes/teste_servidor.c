@@ -0,0 +1,361 @@
+/*
+ * Conversa com 'goianinha --servidor' por pipes e confere que as compilações
+ * incrementais (mesma chave de arquivo, cache aquecido) produzem exatamente o
+ * assembly e os diagnósticos de uma compilação sem cache (chave nova).
+ *
+ * Para cada programa: compila-o numa chave que acumula todas as edições, de
+ * novo sem mudanças (todas as funções reaproveitadas), com um comentário
+ * inserido no início (linhas deslocadas, funções iguais), com a última
+ * função alterada e com uma função nova antes do bloco principal. Depois,
+ * muda o tipo de uma global usada por uma função inalterada, o que deve
+ * invalidar o reaproveitamento.
+ *
+ * Por fim, mede um programa de 2000 funções editado no corpo de uma delas por
+ * vez: cada texto editado é compilado nas duas chaves, então os tempos com e
+ * sem reaproveitamento são sempre do mesmo texto, e a mediana com
+ * reaproveitamento tem de ser menor. Só no nível 0: no 1 não há o que medir.
+ *
+ * As opções antes dos arquivos (-O1, --convencao=..., --peephole=...) vão
+ * para o servidor. No nível 1 nada é reaproveitado, e cada resposta é
+ * comparada com a compilação pela biblioteca com as mesmas opções.
+ *
+ * Uso: teste_servidor ./goianinha [opções...] arquivo.g...
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "compilador.h"
+
+#define MAXIMO_OPCOES 8
+#define FUNCOES_GRANDE 2000
+#define EDICOES_GRANDE 21
+
+typedef struct {
+    int sucesso;
+    char* assembly;
+    size_t tamanho_assembly;
+    char* diagnosticos;
+    size_t tamanho_diagnosticos;
+    int reaproveitadas;
+    int geradas;
+    long microssegundos;
+} Resposta;
+
+static FILE* g_pedidos;
+static FILE* g_respostas;
+static int g_chaves;
+static int g_falhas;
+static long g_tempo_completo, g_tempo_incremental;
+static CompilerContext g_opcoes; /* Só as opções: nível, regras de janela e convenção */
+
+static char* ler_bytes(size_t tamanho) {
+    char* texto = malloc(tamanho + 1);
+    if (fread(texto, 1, tamanho, g_respostas) != tamanho) {
+        fprintf(stderr, "Resposta truncada do servidor\n");
+        exit(1);
+    }
+    texto[tamanho] = '\0';
+    return texto;
+}
+
+static void liberar_resposta(Resposta* r) {
+    free(r->assembly);
+    free(r->diagnosticos);
+}
+
+static Resposta compilar(const char* chave, const char* texto, size_t tamanho) {
+    Resposta r;
+    char estado[16];
+    fprintf(g_pedidos, "COMPILAR %s %zu\n", chave, tamanho);
+    fwrite(texto, 1, tamanho, g_pedidos);
+    fflush(g_pedidos);
+    if (fscanf(g_respostas, "%15s %zu %zu %d %d %ld", estado, &r.tamanho_assembly, &r.tamanho_diagnosticos,
+               &r.reaproveitadas, &r.geradas, &r.microssegundos) != 6 || fgetc(g_respostas) != '\n') {
+        fprintf(stderr, "Resposta invalida do servidor\n");
+        exit(1);
+    }
+    r.sucesso = strcmp(estado, "OK") == 0;
+    r.assembly = ler_bytes(r.tamanho_assembly);
+    r.diagnosticos = ler_bytes(r.tamanho_diagnosticos);
+    return r;
+}
+
+static void esquecer(const char* chave) {
+    char linha[64];
+    fprintf(g_pedidos, "ESQUECER %s\n", chave);
+    fflush(g_pedidos);
+    if (fgets(linha, sizeof(linha), g_respostas) == NULL || strncmp(linha, "OK", 2) != 0) {
+        fprintf(stderr, "Resposta invalida do servidor\n");
+        exit(1);
+    }
+}
+
+/* No nível 1 o servidor compila como a biblioteca: confere byte a byte */
+static void conferir_biblioteca(const char* nome, const char* etapa, const char* texto, size_t tamanho,
+                                const Resposta* r) {
+    CompilerContext* ctx = compilador_criar();
+    ctx->nivel_otimizacao = g_opcoes.nivel_otimizacao;
+    ctx->regras_janela = g_opcoes.regras_janela;
+    ctx->convencao = g_opcoes.convencao;
+    int sucesso = compilar_memoria(ctx, texto, tamanho) == 0;
+    size_t tamanho_assembly, tamanho_diagnosticos;
+    const char* assembly = compilador_assembly(ctx, &tamanho_assembly);
+    const char* diagnosticos = compilador_diagnosticos(ctx, &tamanho_diagnosticos);
+    if (!sucesso) tamanho_assembly = 0;
+
+    if (sucesso != r->sucesso || r->reaproveitadas != 0 || tamanho_assembly != r->tamanho_assembly ||
+        (sucesso && memcmp(assembly, r->assembly, tamanho_assembly) != 0) ||
+        tamanho_diagnosticos != r->tamanho_diagnosticos || memcmp(diagnosticos, r->diagnosticos, tamanho_diagnosticos) != 0) {
+        fprintf(stderr, "Divergencia da biblioteca em %s (%s)\n", nome, etapa);
+        g_falhas++;
+    }
+    compilador_destruir(ctx);
+}
+
+/*
+ * Compila 'texto' numa chave nova e na chave incremental, confere que são
+ * iguais e soma os dois tempos. Se 'tempos' não é NULL, guarda neles os
+ * tempos sem e com o cache.
+ */
+static Resposta conferir(const char* nome, const char* etapa, const char* texto, size_t tamanho, long* tempos) {
+    char chave[32];
+    snprintf(chave, sizeof(chave), "ref%d", g_chaves++);
+    Resposta ref = compilar(chave, texto, tamanho);
+    Resposta inc = compilar("incremental", texto, tamanho);
+    esquecer(chave);
+
+    if (ref.reaproveitadas != 0 || ref.sucesso != inc.sucesso ||
+        ref.tamanho_assembly != inc.tamanho_assembly || memcmp(ref.assembly, inc.assembly, ref.tamanho_assembly) != 0 ||
+        ref.tamanho_diagnosticos != inc.tamanho_diagnosticos ||
+        memcmp(ref.diagnosticos, inc.diagnosticos, ref.tamanho_diagnosticos) != 0) {
+        fprintf(stderr, "Divergencia em %s (%s)\n", nome, etapa);
+        g_falhas++;
+    }
+    if (g_opcoes.nivel_otimizacao >= 1) conferir_biblioteca(nome, etapa, texto, tamanho, &inc);
+
+    g_tempo_completo += ref.microssegundos;
+    g_tempo_incremental += inc.microssegundos;
+    if (tempos != NULL) {
+        tempos[0] = ref.microssegundos;
+        tempos[1] = inc.microssegundos;
+    }
+    liberar_resposta(&ref);
+    return inc;
+}
+
+static char* concatenar(const char* a, size_t na, const char* b, size_t nb, const char* c, size_t nc) {
+    char* texto = malloc(na + nb + nc + 1);
+    memcpy(texto, a, na);
+    memcpy(texto + na, b, nb);
+    memcpy(texto + na + nb, c, nc);
+    texto[na + nb + nc] = '\0';
+    return texto;
+}
+
+/* Último "programa" que começa uma linha */
+static const char* bloco_principal(const char* texto) {
+    const char* principal = NULL;
+    for (const char* p = strstr(texto, "programa"); p != NULL; p = strstr(p + 1, "programa")) {
+        if (p == texto || p[-1] == '\n') principal = p;
+    }
+    return principal;
+}
+
+static void exercitar(const char* nome, const char* texto, size_t tamanho) {
+    Resposta r = conferir(nome, "original", texto, tamanho, NULL);
+    int funcoes = r.reaproveitadas + r.geradas;
+    int sucesso = r.sucesso;
+    liberar_resposta(&r);
+
+    r = conferir(nome, "repetido", texto, tamanho, NULL);
+    int esperadas = g_opcoes.nivel_otimizacao >= 1 ? 0 : funcoes;
+    if (sucesso && (r.reaproveitadas != esperadas || r.geradas != funcoes - esperadas)) {
+        fprintf(stderr, "%s: %d de %d funcoes reaproveitadas sem mudancas\n", nome, r.reaproveitadas, funcoes);
+        g_falhas++;
+    }
+    liberar_resposta(&r);
+
+    const char* comentario = "/* editado */\n\n";
+    char* editado = concatenar(comentario, strlen(comentario), texto, tamanho, "", 0);
+    size_t total = tamanho + strlen(comentario);
+    r = conferir(nome, "comentario", editado, total, NULL);
+    liberar_resposta(&r);
+
+    /* Altera a última função: insere um comando vazio no início do corpo */
+    const char* principal = bloco_principal(editado);
+    const char* corpo = NULL;
+    for (const char* p = strchr(editado, '{'); p != NULL && (principal == NULL || p < principal); p = strchr(p + 1, '{')) {
+        corpo = p;
+    }
+    if (corpo != NULL) {
+        size_t antes = (size_t) (corpo + 1 - editado);
+        char* alterado = concatenar(editado, antes, " ;", 2, corpo + 1, total - antes);
+        r = conferir(nome, "funcao alterada", alterado, total + 2, NULL);
+        liberar_resposta(&r);
+        free(alterado);
+    }
+
+    /* Acrescenta uma função antes do bloco principal */
+    if (principal != NULL) {
+        const char* nova = "int funcao_acrescentada(int x) { retorne x + 1; }\n";
+        size_t antes = (size_t) (principal - editado);
+        char* acrescido = concatenar(editado, antes, nova, strlen(nova), principal, total - antes);
+        r = conferir(nome, "funcao acrescentada", acrescido, total + strlen(nova), NULL);
+        liberar_resposta(&r);
+        free(acrescido);
+    }
+    free(editado);
+}
+
+static int comparar_tempos(const void* a, const void* b) {
+    long x = *(const long*) a, y = *(const long*) b;
+    return (x > y) - (x < y);
+}
+
+/* Programa com FUNCOES_GRANDE funções encadeadas, a i-ésima com constantes[i] */
+static char* programa_grande(const int* constantes, size_t* tamanho) {
+    char* texto = NULL;
+    FILE* saida = open_memstream(&texto, tamanho);
+    fprintf(saida, "int g;\n");
+    for (int i = 0; i < FUNCOES_GRANDE; i++) {
+        fprintf(saida, "int f%d(int a) {\n  int x;\n  x = a * %d + g;\n", i, constantes[i]);
+        fprintf(saida, "  se (x > 100) entao retorne x - 1;\n");
+        if (i > 0) {
+            fprintf(saida, "  retorne f%d(x + 1);\n}\n", i - 1);
+        } else {
+            fprintf(saida, "  retorne x;\n}\n");
+        }
+    }
+    fprintf(saida, "programa {\n  g = 1;\n  escreva f%d(3);\n  novalinha;\n}\n", FUNCOES_GRANDE - 1);
+    fclose(saida);
+    return texto;
+}
+
+static void medir_programa_grande(void) {
+    long completo[EDICOES_GRANDE], incremental[EDICOES_GRANDE];
+    static int constantes[FUNCOES_GRANDE];
+    for (int i = 0; i < FUNCOES_GRANDE; i++) constantes[i] = 2;
+    size_t tamanho;
+    char* texto = programa_grande(constantes, &tamanho);
+    Resposta r = conferir("grande", "original", texto, tamanho, NULL);
+    liberar_resposta(&r);
+    free(texto);
+
+    for (int e = 0; e < EDICOES_GRANDE; e++) {
+        long tempos[2];
+        constantes[(e * 97) % FUNCOES_GRANDE] = 3 + e;
+        texto = programa_grande(constantes, &tamanho);
+        r = conferir("grande", "corpo editado", texto, tamanho, tempos);
+        if (r.sucesso && r.geradas != 1) {
+            fprintf(stderr, "grande: %d funcoes geradas para uma funcao editada\n", r.geradas);
+            g_falhas++;
+        }
+        completo[e] = tempos[0];
+        incremental[e] = tempos[1];
+        liberar_resposta(&r);
+        free(texto);
+    }
+
+    qsort(completo, EDICOES_GRANDE, sizeof(long), comparar_tempos);
+    qsort(incremental, EDICOES_GRANDE, sizeof(long), comparar_tempos);
+    long mediana_completo = completo[EDICOES_GRANDE / 2], mediana_incremental = incremental[EDICOES_GRANDE / 2];
+    printf("%d funcoes, uma editada por vez: mediana de %ld us sem cache, %ld us com cache\n",
+           FUNCOES_GRANDE, mediana_completo, mediana_incremental);
+    if (mediana_incremental >= mediana_completo) {
+        fprintf(stderr, "grande: a compilacao incremental nao foi mais rapida\n");
+        g_falhas++;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s ./goianinha [opcoes...] arquivo.g...\n", argv[0]);
+        return 1;
+    }
+
+    char* argumentos[MAXIMO_OPCOES + 3] = { argv[1], "--servidor" };
+    int num_argumentos = 2;
+    int primeiro = 2;
+    g_opcoes.regras_janela = -1;
+    g_opcoes.convencao = -1;
+    for (; primeiro < argc && argv[primeiro][0] == '-' && num_argumentos < MAXIMO_OPCOES + 2; primeiro++) {
+        const char* opcao = argv[primeiro];
+        unsigned regras;
+        if (strcmp(opcao, "-O1") == 0) {
+            g_opcoes.nivel_otimizacao = 1;
+        } else if (strcmp(opcao, "--convencao=pilha") == 0) {
+            g_opcoes.convencao = CONVENCAO_PILHA;
+        } else if (strcmp(opcao, "--convencao=registradores") == 0) {
+            g_opcoes.convencao = CONVENCAO_REGISTRADORES;
+        } else if (strncmp(opcao, "--peephole=", 11) == 0 && janela_ler_regras(opcao + 11, &regras) == 0) {
+            g_opcoes.regras_janela = (int) regras;
+        } else if (strcmp(opcao, "-O0") != 0) {
+            fprintf(stderr, "Opcao desconhecida: %s\n", opcao);
+            return 1;
+        }
+        argumentos[num_argumentos++] = argv[primeiro];
+    }
+    argumentos[num_argumentos] = NULL;
+
+    int para_servidor[2], do_servidor[2];
+    if (pipe(para_servidor) != 0 || pipe(do_servidor) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(para_servidor[0], STDIN_FILENO);
+        dup2(do_servidor[1], STDOUT_FILENO);
+        close(para_servidor[1]);
+        close(do_servidor[0]);
+        execv(argv[1], argumentos);
+        perror("execv");
+        _exit(127);
+    }
+    close(para_servidor[0]);
+    close(do_servidor[1]);
+    g_pedidos = fdopen(para_servidor[1], "w");
+    g_respostas = fdopen(do_servidor[0], "r");
+
+    for (int i = primeiro; i < argc; i++) {
+        FonteMapeada fonte;
+        FILE* entrada = fopen(argv[i], "r");
+        if (entrada == NULL || ler_fonte(entrada, &fonte) != 0) {
+            fprintf(stderr, "Erro: Nao foi possivel ler '%s'\n", argv[i]);
+            return 1;
+        }
+        fclose(entrada);
+        exercitar(argv[i], fonte.dados, fonte.tamanho);
+        free(fonte.dados);
+    }
+
+    /* Corpo de 'dobro' inalterado, mas a global que ele usa muda de tipo */
+    const char* v1 = "int g;\nint dobro(int a) { g = a; retorne a + a; }\n"
+                     "int outra() { retorne 1; }\nprograma { escreva dobro(2); }\n";
+    const char* v2 = "car g;\nint dobro(int a) { g = a; retorne a + a; }\n"
+                     "int outra() { retorne 1; }\nprograma { escreva dobro(2); }\n";
+    Resposta r = conferir("global", "v1", v1, strlen(v1), NULL);
+    liberar_resposta(&r);
+    r = conferir("global", "v2", v2, strlen(v2), NULL);
+    if (r.sucesso) {
+        fprintf(stderr, "global: a mudanca de tipo de 'g' nao foi detectada\n");
+        g_falhas++;
+    }
+    liberar_resposta(&r);
+
+    if (g_opcoes.nivel_otimizacao == 0) medir_programa_grande();
+
+    fprintf(g_pedidos, "SAIR\n");
+    fclose(g_pedidos);
+    fclose(g_respostas);
+    int status;
+    waitpid(pid, &status, 0);
+
+    printf("%d compilacoes: %d divergencias\n", 2 * g_chaves, g_falhas);
+    printf("tempo total dos mesmos textos: %ld us sem cache, %ld us com cache\n",
+           g_tempo_completo, g_tempo_incremental);
+    return g_falhas != 0;
+}